@@ -19,6 +19,7 @@ limitations under the License.
 #include <fcntl.h>
 #include <stddef.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <memory>
@@ -52,6 +53,34 @@ int64 GetPageSizeAlignedOffset(int64 offset) {
   return aligned_offset;
 }
 
+// Creates the status corresponding to a failed open(2) or shm_open(3) call
+// with the provided errno.
+absl::Status CreateOpenErrorStatus(const std::string& error_message,
+                                   int open_errno) {
+  switch (open_errno) {
+    case ENOENT:
+      return CreateStatusWithPayload(StatusCode::kNotFound, error_message,
+                                     TfLiteSupportStatus::kFileNotFoundError);
+    case EACCES:
+    case EPERM:
+      return CreateStatusWithPayload(
+          StatusCode::kPermissionDenied, error_message,
+          TfLiteSupportStatus::kFilePermissionDeniedError);
+    case EINTR:
+      return CreateStatusWithPayload(StatusCode::kUnavailable, error_message,
+                                     TfLiteSupportStatus::kFileReadError);
+    case EBADF:
+      return CreateStatusWithPayload(StatusCode::kFailedPrecondition,
+                                     error_message,
+                                     TfLiteSupportStatus::kFileReadError);
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kUnknown,
+          absl::StrFormat("%s, errno=%d", error_message, open_errno),
+          TfLiteSupportStatus::kFileReadError);
+  }
+}
+
 }  // namespace
 
 /* static */
@@ -72,11 +101,12 @@ absl::Status ExternalFileHandler::MapExternalFile() {
     return absl::OkStatus();
   }
   if (external_file_.file_name().empty() &&
-      !external_file_.has_file_descriptor_meta()) {
+      !external_file_.has_file_descriptor_meta() &&
+      !external_file_.has_shared_memory_meta()) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
-        "ExternalFile must specify at least one of 'file_content', file_name' "
-        "or 'file_descriptor_meta'.",
+        "ExternalFile must specify at least one of 'file_content', file_name', "
+        "'file_descriptor_meta' or 'shared_memory_meta'.",
         TfLiteSupportStatus::kInvalidArgumentError);
   }
   // Obtain file descriptor, offset and size.
@@ -84,35 +114,13 @@ absl::Status ExternalFileHandler::MapExternalFile() {
   if (!external_file_.file_name().empty()) {
     owned_fd_ = open(external_file_.file_name().c_str(), O_RDONLY);
     if (owned_fd_ < 0) {
-      const std::string error_message = absl::StrFormat(
-          "Unable to open file at %s", external_file_.file_name());
-      switch (errno) {
-        case ENOENT:
-          return CreateStatusWithPayload(
-              StatusCode::kNotFound, error_message,
-              TfLiteSupportStatus::kFileNotFoundError);
-        case EACCES:
-        case EPERM:
-          return CreateStatusWithPayload(
-              StatusCode::kPermissionDenied, error_message,
-              TfLiteSupportStatus::kFilePermissionDeniedError);
-        case EINTR:
-          return CreateStatusWithPayload(StatusCode::kUnavailable,
-                                         error_message,
-                                         TfLiteSupportStatus::kFileReadError);
-        case EBADF:
-          return CreateStatusWithPayload(StatusCode::kFailedPrecondition,
-                                         error_message,
-                                         TfLiteSupportStatus::kFileReadError);
-        default:
-          return CreateStatusWithPayload(
-              StatusCode::kUnknown,
-              absl::StrFormat("%s, errno=%d", error_message, errno),
-              TfLiteSupportStatus::kFileReadError);
-      }
+      return CreateOpenErrorStatus(
+          absl::StrFormat("Unable to open file at %s",
+                          external_file_.file_name()),
+          errno);
     }
     fd = owned_fd_;
-  } else {
+  } else if (external_file_.has_file_descriptor_meta()) {
     fd = external_file_.file_descriptor_meta().fd();
     if (fd < 0) {
       return CreateStatusWithPayload(
@@ -122,6 +130,28 @@ absl::Status ExternalFileHandler::MapExternalFile() {
     }
     buffer_offset_ = external_file_.file_descriptor_meta().offset();
     buffer_size_ = external_file_.file_descriptor_meta().length();
+  } else {
+    const SharedMemoryMeta& shared_memory_meta =
+        external_file_.shared_memory_meta();
+#ifdef __ANDROID__
+    return CreateStatusWithPayload(
+        StatusCode::kUnimplemented,
+        "POSIX shared memory is not supported on Android: use a memfd or "
+        "ASharedMemory file descriptor through 'file_descriptor_meta' instead.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+#else
+    owned_fd_ = shm_open(shared_memory_meta.name().c_str(), O_RDONLY,
+                         /*mode=*/0);
+    if (owned_fd_ < 0) {
+      return CreateOpenErrorStatus(
+          absl::StrFormat("Unable to open shared memory object %s",
+                          shared_memory_meta.name()),
+          errno);
+    }
+#endif
+    fd = owned_fd_;
+    buffer_offset_ = shared_memory_meta.offset();
+    buffer_size_ = shared_memory_meta.length();
   }
   // Get actual file size. Always use 0 as offset to lseek(2) to get the actual
   // file size, as SEEK_END returns the size of the file *plus* offset.
@@ -153,23 +183,100 @@ absl::Status ExternalFileHandler::MapExternalFile() {
                         buffer_size_ + buffer_offset_, file_size),
         TfLiteSupportStatus::kInvalidArgumentError);
   }
+  // Identify the mapped region by the file it comes from and its last
+  // modification: the status change time can't be set by users, so that any
+  // change to the file contents results in a different identity.
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0) {
+#ifdef __APPLE__
+    const struct timespec& mtime = file_stat.st_mtimespec;
+    const struct timespec& ctime = file_stat.st_ctimespec;
+#else
+    const struct timespec& mtime = file_stat.st_mtim;
+    const struct timespec& ctime = file_stat.st_ctim;
+#endif
+    file_identity_ = absl::StrFormat(
+        "%d.%d.%d.%d.%d.%d.%d.%d.%d", file_stat.st_dev, file_stat.st_ino,
+        file_stat.st_size, mtime.tv_sec, mtime.tv_nsec, ctime.tv_sec,
+        ctime.tv_nsec, buffer_offset_, buffer_size_);
+  }
   // If buffer_offset_ is not multiple of sysconf(_SC_PAGE_SIZE), align with
   // extra leading bytes and adjust buffer_size_ to account for the extra
   // leading bytes.
   buffer_aligned_offset_ = GetPageSizeAlignedOffset(buffer_offset_);
   buffer_aligned_size_ = buffer_size_ + buffer_offset_ - buffer_aligned_offset_;
   // Map into memory.
-  buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ, MAP_SHARED,
-                 fd, buffer_aligned_offset_);
+  int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+  if (external_file_.memory_mapping_options().populate()) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+  buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ, flags, fd,
+                 buffer_aligned_offset_);
   if (buffer_ == MAP_FAILED) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown,
         absl::StrFormat("Unable to map file to memory buffer, errno=%d", errno),
         TfLiteSupportStatus::kFileMmapError);
   }
+  return ApplyMemoryMappingOptions();
+}
+
+absl::Status ExternalFileHandler::ApplyMemoryMappingOptions() {
+  const MemoryMappingOptions& options = external_file_.memory_mapping_options();
+  // madvise(2) hints are best-effort: failures are deliberately ignored, e.g.
+  // MADV_HUGEPAGE returns EINVAL on kernels built without huge pages support.
+  switch (options.access_pattern()) {
+    case MemoryMappingOptions::ACCESS_PATTERN_SEQUENTIAL:
+      madvise(buffer_, buffer_aligned_size_, MADV_SEQUENTIAL);
+      break;
+    case MemoryMappingOptions::ACCESS_PATTERN_WILLNEED:
+      madvise(buffer_, buffer_aligned_size_, MADV_WILLNEED);
+      break;
+    case MemoryMappingOptions::ACCESS_PATTERN_RANDOM:
+      madvise(buffer_, buffer_aligned_size_, MADV_RANDOM);
+      break;
+    default:
+      break;
+  }
+#ifdef MADV_HUGEPAGE
+  if (options.transparent_huge_pages()) {
+    madvise(buffer_, buffer_aligned_size_, MADV_HUGEPAGE);
+  }
+#endif
+  if (options.lock()) {
+    if (mlock(buffer_, buffer_aligned_size_) != 0) {
+      const int mlock_errno = errno;
+      return CreateStatusWithPayload(
+          mlock_errno == EPERM ? StatusCode::kPermissionDenied
+                               : StatusCode::kResourceExhausted,
+          absl::StrFormat("Unable to lock memory buffer, errno=%d",
+                          mlock_errno),
+          TfLiteSupportStatus::kFileMmapError);
+    }
+    buffer_locked_ = true;
+  }
+  // Populated or locked pages are already resident: no need to prefetch.
+  if (options.background_prefetch() && !options.populate() &&
+      !options.lock()) {
+    prefetch_thread_ = std::thread([this] { PrefetchMappedPages(); });
+  }
   return absl::OkStatus();
 }
 
+void ExternalFileHandler::PrefetchMappedPages() {
+  const volatile char* data = static_cast<const volatile char*>(buffer_);
+  const int64 page_size = sysconf(_SC_PAGE_SIZE);
+  for (int64 offset = 0; offset < buffer_aligned_size_; offset += page_size) {
+    if (stop_prefetch_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    // Reading a single byte is enough to fault the whole page in.
+    (void)data[offset];
+  }
+}
+
 absl::string_view ExternalFileHandler::GetFileContent() {
   if (!external_file_.file_content().empty()) {
     return external_file_.file_content();
@@ -181,6 +288,14 @@ absl::string_view ExternalFileHandler::GetFileContent() {
 }
 
 ExternalFileHandler::~ExternalFileHandler() {
+  // The prefetch thread reads from buffer_: it must be done before unmapping.
+  if (prefetch_thread_.joinable()) {
+    stop_prefetch_.store(true, std::memory_order_relaxed);
+    prefetch_thread_.join();
+  }
+  if (buffer_locked_) {
+    munlock(buffer_, buffer_aligned_size_);
+  }
   if (buffer_ != MAP_FAILED) {
     munmap(buffer_, buffer_aligned_size_);
   }
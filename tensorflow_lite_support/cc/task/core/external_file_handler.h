@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_EXTERNAL_FILE_HANDLER_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_EXTERNAL_FILE_HANDLER_H_
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -33,6 +36,10 @@ namespace core {
 // proto fields) of opening and/or mapping the file in memory at creation time,
 // as well as closing and/or unmapping at destruction time.
 //
+// The mapping can be tuned through the ExternalFile `memory_mapping_options`,
+// e.g. to populate or lock the pages in memory, or to prefetch them from a
+// background thread.
+//
 // [1]: support/c/task/core/proto/external_file.proto
 class ExternalFileHandler {
  public:
@@ -52,25 +59,44 @@ class ExternalFileHandler {
   // valid as long as the ExternalFileHandler is alive.
   absl::string_view GetFileContent();
 
+  // Returns a string identifying the mapped file region: device and inode
+  // numbers, size, modification and status change times of the file, as well
+  // as offset and length of the region within it. Computing it only takes a
+  // fstat(2) call at mapping time, and it changes whenever the file is
+  // modified. Empty if the contents were provided in memory, or if the file
+  // couldn't be identified.
+  const std::string& GetFileIdentity() const { return file_identity_; }
+
  private:
   // Private constructor, called from CreateFromExternalFile().
   explicit ExternalFileHandler(const ExternalFile* external_file)
       : external_file_(*external_file) {}
 
-  // Opens (if provided by path) and maps (if provided by path or file
-  // descriptor) the external file in memory. Does nothing otherwise, as file
-  // contents are already loaded in memory.
+  // Opens (if provided by path or shared memory object name) and maps (if
+  // provided by path, file descriptor or shared memory object name) the
+  // external file in memory. Does nothing otherwise, as file contents are
+  // already loaded in memory.
   absl::Status MapExternalFile();
 
+  // Applies the ExternalFile `memory_mapping_options` (madvise(2) hints,
+  // mlock(2) and background prefetching) to the mapped memory buffer.
+  absl::Status ApplyMemoryMappingOptions();
+
+  // Touches every page of the mapped memory buffer, unless stop_prefetch_ gets
+  // set in the meantime. Runs on prefetch_thread_.
+  void PrefetchMappedPages();
+
   // Reference to the input ExternalFile.
   const ExternalFile& external_file_;
 
-  // The file descriptor of the ExternalFile if provided by path, as it is
-  // opened and owned by this class. Set to -1 otherwise.
+  // The file descriptor of the ExternalFile if provided by path or shared
+  // memory object name, as it is opened and owned by this class. Set to -1
+  // otherwise.
   int owned_fd_{-1};
 
   // Points to the memory buffer mapped from the file descriptor of the
-  // ExternalFile, if provided by path or file descriptor.
+  // ExternalFile, if provided by path, file descriptor or shared memory object
+  // name.
   void* buffer_{};
 
   // The mapped memory buffer offset, if any.
@@ -78,6 +104,9 @@ class ExternalFileHandler {
   // The size in bytes of the mapped memory buffer, if any.
   int64 buffer_size_{};
 
+  // The identity of the mapped file region, see GetFileIdentity().
+  std::string file_identity_;
+
   // As mmap(2) requires the offset to be a multiple of sysconf(_SC_PAGE_SIZE):
 
   // The aligned mapped memory buffer offset, if any.
@@ -85,6 +114,14 @@ class ExternalFileHandler {
   // The aligned mapped memory buffer size in bytes taking into account the
   // offset shift introduced by buffer_aligned_memory_offset_, if any.
   int64 buffer_aligned_size_{};
+
+  // Whether the mapped memory buffer has been locked using mlock(2).
+  bool buffer_locked_{false};
+
+  // Background thread prefetching the mapped memory buffer, if requested
+  // through `memory_mapping_options`, and the flag used to stop it early.
+  std::thread prefetch_thread_;
+  std::atomic<bool> stop_prefetch_{false};
 };
 
 }  // namespace core
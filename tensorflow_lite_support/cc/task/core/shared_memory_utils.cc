@@ -0,0 +1,174 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/shared_memory_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/memfd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "absl/strings/str_format.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+// Resizes the file referred to by `fd` to the size of `buffer` and copies the
+// buffer contents into it.
+absl::Status WriteBufferToFile(absl::string_view buffer, int fd) {
+  if (ftruncate(fd, buffer.size()) != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kResourceExhausted,
+        absl::StrFormat("Unable to resize shared memory to %d bytes, errno=%d",
+                        buffer.size(), errno),
+        TfLiteSupportStatus::kFileReadError);
+  }
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t result = pwrite(fd, buffer.data() + written,
+                            buffer.size() - written, written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return CreateStatusWithPayload(
+          StatusCode::kUnknown,
+          absl::StrFormat("Unable to write to shared memory, errno=%d", errno),
+          TfLiteSupportStatus::kFileReadError);
+    }
+    written += result;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+StatusOr<int> CreateSealedMemoryFile(absl::string_view buffer,
+                                     const std::string& debug_name) {
+  if (buffer.empty()) {
+    return CreateStatusWithPayload(StatusCode::kInvalidArgument,
+                                   "Expected non-empty buffer.",
+                                   TfLiteSupportStatus::kInvalidArgumentError);
+  }
+#if defined(__linux__) && defined(SYS_memfd_create)
+  int fd = syscall(SYS_memfd_create, debug_name.c_str(),
+                   MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("memfd_create failed, errno=%d", errno),
+        TfLiteSupportStatus::kFileReadError);
+  }
+  absl::Status status = WriteBufferToFile(buffer, fd);
+  if (!status.ok()) {
+    close(fd);
+    return status;
+  }
+#ifdef F_ADD_SEALS
+  // Readers map the file with MAP_SHARED: sealing guarantees them that its
+  // contents can't change under their feet.
+  if (fcntl(fd, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+    const int fcntl_errno = errno;
+    close(fd);
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Unable to seal memory file, errno=%d", fcntl_errno),
+        TfLiteSupportStatus::kFileReadError);
+  }
+#endif
+  return fd;
+#else
+  return CreateStatusWithPayload(
+      StatusCode::kUnimplemented,
+      "memfd_create is not supported on this platform.",
+      TfLiteSupportStatus::kError);
+#endif
+}
+
+StatusOr<ExternalFile> PublishToSharedMemory(absl::string_view buffer,
+                                             const std::string& name) {
+  if (buffer.empty()) {
+    return CreateStatusWithPayload(StatusCode::kInvalidArgument,
+                                   "Expected non-empty buffer.",
+                                   TfLiteSupportStatus::kInvalidArgumentError);
+  }
+#ifdef __ANDROID__
+  return CreateStatusWithPayload(
+      StatusCode::kUnimplemented,
+      "POSIX shared memory is not supported on Android: use "
+      "CreateSealedMemoryFile instead.",
+      TfLiteSupportStatus::kError);
+#else
+  // Created with owner read-write permissions, so that only the publisher can
+  // modify the object while other processes of the same user open it
+  // read-only.
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return CreateStatusWithPayload(
+        errno == EEXIST ? StatusCode::kAlreadyExists : StatusCode::kUnknown,
+        absl::StrFormat("Unable to create shared memory object %s, errno=%d",
+                        name, errno),
+        TfLiteSupportStatus::kFileReadError);
+  }
+  absl::Status status = WriteBufferToFile(buffer, fd);
+  close(fd);
+  if (!status.ok()) {
+    shm_unlink(name.c_str());
+    return status;
+  }
+  ExternalFile external_file;
+  external_file.mutable_shared_memory_meta()->set_name(name);
+  external_file.mutable_shared_memory_meta()->set_length(buffer.size());
+  return external_file;
+#endif
+}
+
+absl::Status UnlinkSharedMemory(const std::string& name) {
+#ifdef __ANDROID__
+  return CreateStatusWithPayload(
+      StatusCode::kUnimplemented,
+      "POSIX shared memory is not supported on Android.",
+      TfLiteSupportStatus::kError);
+#else
+  if (shm_unlink(name.c_str()) != 0) {
+    return CreateStatusWithPayload(
+        errno == ENOENT ? StatusCode::kNotFound : StatusCode::kUnknown,
+        absl::StrFormat("Unable to unlink shared memory object %s, errno=%d",
+                        name, errno),
+        TfLiteSupportStatus::kFileReadError);
+  }
+  return absl::OkStatus();
+#endif
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_MEMORY_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_MEMORY_UTILS_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Helpers to publish an in-memory buffer (e.g. a model fetched from a blob
+// store and decompressed) so that a single copy of it can be mapped read-only
+// by several processes through an ExternalFile, instead of each process
+// holding its own copy in `file_content`.
+
+// Copies `buffer` into a new anonymous memory file created with
+// memfd_create(2), seals it against any further modification, and returns its
+// file descriptor. Ownership of the file descriptor is transferred to the
+// caller, who can share it with other processes (e.g. through fork(2) or
+// SCM_RIGHTS) and reference it in ExternalFile.file_descriptor_meta. The memory
+// is released once all file descriptors and mappings are closed.
+//
+// `debug_name` is only used for display, e.g. in /proc/self/fd. Only supported
+// on Linux and Android.
+tflite::support::StatusOr<int> CreateSealedMemoryFile(
+    absl::string_view buffer, const std::string& debug_name);
+
+// Copies `buffer` into a new POSIX shared memory object named `name` (see
+// shm_open(3)), readable by all processes of the same user, and returns an
+// ExternalFile referring to it through `shared_memory_meta`. Fails if an object
+// with this name already exists. The object lives until UnlinkSharedMemory is
+// called, even if no process maps it. Not supported on Android.
+tflite::support::StatusOr<ExternalFile> PublishToSharedMemory(
+    absl::string_view buffer, const std::string& name);
+
+// Removes the POSIX shared memory object named `name`. Processes which already
+// mapped it are not affected.
+absl::Status UnlinkSharedMemory(const std::string& name);
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_MEMORY_UTILS_H_
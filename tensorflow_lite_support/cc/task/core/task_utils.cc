@@ -61,6 +61,26 @@ std::string LoadBinaryContent(const char* filename) {
   return buffer;
 }
 
+int FindInputTensorIndexByName(
+    const tflite::metadata::ModelMetadataExtractor& metadata_extractor,
+    int num_tensors, absl::string_view name) {
+  if (metadata_extractor.GetInputTensorMetadata() == nullptr ||
+      metadata_extractor.GetInputTensorCount() != num_tensors) {
+    return -1;
+  }
+  return metadata_extractor.FindInputTensorIndex(name);
+}
+
+int FindOutputTensorIndexByName(
+    const tflite::metadata::ModelMetadataExtractor& metadata_extractor,
+    int num_tensors, absl::string_view name) {
+  if (metadata_extractor.GetOutputTensorMetadata() == nullptr ||
+      metadata_extractor.GetOutputTensorCount() != num_tensors) {
+    return -1;
+  }
+  return metadata_extractor.FindOutputTensorIndex(name);
+}
+
 }  // namespace core
 }  // namespace task
 }  // namespace tflite
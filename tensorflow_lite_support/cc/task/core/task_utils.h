@@ -23,11 +23,13 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/type_to_tflitetype.h"
+#include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
 namespace tflite {
@@ -175,6 +177,31 @@ static TensorType* FindTensorByName(
   return nullptr;
 }
 
+// Gets the index of the input tensor with name specified inside metadata, out
+// of `num_tensors` input tensors. Returns -1 if no such tensor can be found or
+// if the metadata doesn't describe exactly `num_tensors` tensors, i.e. in the
+// same cases as FindTensorByName returns nullptr.
+//
+// This relies on the name-to-index map precomputed by the metadata extractor
+// and is meant to be called once at initialization time: the resolved index
+// can then be used with GetTensorAtIndex on the inference hot path.
+int FindInputTensorIndexByName(
+    const tflite::metadata::ModelMetadataExtractor& metadata_extractor,
+    int num_tensors, absl::string_view name);
+
+// Same as above, but for output tensors.
+int FindOutputTensorIndexByName(
+    const tflite::metadata::ModelMetadataExtractor& metadata_extractor,
+    int num_tensors, absl::string_view name);
+
+// Gets the tensor from a vector of tensors at the provided index, or nullptr
+// if the index is out of range (e.g. -1 for an unresolved tensor).
+template <typename TensorType>
+inline TensorType* GetTensorAtIndex(const std::vector<TensorType*>& tensors,
+                                    int index) {
+  return index >= 0 && index < tensors.size() ? tensors[index] : nullptr;
+}
+
 }  // namespace core
 }  // namespace task
 }  // namespace tflite
@@ -17,14 +17,19 @@ limitations under the License.
 
 #include <unistd.h>
 
+#include <cstdint>
+#include <string>
+
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/tools/verifier.h"
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/task/core/external_file_handler.h"
+#include "tensorflow_lite_support/cc/task/core/verification_cache.h"
 
 #if TFLITE_USE_C_API
 #include "tensorflow/lite/c/c_api_experimental.h"
@@ -55,6 +60,34 @@ using ::absl::StatusCode;
 using ::tflite::support::CreateStatusWithPayload;
 using ::tflite::support::TfLiteSupportStatus;
 
+#if !TFLITE_USE_C_API
+namespace {
+
+// Highest builtin operator version probed by GetOpResolverIdentity.
+constexpr int kMaxProbedBuiltinOpVersion = 16;
+
+// Returns a string identifying the builtin operators supported by `resolver`,
+// on which the outcome of tflite::Verify depends: the 64-bit FNV-1a hash, in
+// hexadecimal, of the bitmap of supported (operator, version) pairs. Custom
+// operators can't be enumerated: they are left out, InterpreterBuilder failing
+// anyway on models using custom operators that `resolver` doesn't support.
+std::string GetOpResolverIdentity(const tflite::OpResolver& resolver) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int op = tflite::BuiltinOperator_MIN; op <= tflite::BuiltinOperator_MAX;
+       ++op) {
+    for (int version = 1; version <= kMaxProbedBuiltinOpVersion; ++version) {
+      const bool is_supported =
+          resolver.FindOp(static_cast<tflite::BuiltinOperator>(op), version) !=
+          nullptr;
+      hash = (hash ^ (is_supported ? 1 : 0)) * 0x100000001b3ULL;
+    }
+  }
+  return absl::StrCat(absl::Hex(hash, absl::kZeroPad16));
+}
+
+}  // namespace
+#endif
+
 int TfLiteEngine::ErrorReporter::Report(const char* format, va_list args) {
   return std::vsnprintf(error_message, sizeof(error_message), format, args);
 }
@@ -125,10 +158,51 @@ void TfLiteEngine::VerifyAndBuildModelFromBuffer(const char* buffer_data,
 #endif
 }
 
-absl::Status TfLiteEngine::InitializeFromModelFileHandler() {
+void TfLiteEngine::BuildModelFromVerifiedBuffer(const char* buffer_data,
+                                                size_t buffer_size) {
+#if TFLITE_USE_C_API
+  model_.reset(TfLiteModelCreate(buffer_data, buffer_size));
+#else
+  model_ = tflite::FlatBufferModel::BuildFromBuffer(buffer_data, buffer_size,
+                                                    &error_reporter_);
+#endif
+}
+
+absl::Status TfLiteEngine::InitializeFromModelFileHandler(
+    const ExternalFile& external_file) {
   const char* buffer_data = model_file_handler_->GetFileContent().data();
   size_t buffer_size = model_file_handler_->GetFileContent().size();
-  VerifyAndBuildModelFromBuffer(buffer_data, buffer_size);
+  const VerificationCacheOptions& verification_cache_options =
+      external_file.verification_cache_options();
+  std::string verification_cache_key;
+  bool is_verified = false;
+#if !TFLITE_USE_C_API
+  // The cache is only used when models are verified by
+  // FlatBufferModel::VerifyAndBuildFromBuffer: with the C API, models are
+  // always fully verified, and never recorded as verified. Neither is it used
+  // for models provided in memory, or whose file couldn't be identified.
+  const bool use_verification_cache =
+      verification_cache_options.mode() !=
+          VerificationCacheOptions::MODE_DISABLED &&
+      !model_file_handler_->GetFileIdentity().empty();
+  if (use_verification_cache) {
+    // Probing the resolver takes a few thousand lookups: only do it once.
+    if (op_resolver_identity_.empty()) {
+      op_resolver_identity_ = GetOpResolverIdentity(*resolver_);
+    }
+    verification_cache_key = GetVerificationCacheKey(
+        model_file_handler_->GetFileIdentity(), op_resolver_identity_);
+    is_verified =
+        IsModelVerified(verification_cache_options, verification_cache_key);
+  }
+#else
+  const bool use_verification_cache = false;
+#endif
+  if (is_verified) {
+    BuildModelFromVerifiedBuffer(buffer_data, buffer_size);
+  } else {
+    VerifyAndBuildModelFromBuffer(buffer_data, buffer_size);
+  }
   if (model_ == nullptr) {
     // To be replaced with a proper switch-case when TF Lite model builder
     // returns a `TfLiteStatus` code capturing this type of error.
@@ -149,10 +223,14 @@ absl::Status TfLiteEngine::InitializeFromModelFileHandler() {
     }
   }
 
+  if (use_verification_cache && !is_verified) {
+    RecordVerifiedModel(verification_cache_options, verification_cache_key);
+  }
+
   ASSIGN_OR_RETURN(
       model_metadata_extractor_,
       tflite::metadata::ModelMetadataExtractor::CreateFromModelBuffer(
-          buffer_data, buffer_size));
+          buffer_data, buffer_size, /*verify_buffer=*/!is_verified));
 
   return absl::OkStatus();
 }
@@ -167,7 +245,7 @@ absl::Status TfLiteEngine::BuildModelFromFlatBuffer(const char* buffer_data,
   ASSIGN_OR_RETURN(
       model_file_handler_,
       ExternalFileHandler::CreateFromExternalFile(&external_file_));
-  return InitializeFromModelFileHandler();
+  return InitializeFromModelFileHandler(external_file_);
 }
 
 absl::Status TfLiteEngine::BuildModelFromFile(const std::string& file_name) {
@@ -179,7 +257,7 @@ absl::Status TfLiteEngine::BuildModelFromFile(const std::string& file_name) {
   ASSIGN_OR_RETURN(
       model_file_handler_,
       ExternalFileHandler::CreateFromExternalFile(&external_file_));
-  return InitializeFromModelFileHandler();
+  return InitializeFromModelFileHandler(external_file_);
 }
 
 absl::Status TfLiteEngine::BuildModelFromFileDescriptor(int file_descriptor) {
@@ -191,7 +269,7 @@ absl::Status TfLiteEngine::BuildModelFromFileDescriptor(int file_descriptor) {
   ASSIGN_OR_RETURN(
       model_file_handler_,
       ExternalFileHandler::CreateFromExternalFile(&external_file_));
-  return InitializeFromModelFileHandler();
+  return InitializeFromModelFileHandler(external_file_);
 }
 
 absl::Status TfLiteEngine::BuildModelFromExternalFileProto(
@@ -202,7 +280,7 @@ absl::Status TfLiteEngine::BuildModelFromExternalFileProto(
   }
   ASSIGN_OR_RETURN(model_file_handler_,
                    ExternalFileHandler::CreateFromExternalFile(external_file));
-  return InitializeFromModelFileHandler();
+  return InitializeFromModelFileHandler(*external_file);
 }
 
 absl::Status TfLiteEngine::InitInterpreter(int num_threads) {
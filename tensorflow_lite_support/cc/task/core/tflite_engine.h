@@ -19,6 +19,7 @@ limitations under the License.
 #include <sys/mman.h>
 
 #include <memory>
+#include <string>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -209,11 +210,18 @@ class TfLiteEngine {
   void VerifyAndBuildModelFromBuffer(const char* buffer_data,
                                      size_t buffer_size);
 
-  // Gets the buffer from the file handler; verifies and builds the model
-  // from the buffer; if successful, sets 'model_metadata_extractor_' to be
-  // a TF Lite Metadata extractor for the model; and calculates an appropriate
-  // return Status,
-  absl::Status InitializeFromModelFileHandler();
+  // Builds the model from the supplied buffer and stores it in 'model_',
+  // without verification. Only meant for buffers known to have already passed
+  // verification, see VerificationCacheOptions.
+  void BuildModelFromVerifiedBuffer(const char* buffer_data,
+                                    size_t buffer_size);
+
+  // Gets the buffer from the file handler; verifies (unless it is known from
+  // the `external_file` verification cache options to have already passed
+  // verification) and builds the model from the buffer; if successful, sets
+  // 'model_metadata_extractor_' to be a TF Lite Metadata extractor for the
+  // model; and calculates an appropriate return Status,
+  absl::Status InitializeFromModelFileHandler(const ExternalFile& external_file);
 
   // TF Lite model and interpreter for actual inference.
   std::unique_ptr<Model, ModelDeleter> model_;
@@ -236,6 +244,10 @@ class TfLiteEngine {
   // disk or file descriptor.
   ExternalFile external_file_;
   std::unique_ptr<ExternalFileHandler> model_file_handler_;
+
+  // Identity of the operators supported by 'resolver_' in the verification
+  // cache keys, computed on first use.
+  std::string op_resolver_identity_;
 };
 
 }  // namespace core
@@ -0,0 +1,139 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/verification_cache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex cache_mutex(absl::kConstInit);
+
+// Returns the process-wide set of verified model keys. Never destroyed.
+absl::flat_hash_set<std::string>* GetInProcessCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(cache_mutex) {
+  static auto* cache = new absl::flat_hash_set<std::string>();
+  return cache;
+}
+
+// Returns true if the file opened as `fd` can be trusted as a sidecar file,
+// i.e. if it is a regular file owned by the current user that other users
+// can't write to.
+bool IsTrustedSidecarFile(int fd) {
+  struct stat file_stat;
+  return fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+         file_stat.st_uid == geteuid() &&
+         (file_stat.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// Returns true if `key` is listed in the sidecar file at `path`, provided that
+// the file can be trusted.
+bool SidecarFileContains(const std::string& path, const std::string& key) {
+  int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  std::string content;
+  if (IsTrustedSidecarFile(fd)) {
+    char buffer[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+      content.append(buffer, bytes_read);
+    }
+  }
+  close(fd);
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    if (line == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Appends `key` to the sidecar file at `path`, creating it if needed with
+// permissions restricted to the current user. The line is written with a
+// single append-mode write(2) so that concurrent writers from other processes
+// don't interleave.
+void AppendToSidecarFile(const std::string& path, const std::string& key) {
+  int fd = open(path.c_str(),
+                O_WRONLY | O_APPEND | O_CREAT | O_NOFOLLOW | O_CLOEXEC,
+                S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return;
+  }
+  if (IsTrustedSidecarFile(fd)) {
+    const std::string line = absl::StrCat(key, "\n");
+    (void)write(fd, line.data(), line.size());
+  }
+  close(fd);
+}
+
+}  // namespace
+
+std::string GetVerificationCacheKey(absl::string_view file_identity,
+                                    absl::string_view op_resolver_identity) {
+  return absl::StrCat(file_identity, ":", op_resolver_identity);
+}
+
+bool IsModelVerified(const VerificationCacheOptions& options,
+                     const std::string& key) {
+  if (options.mode() == VerificationCacheOptions::MODE_DISABLED) {
+    return false;
+  }
+  absl::MutexLock lock(&cache_mutex);
+  if (GetInProcessCache()->contains(key)) {
+    return true;
+  }
+  if (options.mode() == VerificationCacheOptions::MODE_SIDECAR_FILE &&
+      !options.sidecar_file_path().empty() &&
+      SidecarFileContains(options.sidecar_file_path(), key)) {
+    GetInProcessCache()->insert(key);
+    return true;
+  }
+  return false;
+}
+
+void RecordVerifiedModel(const VerificationCacheOptions& options,
+                         const std::string& key) {
+  if (options.mode() == VerificationCacheOptions::MODE_DISABLED) {
+    return;
+  }
+  absl::MutexLock lock(&cache_mutex);
+  GetInProcessCache()->insert(key);
+  // Keys are stored one per line in the sidecar file.
+  if (options.mode() == VerificationCacheOptions::MODE_SIDECAR_FILE &&
+      !options.sidecar_file_path().empty() && !absl::StrContains(key, '\n')) {
+    AppendToSidecarFile(options.sidecar_file_path(), key);
+  }
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
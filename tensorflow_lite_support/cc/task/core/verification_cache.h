@@ -0,0 +1,61 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_VERIFICATION_CACHE_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_VERIFICATION_CACHE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Helpers implementing the model verification cache configured through
+// VerificationCacheOptions [1]. All functions are thread-safe.
+//
+// [1]: support/cc/task/core/proto/external_file.proto
+
+// Returns the key identifying a model in the verification cache, from the
+// identity of the file it is mapped from (see
+// ExternalFileHandler::GetFileIdentity) and `op_resolver_identity`, which
+// identifies the operators available to the verifier (see tflite::Verify).
+// Both are cheap to obtain, unlike a digest of the model contents, which would
+// cost about as much as the verification it saves.
+std::string GetVerificationCacheKey(absl::string_view file_identity,
+                                    absl::string_view op_resolver_identity);
+
+// Returns true if the model identified by `key` is known to have passed
+// verification, according to the cache configured in `options`. Always
+// returns false if the cache is disabled. Sidecar files which are not owned by
+// the current user, or are writable by other users, are ignored.
+bool IsModelVerified(const VerificationCacheOptions& options,
+                     const std::string& key);
+
+// Records that the model identified by `key` passed verification in the cache
+// configured in `options`. This is best-effort: failures to write the sidecar
+// file, if any, are ignored. Sidecar files are created readable and writable
+// by the current user only, and existing ones are left untouched unless
+// IsModelVerified would trust them. Does nothing if the cache is disabled.
+void RecordVerifiedModel(const VerificationCacheOptions& options,
+                         const std::string& key);
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_VERIFICATION_CACHE_H_
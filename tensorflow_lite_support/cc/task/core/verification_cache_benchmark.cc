@@ -0,0 +1,74 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares building a TfLiteEngine from a model file with full verification
+// against building it from a verification cache hit. Both include mapping the
+// file; the latter also includes probing the OpResolver to compute the cache
+// key, as every engine does once.
+//
+// Run with --model_path pointing to the model file to build.
+
+#include <memory>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
+
+ABSL_FLAG(std::string, model_path, "", "Path to the TF Lite model to build.");
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+void BuildEngines(benchmark::State& state,
+                  VerificationCacheOptions::Mode mode) {
+  ExternalFile external_file;
+  external_file.set_file_name(absl::GetFlag(FLAGS_model_path));
+  external_file.mutable_verification_cache_options()->set_mode(mode);
+  // Populates the cache, if enabled, and the page cache.
+  {
+    TfLiteEngine engine;
+    absl::Status status =
+        engine.BuildModelFromExternalFileProto(&external_file);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  for (auto s : state) {
+    TfLiteEngine engine;
+    benchmark::DoNotOptimize(
+        engine.BuildModelFromExternalFileProto(&external_file));
+  }
+}
+
+void BM_BuildWithVerification(benchmark::State& state) {
+  BuildEngines(state, VerificationCacheOptions::MODE_DISABLED);
+}
+BENCHMARK(BM_BuildWithVerification);
+
+void BM_BuildWithVerificationCacheHit(benchmark::State& state) {
+  BuildEngines(state, VerificationCacheOptions::MODE_IN_PROCESS);
+}
+BENCHMARK(BM_BuildWithVerificationCacheHit);
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,174 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/verification_cache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/task/core/external_file_handler.h"
+#include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+// Returns a path in the test temporary directory, after removing any file
+// left there by a previous run.
+std::string GetTestFilePath(const std::string& name) {
+  const std::string path = ::testing::TempDir() + "/" + name;
+  unlink(path.c_str());
+  return path;
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << content;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+VerificationCacheOptions CreateOptions(
+    VerificationCacheOptions::Mode mode,
+    const std::string& sidecar_file_path = "") {
+  VerificationCacheOptions options;
+  options.set_mode(mode);
+  options.set_sidecar_file_path(sidecar_file_path);
+  return options;
+}
+
+std::string GetFileIdentity(const ExternalFile& external_file) {
+  std::unique_ptr<ExternalFileHandler> handler =
+      ExternalFileHandler::CreateFromExternalFile(&external_file).value();
+  return handler->GetFileIdentity();
+}
+
+TEST(VerificationCacheTest, KeyCombinesFileAndOpResolverIdentities) {
+  EXPECT_EQ(GetVerificationCacheKey("1.2.3", "abcd"), "1.2.3:abcd");
+  EXPECT_NE(GetVerificationCacheKey("1.2.3", "abcd"),
+            GetVerificationCacheKey("1.2.3", "abce"));
+}
+
+TEST(VerificationCacheTest, DisabledCacheNeverReportsModelsAsVerified) {
+  const VerificationCacheOptions options =
+      CreateOptions(VerificationCacheOptions::MODE_DISABLED);
+  RecordVerifiedModel(options, "disabled");
+  EXPECT_FALSE(IsModelVerified(options, "disabled"));
+  EXPECT_FALSE(IsModelVerified(
+      CreateOptions(VerificationCacheOptions::MODE_IN_PROCESS), "disabled"));
+}
+
+TEST(VerificationCacheTest, InProcessCacheRecordsVerifiedModels) {
+  const VerificationCacheOptions options =
+      CreateOptions(VerificationCacheOptions::MODE_IN_PROCESS);
+  EXPECT_FALSE(IsModelVerified(options, "in_process"));
+  RecordVerifiedModel(options, "in_process");
+  EXPECT_TRUE(IsModelVerified(options, "in_process"));
+  EXPECT_FALSE(IsModelVerified(options, "in_process_other"));
+}
+
+TEST(VerificationCacheTest, SidecarFileRecordsVerifiedModels) {
+  const std::string path = GetTestFilePath("recorded_sidecar");
+  RecordVerifiedModel(
+      CreateOptions(VerificationCacheOptions::MODE_SIDECAR_FILE, path),
+      "recorded");
+  EXPECT_EQ(ReadFile(path), "recorded\n");
+  struct stat file_stat;
+  ASSERT_EQ(stat(path.c_str(), &file_stat), 0);
+  EXPECT_EQ(file_stat.st_mode & 0777, S_IRUSR | S_IWUSR);
+}
+
+TEST(VerificationCacheTest, SidecarFileIsLookedUp) {
+  const std::string path = GetTestFilePath("trusted_sidecar");
+  WriteFile(path, "first\nsidecar\nlast\n");
+  ASSERT_EQ(chmod(path.c_str(), S_IRUSR | S_IWUSR), 0);
+  EXPECT_TRUE(IsModelVerified(
+      CreateOptions(VerificationCacheOptions::MODE_SIDECAR_FILE, path),
+      "sidecar"));
+  EXPECT_FALSE(IsModelVerified(
+      CreateOptions(VerificationCacheOptions::MODE_SIDECAR_FILE, path),
+      "side"));
+}
+
+TEST(VerificationCacheTest, IgnoresSidecarFileWritableByOtherUsers) {
+  const std::string path = GetTestFilePath("untrusted_sidecar");
+  WriteFile(path, "untrusted\n");
+  ASSERT_EQ(chmod(path.c_str(), 0666), 0);
+  const VerificationCacheOptions options =
+      CreateOptions(VerificationCacheOptions::MODE_SIDECAR_FILE, path);
+  EXPECT_FALSE(IsModelVerified(options, "untrusted"));
+  RecordVerifiedModel(options, "untrusted_recorded");
+  EXPECT_EQ(ReadFile(path), "untrusted\n");
+}
+
+TEST(VerificationCacheTest, FileIdentityChangesWithFile) {
+  const std::string path = GetTestFilePath("model");
+  WriteFile(path, std::string(8192, 'a'));
+  ExternalFile external_file;
+  external_file.set_file_name(path);
+  const std::string identity = GetFileIdentity(external_file);
+  EXPECT_FALSE(identity.empty());
+  EXPECT_EQ(GetFileIdentity(external_file), identity);
+
+  // Rewriting the file in place, with a different size.
+  WriteFile(path, std::string(8193, 'a'));
+  EXPECT_NE(GetFileIdentity(external_file), identity);
+
+  // Replacing the file, with the same size.
+  const std::string identity_before_replace = GetFileIdentity(external_file);
+  const std::string replacement_path = GetTestFilePath("model_replacement");
+  WriteFile(replacement_path, std::string(8193, 'b'));
+  ASSERT_EQ(rename(replacement_path.c_str(), path.c_str()), 0);
+  EXPECT_NE(GetFileIdentity(external_file), identity_before_replace);
+}
+
+TEST(VerificationCacheTest, FileIdentityDependsOnMappedRegion) {
+  const std::string path = GetTestFilePath("model_regions");
+  WriteFile(path, std::string(8192, 'a'));
+  int fd = open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  ExternalFile first_region;
+  first_region.mutable_file_descriptor_meta()->set_fd(fd);
+  first_region.mutable_file_descriptor_meta()->set_length(4096);
+  ExternalFile second_region = first_region;
+  second_region.mutable_file_descriptor_meta()->set_offset(4096);
+  EXPECT_NE(GetFileIdentity(first_region), GetFileIdentity(second_region));
+  close(fd);
+}
+
+TEST(VerificationCacheTest, FileIdentityIsEmptyForInMemoryContents) {
+  ExternalFile external_file;
+  external_file.set_file_content(std::string(8192, 'a'));
+  EXPECT_TRUE(GetFileIdentity(external_file).empty());
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
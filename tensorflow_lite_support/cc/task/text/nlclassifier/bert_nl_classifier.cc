@@ -48,7 +48,9 @@ using ::tflite::support::StatusOr;
 using ::tflite::support::TfLiteSupportStatus;
 using ::tflite::support::text::tokenizer::CreateTokenizerFromProcessUnit;
 using ::tflite::support::text::tokenizer::TokenizerResult;
-using ::tflite::task::core::FindTensorByName;
+using ::tflite::task::core::FindInputTensorIndexByName;
+using ::tflite::task::core::FindOutputTensorIndexByName;
+using ::tflite::task::core::GetTensorAtIndex;
 using ::tflite::task::core::PopulateTensor;
 
 namespace {
@@ -63,14 +65,10 @@ constexpr int kTokenizerProcessUnitIndex = 0;
 
 absl::Status BertNLClassifier::Preprocess(
     const std::vector<TfLiteTensor*>& input_tensors, const std::string& input) {
-  auto* input_tensor_metadatas =
-      GetMetadataExtractor()->GetInputTensorMetadata();
-  auto* ids_tensor =
-      FindTensorByName(input_tensors, input_tensor_metadatas, kIdsTensorName);
-  auto* mask_tensor =
-      FindTensorByName(input_tensors, input_tensor_metadatas, kMaskTensorName);
-  auto* segment_ids_tensor = FindTensorByName(
-      input_tensors, input_tensor_metadatas, kSegmentIdsTensorName);
+  auto* ids_tensor = GetTensorAtIndex(input_tensors, ids_tensor_index_);
+  auto* mask_tensor = GetTensorAtIndex(input_tensors, mask_tensor_index_);
+  auto* segment_ids_tensor =
+      GetTensorAtIndex(input_tensors, segment_ids_tensor_index_);
 
   std::string processed_input = input;
   absl::AsciiStrToLower(&processed_input);
@@ -126,9 +124,8 @@ StatusOr<std::vector<core::Category>> BertNLClassifier::Postprocess(
                         output_tensors.size()),
         TfLiteSupportStatus::kInvalidNumOutputTensorsError);
   }
-  const TfLiteTensor* scores = FindTensorByName(
-      output_tensors, GetMetadataExtractor()->GetOutputTensorMetadata(),
-      kScoreTensorName);
+  const TfLiteTensor* scores =
+      GetTensorAtIndex(output_tensors, score_tensor_index_);
 
   // optional labels extracted from metadata
   return BuildResults(scores, /*labels=*/nullptr);
@@ -185,6 +182,17 @@ absl::Status BertNLClassifier::InitializeFromMetadata() {
                    CreateTokenizerFromProcessUnit(tokenizer_process_unit,
                                                   GetMetadataExtractor()));
 
+  // Resolve input and output tensors by name once and for all.
+  const int num_inputs = GetInputTensors().size();
+  ids_tensor_index_ = FindInputTensorIndexByName(
+      *GetMetadataExtractor(), num_inputs, kIdsTensorName);
+  mask_tensor_index_ = FindInputTensorIndexByName(
+      *GetMetadataExtractor(), num_inputs, kMaskTensorName);
+  segment_ids_tensor_index_ = FindInputTensorIndexByName(
+      *GetMetadataExtractor(), num_inputs, kSegmentIdsTensorName);
+  score_tensor_index_ = FindOutputTensorIndexByName(
+      *GetMetadataExtractor(), GetOutputTensors().size(), kScoreTensorName);
+
   // Set up optional label vector.
   TrySetLabelFromMetadata(
       GetMetadataExtractor()->GetOutputTensorMetadata(kOutputTensorIndex))
@@ -95,6 +95,14 @@ class BertNLClassifier : public NLClassifier {
   absl::Status InitializeFromMetadata();
 
   std::unique_ptr<tflite::support::text::tokenizer::Tokenizer> tokenizer_;
+
+  // Indices of the "ids", "mask" and "segment_ids" input tensors, and of the
+  // "probability" output tensor, resolved from the metadata at initialization
+  // time. -1 means that the tensor could not be found.
+  int ids_tensor_index_ = -1;
+  int mask_tensor_index_ = -1;
+  int segment_ids_tensor_index_ = -1;
+  int score_tensor_index_ = -1;
 };
 
 }  // namespace nlclassifier
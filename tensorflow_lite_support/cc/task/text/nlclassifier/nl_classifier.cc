@@ -58,6 +58,7 @@ using ::tflite::support::utils::LoadVocabFromBuffer;
 using ::tflite::task::core::Category;
 using ::tflite::task::core::Dequantize;
 using ::tflite::task::core::GetStringAtIndex;
+using ::tflite::task::core::GetTensorAtIndex;
 using ::tflite::task::core::PopulateTensor;
 
 namespace {
@@ -186,9 +187,8 @@ std::vector<Category> NLClassifier::Classify(const std::string& text) {
 
 absl::Status NLClassifier::Preprocess(
     const std::vector<TfLiteTensor*>& input_tensors, const std::string& input) {
-  TfLiteTensor* input_tensor = FindTensorWithNameOrIndex(
-      input_tensors, GetMetadataExtractor()->GetInputTensorMetadata(),
-      options_.input_tensor_name, options_.input_tensor_index);
+  TfLiteTensor* input_tensor =
+      GetTensorAtIndex(input_tensors, input_tensor_index_);
   if (input_tensor == nullptr) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
@@ -244,14 +244,8 @@ StatusOr<std::vector<Category>> NLClassifier::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
     const std::string& /*input*/) {
   return BuildResults(
-      FindTensorWithNameOrIndex(
-          output_tensors, GetMetadataExtractor()->GetOutputTensorMetadata(),
-          options_.output_score_tensor_name,
-          options_.output_score_tensor_index),
-      FindTensorWithNameOrIndex(
-          output_tensors, GetMetadataExtractor()->GetInputTensorMetadata(),
-          options_.output_label_tensor_name,
-          options_.output_label_tensor_index));
+      GetTensorAtIndex(output_tensors, output_score_tensor_index_),
+      GetTensorAtIndex(output_tensors, output_label_tensor_index_));
 }
 
 std::vector<Category> NLClassifier::BuildResults(const TfLiteTensor* scores,
@@ -297,10 +291,24 @@ std::vector<Category> NLClassifier::BuildResults(const TfLiteTensor* scores,
 }
 absl::Status NLClassifier::Initialize(const NLClassifierOptions& options) {
   options_ = options;
-  // input tensor should be type STRING
-  auto input_tensor = FindTensorWithNameOrIndex(
-      GetInputTensors(), GetMetadataExtractor()->GetInputTensorMetadata(),
+  // Resolve once all tensors from options, so that the inference hot path
+  // doesn't have to look them up by name.
+  std::vector<TfLiteTensor*> input_tensors = GetInputTensors();
+  std::vector<const TfLiteTensor*> output_tensors = GetOutputTensors();
+  const Vector<Offset<TensorMetadata>>* output_tensor_metadatas =
+      GetMetadataExtractor()->GetOutputTensorMetadata();
+  input_tensor_index_ = FindTensorIndexWithNameOrIndex(
+      input_tensors, GetMetadataExtractor()->GetInputTensorMetadata(),
       options.input_tensor_name, options.input_tensor_index);
+  output_score_tensor_index_ = FindTensorIndexWithNameOrIndex(
+      output_tensors, output_tensor_metadatas, options.output_score_tensor_name,
+      options.output_score_tensor_index);
+  output_label_tensor_index_ = FindTensorIndexWithNameOrIndex(
+      output_tensors, output_tensor_metadatas, options.output_label_tensor_name,
+      options.output_label_tensor_index);
+
+  // input tensor should be type STRING
+  auto input_tensor = GetTensorAtIndex(input_tensors, input_tensor_index_);
   if (input_tensor == nullptr) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
@@ -332,13 +340,8 @@ absl::Status NLClassifier::Initialize(const NLClassifierOptions& options) {
 
   // output score tensor should be type
   // UINT8/INT8/INT16(quantized) or FLOAT32/FLOAT64(dequantized) or BOOL
-  std::vector<const TfLiteTensor*> output_tensors = GetOutputTensors();
-  const Vector<Offset<TensorMetadata>>* output_tensor_metadatas =
-      GetMetadataExtractor()->GetOutputTensorMetadata();
-
-  const auto scores = FindTensorWithNameOrIndex(
-      output_tensors, output_tensor_metadatas, options.output_score_tensor_name,
-      options.output_score_tensor_index);
+  const auto scores =
+      GetTensorAtIndex(output_tensors, output_score_tensor_index_);
   if (scores == nullptr) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
@@ -380,9 +383,7 @@ absl::Status NLClassifier::Initialize(const NLClassifierOptions& options) {
   // tensor from options.
   if (labels_vector_ == nullptr) {
     // output label tensor should be type STRING or INT32 if the one exists
-    auto labels = FindTensorWithNameOrIndex(
-        output_tensors, output_tensor_metadatas,
-        options.output_label_tensor_name, options.output_label_tensor_index);
+    auto labels = GetTensorAtIndex(output_tensors, output_label_tensor_index_);
     if (labels != nullptr && labels->type != kTfLiteString &&
         labels->type != kTfLiteInt32) {
       return CreateStatusWithPayload(
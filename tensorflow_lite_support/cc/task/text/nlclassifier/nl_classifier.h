@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/port/statusor.h"
 #include "tensorflow_lite_support/cc/task/core/base_task_api.h"
 #include "tensorflow_lite_support/cc/task/core/category.h"
+#include "tensorflow_lite_support/cc/task/core/task_utils.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/regex_tokenizer.h"
 
 namespace tflite {
@@ -146,20 +147,33 @@ class NLClassifier : public core::BaseTaskApi<std::vector<core::Category>,
       const flatbuffers::Vector<flatbuffers::Offset<TensorMetadata>>*
           metadata_array,
       const std::string& name, int index) {
+    return core::GetTensorAtIndex(
+        tensors,
+        FindTensorIndexWithNameOrIndex(tensors, metadata_array, name, index));
+  }
+
+  // Same as above, but returns the index of the tensor in `tensors`, or -1 if
+  // no tensor is found. Used to resolve tensors once at initialization time.
+  template <typename TensorType>
+  static int FindTensorIndexWithNameOrIndex(
+      const std::vector<TensorType*>& tensors,
+      const flatbuffers::Vector<flatbuffers::Offset<TensorMetadata>>*
+          metadata_array,
+      const std::string& name, int index) {
     if (metadata_array != nullptr && metadata_array->size() == tensors.size()) {
       for (int i = 0; i < metadata_array->size(); i++) {
         if (strcmp(name.data(), metadata_array->Get(i)->name()->c_str()) == 0) {
-          return tensors[i];
+          return i;
         }
       }
     }
 
-    for (TensorType* tensor : tensors) {
-      if (tensor->name == name) {
-        return tensor;
+    for (int i = 0; i < tensors.size(); i++) {
+      if (tensors[i]->name == name) {
+        return i;
       }
     }
-    return index >= 0 && index < tensors.size() ? tensors[index] : nullptr;
+    return index >= 0 && index < tensors.size() ? index : -1;
   }
 
  private:
@@ -167,6 +181,11 @@ class NLClassifier : public core::BaseTaskApi<std::vector<core::Category>,
   absl::Status SetupRegexTokenizer();
 
   NLClassifierOptions options_;
+  // Indices of the input, output score and (optional) output label tensors,
+  // resolved from options_ at initialization time. -1 means not found.
+  int input_tensor_index_ = -1;
+  int output_score_tensor_index_ = -1;
+  int output_label_tensor_index_ = -1;
   // labels vector initialized from output tensor's associated file, if one
   // exists.
   std::unique_ptr<std::vector<std::string>> labels_vector_;
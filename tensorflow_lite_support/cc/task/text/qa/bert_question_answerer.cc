@@ -41,7 +41,9 @@ using ::tflite::support::text::tokenizer::BertTokenizer;
 using ::tflite::support::text::tokenizer::CreateTokenizerFromProcessUnit;
 using ::tflite::support::text::tokenizer::SentencePieceTokenizer;
 using ::tflite::support::text::tokenizer::TokenizerResult;
-using ::tflite::task::core::FindTensorByName;
+using ::tflite::task::core::FindInputTensorIndexByName;
+using ::tflite::task::core::FindOutputTensorIndexByName;
+using ::tflite::task::core::GetTensorAtIndex;
 using ::tflite::task::core::PopulateTensor;
 using ::tflite::task::core::PopulateVector;
 using ::tflite::task::core::ReverseSortIndices;
@@ -50,6 +52,12 @@ namespace {
 constexpr int kTokenizerProcessUnitIndex = 0;
 }
 
+BertQuestionAnswerer::BertQuestionAnswerer(
+    std::unique_ptr<core::TfLiteEngine> engine)
+    : QuestionAnswerer(std::move(engine)) {
+  ResolveTensorIndices();
+}
+
 StatusOr<std::unique_ptr<QuestionAnswerer>>
 BertQuestionAnswerer::CreateFromFile(
     const std::string& path_to_model_with_metadata) {
@@ -161,23 +169,11 @@ std::vector<QaAnswer> BertQuestionAnswerer::Answer(
 absl::Status BertQuestionAnswerer::Preprocess(
     const std::vector<TfLiteTensor*>& input_tensors, const std::string& context,
     const std::string& query) {
-  auto* input_tensor_metadatas =
-      GetMetadataExtractor()->GetInputTensorMetadata();
-  TfLiteTensor* ids_tensor =
-      input_tensor_metadatas
-          ? FindTensorByName(input_tensors, input_tensor_metadatas,
-                             kIdsTensorName)
-          : input_tensors[0];
+  TfLiteTensor* ids_tensor = GetTensorAtIndex(input_tensors, ids_tensor_index_);
   TfLiteTensor* mask_tensor =
-      input_tensor_metadatas
-          ? FindTensorByName(input_tensors, input_tensor_metadatas,
-                             kMaskTensorName)
-          : input_tensors[1];
+      GetTensorAtIndex(input_tensors, mask_tensor_index_);
   TfLiteTensor* segment_ids_tensor =
-      input_tensor_metadatas
-          ? FindTensorByName(input_tensors, input_tensor_metadatas,
-                             kSegmentIdsTensorName)
-          : input_tensors[2];
+      GetTensorAtIndex(input_tensors, segment_ids_tensor_index_);
 
   token_to_orig_map_.clear();
 
@@ -287,19 +283,10 @@ StatusOr<std::vector<QaAnswer>> BertQuestionAnswerer::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
     const std::string& /*lowercased_context*/,
     const std::string& /*lowercased_query*/) {
-  auto* output_tensor_metadatas =
-      GetMetadataExtractor()->GetOutputTensorMetadata();
-
   const TfLiteTensor* end_logits_tensor =
-      output_tensor_metadatas
-          ? FindTensorByName(output_tensors, output_tensor_metadatas,
-                             kEndLogitsTensorName)
-          : output_tensors[0];
+      GetTensorAtIndex(output_tensors, end_logits_tensor_index_);
   const TfLiteTensor* start_logits_tensor =
-      output_tensor_metadatas
-          ? FindTensorByName(output_tensors, output_tensor_metadatas,
-                             kStartLogitsTensorName)
-          : output_tensors[1];
+      GetTensorAtIndex(output_tensors, start_logits_tensor_index_);
 
   std::vector<float> end_logits;
   std::vector<float> start_logits;
@@ -342,6 +329,28 @@ StatusOr<std::vector<QaAnswer>> BertQuestionAnswerer::Postprocess(
   return answers;
 }
 
+void BertQuestionAnswerer::ResolveTensorIndices() {
+  const auto* metadata_extractor = GetMetadataExtractor();
+  if (metadata_extractor->GetInputTensorMetadata() != nullptr) {
+    const int num_inputs =
+        core::TfLiteEngine::InputCount(GetTfLiteEngine()->interpreter());
+    ids_tensor_index_ = FindInputTensorIndexByName(*metadata_extractor,
+                                                   num_inputs, kIdsTensorName);
+    mask_tensor_index_ = FindInputTensorIndexByName(
+        *metadata_extractor, num_inputs, kMaskTensorName);
+    segment_ids_tensor_index_ = FindInputTensorIndexByName(
+        *metadata_extractor, num_inputs, kSegmentIdsTensorName);
+  }
+  if (metadata_extractor->GetOutputTensorMetadata() != nullptr) {
+    const int num_outputs =
+        core::TfLiteEngine::OutputCount(GetTfLiteEngine()->interpreter());
+    end_logits_tensor_index_ = FindOutputTensorIndexByName(
+        *metadata_extractor, num_outputs, kEndLogitsTensorName);
+    start_logits_tensor_index_ = FindOutputTensorIndexByName(
+        *metadata_extractor, num_outputs, kStartLogitsTensorName);
+  }
+}
+
 std::string BertQuestionAnswerer::ConvertIndexToString(int start, int end) {
   int start_index = token_to_orig_map_[start + kOutputOffset];
   int end_index = token_to_orig_map_[end + kOutputOffset];
@@ -120,8 +120,7 @@ class BertQuestionAnswerer : public QuestionAnswerer {
                                          const char* spmodel_buffer_data,
                                          size_t spmodel_buffer_size);
 
-  explicit BertQuestionAnswerer(std::unique_ptr<core::TfLiteEngine> engine)
-      : QuestionAnswerer(std::move(engine)) {}
+  explicit BertQuestionAnswerer(std::unique_ptr<core::TfLiteEngine> engine);
 
   // Answers question based on the context. Could be empty if no answer was
   // found from the given context.
@@ -153,6 +152,10 @@ class BertQuestionAnswerer : public QuestionAnswerer {
   // Initialize the API with the tokenizer set in the metadata.
   absl::Status InitializeFromMetadata();
 
+  // Resolves the indices of the input and output tensors, either from the
+  // tensor names in the metadata if present, or using the default order.
+  void ResolveTensorIndices();
+
   std::string ConvertIndexToString(int start, int end);
 
   std::unique_ptr<tflite::support::text::tokenizer::Tokenizer> tokenizer_;
@@ -160,6 +163,17 @@ class BertQuestionAnswerer : public QuestionAnswerer {
   absl::flat_hash_map<size_t, size_t> token_to_orig_map_;
   // Original tokens of context.
   std::vector<std::string> orig_tokens_;
+
+  // Indices of the "ids", "mask" and "segment_ids" input tensors, and of the
+  // "end_logits" and "start_logits" output tensors, resolved at construction
+  // time. The defaults below are the tensor order used by models without
+  // input (resp. output) tensor metadata. Otherwise, the indices are looked
+  // up by name in the metadata, and are -1 if the tensor is not found there.
+  int ids_tensor_index_ = 0;
+  int mask_tensor_index_ = 1;
+  int segment_ids_tensor_index_ = 2;
+  int end_logits_tensor_index_ = 0;
+  int start_logits_tensor_index_ = 1;
 };
 
 }  // namespace qa
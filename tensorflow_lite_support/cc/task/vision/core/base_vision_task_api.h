@@ -16,7 +16,6 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_BASE_VISION_TASK_API_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_BASE_VISION_TASK_API_H_
 
-#include <array>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -24,6 +23,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/time/clock.h"
+#include "absl/types/optional.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/integral_types.h"
@@ -34,7 +34,11 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/fused_preprocessing.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/preprocessing_cache.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
 namespace tflite {
@@ -61,8 +65,115 @@ class BaseVisionTaskApi
   // Sets the ProcessEngine used for image pre-processing. Must be called before
   // any inference is performed. Can be called between inferences to override
   // the current process engine.
-  void SetProcessEngine(const FrameBufferUtils::ProcessEngine& process_engine) {
-    frame_buffer_utils_ = FrameBufferUtils::Create(process_engine);
+  //
+  // If `num_threads` is greater than 1, the pre-processing operations on large
+  // frames are split into horizontal stripes processed in parallel by a pool of
+  // `num_threads` threads (including the calling thread), with the same result
+  // as single-threaded processing.
+  void SetProcessEngine(const FrameBufferUtils::ProcessEngine& process_engine,
+                        int num_threads = 1) {
+    frame_buffer_utils_ = FrameBufferUtils::Create(process_engine, num_threads);
+    frame_buffer_utils_->SetMaxRetainedScratchBytes(
+        preprocessing_buffer_.max_retained_bytes());
+    frame_buffer_utils_->SetFuseResizeAndOrient(fuse_resize_and_orient_);
+  }
+
+  // Sets the maximum size in bytes of each of the scratch buffers used for
+  // image pre-processing that is retained between inferences. Scratch buffers
+  // are allocated on first use and reused afterwards, so that steady-state
+  // inference on same-sized frames does not allocate frame-sized buffers.
+  void SetMaxRetainedScratchBytes(size_t max_retained_bytes) {
+    preprocessing_buffer_.set_max_retained_bytes(max_retained_bytes);
+    preprocessing_buffer_.ReleaseIfAboveCap();
+    if (frame_buffer_utils_ != nullptr) {
+      frame_buffer_utils_->SetMaxRetainedScratchBytes(max_retained_bytes);
+    }
+  }
+
+  // Releases all the memory retained by the image pre-processing scratch
+  // buffers, e.g. when the input stream is paused.
+  void TrimScratchBuffers() {
+    preprocessing_buffer_.Trim();
+    if (frame_buffer_utils_ != nullptr) {
+      frame_buffer_utils_->TrimScratchBuffers();
+    }
+  }
+
+  // Sets whether image pre-processing is performed in a single pass that
+  // samples the input frame buffer and writes normalized values directly into
+  // the input tensor, or by running the operations of the ProcessEngine set
+  // through `SetProcessEngine` one after the other, followed by a separate
+  // normalization pass (default).
+  //
+  // Single-pass pre-processing resamples on a float center-aligned grid and
+  // converts YUV with float BT.601 coefficients: its results differ from the
+  // ProcessEngine ones by a few levels on average, which may affect model
+  // accuracy. It is also slower than the ProcessEngine operations for frames
+  // up to 640x480, see fused_preprocessing_benchmark.
+  void SetUseFusedPreprocessing(bool use_fused_preprocessing) {
+    use_fused_preprocessing_ = use_fused_preprocessing;
+  }
+
+  // Sets the interpolation method used to resize the region of interest to the
+  // dimensions of the input tensor. Defaults to bilinear interpolation.
+  //
+  // Single-pass pre-processing (see `SetUseFusedPreprocessing`) only supports
+  // bilinear interpolation without box pre-reduction: other methods, as well
+  // as large downscaling ratios, use the ProcessEngine operations instead.
+  void SetInterpolationMethod(InterpolationMethod interpolation_method) {
+    interpolation_method_ = interpolation_method;
+  }
+
+  // Sets whether the aspect ratio of the region of interest is preserved when
+  // resizing it to the dimensions of the input tensor (a.k.a. letterboxing),
+  // the remaining pixels being set to the gray level `padding_value`. Defaults
+  // to false, i.e. the region of interest is stretched.
+  //
+  // Single-pass pre-processing (see `SetUseFusedPreprocessing`) doesn't
+  // support letterboxing: the ProcessEngine operations are used instead.
+  void SetPreserveAspectRatio(bool preserve_aspect_ratio,
+                              uint8 padding_value = 0) {
+    preserve_aspect_ratio_ = preserve_aspect_ratio;
+    letterbox_padding_value_ = padding_value;
+  }
+
+  // Sets whether YUV frame buffers (NV12, NV21, YV12, YV21) are pre-processed
+  // by resizing their luma and chroma planes to the dimensions of the input
+  // tensor first, and then converting the result to RGB straight into the
+  // input tensor. Defaults to false. This works on data of the input tensor
+  // dimensions rather than of the region of interest dimensions, supports all
+  // the interpolation methods as well as letterboxing, and takes precedence
+  // over single-pass pre-processing (see `SetUseFusedPreprocessing`) for such
+  // buffers.
+  //
+  // As the color conversion happens after resizing instead of before, RGB
+  // input values are not bit-exact with the ProcessEngine ones: they differ
+  // by up to 2 levels, and 0.5 on average, see fused_preprocessing_test.
+  // Grayscale input values are unchanged.
+  void SetUseDirectYuvPreprocessing(bool use_direct_yuv_preprocessing) {
+    use_direct_yuv_preprocessing_ = use_direct_yuv_preprocessing;
+  }
+
+  // Sets whether the rotation of the input frame buffer according to its
+  // `Orientation` is folded into bilinear resizing, so that the ProcessEngine
+  // operations orient and resize in a single pass. Defaults to false, as the
+  // results are not bit-exact with the separate passes, see
+  // `FrameBufferUtils::SetFuseResizeAndOrient`.
+  void SetFuseResizeAndOrient(bool fuse_resize_and_orient) {
+    fuse_resize_and_orient_ = fuse_resize_and_orient;
+    if (frame_buffer_utils_ != nullptr) {
+      frame_buffer_utils_->SetFuseResizeAndOrient(fuse_resize_and_orient);
+    }
+  }
+
+  // Sets the cache of pre-processed input tensor data shared with the other
+  // tasks running on the same frames, or disables caching if null (default).
+  // Tasks with the same input tensor specifications and pre-processing
+  // settings then pre-process each frame and region of interest only once,
+  // the others copying the cached input tensor data. Frames are identified
+  // by their content among others, see `PreprocessingCacheKey`.
+  void SetPreprocessingCache(std::shared_ptr<PreprocessingCache> cache) {
+    preprocessing_cache_ = std::move(cache);
   }
 
  protected:
@@ -80,10 +191,19 @@ class BaseVisionTaskApi
         BuildInputImageTensorSpecs(*engine_->interpreter(),
                                    *engine_->metadata_extractor()));
 
-    if (input_specs.color_space != tflite::ColorSpaceType_RGB) {
+    if (input_specs.color_space != tflite::ColorSpaceType_RGB &&
+        input_specs.color_space != tflite::ColorSpaceType_GRAYSCALE) {
       return tflite::support::CreateStatusWithPayload(
           absl::StatusCode::kUnimplemented,
-          "BaseVisionTaskApi only supports RGB color space for now.");
+          "BaseVisionTaskApi only supports RGB and GRAYSCALE color spaces for "
+          "now.");
+    }
+
+    if (input_specs.tensor_type == kTfLiteFloat32) {
+      ASSIGN_OR_RETURN(
+          normalizer_,
+          PixelNormalizer::Create(input_specs.normalization_options.value(),
+                                  GetNumChannels(input_specs.color_space)));
     }
 
     input_specs_ = absl::make_unique<ImageTensorSpecs>(input_specs);
@@ -97,12 +217,22 @@ class BaseVisionTaskApi
   // order):
   // - cropping the frame buffer to the region of interest (which, in most
   //   cases, just covers the entire input image),
-  // - resizing it (with bilinear interpolation, aspect-ratio *not* preserved)
-  //   to the dimensions of the model input tensor,
-  // - converting it to the colorspace of the input tensor (i.e. RGB, which is
-  //   the only supported colorspace for now),
+  // - resizing it (with the interpolation method set through
+  //   `SetInterpolationMethod`, bilinear by default, aspect-ratio *not*
+  //   preserved unless enabled through `SetPreserveAspectRatio`) to the
+  //   dimensions of the model input tensor,
+  // - converting it to the colorspace of the input tensor (i.e. RGB or
+  //   grayscale, the latter being the luma plane as is for YUV frame buffers),
   // - rotating it according to its `Orientation` so that inference is performed
-  //   on an "upright" image.
+  //   on an "upright" image,
+  // - normalizing (float input tensors) or quantizing (int8 input tensors) the
+  //   resulting pixel values.
+  //
+  // If enabled through `SetUseFusedPreprocessing` and supported for the
+  // interpolation method and downscaling ratio, all these steps are fused
+  // into a single pass writing directly into the input tensor. If enabled
+  // through `SetUseDirectYuvPreprocessing`, YUV frame buffers are instead
+  // resized first and then converted directly into the input tensor.
   //
   // IMPORTANT: as a consequence of cropping occurring first, the provided
   // region of interest is expressed in the unrotated frame of reference
@@ -111,6 +241,9 @@ class BaseVisionTaskApi
   // `frame_buffer` data before any `Orientation` flag gets applied. Also, the
   // region of interest is not clamped, so this method will return a non-ok
   // status if the region is out of these bounds.
+  //
+  // If a cache is set through `SetPreprocessingCache`, the input tensor data
+  // is copied from it when available instead.
   absl::Status Preprocess(const std::vector<TfLiteTensor*>& input_tensors,
                           const FrameBuffer& frame_buffer,
                           const BoundingBox& roi) override {
@@ -133,6 +266,51 @@ class BaseVisionTaskApi
           absl::StatusCode::kInternal, "A single input tensor is expected.");
     }
 
+    if (preprocessing_cache_ == nullptr) {
+      return PopulateInputTensor(input_tensors, frame_buffer, roi);
+    }
+    ASSIGN_OR_RETURN(TensorBufferSpec tensor_buffer_spec,
+                     BuildTensorBufferSpec(*input_specs_, input_tensors[0]));
+    ASSIGN_OR_RETURN(
+        const PreprocessingCacheKey key,
+        GetPreprocessingCacheKey(frame_buffer, roi, tensor_buffer_spec));
+    if (preprocessing_cache_->Lookup(key, input_tensors[0]->data.raw,
+                                     input_tensors[0]->bytes)) {
+      return absl::OkStatus();
+    }
+    RETURN_IF_ERROR(PopulateInputTensor(input_tensors, frame_buffer, roi));
+    preprocessing_cache_->Insert(key, input_tensors[0]->data.raw,
+                                 input_tensors[0]->bytes);
+    return absl::OkStatus();
+  }
+
+  // Implementation of `Preprocess`, which populates the input tensor without
+  // going through the cache.
+  absl::Status PopulateInputTensor(
+      const std::vector<TfLiteTensor*>& input_tensors,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+    const bool is_image_preprocessing_needed =
+        IsImagePreprocessingNeeded(frame_buffer, roi);
+    if (use_direct_yuv_preprocessing_ && is_image_preprocessing_needed &&
+        IsYuvFormat(frame_buffer.format())) {
+      ASSIGN_OR_RETURN(TensorBufferSpec tensor_buffer_spec,
+                       BuildTensorBufferSpec(*input_specs_, input_tensors[0]));
+      RETURN_IF_ERROR(PreprocessYuvIntoTensorBuffer(
+          frame_buffer, roi, tensor_buffer_spec, frame_buffer_utils_.get(),
+          &preprocessing_buffer_, interpolation_method_,
+          preserve_aspect_ratio_
+              ? absl::optional<uint8>(letterbox_padding_value_)
+              : absl::nullopt));
+      preprocessing_buffer_.ReleaseIfAboveCap();
+      return absl::OkStatus();
+    }
+    if (use_fused_preprocessing_ && is_image_preprocessing_needed &&
+        IsFusedPreprocessingSupported(frame_buffer, roi)) {
+      ASSIGN_OR_RETURN(TensorBufferSpec tensor_buffer_spec,
+                       BuildTensorBufferSpec(*input_specs_, input_tensors[0]));
+      return PreprocessIntoTensorBuffer(frame_buffer, roi, tensor_buffer_spec);
+    }
+
     // Input data to be normalized (if needed) and used for inference. In most
     // cases, this is the result of image preprocessing. In case no image
     // preprocessing is needed (see below), this points to the input frame
@@ -140,34 +318,43 @@ class BaseVisionTaskApi
     const uint8* input_data;
     size_t input_data_byte_size;
 
-    // Optional buffers in case image preprocessing is needed.
+    // Optional buffer in case image preprocessing is needed.
     std::unique_ptr<FrameBuffer> preprocessed_frame_buffer;
-    std::vector<uint8> preprocessed_data;
 
-    if (IsImagePreprocessingNeeded(frame_buffer, roi)) {
+    if (is_image_preprocessing_needed) {
       // Preprocess input image to fit model requirements.
-      // For now RGB is the only color space supported, which is ensured by
-      // `CheckAndSetInputs`.
+      // For now RGB and grayscale are the only color spaces supported, which
+      // is ensured by `CheckAndSetInputs`.
       FrameBuffer::Dimension to_buffer_dimension = {input_specs_->image_width,
                                                     input_specs_->image_height};
+      const FrameBuffer::Format input_format = GetInputFormat();
+      const int pixel_bytes = GetNumChannels(input_specs_->color_space);
       input_data_byte_size =
-          GetBufferByteSize(to_buffer_dimension, FrameBuffer::Format::kRGB);
-      preprocessed_data.resize(input_data_byte_size / sizeof(uint8), 0);
-      input_data = preprocessed_data.data();
+          GetBufferByteSize(to_buffer_dimension, input_format);
+      uint8* preprocessed_data =
+          preprocessing_buffer_.Get(input_data_byte_size);
+      input_data = preprocessed_data;
 
       FrameBuffer::Plane preprocessed_plane = {
-          /*buffer=*/preprocessed_data.data(),
-          /*stride=*/{input_specs_->image_width * kRgbPixelBytes,
-                      kRgbPixelBytes}};
+          /*buffer=*/preprocessed_data,
+          /*stride=*/{input_specs_->image_width * pixel_bytes, pixel_bytes}};
       preprocessed_frame_buffer = FrameBuffer::Create(
-          {preprocessed_plane}, to_buffer_dimension, FrameBuffer::Format::kRGB,
+          {preprocessed_plane}, to_buffer_dimension, input_format,
           FrameBuffer::Orientation::kTopLeft);
 
-      RETURN_IF_ERROR(frame_buffer_utils_->Preprocess(
-          frame_buffer, roi, preprocessed_frame_buffer.get()));
+      if (preserve_aspect_ratio_) {
+        RETURN_IF_ERROR(frame_buffer_utils_->PreprocessWithLetterbox(
+            frame_buffer, roi, letterbox_padding_value_,
+            preprocessed_frame_buffer.get(), interpolation_method_));
+      } else {
+        RETURN_IF_ERROR(frame_buffer_utils_->Preprocess(
+            frame_buffer, roi, preprocessed_frame_buffer.get(),
+            interpolation_method_));
+      }
     } else {
       // Input frame buffer already targets model requirements: skip image
-      // preprocessing. For RGB, the data is always stored in a single plane.
+      // preprocessing. For RGB and grayscale, the data is always stored in a
+      // single plane.
       input_data = frame_buffer.plane(0).buffer;
       input_data_byte_size = frame_buffer.plane(0).stride.row_stride_bytes *
                              frame_buffer.dimension().height;
@@ -195,52 +382,167 @@ class BaseVisionTaskApi
               "and input tensor.");
         }
         // Normalize and populate.
-        float* normalized_input_data =
+        normalizer_->Normalize(
+            input_data, input_data_byte_size / sizeof(uint8),
             tflite::task::core::AssertAndReturnTypedTensor<float>(
-                input_tensors[0]);
-        const tflite::task::vision::NormalizationOptions&
-            normalization_options = input_specs_->normalization_options.value();
-        if (normalization_options.num_values == 1) {
-          float mean_value = normalization_options.mean_values[0];
-          float inv_std_value = (1.0f / normalization_options.std_values[0]);
-          for (int i = 0; i < input_data_byte_size / sizeof(uint8);
-               i++, input_data++, normalized_input_data++) {
-            *normalized_input_data =
-                inv_std_value * (static_cast<float>(*input_data) - mean_value);
-          }
-        } else {
-          std::array<float, 3> inv_std_values = {
-              1.0f / normalization_options.std_values[0],
-              1.0f / normalization_options.std_values[1],
-              1.0f / normalization_options.std_values[2]};
-          for (int i = 0; i < input_data_byte_size / sizeof(uint8);
-               i++, input_data++, normalized_input_data++) {
-            *normalized_input_data = inv_std_values[i % 3] *
-                                     (static_cast<float>(*input_data) -
-                                      normalization_options.mean_values[i % 3]);
-          }
-        }
+                input_tensors[0]));
+        break;
+      }
+      case kTfLiteInt8: {
+        // Quantize using the fused pre-processing code path, which boils down
+        // to a plain conversion here as the RGB or grayscale data already has
+        // the model dimensions and orientation.
+        const FrameBuffer& input_frame_buffer =
+            is_image_preprocessing_needed ? *preprocessed_frame_buffer
+                                          : frame_buffer;
+        BoundingBox full_roi;
+        full_roi.set_width(input_specs_->image_width);
+        full_roi.set_height(input_specs_->image_height);
+        ASSIGN_OR_RETURN(
+            TensorBufferSpec tensor_buffer_spec,
+            BuildTensorBufferSpec(*input_specs_, input_tensors[0]));
+        RETURN_IF_ERROR(PreprocessIntoTensorBuffer(input_frame_buffer,
+                                                   full_roi,
+                                                   tensor_buffer_spec));
         break;
       }
-      case kTfLiteInt8:
-        return tflite::support::CreateStatusWithPayload(
-            absl::StatusCode::kUnimplemented,
-            "kTfLiteInt8 input type is not implemented yet.");
       default:
         return tflite::support::CreateStatusWithPayload(
             absl::StatusCode::kInternal, "Unexpected input tensor type.");
     }
 
+    preprocessing_buffer_.ReleaseIfAboveCap();
     return absl::OkStatus();
   }
 
+  // Returns the region of the upright input tensor covered by the region of
+  // interest `roi` of `frame_buffer` after pre-processing, in pixels. This is
+  // the whole input tensor unless the aspect ratio is preserved, see
+  // `SetPreserveAspectRatio`.
+  BoundingBox GetInputTensorRegion(const FrameBuffer& frame_buffer,
+                                   const BoundingBox& roi) const {
+    BoundingBox region;
+    region.set_width(input_specs_->image_width);
+    region.set_height(input_specs_->image_height);
+    if (!preserve_aspect_ratio_) {
+      return region;
+    }
+    return GetLetterboxedOutputRegion(
+        {roi.width(), roi.height()}, frame_buffer.format(),
+        frame_buffer.orientation(),
+        {input_specs_->image_width, input_specs_->image_height},
+        GetInputFormat());
+  }
+
   // Utils for input image preprocessing (resizing, colorspace conversion, etc).
   std::unique_ptr<FrameBufferUtils> frame_buffer_utils_;
 
   // Parameters related to the input tensor which represents an image.
   std::unique_ptr<ImageTensorSpecs> input_specs_;
 
+  // Normalizes pixel values into float input tensors whenever single-pass
+  // pre-processing is not used. Only set if the input tensor is float.
+  std::unique_ptr<PixelNormalizer> normalizer_;
+
+  // Whether to use single-pass pre-processing. See `SetUseFusedPreprocessing`.
+  bool use_fused_preprocessing_ = false;
+
+  // Whether to resize YUV frame buffers before converting them directly into
+  // the input tensor. See `SetUseDirectYuvPreprocessing`.
+  bool use_direct_yuv_preprocessing_ = false;
+
+  // Whether to fold orientation into bilinear resizing. See
+  // `SetFuseResizeAndOrient`.
+  bool fuse_resize_and_orient_ = false;
+
+  // Interpolation method used for resizing. See `SetInterpolationMethod`.
+  InterpolationMethod interpolation_method_ = InterpolationMethod::kBilinear;
+
+  // Whether to preserve the aspect ratio of the region of interest, and the
+  // gray level of the padding pixels. See `SetPreserveAspectRatio`.
+  bool preserve_aspect_ratio_ = false;
+  uint8 letterbox_padding_value_ = 0;
+
+  // Scratch buffer holding the pre-processed image, when not using single-pass
+  // pre-processing, or the resized YUV image when using direct YUV
+  // pre-processing.
+  ScratchArena preprocessing_buffer_;
+
+  // Optional cache of pre-processed input tensor data, possibly shared with
+  // other tasks. See `SetPreprocessingCache`.
+  std::shared_ptr<PreprocessingCache> preprocessing_cache_;
+
  private:
+  // Returns the key identifying the input tensor data resulting from the
+  // pre-processing of `frame_buffer` over `roi` into `tensor_buffer_spec`
+  // with the current settings.
+  tflite::support::StatusOr<PreprocessingCacheKey> GetPreprocessingCacheKey(
+      const FrameBuffer& frame_buffer, const BoundingBox& roi,
+      const TensorBufferSpec& tensor_buffer_spec) const {
+    PreprocessingCacheKey key;
+    key.frame_data = frame_buffer.plane(0).buffer;
+    key.timestamp = frame_buffer.timestamp();
+    ASSIGN_OR_RETURN(key.content_fingerprint,
+                     GetFrameContentFingerprint(frame_buffer));
+    key.frame_dimension = frame_buffer.dimension();
+    key.format = frame_buffer.format();
+    key.orientation = frame_buffer.orientation();
+    key.roi_origin_x = roi.origin_x();
+    key.roi_origin_y = roi.origin_y();
+    key.roi_width = roi.width();
+    key.roi_height = roi.height();
+    key.tensor_dimension = tensor_buffer_spec.dimension;
+    key.element_type = tensor_buffer_spec.element_type;
+    key.scale = tensor_buffer_spec.scale;
+    key.offset = tensor_buffer_spec.offset;
+    key.interpolation = interpolation_method_;
+    if (preserve_aspect_ratio_) {
+      key.letterbox_padding_value = letterbox_padding_value_;
+    }
+    key.use_fused_preprocessing = use_fused_preprocessing_;
+    key.use_direct_yuv_preprocessing = use_direct_yuv_preprocessing_;
+    key.fuse_resize_and_orient = fuse_resize_and_orient_;
+    return key;
+  }
+
+  // Returns whether single-pass pre-processing supports the current settings,
+  // i.e. if bilinear interpolation is used without letterboxing, and the
+  // region of interest is not box-reduced first. Even then, its results only
+  // approximate the ProcessEngine ones, see `SetUseFusedPreprocessing`.
+  bool IsFusedPreprocessingSupported(const FrameBuffer& frame_buffer,
+                                     const BoundingBox& roi) {
+    if (interpolation_method_ != InterpolationMethod::kBilinear ||
+        preserve_aspect_ratio_) {
+      return false;
+    }
+    // The region of interest is resized before rotation, i.e. to the input
+    // tensor dimensions in the unrotated frame of reference.
+    FrameBuffer::Dimension to_dimension = {input_specs_->image_width,
+                                           input_specs_->image_height};
+    if (RequireDimensionSwap(frame_buffer.orientation(),
+                             FrameBuffer::Orientation::kTopLeft)) {
+      to_dimension.Swap();
+    }
+    return !UsesBoxPreReduction({roi.width(), roi.height()}, to_dimension,
+                                interpolation_method_);
+  }
+
+  // Returns the frame buffer format matching the color space of the input
+  // tensor.
+  FrameBuffer::Format GetInputFormat() const {
+    return input_specs_->color_space == tflite::ColorSpaceType_GRAYSCALE
+               ? FrameBuffer::Format::kGRAY
+               : FrameBuffer::Format::kRGB;
+  }
+
+  // Returns whether `format` is one of the YUV420 family formats.
+  static bool IsYuvFormat(FrameBuffer::Format format) {
+    return format == FrameBuffer::Format::kNV12 ||
+           format == FrameBuffer::Format::kNV21 ||
+           format == FrameBuffer::Format::kYV12 ||
+           format == FrameBuffer::Format::kYV21;
+  }
+
   // Returns false if image preprocessing could be skipped, true otherwise.
   bool IsImagePreprocessingNeeded(const FrameBuffer& frame_buffer,
                                   const BoundingBox& roi) {
@@ -253,7 +555,7 @@ class BaseVisionTaskApi
 
     // Are image transformations required?
     if (frame_buffer.orientation() != FrameBuffer::Orientation::kTopLeft ||
-        frame_buffer.format() != FrameBuffer::Format::kRGB ||
+        frame_buffer.format() != GetInputFormat() ||
         frame_buffer.dimension().width != input_specs_->image_width ||
         frame_buffer.dimension().height != input_specs_->image_height) {
       return true;
@@ -75,7 +75,26 @@ namespace vision {
 class FrameBuffer {
  public:
   // Colorspace formats.
-  enum class Format { kRGBA, kRGB, kNV12, kNV21, kYV12, kYV21, kGRAY };
+  //
+  // kBGRA and kBGR are the interleaved kRGBA and kRGB formats with the blue and
+  // red channels swapped in memory, e.g. as produced by OpenCV or GPU
+  // readbacks. kYUYV (a.k.a. YUY2) and kUYVY are the packed YUV 4:2:2 formats,
+  // made of a single plane holding 2 bytes per pixel, where each pair of
+  // horizontally adjacent pixels shares a 4-byte Y0 U Y1 V (resp. U Y0 V Y1)
+  // macropixel.
+  enum class Format {
+    kRGBA,
+    kRGB,
+    kNV12,
+    kNV21,
+    kYV12,
+    kYV21,
+    kGRAY,
+    kBGRA,
+    kBGR,
+    kYUYV,
+    kUYVY
+  };
 
   // Stride information.
   struct Stride {
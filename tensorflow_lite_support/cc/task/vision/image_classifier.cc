@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/vision/core/label_map_item.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/class_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/interpolation_utils.h"
 #include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
@@ -125,6 +126,12 @@ absl::Status ImageClassifier::SanityCheckOptions(
         "`num_threads` must be greater than 0 or equal to -1.",
         TfLiteSupportStatus::kInvalidArgumentError);
   }
+  if (options.num_preprocessing_threads() <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "`num_preprocessing_threads` must be greater than 0.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -152,7 +159,10 @@ absl::Status ImageClassifier::Init(
 }
 
 absl::Status ImageClassifier::PreInit() {
-  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv);
+  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv,
+                   options_->num_preprocessing_threads());
+  SetInterpolationMethod(
+      GetInterpolationMethod(options_->interpolation_method()));
   return absl::OkStatus();
 }
 
@@ -85,10 +85,12 @@ class ImageClassifier : public BaseVisionTaskApi<ClassificationResult> {
   // Performs actual classification on the provided FrameBuffer.
   //
   // The FrameBuffer can be of any size and any of the supported formats, i.e.
-  // RGBA, RGB, NV12, NV21, YV12, YV21. It is automatically pre-processed before
-  // inference in order to (and in this order):
-  // - resize it (with bilinear interpolation, aspect-ratio *not* preserved) to
-  //   the dimensions of the model input tensor,
+  // RGBA, RGB, BGRA, BGR, NV12, NV21, YV12, YV21, YUYV, UYVY. It is
+  // automatically pre-processed before inference in order to (and in this
+  // order):
+  // - resize it (with the `interpolation_method` set in the options,
+  //   aspect-ratio *not* preserved) to the dimensions of the model input
+  //   tensor,
   // - convert it to the colorspace of the input tensor (i.e. RGB, which is the
   //   only supported colorspace for now),
   // - rotate it according to its `Orientation` so that inference is performed
@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/core/task_utils.h"
 #include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/interpolation_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/segmentation_mask_utils.h"
 #include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
@@ -155,6 +157,12 @@ absl::Status ImageSegmenter::SanityCheckOptions(
         "`num_threads` must be greater than 0 or equal to -1.",
         TfLiteSupportStatus::kInvalidArgumentError);
   }
+  if (options.num_preprocessing_threads() <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "`num_preprocessing_threads` must be greater than 0.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -192,11 +200,21 @@ absl::Status ImageSegmenter::Init(
   // Initialize colored_labels_ once and for all.
   RETURN_IF_ERROR(InitColoredLabels());
 
+  // Post-processing uses the same thread budget as inference, which is idle
+  // by then.
+  if (options_->num_threads() > 1) {
+    postprocessing_thread_pool_ =
+        absl::make_unique<ThreadPool>(options_->num_threads());
+  }
+
   return absl::OkStatus();
 }
 
 absl::Status ImageSegmenter::PreInit() {
-  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv);
+  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv,
+                   options_->num_preprocessing_threads());
+  SetInterpolationMethod(
+      GetInterpolationMethod(options_->interpolation_method()));
   return absl::OkStatus();
 }
 
@@ -334,94 +352,58 @@ StatusOr<SegmentationResult> ImageSegmenter::Postprocess(
   FrameBuffer::Dimension tensor_dimension = {output_width_, output_height_};
 
   // The masks to produce from the output tensor need to be re-oriented in the
-  // unrotated frame of reference coordinates system, i.e. kTopLeft.
-  FrameBuffer::Orientation mask_orientation =
-      FrameBuffer::Orientation::kTopLeft;
-  // They may thus have swapped dimensions compared to the tensor if the
-  // rotation is 90° or 270°.
-  FrameBuffer::Dimension mask_dimension(tensor_dimension);
-  if (RequireDimensionSwap(frame_buffer.orientation(),
-                           FrameBuffer::Orientation::kTopLeft)) {
-    mask_dimension.Swap();
-  }
+  // unrotated frame of reference coordinates system, i.e. kTopLeft. They may
+  // thus have swapped dimensions compared to the tensor if the rotation is 90°
+  // or 270°. Each mask pixel maps to a contiguous depth vector of the tensor,
+  // whose offset is affine in the mask coordinates.
+  const MaskTensorLayout layout =
+      GetMaskTensorLayout(tensor_dimension, output_depth_, tensor_orientation);
+  const FrameBuffer::Dimension mask_dimension = layout.mask_dimension;
   segmentation->set_width(mask_dimension.width);
   segmentation->set_height(mask_dimension.height);
 
-  // XY coordinates in the tensor, to be computed from mask_x and mask_y below.
-  int tensor_x;
-  int tensor_y;
-
   if (options_->output_type() == ImageSegmenterOptions::CATEGORY_MASK) {
     auto* category_mask = segmentation->mutable_category_mask();
     category_mask->resize(mask_dimension.width * mask_dimension.height);
-    int pixel_offset = 0;
-    for (int mask_y = 0; mask_y < mask_dimension.height; ++mask_y) {
-      for (int mask_x = 0; mask_x < mask_dimension.width; ++mask_x) {
-        // Compute the coordinates (tensor_x, tensor_y) in the tensor with
-        // tensor_orientation = frame_buffer.orientation() corresponding to the
-        // coordinates (mask_x, mask_y) in the mask being filled with
-        // mask_orientation = kTopLeft, i.e. the orientation of the unrotated
-        // frame of reference.
-        OrientCoordinates(/*from_x=*/mask_x,
-                          /*from_y=*/mask_y,
-                          /*from_orientation=*/mask_orientation,
-                          /*to_orientation=*/tensor_orientation,
-                          /*from_dimension=*/mask_dimension,
-                          /*to_x=*/&tensor_x,
-                          /*to_y=*/&tensor_y);
-        int class_index = 0;
-        float max_confidence = 0.0f;
-        for (int d = 0; d < output_depth_; ++d) {
-          const float confidence =
-              GetOutputConfidence(*output_tensor, tensor_x, tensor_y, d);
-          if (confidence > max_confidence) {
-            class_index = d;
-            max_confidence = confidence;
-          }
-        }
-        (*category_mask)[pixel_offset++] = static_cast<char>(class_index);
-      }
+    uint8* category_mask_data = reinterpret_cast<uint8*>(&(*category_mask)[0]);
+    if (has_uint8_outputs_) {
+      ComputeCategoryMask(AssertAndReturnTypedTensor<uint8>(output_tensor),
+                          output_tensor->params.scale,
+                          output_tensor->params.zero_point, layout,
+                          postprocessing_thread_pool_.get(),
+                          category_mask_data);
+    } else {
+      ComputeCategoryMask(AssertAndReturnTypedTensor<float>(output_tensor),
+                          layout, postprocessing_thread_pool_.get(),
+                          category_mask_data);
     }
   } else if (options_->output_type() ==
              ImageSegmenterOptions::CONFIDENCE_MASK) {
+    // Allocate all the masks upfront, so that their rows can be filled
+    // concurrently.
     auto* confidence_masks = segmentation->mutable_confidence_masks();
+    std::vector<float*> confidence_masks_data(output_depth_);
     for (int d = 0; d < output_depth_; ++d) {
-      confidence_masks->add_confidence_mask();
+      auto* values = confidence_masks->add_confidence_mask()->mutable_value();
+      values->Resize(mask_dimension.width * mask_dimension.height, 0.0f);
+      confidence_masks_data[d] = values->mutable_data();
     }
-    for (int mask_y = 0; mask_y < segmentation->height(); ++mask_y) {
-      for (int mask_x = 0; mask_x < segmentation->width(); ++mask_x) {
-        // See above.
-        OrientCoordinates(/*from_x=*/mask_x,
-                          /*from_y=*/mask_y,
-                          /*from_orientation=*/mask_orientation,
-                          /*to_orientation=*/tensor_orientation,
-                          /*from_dimension=*/mask_dimension,
-                          /*to_x=*/&tensor_x,
-                          /*to_y=*/&tensor_y);
-        for (int d = 0; d < output_depth_; ++d) {
-          confidence_masks->mutable_confidence_mask(d)->add_value(
-              GetOutputConfidence(*output_tensor, tensor_x, tensor_y, d));
-        }
-      }
+    if (has_uint8_outputs_) {
+      ComputeConfidenceMasks(AssertAndReturnTypedTensor<uint8>(output_tensor),
+                             output_tensor->params.scale,
+                             output_tensor->params.zero_point, layout,
+                             postprocessing_thread_pool_.get(),
+                             confidence_masks_data.data());
+    } else {
+      ComputeConfidenceMasks(AssertAndReturnTypedTensor<float>(output_tensor),
+                             layout, postprocessing_thread_pool_.get(),
+                             confidence_masks_data.data());
     }
   }
 
   return result;
 }
 
-float ImageSegmenter::GetOutputConfidence(const TfLiteTensor& output_tensor,
-                                          int x, int y, int depth) {
-  int index = output_width_ * output_depth_ * y + output_depth_ * x + depth;
-  if (has_uint8_outputs_) {
-    const uint8* data = AssertAndReturnTypedTensor<uint8>(&output_tensor);
-    return output_tensor.params.scale *
-           (static_cast<int>(data[index]) - output_tensor.params.zero_point);
-  } else {
-    const float* data = AssertAndReturnTypedTensor<float>(&output_tensor);
-    return data[index];
-  }
-}
-
 }  // namespace vision
 }  // namespace task
 }  // namespace tflite
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/image_segmenter_options_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/segmentations_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/thread_pool.h"
 
 namespace tflite {
 namespace task {
@@ -83,10 +84,12 @@ class ImageSegmenter : public BaseVisionTaskApi<SegmentationResult> {
   // Performs actual segmentation on the provided FrameBuffer.
   //
   // The FrameBuffer can be of any size and any of the supported formats, i.e.
-  // RGBA, RGB, NV12, NV21, YV12, YV21. It is automatically pre-processed before
-  // inference in order to (and in this order):
-  // - resize it (with bilinear interpolation, aspect-ratio *not* preserved) to
-  //   the dimensions of the model input tensor,
+  // RGBA, RGB, BGRA, BGR, NV12, NV21, YV12, YV21, YUYV, UYVY. It is
+  // automatically pre-processed before inference in order to (and in this
+  // order):
+  // - resize it (with the `interpolation_method` set in the options,
+  //   aspect-ratio *not* preserved) to the dimensions of the model input
+  //   tensor,
   // - convert it to the colorspace of the input tensor (i.e. RGB, which is the
   //   only supported colorspace for now),
   // - rotate it according to its `Orientation` so that inference is performed
@@ -144,11 +147,6 @@ class ImageSegmenter : public BaseVisionTaskApi<SegmentationResult> {
   // `colored_labels_`.
   absl::Status InitColoredLabels();
 
-  // Returns the output confidence at coordinates {x, y, depth}, dequantizing
-  // on-the-fly if needed (i.e. if `has_uint8_outputs_` is true).
-  float GetOutputConfidence(const TfLiteTensor& output_tensor, int x, int y,
-                            int depth);
-
   // Prebuilt list of ColoredLabel attached to each Segmentation result. The
   // i-th item in this list corresponds to the i-th label map item.
   std::vector<Segmentation::ColoredLabel> colored_labels_;
@@ -163,6 +161,10 @@ class ImageSegmenter : public BaseVisionTaskApi<SegmentationResult> {
   int output_height_;
   // Expected output depth. This corresponds to the number of supported classes.
   int output_depth_;
+
+  // Thread pool computing the masks, or null if post-processing is
+  // single-threaded, i.e. unless `options_->num_threads()` is above 1.
+  std::unique_ptr<ThreadPool> postprocessing_thread_pool_;
 };
 
 }  // namespace vision
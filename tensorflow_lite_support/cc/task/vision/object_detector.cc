@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/class_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/interpolation_utils.h"
 #include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
@@ -247,6 +248,19 @@ absl::Status ObjectDetector::SanityCheckOptions(
         "`num_threads` must be greater than 0 or equal to -1.",
         TfLiteSupportStatus::kInvalidArgumentError);
   }
+  if (options.num_preprocessing_threads() <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "`num_preprocessing_threads` must be greater than 0.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.letterbox_padding_value() < 0 ||
+      options.letterbox_padding_value() > 255) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "`letterbox_padding_value` must be in the [0, 255] range.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -289,7 +303,12 @@ absl::Status ObjectDetector::Init(
 }
 
 absl::Status ObjectDetector::PreInit() {
-  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv);
+  SetProcessEngine(FrameBufferUtils::ProcessEngine::kLibyuv,
+                   options_->num_preprocessing_threads());
+  SetInterpolationMethod(
+      GetInterpolationMethod(options_->interpolation_method()));
+  SetPreserveAspectRatio(options_->preserve_aspect_ratio(),
+                         options_->letterbox_padding_value());
   return absl::OkStatus();
 }
 
@@ -445,7 +464,7 @@ StatusOr<DetectionResult> ObjectDetector::Detect(
 
 StatusOr<DetectionResult> ObjectDetector::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
-    const FrameBuffer& frame_buffer, const BoundingBox& /*roi*/) {
+    const FrameBuffer& frame_buffer, const BoundingBox& roi) {
   // Most of the checks here should never happen, as outputs have been validated
   // at construction time. Checking nonetheless and returning internal errors if
   // something bad happens.
@@ -467,6 +486,12 @@ StatusOr<DetectionResult> ObjectDetector::Postprocess(
     upright_input_frame_dimensions.Swap();
   }
 
+  // The region of the upright input tensor covered by the input frame, which
+  // is smaller than the input tensor in case of letterboxing.
+  const BoundingBox tensor_region = GetInputTensorRegion(frame_buffer, roi);
+  const int tensor_width = input_specs_->image_width;
+  const int tensor_height = input_specs_->image_height;
+
   const float* locations = AssertAndReturnTypedTensor<float>(output_tensors[0]);
   const float* classes = AssertAndReturnTypedTensor<float>(output_tensors[1]);
   const float* scores = AssertAndReturnTypedTensor<float>(output_tensors[2]);
@@ -478,17 +503,34 @@ StatusOr<DetectionResult> ObjectDetector::Postprocess(
       continue;
     }
     Detection* detection = results.add_detections();
+    float left = locations[4 * i + bounding_box_corners_order_[0]];
+    float top = locations[4 * i + bounding_box_corners_order_[1]];
+    float right = locations[4 * i + bounding_box_corners_order_[2]];
+    float bottom = locations[4 * i + bounding_box_corners_order_[3]];
+    if (options_->preserve_aspect_ratio()) {
+      // Map the coordinates from the letterboxed input tensor back to the
+      // upright frame.
+      left = MapToOutputRegion(left, tensor_width, tensor_region.origin_x(),
+                               tensor_region.width());
+      right = MapToOutputRegion(right, tensor_width, tensor_region.origin_x(),
+                                tensor_region.width());
+      top = MapToOutputRegion(top, tensor_height, tensor_region.origin_y(),
+                              tensor_region.height());
+      bottom = MapToOutputRegion(bottom, tensor_height,
+                                 tensor_region.origin_y(),
+                                 tensor_region.height());
+    }
     // Denormalize the bounding box cooordinates in the upright frame
-    // coordinates system, then rotate back from frame_buffer.orientation() to
-    // the unrotated frame of reference coordinates system (i.e. with
-    // orientation = kTopLeft).
+    // coordinates system, then rotate back to the unrotated frame of reference
+    // coordinates system, i.e. undo the rotation from
+    // frame_buffer.orientation() to kTopLeft performed by pre-processing. Both
+    // orientations are swapped as the rotation is not its own inverse for
+    // kRightTop and kLeftBottom.
     *detection->mutable_bounding_box() = OrientAndDenormalizeBoundingBox(
-        /*from_left=*/locations[4 * i + bounding_box_corners_order_[0]],
-        /*from_top=*/locations[4 * i + bounding_box_corners_order_[1]],
-        /*from_right=*/locations[4 * i + bounding_box_corners_order_[2]],
-        /*from_bottom=*/locations[4 * i + bounding_box_corners_order_[3]],
-        /*from_orientation=*/frame_buffer.orientation(),
-        /*to_orientation=*/FrameBuffer::Orientation::kTopLeft,
+        /*from_left=*/left, /*from_top=*/top, /*from_right=*/right,
+        /*from_bottom=*/bottom,
+        /*from_orientation=*/FrameBuffer::Orientation::kTopLeft,
+        /*to_orientation=*/frame_buffer.orientation(),
         /*from_dimension=*/upright_input_frame_dimensions);
     Class* detection_class = detection->add_classes();
     detection_class->set_index(class_index);
@@ -0,0 +1,308 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/auto_frame_buffer_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::tflite::support::StatusOr;
+
+// Dimension of the synthetic input frames used for calibration, and of the
+// output frames of resizing operations, chosen to be representative of
+// camera frames being pre-processed for a vision model.
+constexpr FrameBuffer::Dimension kCalibrationInputDimension = {640, 480};
+constexpr FrameBuffer::Dimension kCalibrationResizeDimension = {224, 224};
+
+// Number of timed runs per candidate engine, the fastest of which is
+// retained. Each candidate is run once more beforehand to warm caches up.
+constexpr int kCalibrationRuns = 3;
+
+// Selected engine index per calibration key, shared by all instances.
+struct CalibrationCache {
+  absl::Mutex mutex;
+  std::map<std::string, int> selected_engines ABSL_GUARDED_BY(mutex);
+};
+
+CalibrationCache& GetCalibrationCache() {
+  static CalibrationCache* const cache = new CalibrationCache();
+  return *cache;
+}
+
+// Synthetic frame buffer along with its backing data.
+struct SyntheticFrame {
+  std::vector<uint8> data;
+  std::unique_ptr<FrameBuffer> buffer;
+};
+
+StatusOr<SyntheticFrame> CreateSyntheticFrame(FrameBuffer::Dimension dimension,
+                                              FrameBuffer::Format format) {
+  SyntheticFrame frame;
+  frame.data.resize(GetFrameBufferByteSize(dimension, format));
+  for (size_t i = 0; i < frame.data.size(); ++i) {
+    frame.data[i] = static_cast<uint8>(i * 7);
+  }
+  ASSIGN_OR_RETURN(frame.buffer,
+                   CreateFromRawBuffer(frame.data.data(), dimension, format));
+  return frame;
+}
+
+}  // namespace
+
+AutoFrameBufferUtils::AutoFrameBufferUtils(std::vector<NamedEngine> engines)
+    : engines_(std::move(engines)) {
+  TFLITE_DCHECK(!engines_.empty());
+  engine_names_ = absl::StrJoin(
+      engines_, ",", [](std::string* out, const NamedEngine& engine) {
+        absl::StrAppend(out, engine.first);
+      });
+  for (std::atomic<int>& selected_engine : selected_engines_) {
+    selected_engine.store(kUnresolvedEngine, std::memory_order_relaxed);
+  }
+}
+
+absl::Status AutoFrameBufferUtils::Crop(const FrameBuffer& buffer, int x0,
+                                        int y0, int x1, int y1,
+                                        FrameBuffer* output_buffer) {
+  const bool is_resize_needed =
+      output_buffer->dimension().width != x1 - x0 + 1 ||
+      output_buffer->dimension().height != y1 - y0 + 1;
+  return SelectEngine(
+             is_resize_needed ? Operation::kCropResize : Operation::kCrop,
+             buffer.format(), output_buffer->format(), /*angle_deg=*/0)
+      ->Crop(buffer, x0, y0, x1, y1, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::Resize(const FrameBuffer& buffer,
+                                          FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kResize, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->Resize(buffer, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::ResizeWithInterpolation(
+    const FrameBuffer& buffer, InterpolationMethod interpolation,
+    FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kResize, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->ResizeWithInterpolation(buffer, interpolation, output_buffer);
+}
+
+bool AutoFrameBufferUtils::SupportsResizeRows(
+    FrameBuffer::Format format) const {
+  return SelectEngine(Operation::kResize, format, format, /*angle_deg=*/0)
+      ->SupportsResizeRows(format);
+}
+
+absl::Status AutoFrameBufferUtils::ResizeRows(const FrameBuffer& buffer,
+                                              int row_begin, int row_end,
+                                              FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kResize, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->ResizeRows(buffer, row_begin, row_end, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::Rotate(const FrameBuffer& buffer,
+                                          int angle_deg,
+                                          FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kRotate, buffer.format(),
+                      output_buffer->format(), angle_deg)
+      ->Rotate(buffer, angle_deg, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::FlipHorizontally(
+    const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kFlipHorizontally, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->FlipHorizontally(buffer, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::FlipVertically(const FrameBuffer& buffer,
+                                                  FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kFlipVertically, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->FlipVertically(buffer, output_buffer);
+}
+
+absl::Status AutoFrameBufferUtils::Convert(const FrameBuffer& buffer,
+                                           FrameBuffer* output_buffer) {
+  return SelectEngine(Operation::kConvert, buffer.format(),
+                      output_buffer->format(), /*angle_deg=*/0)
+      ->Convert(buffer, output_buffer);
+}
+
+std::string AutoFrameBufferUtils::GetSelectedEngineName(
+    Operation operation, FrameBuffer::Format input_format,
+    FrameBuffer::Format output_format, int angle_deg) const {
+  FrameBufferUtilsInterface* engine =
+      SelectEngine(operation, input_format, output_format, angle_deg);
+  for (const NamedEngine& named_engine : engines_) {
+    if (named_engine.second.get() == engine) {
+      return named_engine.first;
+    }
+  }
+  return "";
+}
+
+FrameBufferUtilsInterface* AutoFrameBufferUtils::SelectEngine(
+    Operation operation, FrameBuffer::Format input_format,
+    FrameBuffer::Format output_format, int angle_deg) const {
+  // Angles other than 0, 90, 180 and 270 degrees are left to the first
+  // engine, e.g. to report their error.
+  const int rotation = angle_deg / 90;
+  if (engines_.size() == 1 || angle_deg % 90 != 0 || rotation < 0 ||
+      rotation >= kNumRotations) {
+    return engines_[0].second.get();
+  }
+  std::atomic<int>& selected_engine =
+      selected_engines_[((static_cast<int>(operation) * kNumFormats +
+                          static_cast<int>(input_format)) *
+                             kNumFormats +
+                         static_cast<int>(output_format)) *
+                            kNumRotations +
+                        rotation];
+  int index = selected_engine.load(std::memory_order_acquire);
+  if (index == kUnresolvedEngine) {
+    // Concurrent callers may both get here, in which case they get the same
+    // result from the shared calibration cache.
+    index =
+        SelectSharedEngine(operation, input_format, output_format, angle_deg);
+    selected_engine.store(index, std::memory_order_release);
+  }
+  return engines_[index].second.get();
+}
+
+int AutoFrameBufferUtils::SelectSharedEngine(Operation operation,
+                                             FrameBuffer::Format input_format,
+                                             FrameBuffer::Format output_format,
+                                             int angle_deg) const {
+  const std::string key =
+      absl::StrCat(engine_names_, "/", static_cast<int>(operation), "/",
+                   static_cast<int>(input_format), "/",
+                   static_cast<int>(output_format), "/", angle_deg);
+  CalibrationCache& cache = GetCalibrationCache();
+  // The lock is held during calibration so that concurrent callers, e.g. the
+  // threads processing the stripes of a same image, wait for its result
+  // instead of disturbing the measurements.
+  absl::MutexLock lock(&cache.mutex);
+  auto it = cache.selected_engines.find(key);
+  if (it != cache.selected_engines.end()) {
+    return it->second;
+  }
+
+  const FrameBuffer::Dimension input_dimension = kCalibrationInputDimension;
+  FrameBuffer::Dimension output_dimension = input_dimension;
+  switch (operation) {
+    case Operation::kCrop:
+      output_dimension = {input_dimension.width / 2,
+                          input_dimension.height / 2};
+      break;
+    case Operation::kCropResize:
+    case Operation::kResize:
+      output_dimension = kCalibrationResizeDimension;
+      break;
+    case Operation::kRotate:
+      if (angle_deg % 180 != 0) {
+        output_dimension = {input_dimension.height, input_dimension.width};
+      }
+      break;
+    case Operation::kFlipHorizontally:
+    case Operation::kFlipVertically:
+    case Operation::kConvert:
+      break;
+  }
+  int selected_engine = 0;
+  StatusOr<SyntheticFrame> input =
+      CreateSyntheticFrame(input_dimension, input_format);
+  StatusOr<SyntheticFrame> output =
+      CreateSyntheticFrame(output_dimension, output_format);
+  if (input.ok() && output.ok()) {
+    const FrameBuffer& input_buffer = *input.value().buffer;
+    FrameBuffer* output_buffer = output.value().buffer.get();
+    // Crops the center of the input frame.
+    const int x0 = input_dimension.width / 4;
+    const int y0 = input_dimension.height / 4;
+    const int x1 = x0 + input_dimension.width / 2 - 1;
+    const int y1 = y0 + input_dimension.height / 2 - 1;
+    selected_engine = Calibrate([&](FrameBufferUtilsInterface* engine) {
+      switch (operation) {
+        case Operation::kCrop:
+        case Operation::kCropResize:
+          return engine->Crop(input_buffer, x0, y0, x1, y1, output_buffer);
+        case Operation::kResize:
+          return engine->Resize(input_buffer, output_buffer);
+        case Operation::kRotate:
+          return engine->Rotate(input_buffer, angle_deg, output_buffer);
+        case Operation::kFlipHorizontally:
+          return engine->FlipHorizontally(input_buffer, output_buffer);
+        case Operation::kFlipVertically:
+          return engine->FlipVertically(input_buffer, output_buffer);
+        case Operation::kConvert:
+          return engine->Convert(input_buffer, output_buffer);
+      }
+      return absl::OkStatus();
+    });
+  }
+  cache.selected_engines[key] = selected_engine;
+  return selected_engine;
+}
+
+int AutoFrameBufferUtils::Calibrate(const CalibrationRun& run) const {
+  int selected_engine = 0;
+  absl::Duration selected_duration = absl::InfiniteDuration();
+  for (int i = 0; i < engines_.size(); ++i) {
+    FrameBufferUtilsInterface* engine = engines_[i].second.get();
+    if (!run(engine).ok()) {
+      continue;
+    }
+    absl::Duration duration = absl::InfiniteDuration();
+    for (int run_index = 0; run_index < kCalibrationRuns; ++run_index) {
+      const absl::Time start = absl::Now();
+      run(engine).IgnoreError();
+      duration = std::min(duration, absl::Now() - start);
+    }
+    if (duration < selected_duration) {
+      selected_engine = i;
+      selected_duration = duration;
+    }
+  }
+  return selected_engine;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
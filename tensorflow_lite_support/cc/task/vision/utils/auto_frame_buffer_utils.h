@@ -0,0 +1,159 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_AUTO_FRAME_BUFFER_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_AUTO_FRAME_BUFFER_UTILS_H_
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Image processing engine conforming to FrameBufferUtilsInterface that
+// dispatches each operation to the fastest of a set of candidate engines.
+//
+// The fastest engine is determined per kind of operation (e.g. rotation by 90
+// degrees of kRGB buffers, or conversion from kNV21 to kRGB) by timing every
+// candidate on a synthetic frame the first time such an operation is
+// performed. Calibration results are shared by all the instances using the
+// same candidates in the process, so that it only happens once per kind of
+// operation. Each instance then keeps the selected engines in a table read
+// without locking, so that dispatching an operation, e.g. from the threads
+// resizing the stripes of an image, costs a single atomic load.
+//
+// Candidates are expected to produce identical results, which is the case of
+// the in-tree engines: the selection only affects performance.
+class AutoFrameBufferUtils : public FrameBufferUtilsInterface {
+ public:
+  // Kinds of operations calibrated separately.
+  enum class Operation {
+    kCrop,
+    kCropResize,
+    kResize,
+    kRotate,
+    kFlipHorizontally,
+    kFlipVertically,
+    kConvert,
+  };
+
+  // A candidate engine, along with a name uniquely identifying its
+  // implementation.
+  using NamedEngine =
+      std::pair<std::string, std::unique_ptr<FrameBufferUtilsInterface>>;
+
+  // Creates an instance dispatching to the given candidate `engines`, which
+  // must not be empty. Operations not supported by any candidate are performed
+  // by the first one, so as to report its error.
+  explicit AutoFrameBufferUtils(std::vector<NamedEngine> engines);
+  ~AutoFrameBufferUtils() override = default;
+
+  absl::Status Crop(const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
+                    FrameBuffer* output_buffer) override;
+
+  absl::Status Resize(const FrameBuffer& buffer,
+                      FrameBuffer* output_buffer) override;
+
+  // Uses the engine selected for bilinear resizing of the same formats.
+  absl::Status ResizeWithInterpolation(const FrameBuffer& buffer,
+                                       InterpolationMethod interpolation,
+                                       FrameBuffer* output_buffer) override;
+
+  // Returns whether the engine selected for resizing buffers of the given
+  // `format` supports `ResizeRows`.
+  bool SupportsResizeRows(FrameBuffer::Format format) const override;
+
+  absl::Status ResizeRows(const FrameBuffer& buffer, int row_begin,
+                          int row_end, FrameBuffer* output_buffer) override;
+
+  absl::Status Rotate(const FrameBuffer& buffer, int angle_deg,
+                      FrameBuffer* output_buffer) override;
+
+  absl::Status FlipHorizontally(const FrameBuffer& buffer,
+                                FrameBuffer* output_buffer) override;
+
+  absl::Status FlipVertically(const FrameBuffer& buffer,
+                              FrameBuffer* output_buffer) override;
+
+  absl::Status Convert(const FrameBuffer& buffer,
+                       FrameBuffer* output_buffer) override;
+
+  // Returns the name of the engine selected for the given kind of operation,
+  // calibrating it if needed. `angle_deg` is only relevant for rotations.
+  // Exposed for testing and logging purposes.
+  std::string GetSelectedEngineName(Operation operation,
+                                    FrameBuffer::Format input_format,
+                                    FrameBuffer::Format output_format,
+                                    int angle_deg = 0) const;
+
+ private:
+  // Runs one instance of the operation being calibrated on `engine`.
+  using CalibrationRun =
+      std::function<absl::Status(FrameBufferUtilsInterface* engine)>;
+
+  // Returns the engine selected for the given kind of operation, calibrating
+  // it if not done yet.
+  FrameBufferUtilsInterface* SelectEngine(Operation operation,
+                                          FrameBuffer::Format input_format,
+                                          FrameBuffer::Format output_format,
+                                          int angle_deg) const;
+
+  // Returns the index in `engines_` of the engine selected for the given kind
+  // of operation from the calibration results shared by all instances,
+  // calibrating it if not done yet.
+  int SelectSharedEngine(Operation operation,
+                         FrameBuffer::Format input_format,
+                         FrameBuffer::Format output_format,
+                         int angle_deg) const;
+
+  // Returns the index in `engines_` of the fastest engine running `run`
+  // successfully, or 0 if none does.
+  int Calibrate(const CalibrationRun& run) const;
+
+  static constexpr int kNumOperations =
+      static_cast<int>(Operation::kConvert) + 1;
+  static constexpr int kNumFormats =
+      static_cast<int>(FrameBuffer::Format::kUYVY) + 1;
+  // Number of distinct rotations, by 0, 90, 180 and 270 degrees.
+  static constexpr int kNumRotations = 4;
+  // Value of the entries of `selected_engines_` not resolved yet.
+  static constexpr int kUnresolvedEngine = -1;
+
+  std::vector<NamedEngine> engines_;
+  // Comma-separated names of `engines_`, used to scope calibration results.
+  std::string engine_names_;
+  // Index in `engines_` of the engine selected per operation, input format,
+  // output format and rotation, or `kUnresolvedEngine`. Entries are written
+  // once, after calibration, and read without locking.
+  mutable std::array<std::atomic<int>, kNumOperations * kNumFormats *
+                                           kNumFormats * kNumRotations>
+      selected_engines_;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_AUTO_FRAME_BUFFER_UTILS_H_
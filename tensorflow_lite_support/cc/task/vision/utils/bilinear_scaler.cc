@@ -0,0 +1,656 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/bilinear_scaler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/common.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TFLITE_SUPPORT_SCALER_HAS_AVX2 1
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+constexpr int kPixelBytes = 3;
+
+// Returns `num / div` in 16.16 fixed-point.
+int FixedDiv(int num, int div) {
+  return static_cast<int>((static_cast<int64>(num) << 16) / div);
+}
+
+// Returns `(num - 1) / (div - 1)` in 16.16 fixed-point, used to align the
+// first and last pixels when upscaling.
+int FixedDiv1(int num, int div) {
+  return static_cast<int>(((static_cast<int64>(num) << 16) - 0x00010001) /
+                          (div - 1));
+}
+
+// Computes the 16.16 fixed-point position of the first sample and the step
+// between samples along one axis, as libyuv does for `kFilterBilinear`.
+void ComputeSlope(int src_size, int dst_size, int* start, int* step) {
+  *start = 0;
+  *step = FixedDiv(src_size, dst_size);
+  if (dst_size <= src_size) {
+    // Subtract 0.5 to center the filter.
+    *start = (*step >> 1) - 32768;
+  } else if (src_size > 1 && dst_size > 1) {
+    *step = FixedDiv1(src_size, dst_size);
+  }
+}
+
+// Horizontal interpolation parameters for one destination pixel.
+struct ColumnSample {
+  // Byte offsets of the two source pixels.
+  int offset0;
+  int offset1;
+  // 7-bit weight of the second source pixel.
+  int weight;
+};
+
+std::vector<ColumnSample> BuildColumnSamples(int src_width, int dst_width,
+                                             int pixel_bytes = kPixelBytes) {
+  int x, dx;
+  ComputeSlope(src_width, dst_width, &x, &dx);
+  const int max_x = (src_width - 1) << 16;
+  std::vector<ColumnSample> samples(dst_width);
+  for (int i = 0; i < dst_width; ++i, x += dx) {
+    const int position = std::min(std::max(x, 0), max_x);
+    const int index = position >> 16;
+    samples[i] = {index * pixel_bytes,
+                  std::min(index + 1, src_width - 1) * pixel_bytes,
+                  (position >> 9) & 0x7f};
+  }
+  return samples;
+}
+
+// Vertical interpolation parameters for one destination row.
+struct RowSample {
+  // Indices of the two source rows.
+  int index0;
+  int index1;
+  // 8-bit weight of the second source row.
+  int weight;
+};
+
+std::vector<RowSample> BuildRowSamples(int src_height, int dst_height) {
+  int y, dy;
+  ComputeSlope(src_height, dst_height, &y, &dy);
+  const int max_y = (src_height - 1) << 16;
+  std::vector<RowSample> samples(dst_height);
+  for (int j = 0; j < dst_height; ++j, y += dy) {
+    const int position = std::min(std::max(y, 0), max_y);
+    const int index = position >> 16;
+    samples[j] = {index, std::min(index + 1, src_height - 1),
+                  (position >> 8) & 0xff};
+  }
+  return samples;
+}
+
+// Interpolates the pixels `a` and `b` made of `kNumChannels` bytes into `dst`,
+// with `f` the 7-bit weight of `b`.
+template <int kNumChannels>
+inline void FilterPixel(const uint8* a, const uint8* b, int f, uint8* dst) {
+  const int g = 128 - f;
+  for (int c = 0; c < kNumChannels; ++c) {
+    dst[c] = static_cast<uint8>((a[c] * g + b[c] * f + 64) >> 7);
+  }
+}
+
+// 4 bytes pixels are interpolated two channels at a time, as the 16-bit halves
+// of 32-bit integers: weighted sums are below 2^15, so that they never carry
+// into the upper half.
+template <>
+inline void FilterPixel<4>(const uint8* a, const uint8* b, int f, uint8* dst) {
+  uint32 pixel_a, pixel_b;
+  memcpy(&pixel_a, a, sizeof(pixel_a));
+  memcpy(&pixel_b, b, sizeof(pixel_b));
+  const uint32 weight_b = f;
+  const uint32 weight_a = 128 - f;
+  const uint32 even = (((pixel_a & 0x00ff00ff) * weight_a +
+                        (pixel_b & 0x00ff00ff) * weight_b + 0x00400040) >>
+                       7) &
+                      0x00ff00ff;
+  const uint32 odd = ((((pixel_a >> 8) & 0x00ff00ff) * weight_a +
+                       ((pixel_b >> 8) & 0x00ff00ff) * weight_b + 0x00400040) >>
+                      7) &
+                     0x00ff00ff;
+  const uint32 result = even | (odd << 8);
+  memcpy(dst, &result, sizeof(result));
+}
+
+// Interpolates the `src` row horizontally into `dst` using `samples`, for
+// pixels made of `kNumChannels` bytes written every `dst_pixel_stride` bytes.
+template <int kNumChannels>
+void FilterPixelColumns(const uint8* src,
+                        const std::vector<ColumnSample>& samples, uint8* dst,
+                        int dst_pixel_stride) {
+  for (const ColumnSample& sample : samples) {
+    FilterPixel<kNumChannels>(src + sample.offset0, src + sample.offset1,
+                              sample.weight, dst);
+    dst += dst_pixel_stride;
+  }
+}
+
+// Scalar version of InterpolateRow, processing bytes [start, num_bytes).
+void InterpolateRowScalar(const uint8* src0, const uint8* src1, int start,
+                          int num_bytes, int f, uint8* dst) {
+  const int g = 256 - f;
+  for (int i = start; i < num_bytes; ++i) {
+    dst[i] = static_cast<uint8>((src0[i] * g + src1[i] * f + 128) >> 8);
+  }
+}
+
+#if defined(TFLITE_SUPPORT_SCALER_HAS_AVX2)
+__attribute__((target("avx2"))) int InterpolateRowAvx2(const uint8* src0,
+                                                        const uint8* src1,
+                                                        int num_bytes, int f,
+                                                        uint8* dst) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i weight0 = _mm256_set1_epi16(static_cast<int16>(256 - f));
+  const __m256i weight1 = _mm256_set1_epi16(static_cast<int16>(f));
+  const __m256i rounding = _mm256_set1_epi16(128);
+  int i = 0;
+  for (; i + 32 <= num_bytes; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src0 + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+    __m256i lo = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), weight0),
+        _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), weight1));
+    __m256i hi = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), weight0),
+        _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), weight1));
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, rounding), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, rounding), 8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  return i;
+}
+
+bool HasAvx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+#endif  // TFLITE_SUPPORT_SCALER_HAS_AVX2
+
+// Interpolates two rows vertically: `dst = ((256 - f) * src0 + f * src1) /
+// 256`, with `f` the 8-bit weight of `src1`.
+void InterpolateRow(const uint8* src0, const uint8* src1, int num_bytes,
+                    int f, uint8* dst) {
+  if (f == 0) {
+    memcpy(dst, src0, num_bytes);
+    return;
+  }
+  int i = 0;
+#if defined(TFLITE_SUPPORT_SCALER_HAS_AVX2)
+  if (HasAvx2()) {
+    i = InterpolateRowAvx2(src0, src1, num_bytes, f, dst);
+  }
+#endif  // TFLITE_SUPPORT_SCALER_HAS_AVX2
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weight0 = _mm_set1_epi16(static_cast<int16>(256 - f));
+  const __m128i weight1 = _mm_set1_epi16(static_cast<int16>(f));
+  const __m128i rounding = _mm_set1_epi16(128);
+  for (; i + 16 <= num_bytes; i += 16) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+    __m128i lo =
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), weight0),
+                      _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), weight1));
+    __m128i hi =
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), weight0),
+                      _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), weight1));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, rounding), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, rounding), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  // `f` is in [1, 255] here, so both weights fit in 8 bits.
+  const uint8x8_t weight0 = vdup_n_u8(static_cast<uint8>(256 - f));
+  const uint8x8_t weight1 = vdup_n_u8(static_cast<uint8>(f));
+  for (; i + 16 <= num_bytes; i += 16) {
+    const uint8x16_t a = vld1q_u8(src0 + i);
+    const uint8x16_t b = vld1q_u8(src1 + i);
+    uint16x8_t lo = vmull_u8(vget_low_u8(a), weight0);
+    lo = vmlal_u8(lo, vget_low_u8(b), weight1);
+    uint16x8_t hi = vmull_u8(vget_high_u8(a), weight0);
+    hi = vmlal_u8(hi, vget_high_u8(b), weight1);
+    vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+  }
+#endif
+  InterpolateRowScalar(src0, src1, i, num_bytes, f, dst);
+}
+
+// Implementation of ResizeAndOrientPlaneBilinearRows for pixels made of
+// `kNumChannels` bytes, sampling the resized image with `columns` and `rows`
+// in the order in which they are used by the destination image.
+template <int kNumChannels>
+void ResizeAndOrientRows(const uint8* src, int src_row_stride,
+                         int src_pixel_stride, int src_width,
+                         const std::vector<ColumnSample>& columns,
+                         const std::vector<RowSample>& rows, bool transpose,
+                         uint8* dst, int dst_row_stride, int dst_pixel_stride,
+                         int dst_width, int dst_row_begin, int dst_row_end) {
+  if (!transpose) {
+    // Interpolate the two source rows first, then filter the resulting row
+    // horizontally.
+    const int row_bytes = (src_width - 1) * src_pixel_stride + kNumChannels;
+    std::vector<uint8> row(row_bytes);
+    for (int j = dst_row_begin; j < dst_row_end; ++j) {
+      const RowSample& sample = rows[j];
+      const uint8* src_row =
+          src + static_cast<int64>(sample.index0) * src_row_stride;
+      if (sample.weight != 0) {
+        InterpolateRow(
+            src_row, src + static_cast<int64>(sample.index1) * src_row_stride,
+            row_bytes, sample.weight, row.data());
+        src_row = row.data();
+      }
+      FilterPixelColumns<kNumChannels>(
+          src_row, columns, dst + static_cast<int64>(j) * dst_row_stride,
+          dst_pixel_stride);
+    }
+    return;
+  }
+
+  // Each destination row samples a column of the resized image, and each
+  // destination column a row of it: the span of source columns sampled by the
+  // destination rows is interpolated vertically once per destination column,
+  // then filtered horizontally into that column. Destination rows are written
+  // in parallel, so that they stay in cache from a column to the next.
+  int span_begin = columns[dst_row_begin].offset0;
+  int span_end = 0;
+  for (int j = dst_row_begin; j < dst_row_end; ++j) {
+    span_begin = std::min(span_begin, columns[j].offset0);
+    span_end = std::max(span_end, columns[j].offset1 + kNumChannels);
+  }
+  const int span_bytes = span_end - span_begin;
+  std::vector<uint8> span(span_bytes);
+  for (int i = 0; i < dst_width; ++i) {
+    const RowSample& row = rows[i];
+    const uint8* src_span =
+        src + static_cast<int64>(row.index0) * src_row_stride + span_begin;
+    if (row.weight != 0) {
+      InterpolateRow(
+          src_span,
+          src + static_cast<int64>(row.index1) * src_row_stride + span_begin,
+          span_bytes, row.weight, span.data());
+      src_span = span.data();
+    }
+    uint8* dst_column = dst + i * dst_pixel_stride;
+    for (int j = dst_row_begin; j < dst_row_end; ++j) {
+      const ColumnSample& column = columns[j];
+      FilterPixel<kNumChannels>(src_span + (column.offset0 - span_begin),
+                                src_span + (column.offset1 - span_begin),
+                                column.weight,
+                                dst_column + static_cast<int64>(j) *
+                                                 dst_row_stride);
+    }
+  }
+}
+
+// Interpolates the `src` row horizontally into `dst` using `samples`, with the
+// rounding of libyuv's ScaleARGBFilterCols: the weights of the two source
+// pixels sum up to 127 and the result is truncated.
+void FilterColumns(const uint8* src, const std::vector<ColumnSample>& samples,
+                   uint8* dst) {
+  for (const ColumnSample& sample : samples) {
+    const uint8* a = src + sample.offset0;
+    const uint8* b = src + sample.offset1;
+    const int f = sample.weight;
+    const int g = 0x7f ^ f;
+    dst[0] = static_cast<uint8>((a[0] * g + b[0] * f) >> 7);
+    dst[1] = static_cast<uint8>((a[1] * g + b[1] * f) >> 7);
+    dst[2] = static_cast<uint8>((a[2] * g + b[2] * f) >> 7);
+    dst += kPixelBytes;
+  }
+}
+
+// Filtering actually applied by libyuv for `kFilterBilinear`, once simplified
+// by its ScaleFilterReduce function.
+enum class FilterMode {
+  // Point sampling.
+  kNone,
+  // Horizontal interpolation only.
+  kLinear,
+  kBilinear,
+};
+
+FilterMode ReduceFilterMode(int src_width, int src_height, int dst_width,
+                            int dst_height) {
+  FilterMode mode = FilterMode::kBilinear;
+  if (src_height == 1 || dst_height == src_height ||
+      dst_height * 3 == src_height) {
+    mode = FilterMode::kLinear;
+  }
+  if (src_width == 1 ||
+      (mode == FilterMode::kLinear &&
+       (dst_width == src_width || dst_width * 3 == src_width))) {
+    mode = FilterMode::kNone;
+  }
+  return mode;
+}
+
+// Same as ComputeSlope for an axis which is not interpolated, i.e. sampling
+// the center of each source interval.
+void ComputePointSlope(int src_size, int dst_size, int* start, int* step) {
+  *step = FixedDiv(src_size, dst_size);
+  *start = *step >> 1;
+}
+
+// Computes rows [dst_row_begin, dst_row_end) of `dst` by point sampling `src`
+// from (x, y) by steps of (dx, dy), in 16.16 fixed-point.
+void SampleNearestRows(const uint8* src, int src_stride, int src_width,
+                       int src_height, int x, int dx, int y, int dy,
+                       uint8* dst, int dst_stride, int dst_width,
+                       int dst_row_begin, int dst_row_end) {
+  std::vector<int> offsets(dst_width);
+  for (int i = 0; i < dst_width; ++i, x += dx) {
+    offsets[i] = std::min(x >> 16, src_width - 1) * kPixelBytes;
+  }
+  y += dst_row_begin * dy;
+  for (int j = dst_row_begin; j < dst_row_end; ++j, y += dy) {
+    const uint8* src_row =
+        src + static_cast<int64>(std::min(y >> 16, src_height - 1)) *
+                  src_stride;
+    uint8* dst_pixel = dst + static_cast<int64>(j) * dst_stride;
+    for (int offset : offsets) {
+      memcpy(dst_pixel, src_row + offset, kPixelBytes);
+      dst_pixel += kPixelBytes;
+    }
+  }
+}
+
+// Returns the rounded average of the 2x2 box with rows (a, b) and (c, d).
+inline uint8 AverageBox(int a, int b, int c, int d) {
+  return static_cast<uint8>((a + b + c + d + 2) >> 2);
+}
+
+// Same as AverageBox, but averaging rows then columns with rounded halvings as
+// the x86 versions of libyuv's ScaleARGBRowDown2Box and
+// ScaleARGBRowDownEvenBox do.
+inline uint8 AverageBoxByHalves(int a, int b, int c, int d) {
+  return static_cast<uint8>((((a + c + 1) >> 1) + ((b + d + 1) >> 1) + 1) >>
+                            1);
+}
+
+// Computes rows [dst_row_begin, dst_row_end) of `dst` as the average of the
+// 2x2 source pixels at (x, y), stepping by the even integers (dx, dy) in 16.16
+// fixed-point: libyuv's even downscaling special case. On x86, libyuv only
+// uses its vectorized rows for the largest multiple of 4 pixels, and its
+// portable code for the remaining ones.
+void AverageBoxRows(const uint8* src, int src_stride, int x, int dx, int y,
+                    int dy, uint8* dst, int dst_stride, int dst_width,
+                    int dst_row_begin, int dst_row_end) {
+  const int column_step = (dx >> 16) * kPixelBytes;
+#if defined(__x86_64__) || defined(__i386__)
+  const int vectorized_bytes = (dst_width & ~3) * kPixelBytes;
+#else
+  const int vectorized_bytes = 0;
+#endif
+  for (int j = dst_row_begin; j < dst_row_end; ++j) {
+    const uint8* src_row0 =
+        src + static_cast<int64>((y >> 16) + j * (dy >> 16)) * src_stride +
+        (x >> 16) * kPixelBytes;
+    const uint8* src_row1 = src_row0 + src_stride;
+    uint8* dst_row = dst + static_cast<int64>(j) * dst_stride;
+    for (int i = 0; i < dst_width * kPixelBytes; i += kPixelBytes) {
+      for (int c = 0; c < kPixelBytes; ++c) {
+        dst_row[i + c] =
+            i < vectorized_bytes
+                ? AverageBoxByHalves(src_row0[c], src_row0[c + kPixelBytes],
+                                     src_row1[c], src_row1[c + kPixelBytes])
+                : AverageBox(src_row0[c], src_row0[c + kPixelBytes],
+                             src_row1[c], src_row1[c + kPixelBytes]);
+      }
+      src_row0 += column_step;
+      src_row1 += column_step;
+    }
+  }
+}
+
+}  // namespace
+
+absl::Status ResizeRgb24Bilinear(const uint8* src, int src_stride,
+                                 int src_width, int src_height, uint8* dst,
+                                 int dst_stride, int dst_width,
+                                 int dst_height) {
+  return ResizeRgb24BilinearRows(src, src_stride, src_width, src_height, dst,
+                                 dst_stride, dst_width, dst_height,
+                                 /*dst_row_begin=*/0,
+                                 /*dst_row_end=*/dst_height);
+}
+
+absl::Status ResizeRgb24BilinearRows(const uint8* src, int src_stride,
+                                     int src_width, int src_height, uint8* dst,
+                                     int dst_stride, int dst_width,
+                                     int dst_height, int dst_row_begin,
+                                     int dst_row_end) {
+  if (src == nullptr || dst == nullptr || src_width <= 0 || src_height <= 0 ||
+      dst_width <= 0 || dst_height <= 0 ||
+      src_stride < src_width * kPixelBytes ||
+      dst_stride < dst_width * kPixelBytes || dst_row_begin < 0 ||
+      dst_row_begin > dst_row_end || dst_row_end > dst_height) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid buffer or dimension arguments for ResizeRgb24Bilinear.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+
+  // Follow libyuv's ScaleARGB decisions, so that the result is the same as
+  // going through ARGB.
+  const FilterMode mode =
+      ReduceFilterMode(src_width, src_height, dst_width, dst_height);
+  int x, dx, y, dy;
+  if (mode == FilterMode::kNone) {
+    ComputePointSlope(src_width, dst_width, &x, &dx);
+  } else {
+    ComputeSlope(src_width, dst_width, &x, &dx);
+  }
+  if (mode == FilterMode::kBilinear) {
+    ComputeSlope(src_height, dst_height, &y, &dy);
+  } else {
+    ComputePointSlope(src_height, dst_height, &y, &dy);
+  }
+  if (((dx | dy) & 0xffff) == 0) {
+    // Integer steps: downscaling by even factors averages 2x2 boxes, while
+    // odd factors and 1 pixel wide or tall images are point sampled.
+    if (dx != 0 && dy != 0 && (dx & 0x10000) == 0 && (dy & 0x10000) == 0) {
+      AverageBoxRows(src, src_stride, x, dx, y, dy, dst, dst_stride,
+                     dst_width, dst_row_begin, dst_row_end);
+      return absl::OkStatus();
+    }
+    if (dx == 0 || dy == 0 || ((dx & 0x10000) != 0 && (dy & 0x10000) != 0)) {
+      SampleNearestRows(src, src_stride, src_width, src_height, x, dx, y, dy,
+                        dst, dst_stride, dst_width, dst_row_begin,
+                        dst_row_end);
+      return absl::OkStatus();
+    }
+  }
+  if (mode == FilterMode::kNone) {
+    SampleNearestRows(src, src_stride, src_width, src_height, x, dx, y, dy,
+                      dst, dst_stride, dst_width, dst_row_begin, dst_row_end);
+    return absl::OkStatus();
+  }
+
+  // Columns are not filtered at all when the width is unchanged and the
+  // samples are aligned on source pixels.
+  const bool filter_columns = dx != 0x10000 || (x & 0xffff) != 0;
+  std::vector<ColumnSample> columns;
+  if (filter_columns) {
+    columns = BuildColumnSamples(src_width, dst_width);
+  }
+  const auto filter_row = [&](const uint8* src_row, uint8* dst_row) {
+    if (filter_columns) {
+      FilterColumns(src_row, columns, dst_row);
+    } else {
+      memcpy(dst_row, src_row, dst_width * kPixelBytes);
+    }
+  };
+  // Rows are not interpolated in the linear mode.
+  const int row_weight_mask = mode == FilterMode::kBilinear ? 0xff : 0;
+  y += dst_row_begin * dy;
+  const int max_y = (src_height - 1) << 16;
+
+  if (dy >= 0x10000) {
+    // Not upscaling vertically: interpolate the two source rows first, then
+    // filter the resulting row horizontally.
+    const int row_bytes = src_width * kPixelBytes;
+    std::vector<uint8> row(row_bytes);
+    for (int j = dst_row_begin; j < dst_row_end; ++j, y += dy) {
+      const int position = std::min(std::max(y, 0), max_y);
+      const int index = position >> 16;
+      const int f = (position >> 8) & row_weight_mask;
+      const uint8* src_row0 = src + static_cast<int64>(index) * src_stride;
+      const uint8* src_row1 =
+          src + static_cast<int64>(std::min(index + 1, src_height - 1)) *
+                    src_stride;
+      uint8* dst_row = dst + static_cast<int64>(j) * dst_stride;
+      if (f == 0) {
+        filter_row(src_row0, dst_row);
+      } else {
+        InterpolateRow(src_row0, src_row1, row_bytes, f, row.data());
+        filter_row(row.data(), dst_row);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Upscaling vertically: filter each source row horizontally only once, then
+  // interpolate between the two cached rows.
+  const int row_bytes = dst_width * kPixelBytes;
+  std::vector<uint8> rows(2 * row_bytes);
+  uint8* cached_rows[2] = {rows.data(), rows.data() + row_bytes};
+  int cached_indices[2] = {-1, -1};
+  for (int j = dst_row_begin; j < dst_row_end; ++j, y += dy) {
+    const int position = std::min(std::max(y, 0), max_y);
+    const int index = position >> 16;
+    const int f = (position >> 8) & row_weight_mask;
+    const int next_index = std::min(index + 1, src_height - 1);
+    if (cached_indices[0] != index) {
+      if (cached_indices[1] == index) {
+        std::swap(cached_rows[0], cached_rows[1]);
+        std::swap(cached_indices[0], cached_indices[1]);
+      } else {
+        filter_row(src + static_cast<int64>(index) * src_stride,
+                   cached_rows[0]);
+        cached_indices[0] = index;
+      }
+    }
+    if (cached_indices[1] != next_index) {
+      filter_row(src + static_cast<int64>(next_index) * src_stride,
+                 cached_rows[1]);
+      cached_indices[1] = next_index;
+    }
+    InterpolateRow(cached_rows[0], cached_rows[1], row_bytes, f,
+                   dst + static_cast<int64>(j) * dst_stride);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ResizeAndOrientPlaneBilinearRows(
+    const uint8* src, int src_row_stride, int src_pixel_stride, int src_width,
+    int src_height, int num_channels, const PlaneOrientation& orientation,
+    uint8* dst, int dst_row_stride, int dst_pixel_stride, int dst_width,
+    int dst_height, int dst_row_begin, int dst_row_end) {
+  if (src == nullptr || dst == nullptr || src_width <= 0 || src_height <= 0 ||
+      dst_width <= 0 || dst_height <= 0 || num_channels <= 0 ||
+      num_channels > 4 || src_pixel_stride < num_channels ||
+      dst_pixel_stride < num_channels ||
+      src_row_stride < (src_width - 1) * src_pixel_stride + num_channels ||
+      dst_row_stride < (dst_width - 1) * dst_pixel_stride + num_channels ||
+      dst_row_begin < 0 || dst_row_begin > dst_row_end ||
+      dst_row_end > dst_height) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid buffer or dimension arguments for "
+        "ResizeAndOrientPlaneBilinearRows.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+
+  // Sampling parameters of the resized image, in the order in which they are
+  // used by the destination image.
+  const int resized_width = orientation.transpose ? dst_height : dst_width;
+  const int resized_height = orientation.transpose ? dst_width : dst_height;
+  std::vector<ColumnSample> columns =
+      BuildColumnSamples(src_width, resized_width, src_pixel_stride);
+  std::vector<RowSample> rows = BuildRowSamples(src_height, resized_height);
+  if (orientation.mirror_x) {
+    std::reverse(columns.begin(), columns.end());
+  }
+  if (orientation.mirror_y) {
+    std::reverse(rows.begin(), rows.end());
+  }
+
+  switch (num_channels) {
+    case 1:
+      ResizeAndOrientRows<1>(src, src_row_stride, src_pixel_stride, src_width,
+                             columns, rows, orientation.transpose, dst,
+                             dst_row_stride, dst_pixel_stride, dst_width,
+                             dst_row_begin, dst_row_end);
+      break;
+    case 2:
+      ResizeAndOrientRows<2>(src, src_row_stride, src_pixel_stride, src_width,
+                             columns, rows, orientation.transpose, dst,
+                             dst_row_stride, dst_pixel_stride, dst_width,
+                             dst_row_begin, dst_row_end);
+      break;
+    case 3:
+      ResizeAndOrientRows<3>(src, src_row_stride, src_pixel_stride, src_width,
+                             columns, rows, orientation.transpose, dst,
+                             dst_row_stride, dst_pixel_stride, dst_width,
+                             dst_row_begin, dst_row_end);
+      break;
+    default:
+      ResizeAndOrientRows<4>(src, src_row_stride, src_pixel_stride, src_width,
+                             columns, rows, orientation.transpose, dst,
+                             dst_row_stride, dst_pixel_stride, dst_width,
+                             dst_row_begin, dst_row_end);
+      break;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
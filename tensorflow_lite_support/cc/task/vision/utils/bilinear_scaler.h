@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BILINEAR_SCALER_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BILINEAR_SCALER_H_
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Resizes the packed 3 bytes per pixel (e.g. RGB24) image `src` to `dst` using
+// bilinear interpolation, without any intermediate conversion to a 4 bytes per
+// pixel format.
+//
+// The output is the same as converting to ARGB, scaling with libyuv's
+// `kFilterBilinear` mode and converting back: pixel centers are aligned when
+// downscaling, image edges are aligned when upscaling, interpolation weights
+// are quantized to 8 bits vertically and 7 bits horizontally with the same
+// rounding, and libyuv's special cases are replicated (2x2 box averaging for
+// even integer downscaling factors, point sampling for odd ones and for 1
+// pixel wide images, no vertical interpolation when the height is unchanged
+// or divided by 3, etc).
+//
+// The vertical interpolation, which dominates the cost, is vectorized with
+// AVX2 (selected at runtime), SSE2 or NEON when available, with a portable
+// scalar fallback otherwise.
+absl::Status ResizeRgb24Bilinear(const uint8* src, int src_stride,
+                                 int src_width, int src_height, uint8* dst,
+                                 int dst_stride, int dst_width, int dst_height);
+
+// Same as `ResizeRgb24Bilinear`, but only computes the destination rows
+// [dst_row_begin, dst_row_end), which are identical to the corresponding rows
+// computed by `ResizeRgb24Bilinear`. `dst` still points to the first row of
+// the whole destination image.
+absl::Status ResizeRgb24BilinearRows(const uint8* src, int src_stride,
+                                     int src_width, int src_height, uint8* dst,
+                                     int dst_stride, int dst_width,
+                                     int dst_height, int dst_row_begin,
+                                     int dst_row_end);
+
+// Axis permutation and mirroring applied by
+// `ResizeAndOrientPlaneBilinearRows` on top of resizing. Destination pixel
+// (x, y) is the pixel of the resized image at (y, x) if `transpose` is true,
+// or at (x, y) otherwise, the resized image being mirrored beforehand along its
+// x (`mirror_x`) and / or y (`mirror_y`) axis. Any combination of a rotation
+// by a multiple of 90 degrees and a flip can be expressed this way.
+struct PlaneOrientation {
+  bool transpose = false;
+  bool mirror_x = false;
+  bool mirror_y = false;
+};
+
+// Resizes the `src_width` x `src_height` plane `src` with bilinear
+// interpolation and orients it as described by `orientation` in a single pass,
+// reading the source pixels through the orientation transform so that no
+// resized-but-unoriented image is ever written to memory. The resized image
+// is `dst_width` x `dst_height`, or `dst_height` x `dst_width` if
+// `orientation.transpose` is true. The sampling grid is the same as for
+// `ResizeRgb24Bilinear`.
+//
+// Pixels are made of `num_channels` (at most 4) consecutive bytes,
+// interpolated separately, and laid out every `src_pixel_stride` (resp.
+// `dst_pixel_stride`) bytes.
+//
+// Only the destination rows [dst_row_begin, dst_row_end) are computed, so that
+// disjoint row ranges can be computed concurrently. `dst` still points to the
+// first row of the whole destination image.
+//
+// Without transposition, each destination row is computed from two source
+// rows interpolated with the same vectorized code as `ResizeRgb24Bilinear`.
+// With transposition, the span of each pair of source rows sampled by the
+// destination rows is interpolated vertically once, with the same vectorized
+// code, then filtered into a destination column.
+absl::Status ResizeAndOrientPlaneBilinearRows(
+    const uint8* src, int src_row_stride, int src_pixel_stride, int src_width,
+    int src_height, int num_channels, const PlaneOrientation& orientation,
+    uint8* dst, int dst_row_stride, int dst_pixel_stride, int dst_width,
+    int dst_height, int dst_row_begin, int dst_row_end);
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BILINEAR_SCALER_H_
@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares ResizeRgb24Bilinear against the RGB24 -> ARGB -> ARGBScale -> RGB24
+// round trip previously used to resize kRGB frame buffers.
+//
+// Arguments are: source width, source height, destination width, destination
+// height.
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "include/libyuv.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/bilinear_scaler.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+constexpr int kRgbPixelBytes = 3;
+constexpr int kArgbPixelBytes = 4;
+
+std::vector<uint8> CreateTestImage(int width, int height) {
+  std::vector<uint8> image(width * height * kRgbPixelBytes);
+  for (int i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<uint8>(i * 7 + (i / kRgbPixelBytes) % 251);
+  }
+  return image;
+}
+
+void BM_ResizeRgb24Bilinear(benchmark::State& state) {
+  const int src_width = state.range(0);
+  const int src_height = state.range(1);
+  const int dst_width = state.range(2);
+  const int dst_height = state.range(3);
+  const std::vector<uint8> src = CreateTestImage(src_width, src_height);
+  std::vector<uint8> dst(dst_width * dst_height * kRgbPixelBytes);
+  for (auto s : state) {
+    ResizeRgb24Bilinear(src.data(), src_width * kRgbPixelBytes, src_width,
+                        src_height, dst.data(), dst_width * kRgbPixelBytes,
+                        dst_width, dst_height)
+        .IgnoreError();
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+void BM_ResizeRgb24ThroughArgb(benchmark::State& state) {
+  const int src_width = state.range(0);
+  const int src_height = state.range(1);
+  const int dst_width = state.range(2);
+  const int dst_height = state.range(3);
+  const std::vector<uint8> src = CreateTestImage(src_width, src_height);
+  std::vector<uint8> dst(dst_width * dst_height * kRgbPixelBytes);
+  for (auto s : state) {
+    // Mirrors the allocations performed by the previous implementation.
+    auto argb = absl::make_unique<uint8[]>(src_width * src_height *
+                                           kArgbPixelBytes);
+    auto resized_argb = absl::make_unique<uint8[]>(dst_width * dst_height *
+                                                   kArgbPixelBytes);
+    libyuv::RGB24ToARGB(src.data(), src_width * kRgbPixelBytes, argb.get(),
+                        src_width * kArgbPixelBytes, src_width, src_height);
+    libyuv::ARGBScale(argb.get(), src_width * kArgbPixelBytes, src_width,
+                      src_height, resized_argb.get(),
+                      dst_width * kArgbPixelBytes, dst_width, dst_height,
+                      libyuv::FilterMode::kFilterBilinear);
+    libyuv::ARGBToRGB24(resized_argb.get(), dst_width * kArgbPixelBytes,
+                        dst.data(), dst_width * kRgbPixelBytes, dst_width,
+                        dst_height);
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+void ResizeArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Args({1920, 1080, 224, 224})
+      ->Args({1280, 720, 300, 300})
+      ->Args({640, 480, 224, 224})
+      ->Args({640, 480, 513, 513})
+      ->Args({224, 224, 640, 480});
+}
+
+BENCHMARK(BM_ResizeRgb24Bilinear)->Apply(ResizeArguments);
+BENCHMARK(BM_ResizeRgb24ThroughArgb)->Apply(ResizeArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
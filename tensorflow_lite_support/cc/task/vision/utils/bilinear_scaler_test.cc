@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/bilinear_scaler.h"
+
+#include <utility>
+#include <vector>
+
+#include "include/libyuv.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+constexpr int kPixelBytes = 3;
+
+struct ScaleParams {
+  int src_width;
+  int src_height;
+  int dst_width;
+  int dst_height;
+};
+
+std::vector<uint8> CreateTestImage(int width, int height) {
+  std::vector<uint8> image(width * height * kPixelBytes);
+  uint32 state = 12345;
+  for (uint8& value : image) {
+    state = state * 1103515245 + 12345;
+    value = static_cast<uint8>(state >> 16);
+  }
+  return image;
+}
+
+// Resizes `src` the way ResizeRgb24Bilinear replaces, i.e. going through ARGB.
+std::vector<uint8> ResizeThroughArgb(const std::vector<uint8>& src,
+                                     const ScaleParams& params) {
+  std::vector<uint8> src_argb(params.src_width * params.src_height * 4);
+  std::vector<uint8> dst_argb(params.dst_width * params.dst_height * 4);
+  std::vector<uint8> dst(params.dst_width * params.dst_height * kPixelBytes);
+  libyuv::RGB24ToARGB(src.data(), params.src_width * kPixelBytes,
+                      src_argb.data(), params.src_width * 4, params.src_width,
+                      params.src_height);
+  libyuv::ARGBScale(src_argb.data(), params.src_width * 4, params.src_width,
+                    params.src_height, dst_argb.data(), params.dst_width * 4,
+                    params.dst_width, params.dst_height,
+                    libyuv::kFilterBilinear);
+  libyuv::ARGBToRGB24(dst_argb.data(), params.dst_width * 4, dst.data(),
+                      params.dst_width * kPixelBytes, params.dst_width,
+                      params.dst_height);
+  return dst;
+}
+
+class BilinearScalerTest : public ::testing::TestWithParam<ScaleParams> {};
+
+TEST_P(BilinearScalerTest, MatchesArgbRoundTrip) {
+  const ScaleParams& params = GetParam();
+  const std::vector<uint8> src =
+      CreateTestImage(params.src_width, params.src_height);
+  std::vector<uint8> dst(params.dst_width * params.dst_height * kPixelBytes);
+  ASSERT_TRUE(ResizeRgb24Bilinear(src.data(), params.src_width * kPixelBytes,
+                                  params.src_width, params.src_height,
+                                  dst.data(), params.dst_width * kPixelBytes,
+                                  params.dst_width, params.dst_height)
+                  .ok());
+  EXPECT_EQ(dst, ResizeThroughArgb(src, params));
+}
+
+TEST_P(BilinearScalerTest, RowRangesMatchWholeImage) {
+  const ScaleParams& params = GetParam();
+  const std::vector<uint8> src =
+      CreateTestImage(params.src_width, params.src_height);
+  const int dst_stride = params.dst_width * kPixelBytes;
+  std::vector<uint8> expected_dst(params.dst_height * dst_stride);
+  ASSERT_TRUE(ResizeRgb24Bilinear(src.data(), params.src_width * kPixelBytes,
+                                  params.src_width, params.src_height,
+                                  expected_dst.data(), dst_stride,
+                                  params.dst_width, params.dst_height)
+                  .ok());
+  std::vector<uint8> dst(expected_dst.size());
+  // Computes the bottom rows first, then the top ones.
+  const int middle_row = params.dst_height / 3;
+  for (const auto& rows : {std::make_pair(middle_row, params.dst_height),
+                           std::make_pair(0, middle_row)}) {
+    ASSERT_TRUE(ResizeRgb24BilinearRows(
+                    src.data(), params.src_width * kPixelBytes,
+                    params.src_width, params.src_height, dst.data(),
+                    dst_stride, params.dst_width, params.dst_height,
+                    rows.first, rows.second)
+                    .ok());
+  }
+  EXPECT_EQ(dst, expected_dst);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ScaleRatios, BilinearScalerTest,
+    ::testing::Values(
+        // Even integer downscaling factors, with and without a multiple of 4
+        // destination pixels.
+        ScaleParams{64, 48, 32, 24}, ScaleParams{100, 80, 50, 40},
+        ScaleParams{64, 48, 16, 12}, ScaleParams{100, 80, 25, 20},
+        ScaleParams{64, 48, 16, 24}, ScaleParams{64, 48, 32, 12},
+        // Odd integer downscaling factors.
+        ScaleParams{60, 45, 20, 15}, ScaleParams{64, 48, 64, 16},
+        ScaleParams{64, 48, 64, 48},
+        // Unchanged width or height, or height divided by 3.
+        ScaleParams{64, 48, 64, 24}, ScaleParams{64, 48, 32, 48},
+        ScaleParams{60, 45, 30, 45}, ScaleParams{66, 48, 22, 48},
+        ScaleParams{64, 48, 96, 48}, ScaleParams{64, 48, 21, 16},
+        // 1 pixel wide or tall images.
+        ScaleParams{1, 48, 1, 24}, ScaleParams{64, 1, 32, 1},
+        ScaleParams{64, 1, 17, 5}, ScaleParams{1, 1, 7, 3},
+        ScaleParams{64, 48, 1, 48}, ScaleParams{64, 48, 64, 1},
+        ScaleParams{64, 48, 1, 1}, ScaleParams{3, 48, 1, 16},
+        // Arbitrary ratios.
+        ScaleParams{64, 48, 63, 47}, ScaleParams{65, 49, 32, 24},
+        ScaleParams{64, 48, 37, 29}, ScaleParams{64, 48, 128, 96},
+        ScaleParams{64, 48, 200, 150}, ScaleParams{640, 480, 224, 224},
+        ScaleParams{641, 479, 300, 300}));
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
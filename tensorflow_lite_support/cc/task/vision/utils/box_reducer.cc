@@ -0,0 +1,308 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/box_reducer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/common.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+// Adds the `num_bytes` bytes of `src` to the column sums `sums`.
+template <typename ColumnSum>
+void AddRow(const uint8* src, int num_bytes, ColumnSum* sums) {
+  for (int i = 0; i < num_bytes; ++i) {
+    sums[i] += src[i];
+  }
+}
+
+// Same as above, vectorized with SSE2 or NEON when available for the 16-bit
+// column sums used in most cases.
+template <>
+void AddRow<uint16>(const uint8* src, int num_bytes, uint16* sums) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= num_bytes; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i* lo = reinterpret_cast<__m128i*>(sums + i);
+    __m128i* hi = reinterpret_cast<__m128i*>(sums + i + 8);
+    _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo),
+                                       _mm_unpacklo_epi8(bytes, zero)));
+    _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi),
+                                       _mm_unpackhi_epi8(bytes, zero)));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i + 16 <= num_bytes; i += 16) {
+    const uint8x16_t bytes = vld1q_u8(src + i);
+    vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(bytes)));
+    vst1q_u16(sums + i + 8,
+              vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(bytes)));
+  }
+#endif
+  for (; i < num_bytes; ++i) {
+    sums[i] += src[i];
+  }
+}
+
+// Divides 32-bit sums of 8-bit values by a fixed `divisor`, rounding to
+// nearest. Uses a multiplication by the fixed-point reciprocal of `divisor`
+// rather than an integer division whenever it gives the exact same result,
+// i.e. for divisors below 4096.
+class RoundingDivider {
+ public:
+  explicit RoundingDivider(uint32 divisor)
+      : divisor_(divisor),
+        reciprocal_(divisor < kMaxReciprocalDivisor
+                        ? (uint64{1} << 32) / divisor + 1
+                        : 0) {}
+
+  // Returns `sum / divisor` rounded to nearest, `sum` being at most 255 times
+  // `divisor`.
+  uint8 operator()(uint32 sum) const {
+    const uint32 numerator = sum + divisor_ / 2;
+    if (reciprocal_ != 0) {
+      return static_cast<uint8>((numerator * reciprocal_) >> 32);
+    }
+    return static_cast<uint8>(numerator / divisor_);
+  }
+
+ private:
+  // The reciprocal is exact as long as `numerator * divisor < 2^32`, which
+  // holds for numerators up to `256 * divisor` if `divisor < 2^12`.
+  static constexpr uint32 kMaxReciprocalDivisor = 1 << 12;
+
+  uint32 divisor_;
+  uint64 reciprocal_;
+};
+
+// Sums the column `sums` of `num_blocks` consecutive blocks of `block_width`
+// pixels horizontally, and writes their average to `dst`. `kNumChannels` is
+// the compile-time channel count, or 0 if only known at runtime.
+template <typename ColumnSum, int kNumChannels>
+void ReduceBlocks(const ColumnSum* sums, int src_pixel_stride,
+                  int runtime_num_channels, int block_width, int num_blocks,
+                  const RoundingDivider& divide, uint8* dst,
+                  int dst_pixel_stride) {
+  const int num_channels =
+      kNumChannels > 0 ? kNumChannels : runtime_num_channels;
+  const int block_stride = block_width * src_pixel_stride;
+  for (int x = 0; x < num_blocks; ++x) {
+    for (int c = 0; c < num_channels; c += 4) {
+      const int num_block_channels = std::min(4, num_channels - c);
+      uint32 block_sums[4] = {0, 0, 0, 0};
+      const ColumnSum* pixel = sums + c;
+      for (int i = 0; i < block_width; ++i) {
+        for (int k = 0; k < num_block_channels; ++k) {
+          block_sums[k] += pixel[k];
+        }
+        pixel += src_pixel_stride;
+      }
+      for (int k = 0; k < num_block_channels; ++k) {
+        dst[c + k] = divide(block_sums[k]);
+      }
+    }
+    sums += block_stride;
+    dst += dst_pixel_stride;
+  }
+}
+
+// Same as `ReduceBlocks` for the common case of blocks of 2 packed pixels and
+// a block area that is a power of two, i.e. `1 << shift`: the average is then
+// computed with shifts only, which lets the compiler vectorize the loop.
+template <typename ColumnSum, int kNumChannels>
+void ReducePackedPairs(const ColumnSum* sums, int num_blocks, int shift,
+                       uint8* dst) {
+  const uint32 rounding = (uint32{1} << shift) >> 1;
+  for (int x = 0; x < num_blocks; ++x) {
+    for (int k = 0; k < kNumChannels; ++k) {
+      dst[x * kNumChannels + k] = static_cast<uint8>(
+          (uint32{sums[2 * x * kNumChannels + k]} +
+           sums[(2 * x + 1) * kNumChannels + k] + rounding) >>
+          shift);
+    }
+  }
+}
+
+// Sums the column `sums` of each block of a destination row horizontally, and
+// writes their average to `dst`. Specialized for compile-time channel counts,
+// `kNumChannels` being 0 otherwise.
+template <typename ColumnSum, int kNumChannels>
+void ReduceColumnSums(const ColumnSum* sums, int src_pixel_stride,
+                      int src_width, int runtime_num_channels, int factor_x,
+                      int block_height, uint8* dst, int dst_pixel_stride) {
+  const int dst_width = GetBoxReducedSize(src_width, factor_x);
+  // Width of the last block, which may be truncated and is thus handled
+  // separately, keeping the main loop free of per-block branches.
+  const int last_block_width = src_width - (dst_width - 1) * factor_x;
+  const int block_area = factor_x * block_height;
+  const bool is_power_of_two_area = (block_area & (block_area - 1)) == 0;
+  if (kNumChannels > 0 && factor_x == 2 && src_pixel_stride == kNumChannels &&
+      dst_pixel_stride == kNumChannels && is_power_of_two_area) {
+    int shift = 0;
+    while ((1 << shift) < block_area) {
+      ++shift;
+    }
+    ReducePackedPairs<ColumnSum, kNumChannels>(sums, dst_width - 1, shift, dst);
+  } else {
+    ReduceBlocks<ColumnSum, kNumChannels>(
+        sums, src_pixel_stride, runtime_num_channels, factor_x, dst_width - 1,
+        RoundingDivider(block_area), dst, dst_pixel_stride);
+  }
+  ReduceBlocks<ColumnSum, kNumChannels>(
+      sums + (dst_width - 1) * factor_x * src_pixel_stride, src_pixel_stride,
+      runtime_num_channels, last_block_width, /*num_blocks=*/1,
+      RoundingDivider(last_block_width * block_height),
+      dst + (dst_width - 1) * dst_pixel_stride, dst_pixel_stride);
+}
+
+// Calls `ReduceColumnSums` specialized for the given channel count.
+template <typename ColumnSum>
+void ReduceColumnSumsForChannels(const ColumnSum* sums, int src_pixel_stride,
+                                 int src_width, int num_channels, int factor_x,
+                                 int block_height, uint8* dst,
+                                 int dst_pixel_stride) {
+  switch (num_channels) {
+    case 1:
+      ReduceColumnSums<ColumnSum, 1>(sums, src_pixel_stride, src_width,
+                                     num_channels, factor_x, block_height, dst,
+                                     dst_pixel_stride);
+      break;
+    case 2:
+      ReduceColumnSums<ColumnSum, 2>(sums, src_pixel_stride, src_width,
+                                     num_channels, factor_x, block_height, dst,
+                                     dst_pixel_stride);
+      break;
+    case 3:
+      ReduceColumnSums<ColumnSum, 3>(sums, src_pixel_stride, src_width,
+                                     num_channels, factor_x, block_height, dst,
+                                     dst_pixel_stride);
+      break;
+    case 4:
+      ReduceColumnSums<ColumnSum, 4>(sums, src_pixel_stride, src_width,
+                                     num_channels, factor_x, block_height, dst,
+                                     dst_pixel_stride);
+      break;
+    default:
+      ReduceColumnSums<ColumnSum, 0>(sums, src_pixel_stride, src_width,
+                                     num_channels, factor_x, block_height, dst,
+                                     dst_pixel_stride);
+      break;
+  }
+}
+
+// Computes the destination rows [dst_row_begin, dst_row_end) of
+// `BoxReducePlaneRows`, accumulating the vertical sums of each block in
+// `ColumnSum` integers, which must be large enough to hold `factor_y` times
+// 255.
+//
+// The vertical sums are accumulated over all the bytes of the source rows,
+// then the `num_channels` channels of each block are summed horizontally once
+// per destination row.
+template <typename ColumnSum>
+void BoxReduceRows(const uint8* src, int src_row_stride, int src_pixel_stride,
+                   int src_width, int src_height, int num_channels,
+                   int factor_x, int factor_y, uint8* dst, int dst_row_stride,
+                   int dst_pixel_stride, int dst_row_begin, int dst_row_end) {
+  const int row_bytes = (src_width - 1) * src_pixel_stride + num_channels;
+  std::vector<ColumnSum> column_sums(row_bytes);
+  for (int dst_row = dst_row_begin; dst_row < dst_row_end; ++dst_row) {
+    const int src_row_begin = dst_row * factor_y;
+    const int src_row_end = std::min(src_height, src_row_begin + factor_y);
+    ColumnSum* sums = column_sums.data();
+    std::fill(column_sums.begin(), column_sums.end(), 0);
+    for (int src_row = src_row_begin; src_row < src_row_end; ++src_row) {
+      AddRow(src + src_row * src_row_stride, row_bytes, sums);
+    }
+
+    ReduceColumnSumsForChannels(sums, src_pixel_stride, src_width,
+                                num_channels, factor_x,
+                                src_row_end - src_row_begin,
+                                dst + dst_row * dst_row_stride,
+                                dst_pixel_stride);
+  }
+}
+
+}  // namespace
+
+absl::Status BoxReducePlaneRows(const uint8* src, int src_row_stride,
+                                int src_pixel_stride, int src_width,
+                                int src_height, int num_channels, int factor_x,
+                                int factor_y, uint8* dst, int dst_row_stride,
+                                int dst_pixel_stride, int dst_row_begin,
+                                int dst_row_end) {
+  if (src == nullptr || dst == nullptr || src_width <= 0 || src_height <= 0 ||
+      factor_x <= 0 || factor_y <= 0 || num_channels <= 0 ||
+      num_channels > src_pixel_stride || num_channels > dst_pixel_stride) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid buffer or dimension arguments for BoxReducePlaneRows.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (dst_row_begin < 0 || dst_row_begin > dst_row_end ||
+      dst_row_end > GetBoxReducedSize(src_height, factor_y)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid destination row range for BoxReducePlaneRows.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (factor_y == 1) {
+    // Blocks are a single row high: source rows are reduced horizontally
+    // in-place, without accumulating column sums.
+    for (int dst_row = dst_row_begin; dst_row < dst_row_end; ++dst_row) {
+      ReduceColumnSumsForChannels(src + dst_row * src_row_stride,
+                                  src_pixel_stride, src_width, num_channels,
+                                  factor_x, /*block_height=*/1,
+                                  dst + dst_row * dst_row_stride,
+                                  dst_pixel_stride);
+    }
+  } else if (factor_y <= 0xffff / 0xff) {
+    // 16-bit column sums, which are vectorized, hold up to 257 rows of 8-bit
+    // values.
+    BoxReduceRows<uint16>(src, src_row_stride, src_pixel_stride, src_width,
+                          src_height, num_channels, factor_x, factor_y, dst,
+                          dst_row_stride, dst_pixel_stride, dst_row_begin,
+                          dst_row_end);
+  } else {
+    BoxReduceRows<uint32>(src, src_row_stride, src_pixel_stride, src_width,
+                          src_height, num_channels, factor_x, factor_y, dst,
+                          dst_row_stride, dst_pixel_stride, dst_row_begin,
+                          dst_row_end);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
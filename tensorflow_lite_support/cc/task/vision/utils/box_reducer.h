@@ -0,0 +1,60 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BOX_REDUCER_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BOX_REDUCER_H_
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Returns the size of an image axis of the given `size` after reduction by the
+// integer `factor` with `BoxReducePlaneRows`.
+inline int GetBoxReducedSize(int size, int factor) {
+  return (size + factor - 1) / factor;
+}
+
+// Downscales the `src_width` x `src_height` image `src` by the integer factors
+// `factor_x` and `factor_y`, each destination pixel being the rounded average
+// of the corresponding `factor_x` x `factor_y` block of source pixels. Blocks
+// along the right and bottom edges are truncated to the source image, and
+// averaged over the pixels they cover.
+//
+// Pixels are made of `num_channels` consecutive bytes, averaged separately,
+// and laid out every `src_pixel_stride` (resp. `dst_pixel_stride`) bytes.
+//
+// Only the destination rows [dst_row_begin, dst_row_end) are computed, so that
+// disjoint row ranges can be computed concurrently. `dst` still points to the
+// first row of the whole destination image.
+//
+// Sums are accumulated with integer arithmetic one source row at a time, so
+// that the source image is read sequentially exactly once, and vertically
+// before horizontally so that most of the work is done with SSE2 or NEON
+// instructions where available.
+absl::Status BoxReducePlaneRows(const uint8* src, int src_row_stride,
+                                int src_pixel_stride, int src_width,
+                                int src_height, int num_channels, int factor_x,
+                                int factor_y, uint8* dst, int dst_row_stride,
+                                int dst_pixel_stride, int dst_row_begin,
+                                int dst_row_end);
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_BOX_REDUCER_H_
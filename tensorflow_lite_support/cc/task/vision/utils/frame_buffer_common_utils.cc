@@ -55,6 +55,20 @@ std::unique_ptr<FrameBuffer> CreateFromNV21RawBuffer(
                              timestamp);
 }
 
+// Creates a single-plane FrameBuffer of the given interleaved or packed
+// `format` from raw buffer and passing arguments, with rows holding
+// `dimension.width` pixels and no padding.
+std::unique_ptr<FrameBuffer> CreateFromSinglePlaneRawBuffer(
+    const uint8* input, FrameBuffer::Dimension dimension,
+    FrameBuffer::Format format, int pixel_stride,
+    FrameBuffer::Orientation orientation, const absl::Time timestamp) {
+  const int row_stride = GetFrameBufferByteSize({dimension.width, 1}, format);
+  FrameBuffer::Plane input_plane = {/*buffer=*/input,
+                                    /*stride=*/{row_stride, pixel_stride}};
+  return FrameBuffer::Create({input_plane}, dimension, format, orientation,
+                             timestamp);
+}
+
 // Indicates whether the given buffers have the same dimensions.
 bool AreBufferDimsEqual(const FrameBuffer& buffer1,
                         const FrameBuffer& buffer2) {
@@ -71,6 +85,10 @@ bool AreBufferFormatsCompatible(const FrameBuffer& buffer1,
     case FrameBuffer::Format::kRGB:
       return (buffer2.format() == FrameBuffer::Format::kRGBA ||
               buffer2.format() == FrameBuffer::Format::kRGB);
+    case FrameBuffer::Format::kBGRA:
+    case FrameBuffer::Format::kBGR:
+      return (buffer2.format() == FrameBuffer::Format::kBGRA ||
+              buffer2.format() == FrameBuffer::Format::kBGR);
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kYV12:
@@ -80,6 +98,8 @@ bool AreBufferFormatsCompatible(const FrameBuffer& buffer1,
               buffer2.format() == FrameBuffer::Format::kYV12 ||
               buffer2.format() == FrameBuffer::Format::kYV21);
     case FrameBuffer::Format::kGRAY:
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
     default:
       return buffer1.format() == buffer2.format();
   }
@@ -100,11 +120,18 @@ int GetFrameBufferByteSize(FrameBuffer::Dimension dimension,
              /*uv plane*/ ((static_cast<float>(dimension.width + 1) / 2) *
                            (static_cast<float>(dimension.height + 1) / 2) * 2);
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
       return dimension.Size() * 3;
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
       return dimension.Size() * 4;
     case FrameBuffer::Format::kGRAY:
       return dimension.Size();
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      // Rows hold whole macropixels, i.e. an even number of pixels.
+      return (dimension.width + 1) / 2 * kPackedYuv422MacropixelBytes *
+             dimension.height;
     default:
       return 0;
   }
@@ -115,15 +142,25 @@ StatusOr<int> GetPixelStrides(FrameBuffer::Format format) {
     case FrameBuffer::Format::kGRAY:
       return kGrayPixelBytes;
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
       return kRgbPixelBytes;
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
       return kRgbaPixelBytes;
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return kPackedYuv422PixelBytes;
     default:
       return absl::InvalidArgumentError(absl::StrFormat(
           "GetPixelStrides does not support format: %i.", format));
   }
 }
 
+bool IsPackedYuv422Format(FrameBuffer::Format format) {
+  return format == FrameBuffer::Format::kYUYV ||
+         format == FrameBuffer::Format::kUYVY;
+}
+
 StatusOr<const uint8*> GetUvRawBuffer(const FrameBuffer& buffer) {
   if (buffer.format() != FrameBuffer::Format::kNV12 &&
       buffer.format() != FrameBuffer::Format::kNV21) {
@@ -189,6 +226,13 @@ absl::Status ValidateBufferFormat(const FrameBuffer& buffer) {
       if (buffer.plane_count() == 1) return absl::OkStatus();
       return absl::InvalidArgumentError(
           "Plane count must be 1 for grayscale and RGB[a] buffers.");
+    case FrameBuffer::Format::kBGR:
+    case FrameBuffer::Format::kBGRA:
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      if (buffer.plane_count() == 1) return absl::OkStatus();
+      return absl::InvalidArgumentError(
+          "Plane count must be 1 for BGR[a] and packed YUV 4:2:2 buffers.");
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kYV21:
@@ -217,6 +261,10 @@ absl::Status ValidateResizeBufferInputs(const FrameBuffer& buffer,
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21:
+    case FrameBuffer::Format::kBGR:
+    case FrameBuffer::Format::kBGRA:
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
       valid_format = (buffer.format() == output_buffer.format());
       break;
     case FrameBuffer::Format::kRGBA:
@@ -296,22 +344,31 @@ absl::Status ValidateConvertFormats(FrameBuffer::Format from_format,
   if (from_format == to_format) {
     return absl::InvalidArgumentError("Formats must be different.");
   }
+  if (IsPackedYuv422Format(to_format) && !IsPackedYuv422Format(from_format)) {
+    return absl::InvalidArgumentError(
+        "Packed YUV 4:2:2 formats are only converted from one another.");
+  }
 
   switch (from_format) {
     case FrameBuffer::Format::kGRAY:
       return absl::InvalidArgumentError(
           "Grayscale format does not convert to other formats.");
     case FrameBuffer::Format::kRGB:
-      if (to_format == FrameBuffer::Format::kRGBA) {
+    case FrameBuffer::Format::kBGR:
+      if (to_format == FrameBuffer::Format::kRGBA ||
+          to_format == FrameBuffer::Format::kBGRA) {
         return absl::InvalidArgumentError(
-            "RGB format does not convert to RGBA");
+            "RGB and BGR formats do not convert to RGBA or BGRA");
       }
       return absl::OkStatus();
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21:
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
       return absl::OkStatus();
     default:
       return absl::InternalError(
@@ -416,6 +473,19 @@ StatusOr<std::unique_ptr<FrameBuffer>> CreateFromRawBuffer(
       return CreateFromRgbRawBuffer(buffer, dimension, orientation, timestamp);
     case FrameBuffer::Format::kGRAY:
       return CreateFromGrayRawBuffer(buffer, dimension, orientation, timestamp);
+    case FrameBuffer::Format::kBGRA:
+      return CreateFromSinglePlaneRawBuffer(buffer, dimension, target_format,
+                                            kRgbaPixelBytes, orientation,
+                                            timestamp);
+    case FrameBuffer::Format::kBGR:
+      return CreateFromSinglePlaneRawBuffer(buffer, dimension, target_format,
+                                            kRgbPixelBytes, orientation,
+                                            timestamp);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return CreateFromSinglePlaneRawBuffer(buffer, dimension, target_format,
+                                            kPackedYuv422PixelBytes,
+                                            orientation, timestamp);
     default:
 
       return absl::InternalError(
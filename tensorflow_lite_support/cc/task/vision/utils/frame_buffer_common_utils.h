@@ -29,20 +29,30 @@ namespace task {
 namespace vision {
 
 constexpr int kRgbaPixelBytes = 4, kRgbPixelBytes = 3, kGrayPixelBytes = 1;
+// Average number of bytes per pixel of the packed YUV 4:2:2 formats, and
+// number of bytes of the macropixels holding pairs of pixels.
+constexpr int kPackedYuv422PixelBytes = 2, kPackedYuv422MacropixelBytes = 4;
 
 // Miscellaneous Methods
 // -----------------------------------------------------------------
 
 // Returns the frame buffer size in bytes based on the input format and
 // dimensions. GRAY, YV12/YV21 are in the planar formats, NV12/NV21 are in the
-// semi-planar formats with the interleaved UV planes. RGB/RGBA are in the
-// interleaved format.
+// semi-planar formats with the interleaved UV planes. RGB/RGBA/BGR/BGRA are in
+// the interleaved format, YUYV/UYVY in the packed format with rows made of
+// whole macropixels.
 int GetFrameBufferByteSize(FrameBuffer::Dimension dimension,
                            FrameBuffer::Format format);
 
-// Returns pixel stride info for kGRAY, kRGB, kRGBA formats.
+// Returns pixel stride info for kGRAY, kRGB, kRGBA, kBGR, kBGRA, kYUYV and
+// kUYVY formats. For the packed YUV 4:2:2 formats, this is the distance
+// between two consecutive luma values.
 tflite::support::StatusOr<int> GetPixelStrides(FrameBuffer::Format format);
 
+// Returns whether `format` is one of the packed YUV 4:2:2 formats, i.e. kYUYV
+// or kUYVY.
+bool IsPackedYuv422Format(FrameBuffer::Format format);
+
 // Returns the biplanar UV raw buffer for NV12/NV21 frame buffer.
 tflite::support::StatusOr<const uint8*> GetUvRawBuffer(
     const FrameBuffer& buffer);
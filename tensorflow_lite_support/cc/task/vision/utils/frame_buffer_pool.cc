@@ -0,0 +1,235 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_pool.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+// Size and stride information of a plane, `offset` bytes after the start of
+// the memory block.
+struct PlaneLayout {
+  size_t offset;
+  FrameBuffer::Stride stride;
+};
+
+size_t AlignUp(size_t size) {
+  return (size + FrameBufferPool::kAlignment - 1) /
+         FrameBufferPool::kAlignment * FrameBufferPool::kAlignment;
+}
+
+// Lays out the planes of a buffer of the given `dimension` and `format` in
+// `planes`, and returns the total size in bytes of the memory block holding
+// them.
+size_t GetPlaneLayouts(FrameBuffer::Dimension dimension,
+                       FrameBuffer::Format format,
+                       std::vector<PlaneLayout>* planes) {
+  // Appends a plane of `num_rows` rows of `row_stride_bytes` bytes.
+  size_t byte_size = 0;
+  auto add_plane = [&](int row_stride_bytes, int pixel_stride_bytes,
+                       int num_rows) {
+    planes->push_back({byte_size, {row_stride_bytes, pixel_stride_bytes}});
+    byte_size = AlignUp(byte_size + static_cast<size_t>(row_stride_bytes) *
+                                        num_rows);
+  };
+  const int uv_width = (dimension.width + 1) / 2;
+  const int uv_height = (dimension.height + 1) / 2;
+  switch (format) {
+    case FrameBuffer::Format::kGRAY:
+      add_plane(dimension.width, 1, dimension.height);
+      break;
+    case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
+      add_plane(dimension.width * 3, 3, dimension.height);
+      break;
+    case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
+      add_plane(dimension.width * 4, 4, dimension.height);
+      break;
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      // Rows hold whole macropixels.
+      add_plane(uv_width * 4, 2, dimension.height);
+      break;
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+      add_plane(dimension.width, 1, dimension.height);
+      add_plane(uv_width * 2, 2, uv_height);
+      break;
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21:
+      add_plane(dimension.width, 1, dimension.height);
+      add_plane(uv_width, 1, uv_height);
+      add_plane(uv_width, 1, uv_height);
+      break;
+  }
+  return byte_size;
+}
+
+}  // namespace
+
+constexpr size_t FrameBufferPool::kAlignment;
+constexpr size_t FrameBufferPool::kMaxOversizeRatio;
+constexpr size_t FrameBufferPool::kDefaultMaxRetainedBytes;
+
+struct FrameBufferPool::State {
+  explicit State(size_t max_retained_bytes)
+      : max_retained_bytes(max_retained_bytes) {}
+
+  const size_t max_retained_bytes;
+  mutable absl::Mutex mutex;
+  // Free blocks, by capacity.
+  std::multimap<size_t, Block> free_blocks ABSL_GUARDED_BY(mutex);
+  // Total capacity of `free_blocks`.
+  size_t retained_bytes ABSL_GUARDED_BY(mutex) = 0;
+  // Whether the pool was destroyed, in which case released blocks are freed.
+  bool is_destroyed ABSL_GUARDED_BY(mutex) = false;
+};
+
+FrameBufferPool::FrameBufferPool(size_t max_retained_bytes)
+    : state_(std::make_shared<State>(max_retained_bytes)) {}
+
+FrameBufferPool::~FrameBufferPool() {
+  std::multimap<size_t, Block> free_blocks;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    state_->is_destroyed = true;
+    free_blocks.swap(state_->free_blocks);
+    state_->retained_bytes = 0;
+  }
+}
+
+size_t FrameBufferPool::GetByteSize(FrameBuffer::Dimension dimension,
+                                    FrameBuffer::Format format) {
+  std::vector<PlaneLayout> planes;
+  return GetPlaneLayouts(dimension, format, &planes);
+}
+
+StatusOr<PooledFrameBuffer> FrameBufferPool::Acquire(
+    FrameBuffer::Dimension dimension, FrameBuffer::Format format,
+    FrameBuffer::Orientation orientation, absl::Time timestamp) {
+  if (dimension.width <= 0 || dimension.height <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid buffer dimension: %dx%d.", dimension.width,
+                        dimension.height),
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  std::vector<PlaneLayout> layouts;
+  const size_t byte_size = GetPlaneLayouts(dimension, format, &layouts);
+
+  PooledFrameBuffer result;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    // Best fit: the smallest free block that is large enough, provided it
+    // isn't too large.
+    auto it = state_->free_blocks.lower_bound(byte_size);
+    if (it != state_->free_blocks.end() &&
+        it->first <= byte_size * kMaxOversizeRatio) {
+      result.block_ = std::move(it->second);
+      state_->retained_bytes -= it->first;
+      state_->free_blocks.erase(it);
+    }
+  }
+  if (result.block_.data == nullptr) {
+    result.block_.data =
+        AllocateAlignedBlock(byte_size, kAlignment, &result.block_.storage,
+                             &result.block_.capacity);
+  }
+
+  std::vector<FrameBuffer::Plane> planes;
+  planes.reserve(layouts.size());
+  for (const PlaneLayout& layout : layouts) {
+    planes.push_back({result.block_.data + layout.offset, layout.stride});
+  }
+  result.frame_buffer_ = FrameBuffer::Create(std::move(planes), dimension,
+                                             format, orientation, timestamp);
+  result.pool_state_ = state_;
+  return result;
+}
+
+void FrameBufferPool::Trim() {
+  std::multimap<size_t, Block> free_blocks;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    free_blocks.swap(state_->free_blocks);
+    state_->retained_bytes = 0;
+  }
+}
+
+size_t FrameBufferPool::retained_bytes() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->retained_bytes;
+}
+
+size_t FrameBufferPool::max_retained_bytes() const {
+  return state_->max_retained_bytes;
+}
+
+void FrameBufferPool::Recycle(State* state, Block block) {
+  absl::MutexLock lock(&state->mutex);
+  if (state->is_destroyed ||
+      state->retained_bytes + block.capacity > state->max_retained_bytes) {
+    // Freed on return, once the lock is released.
+    return;
+  }
+  state->retained_bytes += block.capacity;
+  const size_t capacity = block.capacity;
+  state->free_blocks.emplace(capacity, std::move(block));
+}
+
+PooledFrameBuffer& PooledFrameBuffer::operator=(PooledFrameBuffer&& other) {
+  if (this != &other) {
+    Release();
+    pool_state_ = std::move(other.pool_state_);
+    block_ = std::move(other.block_);
+    other.block_ = FrameBufferPool::Block();
+    frame_buffer_ = std::move(other.frame_buffer_);
+  }
+  return *this;
+}
+
+void PooledFrameBuffer::Release() {
+  if (frame_buffer_ == nullptr) {
+    return;
+  }
+  frame_buffer_.reset();
+  FrameBufferPool::Recycle(pool_state_.get(), std::move(block_));
+  block_ = FrameBufferPool::Block();
+  pool_state_.reset();
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
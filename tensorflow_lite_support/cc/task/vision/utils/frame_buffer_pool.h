@@ -0,0 +1,188 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_POOL_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+class PooledFrameBuffer;
+
+// Allocator of owning frame buffers, recycling the memory of the buffers
+// released by the pipeline stages producing them (decoders, image processing,
+// etc.), so that processing a stream of frames does not allocate nor fragment
+// the heap with pixel memory once the pool has warmed up. Only pixel memory is
+// reused: each acquisition still builds the plane layout and plane vectors and
+// the `FrameBuffer` view with `FrameBuffer::Create`, and each release inserts
+// a node into the free block multimap, i.e. a few small allocations per frame.
+//
+// Buffers are acquired for a given dimension and format, and handed out as
+// `PooledFrameBuffer` instances exposing a `FrameBuffer` view over their
+// memory. Released memory blocks are kept for later acquisitions, each of
+// which reuses the smallest free block that is large enough, unless it is more
+// than `kMaxOversizeRatio` times larger than needed. In order to bound the
+// memory kept alive between frames, free blocks are discarded as soon as they
+// total more than `max_retained_bytes`.
+//
+// Memory layout: each plane starts on a `kAlignment` boundary and rows are
+// not padded. Chroma rows of the YUV formats never overlap, even for odd
+// widths, i.e. they hold (width + 1) / 2 chroma samples.
+//
+// Example usage:
+//
+//   FrameBufferPool pool;
+//   while (...) {
+//     ASSIGN_OR_RETURN(PooledFrameBuffer frame,
+//                      pool.Acquire({640, 480}, FrameBuffer::Format::kRGB));
+//     RETURN_IF_ERROR(DecodeInto(..., frame.data()));
+//     ASSIGN_OR_RETURN(PooledFrameBuffer crop,
+//                      pool.Acquire({224, 224}, FrameBuffer::Format::kRGB));
+//     RETURN_IF_ERROR(utils.Preprocess(*frame, roi, crop.frame_buffer()));
+//     ...
+//   }  // The memory of `frame` and `crop` is returned to the pool here.
+//
+// FrameBufferPool is thread-safe: buffers may be acquired and released
+// concurrently from several threads, e.g. by the stages of a pipeline.
+class FrameBufferPool {
+ public:
+  // Alignment in bytes of the planes of the acquired buffers, which matches
+  // the cache line size of most targeted CPUs and the widest SIMD registers.
+  static constexpr size_t kAlignment = 64;
+
+  // Maximum ratio between the size of a reused free block and the size of the
+  // acquired buffer. Larger free blocks are left for larger buffers and a new
+  // block is allocated instead, so that e.g. a 224x224 crop doesn't hold the
+  // memory of a 1080p frame.
+  static constexpr size_t kMaxOversizeRatio = 2;
+
+  // Default value for `max_retained_bytes`, large enough to hold a few 1080p
+  // RGBA frames.
+  static constexpr size_t kDefaultMaxRetainedBytes = 64 * 1024 * 1024;
+
+  explicit FrameBufferPool(
+      size_t max_retained_bytes = kDefaultMaxRetainedBytes);
+
+  // Buffers acquired from the pool may outlive it: their memory is then freed
+  // on release instead of being recycled.
+  ~FrameBufferPool();
+
+  // FrameBufferPool is neither copyable nor movable.
+  FrameBufferPool(const FrameBufferPool&) = delete;
+  FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+  // Returns a buffer of the given `dimension` and `format`, with unspecified
+  // pixel values, reusing released memory when possible. All the formats are
+  // supported. Returns an InvalidArgument error if `dimension` is empty.
+  tflite::support::StatusOr<PooledFrameBuffer> Acquire(
+      FrameBuffer::Dimension dimension, FrameBuffer::Format format,
+      FrameBuffer::Orientation orientation = FrameBuffer::Orientation::kTopLeft,
+      absl::Time timestamp = absl::Now());
+
+  // Frees all the memory blocks currently retained by the pool. Buffers
+  // currently acquired are not affected.
+  void Trim();
+
+  // Returns the total size in bytes of the free memory blocks retained by the
+  // pool.
+  size_t retained_bytes() const;
+
+  size_t max_retained_bytes() const;
+
+  // Returns the size in bytes of the memory block holding a buffer of the
+  // given `dimension` and `format`, as laid out by the pool.
+  static size_t GetByteSize(FrameBuffer::Dimension dimension,
+                            FrameBuffer::Format format);
+
+ private:
+  friend class PooledFrameBuffer;
+
+  // Memory block backing a buffer.
+  struct Block {
+    std::unique_ptr<uint8[]> storage;
+    // Start of the `kAlignment` aligned region within `storage`.
+    uint8* data = nullptr;
+    size_t capacity = 0;
+  };
+
+  // State shared by the pool and the buffers it handed out, so that buffers
+  // can be released after the pool is destroyed.
+  struct State;
+
+  // Returns `block` to the pool sharing `state`, or frees it if the pool is
+  // full or destroyed.
+  static void Recycle(State* state, Block block);
+
+  std::shared_ptr<State> state_;
+};
+
+// Frame buffer owning its memory, acquired from a `FrameBufferPool` to which
+// the memory is returned on destruction.
+//
+// PooledFrameBuffer is movable but not copyable.
+class PooledFrameBuffer {
+ public:
+  // Creates an empty instance, holding no buffer.
+  PooledFrameBuffer() = default;
+  ~PooledFrameBuffer() { Release(); }
+
+  PooledFrameBuffer(PooledFrameBuffer&& other) { *this = std::move(other); }
+  PooledFrameBuffer& operator=(PooledFrameBuffer&& other);
+  PooledFrameBuffer(const PooledFrameBuffer&) = delete;
+  PooledFrameBuffer& operator=(const PooledFrameBuffer&) = delete;
+
+  // Returns whether the instance holds a buffer, i.e. it was acquired from a
+  // pool and has neither been released nor moved from.
+  explicit operator bool() const { return frame_buffer_ != nullptr; }
+
+  // Returns the `FrameBuffer` view over the owned memory, which must not be
+  // used after the instance is released. It can be used as the output buffer
+  // of image processing operations, e.g. `FrameBufferUtils::Preprocess`.
+  FrameBuffer* frame_buffer() const { return frame_buffer_.get(); }
+  FrameBuffer& operator*() const { return *frame_buffer_; }
+  FrameBuffer* operator->() const { return frame_buffer_.get(); }
+
+  // Returns the owned memory block and its size in bytes, which is at least
+  // `FrameBufferPool::GetByteSize` for the buffer dimension and format.
+  uint8* data() const { return block_.data; }
+  size_t capacity() const { return block_.capacity; }
+
+  // Returns the owned memory to its pool and empties the instance. Does
+  // nothing if the instance is empty.
+  void Release();
+
+ private:
+  friend class FrameBufferPool;
+
+  std::shared_ptr<FrameBufferPool::State> pool_state_;
+  FrameBufferPool::Block block_;
+  std::unique_ptr<FrameBuffer> frame_buffer_;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_POOL_H_
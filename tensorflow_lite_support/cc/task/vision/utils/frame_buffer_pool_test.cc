@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_pool.h"
+
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+
+TEST(FrameBufferPoolTest, ReusesReleasedBlock) {
+  FrameBufferPool pool;
+  PooledFrameBuffer frame = pool.Acquire({640, 480}, Format::kRGB).value();
+  const uint8* data = frame.data();
+  const size_t capacity = frame.capacity();
+  frame.Release();
+  EXPECT_EQ(pool.retained_bytes(), capacity);
+
+  frame = pool.Acquire({640, 480}, Format::kRGB).value();
+  EXPECT_EQ(frame.data(), data);
+  EXPECT_EQ(pool.retained_bytes(), 0);
+}
+
+TEST(FrameBufferPoolTest, ReusesBlockUpToMaxOversizeRatio) {
+  FrameBufferPool pool;
+  PooledFrameBuffer frame = pool.Acquire({640, 480}, Format::kRGB).value();
+  const uint8* data = frame.data();
+  frame.Release();
+
+  // Half the size of the released block.
+  frame = pool.Acquire({320, 480}, Format::kRGB).value();
+  EXPECT_EQ(frame.data(), data);
+  EXPECT_EQ(pool.retained_bytes(), 0);
+}
+
+TEST(FrameBufferPoolTest, DoesNotReuseMuchLargerBlock) {
+  FrameBufferPool pool;
+  PooledFrameBuffer frame = pool.Acquire({640, 480}, Format::kRGB).value();
+  const size_t capacity = frame.capacity();
+  frame.Release();
+
+  PooledFrameBuffer crop = pool.Acquire({224, 224}, Format::kRGB).value();
+  EXPECT_LT(crop.capacity(), capacity);
+  EXPECT_EQ(pool.retained_bytes(), capacity);
+
+  // The large block is still available for large buffers.
+  frame = pool.Acquire({640, 480}, Format::kRGB).value();
+  EXPECT_EQ(frame.capacity(), capacity);
+  EXPECT_EQ(pool.retained_bytes(), 0);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
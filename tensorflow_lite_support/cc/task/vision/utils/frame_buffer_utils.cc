@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -28,13 +30,17 @@ limitations under the License.
 #include "tensorflow/lite/kernels/op_macros.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/bilinear_scaler.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/box_reducer.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
-#include "tensorflow_lite_support/cc/task/vision/utils/libyuv_frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/process_engine_registry.h"
 
 namespace tflite {
 namespace task {
 namespace vision {
 
+using ::tflite::support::StatusOr;
+
 namespace {
 
 // Exif grouping to help determine rotation and flipping neededs between
@@ -43,6 +49,218 @@ constexpr int kExifGroup[] = {1, 6, 3, 8, 2, 5, 4, 7};
 // Exif group size.
 constexpr int kExifGroupSize = 4;
 
+// Minimum number of output rows per stripe, and minimum number of output
+// pixels for an operation to be split into stripes: below these, the
+// synchronization overhead outweighs the benefits of parallel processing.
+constexpr int kMinStripeRows = 16;
+constexpr int kMinParallelPixels = 128 * 128;
+
+// Minimum downscaling ratio along an axis for box pre-reduction to be used.
+constexpr int kMinBoxPreReductionRatio = 4;
+
+// Returns the integer factor by which an image axis of size `from_size` is
+// reduced by box pre-reduction, so as to be at least twice `to_size`.
+int GetBoxPreReductionFactor(int from_size, int to_size) {
+  return std::max(1, from_size / (2 * to_size));
+}
+
+// Returns whether `format` has subsampled chroma planes.
+bool IsYuvFormat(FrameBuffer::Format format) {
+  return format == FrameBuffer::Format::kNV12 ||
+         format == FrameBuffer::Format::kNV21 ||
+         format == FrameBuffer::Format::kYV12 ||
+         format == FrameBuffer::Format::kYV21;
+}
+
+// Returns whether pre-processing buffers of format `input_format` into
+// buffers of format `output_format` only processes their luma plane, as a
+// grayscale buffer.
+bool UsesLumaPlane(FrameBuffer::Format input_format,
+                   FrameBuffer::Format output_format) {
+  return output_format == FrameBuffer::Format::kGRAY &&
+         IsYuvFormat(input_format);
+}
+
+// Returns whether disjoint row ranges of `buffer` map to disjoint memory, so
+// that they can be written concurrently. This doesn't hold for YUV buffers
+// whose chroma row stride is too small to hold a full chroma row, e.g. NV12
+// buffers with an odd width created by `CreateFromRawBuffer`, where the last
+// chroma pixel of a row overlaps the first one of the next row.
+bool HasDisjointRows(const FrameBuffer& buffer) {
+  if (!IsYuvFormat(buffer.format())) {
+    return true;
+  }
+  StatusOr<FrameBuffer::YuvData> yuv_data =
+      FrameBuffer::GetYuvDataFromFrameBuffer(buffer);
+  if (!yuv_data.ok()) {
+    return false;
+  }
+  const int uv_width = (buffer.dimension().width + 1) / 2;
+  return yuv_data.value().uv_row_stride >=
+         uv_width * yuv_data.value().uv_pixel_stride;
+}
+
+// Returns the BT.601 (limited range) luma value of the gray level `gray`, as
+// expected by the YUV to RGB conversions.
+uint8 GetLumaFromGray(uint8 gray) {
+  return static_cast<uint8>(16 + (gray * 219 + 127) / 255);
+}
+
+// Sets all the pixels of the `width` x `height` rectangle at (`x`, `y`) of
+// `plane` to `pixel`, made of `pixel_bytes` bytes.
+void FillPlaneRect(const FrameBuffer::Plane& plane, int x, int y, int width,
+                   int height, const uint8* pixel, int pixel_bytes) {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  const int pixel_stride = plane.stride.pixel_stride_bytes;
+  const bool is_uniform =
+      pixel_stride == pixel_bytes &&
+      std::all_of(pixel, pixel + pixel_bytes,
+                  [pixel](uint8 value) { return value == pixel[0]; });
+  for (int row = y; row < y + height; ++row) {
+    uint8* data = const_cast<uint8*>(plane.buffer) +
+                  row * plane.stride.row_stride_bytes + x * pixel_stride;
+    if (is_uniform) {
+      std::memset(data, pixel[0], width * pixel_bytes);
+      continue;
+    }
+    for (int i = 0; i < width; ++i) {
+      std::memcpy(data + i * pixel_stride, pixel, pixel_bytes);
+    }
+  }
+}
+
+// Sets the pixels of the `dimension` `plane` lying outside of the
+// `inner_width` x `inner_height` rectangle at (`inner_x`, `inner_y`) to
+// `pixel`, made of `pixel_bytes` bytes.
+void FillPlaneBorders(const FrameBuffer::Plane& plane,
+                      FrameBuffer::Dimension dimension, int inner_x,
+                      int inner_y, int inner_width, int inner_height,
+                      const uint8* pixel, int pixel_bytes) {
+  const int inner_right = inner_x + inner_width;
+  const int inner_bottom = inner_y + inner_height;
+  FillPlaneRect(plane, 0, 0, dimension.width, inner_y, pixel, pixel_bytes);
+  FillPlaneRect(plane, 0, inner_y, inner_x, inner_height, pixel, pixel_bytes);
+  FillPlaneRect(plane, inner_right, inner_y, dimension.width - inner_right,
+                inner_height, pixel, pixel_bytes);
+  FillPlaneRect(plane, 0, inner_bottom, dimension.width,
+                dimension.height - inner_bottom, pixel, pixel_bytes);
+}
+
+// Pads the pixels of `buffer` lying outside of the letterboxed image described
+// by `params` with the gray level `padding_value`.
+absl::Status FillLetterboxPadding(const FrameBuffer& buffer,
+                                  const LetterboxParams& params,
+                                  uint8 padding_value) {
+  const FrameBuffer::Dimension dimension = buffer.dimension();
+  const int x = params.offset_x;
+  const int y = params.offset_y;
+  const int width = params.scaled_dimension.width;
+  const int height = params.scaled_dimension.height;
+  if (IsYuvFormat(buffer.format())) {
+    ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                     FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+    const uint8 luma = GetLumaFromGray(padding_value);
+    FillPlaneBorders({yuv_data.y_buffer, {yuv_data.y_row_stride, 1}},
+                     dimension, x, y, width, height, &luma, 1);
+    // Chroma samples shared by padding and image pixels belong to the image.
+    // Offsets are even, so that only the right and bottom ones are shared.
+    constexpr uint8 kNeutralChroma = 128;
+    const FrameBuffer::Dimension uv_dimension = {(dimension.width + 1) / 2,
+                                                 (dimension.height + 1) / 2};
+    const int uv_x = x / 2;
+    const int uv_y = y / 2;
+    const int uv_width = (x + width + 1) / 2 - uv_x;
+    const int uv_height = (y + height + 1) / 2 - uv_y;
+    const FrameBuffer::Stride uv_stride = {yuv_data.uv_row_stride,
+                                           yuv_data.uv_pixel_stride};
+    FillPlaneBorders({yuv_data.u_buffer, uv_stride}, uv_dimension, uv_x, uv_y,
+                     uv_width, uv_height, &kNeutralChroma, 1);
+    FillPlaneBorders({yuv_data.v_buffer, uv_stride}, uv_dimension, uv_x, uv_y,
+                     uv_width, uv_height, &kNeutralChroma, 1);
+    return absl::OkStatus();
+  }
+  if (IsPackedYuv422Format(buffer.format())) {
+    // Luma and chroma samples alternate, each pixel being stored as a luma
+    // sample followed or preceded by one of the chroma samples of its
+    // macropixel. Chroma samples shared by padding and image pixels belong to
+    // the image: `x` is even, so that only the right ones are shared.
+    const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+    const uint8* data = buffer.plane(0).buffer;
+    const FrameBuffer::Stride stride = {buffer.plane(0).stride.row_stride_bytes,
+                                        kPackedYuv422PixelBytes};
+    const uint8 luma = GetLumaFromGray(padding_value);
+    FillPlaneBorders({is_yuyv ? data : data + 1, stride}, dimension, x, y,
+                     width, height, &luma, 1);
+    constexpr uint8 kNeutralChroma = 128;
+    const FrameBuffer::Dimension uv_dimension = {
+        (dimension.width + 1) / 2 * 2, dimension.height};
+    const int uv_width = (x + width + 1) / 2 * 2 - x;
+    FillPlaneBorders({is_yuyv ? data + 1 : data, stride}, uv_dimension, x, y,
+                     uv_width, height, &kNeutralChroma, 1);
+    return absl::OkStatus();
+  }
+  ASSIGN_OR_RETURN(const int pixel_bytes, GetPixelStrides(buffer.format()));
+  std::vector<uint8> pixel(pixel_bytes, padding_value);
+  if (buffer.format() == FrameBuffer::Format::kRGBA ||
+      buffer.format() == FrameBuffer::Format::kBGRA) {
+    // Opaque alpha.
+    pixel.back() = 255;
+  }
+  FillPlaneBorders(buffer.plane(0), dimension, x, y, width, height,
+                   pixel.data(), pixel_bytes);
+  return absl::OkStatus();
+}
+
+// Returns a FrameBuffer sharing the data of the `dimension` region of `buffer`
+// whose top-left corner is at (`x`, `y`). For YUV formats, `x` and `y` must be
+// even so that the chroma planes cover the same region as the luma plane. For
+// packed YUV 4:2:2 formats, `x` must be even so that the region starts on a
+// macropixel.
+StatusOr<FrameBuffer> GetSubFrameBuffer(const FrameBuffer& buffer, int x, int y,
+                                        FrameBuffer::Dimension dimension) {
+  std::vector<FrameBuffer::Plane> planes;
+  if (IsYuvFormat(buffer.format())) {
+    // Always describe YUV regions with 3 planes: single-plane YUV buffers
+    // locate their chroma data from the frame dimension, which doesn't hold
+    // for a region.
+    ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                     FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+    const int uv_offset =
+        (y / 2) * yuv_data.uv_row_stride + (x / 2) * yuv_data.uv_pixel_stride;
+    const FrameBuffer::Plane y_plane = {
+        /*buffer=*/yuv_data.y_buffer + y * yuv_data.y_row_stride + x,
+        /*stride=*/{yuv_data.y_row_stride, /*pixel_stride_bytes=*/1}};
+    const FrameBuffer::Plane u_plane = {
+        /*buffer=*/yuv_data.u_buffer + uv_offset,
+        /*stride=*/{yuv_data.uv_row_stride, yuv_data.uv_pixel_stride}};
+    const FrameBuffer::Plane v_plane = {
+        /*buffer=*/yuv_data.v_buffer + uv_offset,
+        /*stride=*/{yuv_data.uv_row_stride, yuv_data.uv_pixel_stride}};
+    if (buffer.format() == FrameBuffer::Format::kNV21 ||
+        buffer.format() == FrameBuffer::Format::kYV12) {
+      planes = {y_plane, v_plane, u_plane};
+    } else {
+      planes = {y_plane, u_plane, v_plane};
+    }
+  } else {
+    // Packed YUV 4:2:2 pixels are located by their macropixel.
+    const int x_offset_bytes =
+        IsPackedYuv422Format(buffer.format())
+            ? x / 2 * kPackedYuv422MacropixelBytes
+            : x * buffer.plane(0).stride.pixel_stride_bytes;
+    planes.reserve(buffer.plane_count());
+    for (int i = 0; i < buffer.plane_count(); ++i) {
+      FrameBuffer::Plane plane = buffer.plane(i);
+      plane.buffer += y * plane.stride.row_stride_bytes + x_offset_bytes;
+      planes.push_back(plane);
+    }
+  }
+  return FrameBuffer(std::move(planes), dimension, buffer.format(),
+                     buffer.orientation(), buffer.timestamp());
+}
+
 // Returns orientation position in Exif group.
 static int GetOrientationIndex(FrameBuffer::Orientation orientation) {
   const int* index = std::find(kExifGroup, kExifGroup + kExifGroupSize * 2,
@@ -153,6 +371,89 @@ static void RotateCoordinates(int from_x, int from_y, int angle,
   }
 }
 
+// Returns the plane orientation resampling an image as described by `params`,
+// i.e. the inverse of `RotateCoordinates` followed by the flip.
+PlaneOrientation GetPlaneOrientation(const OrientParams& params) {
+  PlaneOrientation orientation;
+  switch (params.rotation_angle_deg) {
+    case 90:
+      orientation.transpose = true;
+      orientation.mirror_x = true;
+      break;
+    case 180:
+      orientation.mirror_x = true;
+      orientation.mirror_y = true;
+      break;
+    case 270:
+      orientation.transpose = true;
+      orientation.mirror_y = true;
+      break;
+  }
+  // Flips mirror the axis of the unoriented image mapped onto the flipped
+  // axis of the oriented image.
+  if (params.flip == OrientParams::FlipType::kHorizontal) {
+    bool& mirror =
+        orientation.transpose ? orientation.mirror_y : orientation.mirror_x;
+    mirror = !mirror;
+  } else if (params.flip == OrientParams::FlipType::kVertical) {
+    bool& mirror =
+        orientation.transpose ? orientation.mirror_x : orientation.mirror_y;
+    mirror = !mirror;
+  }
+  return orientation;
+}
+
+// Returns whether `FrameBufferUtils::CropResizeAndOrient` can crop `buffer` to
+// `crop_dimension`, resize it to `resize_dimension` with `interpolation` and
+// orient it in a single pass. Plain crops are left to the engine rotations,
+// which are faster than resampling. So are 1 and 4 bytes pixels, which the
+// engines resize and rotate with SIMD kernels without any intermediate format
+// conversion.
+bool SupportsCropResizeAndOrient(FrameBuffer::Format format,
+                                 bool has_disjoint_rows,
+                                 FrameBuffer::Dimension crop_dimension,
+                                 FrameBuffer::Dimension resize_dimension,
+                                 InterpolationMethod interpolation) {
+  switch (format) {
+    case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21:
+      break;
+    default:
+      return false;
+  }
+  return interpolation == InterpolationMethod::kBilinear &&
+         crop_dimension != resize_dimension && has_disjoint_rows;
+}
+
+bool SupportsCropResizeAndOrient(const FrameBuffer& buffer,
+                                 FrameBuffer::Dimension crop_dimension,
+                                 FrameBuffer::Dimension resize_dimension,
+                                 InterpolationMethod interpolation) {
+  return SupportsCropResizeAndOrient(buffer.format(), HasDisjointRows(buffer),
+                                     crop_dimension, resize_dimension,
+                                     interpolation);
+}
+
+// Returns whether `a` and `b` cover the same region.
+bool IsSameBoundingBox(const BoundingBox& a, const BoundingBox& b) {
+  return a.origin_x() == b.origin_x() && a.origin_y() == b.origin_y() &&
+         a.width() == b.width() && a.height() == b.height();
+}
+
+// Returns the grayscale buffer made of the luma plane of the YUV `buffer`.
+StatusOr<FrameBuffer> GetLumaFrameBuffer(const FrameBuffer& buffer) {
+  ASSIGN_OR_RETURN(const FrameBuffer::YuvData yuv_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+  return FrameBuffer(
+      {{yuv_data.y_buffer, {yuv_data.y_row_stride, /*pixel_stride_bytes=*/1}}},
+      buffer.dimension(), FrameBuffer::Format::kGRAY, buffer.orientation(),
+      buffer.timestamp());
+}
+
 }  // namespace
 
 int GetBufferByteSize(FrameBuffer::Dimension dimension,
@@ -160,15 +461,92 @@ int GetBufferByteSize(FrameBuffer::Dimension dimension,
   return GetFrameBufferByteSize(dimension, format);
 }
 
-FrameBufferUtils::FrameBufferUtils(ProcessEngine engine) {
+/* static */
+PreprocessPlan::BufferSignature PreprocessPlan::BufferSignature::Of(
+    const FrameBuffer& buffer) {
+  BufferSignature signature;
+  signature.dimension = buffer.dimension();
+  signature.format = buffer.format();
+  signature.orientation = buffer.orientation();
+  signature.strides.reserve(buffer.plane_count());
+  for (int i = 0; i < buffer.plane_count(); ++i) {
+    signature.strides.push_back(buffer.plane(i).stride);
+  }
+  return signature;
+}
+
+bool PreprocessPlan::BufferSignature::Matches(const FrameBuffer& buffer) const {
+  if (buffer.dimension() != dimension || buffer.format() != format ||
+      buffer.orientation() != orientation ||
+      buffer.plane_count() != strides.size()) {
+    return false;
+  }
+  for (int i = 0; i < strides.size(); ++i) {
+    const FrameBuffer::Stride& stride = buffer.plane(i).stride;
+    if (stride.row_stride_bytes != strides[i].row_stride_bytes ||
+        stride.pixel_stride_bytes != strides[i].pixel_stride_bytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PreprocessPlan::Matches(const FrameBuffer& buffer,
+                             const absl::optional<BoundingBox>& bounding_box,
+                             absl::optional<uint8> letterbox_padding_value,
+                             const FrameBuffer& output_buffer,
+                             InterpolationMethod interpolation) const {
+  if (interpolation != interpolation_ ||
+      letterbox_padding_value != letterbox_padding_value_ ||
+      bounding_box.has_value() != bounding_box_.has_value() ||
+      (bounding_box.has_value() &&
+       !IsSameBoundingBox(bounding_box.value(), bounding_box_.value()))) {
+    return false;
+  }
+  return input_signature_.Matches(buffer) &&
+         output_signature_.Matches(output_buffer);
+}
+
+FrameBufferUtils::FrameBufferUtils(ProcessEngine engine, int num_threads) {
+  const char* engine_name = nullptr;
   switch (engine) {
     case ProcessEngine::kLibyuv:
-      utils_ = absl::make_unique<LibyuvFrameBufferUtils>();
+      engine_name = kLibyuvProcessEngineName;
+      break;
+    case ProcessEngine::kSimd:
+      engine_name = kSimdProcessEngineName;
+      break;
+    case ProcessEngine::kAuto:
+      engine_name = kAutoProcessEngineName;
       break;
     default:
       TF_LITE_FATAL(
           absl::StrFormat("Unexpected ProcessEngine: %d.", engine).c_str());
   }
+  StatusOr<std::unique_ptr<FrameBufferUtilsInterface>> utils =
+      ProcessEngineRegistry::Global().Create(engine_name);
+  if (!utils.ok()) {
+    TF_LITE_FATAL(std::string(utils.status().message()).c_str());
+  }
+  utils_ = std::move(utils.value());
+  if (num_threads > 1) {
+    thread_pool_ = absl::make_unique<ThreadPool>(num_threads);
+  }
+}
+
+FrameBufferUtils::FrameBufferUtils(
+    std::unique_ptr<FrameBufferUtilsInterface> engine, int num_threads)
+    : utils_(std::move(engine)) {
+  if (num_threads > 1) {
+    thread_pool_ = absl::make_unique<ThreadPool>(num_threads);
+  }
+}
+
+StatusOr<std::unique_ptr<FrameBufferUtils>> FrameBufferUtils::CreateWithEngine(
+    const std::string& engine_name, int num_threads) {
+  ASSIGN_OR_RETURN(std::unique_ptr<FrameBufferUtilsInterface> engine,
+                   ProcessEngineRegistry::Global().Create(engine_name));
+  return absl::make_unique<FrameBufferUtils>(std::move(engine), num_threads);
 }
 
 BoundingBox OrientBoundingBox(const BoundingBox& from_box,
@@ -298,19 +676,218 @@ bool RequireDimensionSwap(FrameBuffer::Orientation from_orientation,
   return params.rotation_angle_deg == 90 || params.rotation_angle_deg == 270;
 }
 
+bool UsesBoxPreReduction(FrameBuffer::Dimension from_dimension,
+                         FrameBuffer::Dimension to_dimension,
+                         InterpolationMethod interpolation) {
+  if (interpolation == InterpolationMethod::kNearestNeighbor ||
+      to_dimension.width <= 0 || to_dimension.height <= 0) {
+    return false;
+  }
+  return from_dimension.width >=
+             kMinBoxPreReductionRatio * to_dimension.width ||
+         from_dimension.height >=
+             kMinBoxPreReductionRatio * to_dimension.height;
+}
+
+LetterboxParams GetLetterboxParams(FrameBuffer::Dimension from_dimension,
+                                   FrameBuffer::Dimension to_dimension,
+                                   FrameBuffer::Format format) {
+  LetterboxParams params;
+  // Compare the aspect ratios with integer arithmetic, so that identical
+  // aspect ratios always fill the whole image.
+  const int64 from_width = from_dimension.width;
+  const int64 from_height = from_dimension.height;
+  if (from_width * to_dimension.height <= from_height * to_dimension.width) {
+    // Height-constrained: the scaled width is rounded to nearest.
+    params.scaled_dimension.height = to_dimension.height;
+    params.scaled_dimension.width = static_cast<int>(
+        (2 * from_width * to_dimension.height + from_height) /
+        (2 * from_height));
+  } else {
+    params.scaled_dimension.width = to_dimension.width;
+    params.scaled_dimension.height = static_cast<int>(
+        (2 * from_height * to_dimension.width + from_width) /
+        (2 * from_width));
+  }
+  params.scaled_dimension.width =
+      std::max(1, std::min(params.scaled_dimension.width, to_dimension.width));
+  params.scaled_dimension.height = std::max(
+      1, std::min(params.scaled_dimension.height, to_dimension.height));
+  params.offset_x = (to_dimension.width - params.scaled_dimension.width) / 2;
+  params.offset_y = (to_dimension.height - params.scaled_dimension.height) / 2;
+  if (IsYuvFormat(format)) {
+    params.offset_x &= ~1;
+    params.offset_y &= ~1;
+  } else if (IsPackedYuv422Format(format)) {
+    params.offset_x &= ~1;
+  }
+  return params;
+}
+
+FrameBuffer::Format GetLetterboxFormat(FrameBuffer::Format input_format,
+                                       FrameBuffer::Format output_format) {
+  return UsesLumaPlane(input_format, output_format) ? FrameBuffer::Format::kGRAY
+                                                    : input_format;
+}
+
+BoundingBox GetLetterboxedOutputRegion(FrameBuffer::Dimension roi_dimension,
+                                       FrameBuffer::Format input_format,
+                                       FrameBuffer::Orientation orientation,
+                                       FrameBuffer::Dimension tensor_dimension,
+                                       FrameBuffer::Format output_format) {
+  // Letterboxing happens in the unrotated frame of reference, i.e. before
+  // the rotation to the upright output.
+  FrameBuffer::Dimension pre_orient_dimension = tensor_dimension;
+  if (RequireDimensionSwap(orientation, FrameBuffer::Orientation::kTopLeft)) {
+    pre_orient_dimension.Swap();
+  }
+  // Grayscale outputs letterbox the luma plane of YUV buffers, whose offsets
+  // are not rounded to even values.
+  const LetterboxParams params =
+      GetLetterboxParams(roi_dimension, pre_orient_dimension,
+                         GetLetterboxFormat(input_format, output_format));
+  BoundingBox region;
+  region.set_origin_x(params.offset_x);
+  region.set_origin_y(params.offset_y);
+  region.set_width(params.scaled_dimension.width);
+  region.set_height(params.scaled_dimension.height);
+  return OrientBoundingBox(region, orientation,
+                           FrameBuffer::Orientation::kTopLeft,
+                           pre_orient_dimension);
+}
+
+float MapToOutputRegion(float value, int output_size, int region_origin,
+                        int region_size) {
+  const float mapped =
+      (value * output_size - region_origin) / static_cast<float>(region_size);
+  return std::min(1.0f, std::max(0.0f, mapped));
+}
+
+absl::Status FrameBufferUtils::RunInStripes(
+    int num_rows, int num_columns, int row_alignment,
+    const std::function<absl::Status(int row_begin, int row_end)>&
+        operation) {
+  int num_stripes = 1;
+  if (thread_pool_ != nullptr && num_rows * num_columns >= kMinParallelPixels) {
+    num_stripes =
+        std::min(thread_pool_->num_threads(), num_rows / kMinStripeRows);
+  }
+  if (num_stripes <= 1) {
+    return operation(0, num_rows);
+  }
+  // Split the rows as evenly as possible, in units of `row_alignment` rows.
+  const int num_units = (num_rows + row_alignment - 1) / row_alignment;
+  std::vector<absl::Status> statuses(num_stripes);
+  thread_pool_->ParallelFor(num_stripes, [&](int stripe) {
+    const int row_begin = std::min(
+        num_rows, num_units * stripe / num_stripes * row_alignment);
+    const int row_end =
+        stripe + 1 == num_stripes
+            ? num_rows
+            : std::min(num_rows,
+                       num_units * (stripe + 1) / num_stripes * row_alignment);
+    if (row_begin < row_end) {
+      statuses[stripe] = operation(row_begin, row_end);
+    }
+  });
+  for (const absl::Status& status : statuses) {
+    RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status FrameBufferUtils::Crop(const FrameBuffer& buffer, int x0, int y0,
-                                    int x1, int y1,
-                                    FrameBuffer* output_buffer) {
+                                    int x1, int y1, FrameBuffer* output_buffer,
+                                    InterpolationMethod interpolation) {
   TFLITE_DCHECK(utils_ != nullptr);
+  const FrameBuffer::Dimension crop_dimension = {x1 - x0 + 1, y1 - y0 + 1};
+  const FrameBuffer::Dimension output_dimension = output_buffer->dimension();
+  // Invalid inputs are left to the engine to report.
+  const bool are_inputs_valid =
+      ValidateCropBufferInputs(buffer, *output_buffer, x0, y0, x1, y1).ok();
+  if (are_inputs_valid && crop_dimension != output_dimension &&
+      (interpolation != InterpolationMethod::kBilinear ||
+       UsesBoxPreReduction(crop_dimension, output_dimension, interpolation))) {
+    // Resize the cropped region of `buffer`, as engines only support other
+    // interpolation methods than bilinear for plain resizing.
+    if (IsPackedYuv422Format(buffer.format()) && x0 % 2 != 0) {
+      // The cropped region doesn't start on a macropixel: realign it first.
+      uint8* cropped_data = crop_buffer_.Get(
+          GetFrameBufferByteSize(crop_dimension, buffer.format()));
+      FrameBuffer cropped_buffer(
+          GetPlanes(cropped_data, crop_dimension, buffer.format()),
+          crop_dimension, buffer.format(), buffer.orientation(),
+          buffer.timestamp());
+      absl::Status status =
+          utils_->Crop(buffer, x0, y0, x1, y1, &cropped_buffer);
+      if (status.ok()) {
+        status = Resize(cropped_buffer, output_buffer, interpolation);
+      }
+      crop_buffer_.ReleaseIfAboveCap();
+      return status;
+    }
+    ASSIGN_OR_RETURN(const FrameBuffer cropped_buffer,
+                     GetSubFrameBuffer(buffer, x0, y0, crop_dimension));
+    return Resize(cropped_buffer, output_buffer, interpolation);
+  }
+  if (thread_pool_ == nullptr || !HasDisjointRows(*output_buffer) ||
+      !are_inputs_valid) {
+    return utils_->Crop(buffer, x0, y0, x1, y1, output_buffer);
+  }
+  const bool is_yuv = IsYuvFormat(buffer.format());
+  if (crop_dimension == output_dimension && !(is_yuv && y0 % 2 != 0)) {
+    // Plain cropping: crop each output stripe from the matching input rows.
+    return RunInStripes(
+        output_dimension.height, output_dimension.width, is_yuv ? 2 : 1,
+        [&](int row_begin, int row_end) {
+          ASSIGN_OR_RETURN(
+              FrameBuffer output_stripe,
+              GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                {output_dimension.width, row_end - row_begin}));
+          return utils_->Crop(buffer, x0, y0 + row_begin, x1,
+                              y0 + row_end - 1, &output_stripe);
+        });
+  }
+  if (crop_dimension != output_dimension &&
+      utils_->SupportsResizeRows(buffer.format())) {
+    // Cropping with resizing: resize the cropped region of `buffer` stripe by
+    // stripe.
+    ASSIGN_OR_RETURN(const FrameBuffer cropped_buffer,
+                     GetSubFrameBuffer(buffer, x0, y0, crop_dimension));
+    return RunInStripes(output_dimension.height, output_dimension.width,
+                        /*row_alignment=*/1, [&](int row_begin, int row_end) {
+                          return utils_->ResizeRows(cropped_buffer, row_begin,
+                                                    row_end, output_buffer);
+                        });
+  }
   return utils_->Crop(buffer, x0, y0, x1, y1, output_buffer);
 }
 
+absl::Status FrameBufferUtils::Letterbox(const FrameBuffer& buffer, int x0,
+                                         int y0, int x1, int y1,
+                                         uint8 padding_value,
+                                         FrameBuffer* output_buffer,
+                                         InterpolationMethod interpolation) {
+  RETURN_IF_ERROR(
+      ValidateCropBufferInputs(buffer, *output_buffer, x0, y0, x1, y1));
+  RETURN_IF_ERROR(ValidateBufferFormat(*output_buffer));
+  const LetterboxParams params =
+      GetLetterboxParams({x1 - x0 + 1, y1 - y0 + 1},
+                         output_buffer->dimension(), output_buffer->format());
+  RETURN_IF_ERROR(FillLetterboxPadding(*output_buffer, params, padding_value));
+  // Crop and resize directly into the inner region of `output_buffer`.
+  ASSIGN_OR_RETURN(FrameBuffer inner_buffer,
+                   GetSubFrameBuffer(*output_buffer, params.offset_x,
+                                     params.offset_y, params.scaled_dimension));
+  return Crop(buffer, x0, y0, x1, y1, &inner_buffer, interpolation);
+}
+
 FrameBuffer::Dimension FrameBufferUtils::GetSize(
-    const FrameBuffer& buffer, const FrameBufferOperation& operation) {
-  FrameBuffer::Dimension dimension = buffer.dimension();
+    FrameBuffer::Dimension dimension, FrameBuffer::Orientation orientation,
+    const FrameBufferOperation& operation) {
   if (absl::holds_alternative<OrientOperation>(operation)) {
     OrientParams params =
-        GetOrientParams(buffer.orientation(),
+        GetOrientParams(orientation,
                         absl::get<OrientOperation>(operation).to_orientation);
     if (params.rotation_angle_deg == 90 || params.rotation_angle_deg == 270) {
       dimension.Swap();
@@ -318,6 +895,8 @@ FrameBuffer::Dimension FrameBufferUtils::GetSize(
   } else if (absl::holds_alternative<CropResizeOperation>(operation)) {
     const auto& crop_resize = absl::get<CropResizeOperation>(operation);
     dimension = crop_resize.resize_dimension;
+  } else if (absl::holds_alternative<LetterboxOperation>(operation)) {
+    dimension = absl::get<LetterboxOperation>(operation).letterbox_dimension;
   }
   return dimension;
 }
@@ -333,22 +912,36 @@ std::vector<FrameBuffer::Plane> FrameBufferUtils::GetPlanes(
                                     /*pixel_stride_bytes=*/1}});
       break;
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
       planes.push_back({/*buffer=*/buffer,
                         /*stride=*/{/*row_stride_bytes=*/dimension.width * 3,
                                     /*pixel_stride_bytes=*/3}});
       break;
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
       planes.push_back({/*buffer=*/buffer,
                         /*stride=*/{/*row_stride_bytes=*/dimension.width * 4,
                                     /*pixel_stride_bytes=*/4}});
       break;
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      // Rows hold whole macropixels.
+      planes.push_back(
+          {/*buffer=*/buffer,
+           /*stride=*/{/*row_stride_bytes=*/(dimension.width + 1) / 2 *
+                           kPackedYuv422MacropixelBytes,
+                       /*pixel_stride_bytes=*/kPackedYuv422PixelBytes}});
+      break;
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kNV12: {
+      // Chroma rows hold (width + 1) / 2 interleaved UV pairs, so that they
+      // don't overlap for odd widths.
+      const int uv_row_stride = (dimension.width + 1) / 2 * 2;
       planes.push_back(
           {buffer, /*stride=*/{/*row_stride_bytes=*/dimension.width,
                                /*pixel_stride_bytes=*/1}});
       planes.push_back({buffer + (dimension.width * dimension.height),
-                        /*stride=*/{/*row_stride_bytes=*/dimension.width,
+                        /*stride=*/{/*row_stride_bytes=*/uv_row_stride,
                                     /*pixel_stride_bytes=*/2}});
     } break;
     case FrameBuffer::Format::kYV12:
@@ -373,19 +966,20 @@ std::vector<FrameBuffer::Plane> FrameBufferUtils::GetPlanes(
 }
 
 FrameBuffer::Orientation FrameBufferUtils::GetOrientation(
-    const FrameBuffer& buffer, const FrameBufferOperation& operation) {
+    FrameBuffer::Orientation orientation,
+    const FrameBufferOperation& operation) {
   if (absl::holds_alternative<OrientOperation>(operation)) {
     return absl::get<OrientOperation>(operation).to_orientation;
   }
-  return buffer.orientation();
+  return orientation;
 }
 
 FrameBuffer::Format FrameBufferUtils::GetFormat(
-    const FrameBuffer& buffer, const FrameBufferOperation& operation) {
+    FrameBuffer::Format format, const FrameBufferOperation& operation) {
   if (absl::holds_alternative<ConvertOperation>(operation)) {
     return absl::get<ConvertOperation>(operation).to_format;
   }
-  return buffer.format();
+  return format;
 }
 
 absl::Status FrameBufferUtils::Execute(const FrameBuffer& buffer,
@@ -397,11 +991,18 @@ absl::Status FrameBufferUtils::Execute(const FrameBuffer& buffer,
         Crop(buffer, params.crop_origin_x, params.crop_origin_y,
              (params.crop_dimension.width + params.crop_origin_x - 1),
              (params.crop_dimension.height + params.crop_origin_y - 1),
-             output_buffer));
+             output_buffer, params.interpolation));
   } else if (absl::holds_alternative<ConvertOperation>(operation)) {
     RETURN_IF_ERROR(Convert(buffer, output_buffer));
   } else if (absl::holds_alternative<OrientOperation>(operation)) {
     RETURN_IF_ERROR(Orient(buffer, output_buffer));
+  } else if (absl::holds_alternative<LetterboxOperation>(operation)) {
+    const auto& params = absl::get<LetterboxOperation>(operation);
+    RETURN_IF_ERROR(
+        Letterbox(buffer, params.crop_origin_x, params.crop_origin_y,
+                  (params.crop_dimension.width + params.crop_origin_x - 1),
+                  (params.crop_dimension.height + params.crop_origin_y - 1),
+                  params.padding_value, output_buffer, params.interpolation));
   } else {
     return absl::UnimplementedError(absl::StrFormat(
         "FrameBufferOperation %i is not supported.", operation.index()));
@@ -410,34 +1011,327 @@ absl::Status FrameBufferUtils::Execute(const FrameBuffer& buffer,
 }
 
 absl::Status FrameBufferUtils::Resize(const FrameBuffer& buffer,
-                                      FrameBuffer* output_buffer) {
+                                      FrameBuffer* output_buffer,
+                                      InterpolationMethod interpolation) {
   TFLITE_DCHECK(utils_ != nullptr);
-  return utils_->Resize(buffer, output_buffer);
+  if (buffer.dimension() != output_buffer->dimension()) {
+    if (UsesBoxPreReduction(buffer.dimension(), output_buffer->dimension(),
+                            interpolation)) {
+      return ResizeWithBoxPreReduction(buffer, interpolation, output_buffer);
+    }
+    if (interpolation != InterpolationMethod::kBilinear) {
+      return utils_->ResizeWithInterpolation(buffer, interpolation,
+                                             output_buffer);
+    }
+  }
+  if (thread_pool_ == nullptr || !utils_->SupportsResizeRows(buffer.format())) {
+    return utils_->Resize(buffer, output_buffer);
+  }
+  const FrameBuffer::Dimension output_dimension = output_buffer->dimension();
+  return RunInStripes(output_dimension.height, output_dimension.width,
+                      /*row_alignment=*/1, [&](int row_begin, int row_end) {
+                        return utils_->ResizeRows(buffer, row_begin, row_end,
+                                                  output_buffer);
+                      });
+}
+
+absl::Status FrameBufferUtils::ResizeWithBoxPreReduction(
+    const FrameBuffer& buffer, InterpolationMethod interpolation,
+    FrameBuffer* output_buffer) {
+  // Invalid inputs are left to the engine to report.
+  if (!ValidateResizeBufferInputs(buffer, *output_buffer).ok() ||
+      !ValidateBufferPlaneMetadata(buffer).ok()) {
+    return utils_->ResizeWithInterpolation(buffer, interpolation,
+                                           output_buffer);
+  }
+  StatusOr<FrameBuffer> reduced_buffer =
+      BoxPreReduce(buffer, output_buffer->dimension());
+  // The reduced buffer is less than 4 times as large as `output_buffer` along
+  // each axis, so that it isn't reduced any further.
+  absl::Status status =
+      reduced_buffer.ok()
+          ? Resize(reduced_buffer.value(), output_buffer, interpolation)
+          : reduced_buffer.status();
+  reduce_buffer_.ReleaseIfAboveCap();
+  return status;
+}
+
+StatusOr<FrameBuffer> FrameBufferUtils::BoxPreReduce(
+    const FrameBuffer& buffer, FrameBuffer::Dimension output_dimension) {
+  const FrameBuffer::Dimension input_dimension = buffer.dimension();
+  const int factor_x = GetBoxPreReductionFactor(input_dimension.width,
+                                                output_dimension.width);
+  const int factor_y = GetBoxPreReductionFactor(input_dimension.height,
+                                                output_dimension.height);
+  const FrameBuffer::Dimension reduced_dimension = {
+      GetBoxReducedSize(input_dimension.width, factor_x),
+      GetBoxReducedSize(input_dimension.height, factor_y)};
+  uint8* reduced_data = reduce_buffer_.Get(
+      GetFrameBufferByteSize(reduced_dimension, buffer.format()));
+
+  std::vector<FrameBuffer::Plane> reduced_planes;
+  if (IsYuvFormat(buffer.format())) {
+    ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                     FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+    const FrameBuffer::Dimension uv_dimension = {
+        (input_dimension.width + 1) / 2, (input_dimension.height + 1) / 2};
+    const FrameBuffer::Dimension reduced_uv_dimension = {
+        (reduced_dimension.width + 1) / 2, (reduced_dimension.height + 1) / 2};
+    // Chroma is kept interleaved for the kNV12 and kNV21 formats, and planar
+    // for the kYV12 and kYV21 formats, with rows that never overlap.
+    const bool is_nv = buffer.format() == FrameBuffer::Format::kNV12 ||
+                       buffer.format() == FrameBuffer::Format::kNV21;
+    const int uv_pixel_stride = is_nv ? 2 : 1;
+    const int uv_row_stride = reduced_uv_dimension.width * uv_pixel_stride;
+    uint8* y_data = reduced_data;
+    uint8* uv_data =
+        y_data + reduced_dimension.width * reduced_dimension.height;
+    uint8* u_data = uv_data;
+    uint8* v_data =
+        is_nv ? u_data + 1
+              : u_data + reduced_uv_dimension.width *
+                             reduced_uv_dimension.height;
+    if (buffer.format() == FrameBuffer::Format::kNV21 ||
+        buffer.format() == FrameBuffer::Format::kYV12) {
+      std::swap(u_data, v_data);
+    }
+    RETURN_IF_ERROR(RunInStripes(
+        reduced_dimension.height, reduced_dimension.width,
+        /*row_alignment=*/2, [&](int row_begin, int row_end) {
+          RETURN_IF_ERROR(BoxReducePlaneRows(
+              yuv_data.y_buffer, yuv_data.y_row_stride,
+              /*src_pixel_stride=*/1, input_dimension.width,
+              input_dimension.height, /*num_channels=*/1, factor_x, factor_y,
+              y_data, reduced_dimension.width, /*dst_pixel_stride=*/1,
+              row_begin, row_end));
+          const int uv_row_begin = row_begin / 2;
+          const int uv_row_end = (row_end + 1) / 2;
+          if (is_nv) {
+            // Interleaved chroma is reduced in a single pass, as 2 channels
+            // stored in the same order as in the source.
+            return BoxReducePlaneRows(
+                std::min(yuv_data.u_buffer, yuv_data.v_buffer),
+                yuv_data.uv_row_stride, yuv_data.uv_pixel_stride,
+                uv_dimension.width, uv_dimension.height, /*num_channels=*/2,
+                factor_x, factor_y, std::min(u_data, v_data), uv_row_stride,
+                uv_pixel_stride, uv_row_begin, uv_row_end);
+          }
+          RETURN_IF_ERROR(BoxReducePlaneRows(
+              yuv_data.u_buffer, yuv_data.uv_row_stride,
+              yuv_data.uv_pixel_stride, uv_dimension.width,
+              uv_dimension.height, /*num_channels=*/1, factor_x, factor_y,
+              u_data, uv_row_stride, uv_pixel_stride, uv_row_begin,
+              uv_row_end));
+          return BoxReducePlaneRows(
+              yuv_data.v_buffer, yuv_data.uv_row_stride,
+              yuv_data.uv_pixel_stride, uv_dimension.width,
+              uv_dimension.height, /*num_channels=*/1, factor_x, factor_y,
+              v_data, uv_row_stride, uv_pixel_stride, uv_row_begin,
+              uv_row_end);
+        }));
+    const FrameBuffer::Plane y_plane = {
+        y_data, /*stride=*/{reduced_dimension.width, /*pixel_stride_bytes=*/1}};
+    const FrameBuffer::Plane u_plane = {
+        u_data, /*stride=*/{uv_row_stride, uv_pixel_stride}};
+    const FrameBuffer::Plane v_plane = {
+        v_data, /*stride=*/{uv_row_stride, uv_pixel_stride}};
+    if (buffer.format() == FrameBuffer::Format::kNV21 ||
+        buffer.format() == FrameBuffer::Format::kYV12) {
+      reduced_planes = {y_plane, v_plane, u_plane};
+    } else {
+      reduced_planes = {y_plane, u_plane, v_plane};
+    }
+  } else if (IsPackedYuv422Format(buffer.format())) {
+    // Luma and chroma samples are reduced separately, in place in the packed
+    // reduced buffer: luma samples are 2 bytes apart, and samples of each
+    // chroma plane a macropixel apart.
+    const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+    const int y_offset = is_yuyv ? 0 : 1;
+    const int u_offset = is_yuyv ? 1 : 0;
+    const int v_offset = u_offset + 2;
+    const FrameBuffer::Plane& plane = buffer.plane(0);
+    const int uv_width = (input_dimension.width + 1) / 2;
+    reduced_planes =
+        GetPlanes(reduced_data, reduced_dimension, buffer.format());
+    const int reduced_row_stride = reduced_planes[0].stride.row_stride_bytes;
+    RETURN_IF_ERROR(RunInStripes(
+        reduced_dimension.height, reduced_dimension.width,
+        /*row_alignment=*/1, [&](int row_begin, int row_end) {
+          RETURN_IF_ERROR(BoxReducePlaneRows(
+              plane.buffer + y_offset, plane.stride.row_stride_bytes,
+              kPackedYuv422PixelBytes, input_dimension.width,
+              input_dimension.height, /*num_channels=*/1, factor_x, factor_y,
+              reduced_data + y_offset, reduced_row_stride,
+              kPackedYuv422PixelBytes, row_begin, row_end));
+          for (const int uv_offset : {u_offset, v_offset}) {
+            RETURN_IF_ERROR(BoxReducePlaneRows(
+                plane.buffer + uv_offset, plane.stride.row_stride_bytes,
+                kPackedYuv422MacropixelBytes, uv_width, input_dimension.height,
+                /*num_channels=*/1, factor_x, factor_y,
+                reduced_data + uv_offset, reduced_row_stride,
+                kPackedYuv422MacropixelBytes, row_begin, row_end));
+          }
+          return absl::OkStatus();
+        }));
+  } else {
+    ASSIGN_OR_RETURN(const int pixel_bytes, GetPixelStrides(buffer.format()));
+    const FrameBuffer::Plane& plane = buffer.plane(0);
+    reduced_planes =
+        GetPlanes(reduced_data, reduced_dimension, buffer.format());
+    RETURN_IF_ERROR(RunInStripes(
+        reduced_dimension.height, reduced_dimension.width,
+        /*row_alignment=*/1, [&](int row_begin, int row_end) {
+          return BoxReducePlaneRows(
+              plane.buffer, plane.stride.row_stride_bytes,
+              plane.stride.pixel_stride_bytes, input_dimension.width,
+              input_dimension.height, /*num_channels=*/pixel_bytes, factor_x,
+              factor_y, reduced_data, reduced_dimension.width * pixel_bytes,
+              /*dst_pixel_stride=*/pixel_bytes, row_begin, row_end);
+        }));
+  }
+  return FrameBuffer(std::move(reduced_planes), reduced_dimension,
+                     buffer.format(), buffer.orientation(), buffer.timestamp());
 }
 
 absl::Status FrameBufferUtils::Rotate(const FrameBuffer& buffer,
                                       RotationDegree rotation,
                                       FrameBuffer* output_buffer) {
   TFLITE_DCHECK(utils_ != nullptr);
-  return utils_->Rotate(buffer, 90 * static_cast<int>(rotation), output_buffer);
+  const int angle_deg = 90 * static_cast<int>(rotation);
+  if (thread_pool_ == nullptr || !HasDisjointRows(*output_buffer) ||
+      buffer.format() != output_buffer->format()) {
+    return utils_->Rotate(buffer, angle_deg, output_buffer);
+  }
+  const FrameBuffer::Dimension input_dimension = buffer.dimension();
+  const FrameBuffer::Dimension output_dimension = output_buffer->dimension();
+  const bool is_yuv = IsYuvFormat(buffer.format());
+  const int row_alignment = is_yuv ? 2 : 1;
+  if (angle_deg == 180 && input_dimension == output_dimension &&
+      !(is_yuv && input_dimension.height % 2 != 0)) {
+    // Output rows [row_begin, row_end) come from input rows [height - row_end,
+    // height - row_begin).
+    return RunInStripes(
+        output_dimension.height, output_dimension.width, row_alignment,
+        [&](int row_begin, int row_end) {
+          const FrameBuffer::Dimension stripe_dimension = {
+              output_dimension.width, row_end - row_begin};
+          ASSIGN_OR_RETURN(
+              FrameBuffer input_stripe,
+              GetSubFrameBuffer(buffer, 0, input_dimension.height - row_end,
+                                stripe_dimension));
+          ASSIGN_OR_RETURN(FrameBuffer output_stripe,
+                           GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                             stripe_dimension));
+          return utils_->Rotate(input_stripe, angle_deg, &output_stripe);
+        });
+  }
+  // Input columns can't be split between macropixels for packed YUV 4:2:2
+  // formats.
+  if ((angle_deg == 90 || angle_deg == 270) &&
+      input_dimension.width == output_dimension.height &&
+      input_dimension.height == output_dimension.width &&
+      !(is_yuv && input_dimension.width % 2 != 0) &&
+      !IsPackedYuv422Format(buffer.format())) {
+    // Output rows [row_begin, row_end) come from input columns [width -
+    // row_end, width - row_begin) when rotating by 90 degrees, or [row_begin,
+    // row_end) when rotating by 270 degrees.
+    return RunInStripes(
+        output_dimension.height, output_dimension.width, row_alignment,
+        [&](int row_begin, int row_end) {
+          const int x = angle_deg == 90 ? input_dimension.width - row_end
+                                        : row_begin;
+          ASSIGN_OR_RETURN(
+              FrameBuffer input_stripe,
+              GetSubFrameBuffer(buffer, x, 0,
+                                {row_end - row_begin, input_dimension.height}));
+          ASSIGN_OR_RETURN(
+              FrameBuffer output_stripe,
+              GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                {output_dimension.width, row_end - row_begin}));
+          return utils_->Rotate(input_stripe, angle_deg, &output_stripe);
+        });
+  }
+  return utils_->Rotate(buffer, angle_deg, output_buffer);
 }
 
 absl::Status FrameBufferUtils::FlipHorizontally(const FrameBuffer& buffer,
                                                 FrameBuffer* output_buffer) {
   TFLITE_DCHECK(utils_ != nullptr);
-  return utils_->FlipHorizontally(buffer, output_buffer);
+  if (thread_pool_ == nullptr || !HasDisjointRows(*output_buffer) ||
+      !ValidateFlipBufferInputs(buffer, *output_buffer).ok()) {
+    return utils_->FlipHorizontally(buffer, output_buffer);
+  }
+  const FrameBuffer::Dimension dimension = buffer.dimension();
+  return RunInStripes(
+      dimension.height, dimension.width,
+      IsYuvFormat(buffer.format()) ? 2 : 1, [&](int row_begin, int row_end) {
+        const FrameBuffer::Dimension stripe_dimension = {dimension.width,
+                                                         row_end - row_begin};
+        ASSIGN_OR_RETURN(
+            FrameBuffer input_stripe,
+            GetSubFrameBuffer(buffer, 0, row_begin, stripe_dimension));
+        ASSIGN_OR_RETURN(FrameBuffer output_stripe,
+                         GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                           stripe_dimension));
+        return utils_->FlipHorizontally(input_stripe, &output_stripe);
+      });
 }
 
 absl::Status FrameBufferUtils::FlipVertically(const FrameBuffer& buffer,
                                               FrameBuffer* output_buffer) {
   TFLITE_DCHECK(utils_ != nullptr);
-  return utils_->FlipVertically(buffer, output_buffer);
+  const FrameBuffer::Dimension dimension = buffer.dimension();
+  const bool is_yuv = IsYuvFormat(buffer.format());
+  if (thread_pool_ == nullptr || !HasDisjointRows(*output_buffer) ||
+      !ValidateFlipBufferInputs(buffer, *output_buffer).ok() ||
+      (is_yuv && dimension.height % 2 != 0)) {
+    return utils_->FlipVertically(buffer, output_buffer);
+  }
+  // Output rows [row_begin, row_end) come from input rows [height - row_end,
+  // height - row_begin).
+  return RunInStripes(
+      dimension.height, dimension.width, is_yuv ? 2 : 1,
+      [&](int row_begin, int row_end) {
+        const FrameBuffer::Dimension stripe_dimension = {dimension.width,
+                                                         row_end - row_begin};
+        ASSIGN_OR_RETURN(FrameBuffer input_stripe,
+                         GetSubFrameBuffer(buffer, 0,
+                                           dimension.height - row_end,
+                                           stripe_dimension));
+        ASSIGN_OR_RETURN(FrameBuffer output_stripe,
+                         GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                           stripe_dimension));
+        return utils_->FlipVertically(input_stripe, &output_stripe);
+      });
 }
 
 absl::Status FrameBufferUtils::Convert(const FrameBuffer& buffer,
                                        FrameBuffer* output_buffer) {
   TFLITE_DCHECK(utils_ != nullptr);
-  return utils_->Convert(buffer, output_buffer);
+  const FrameBuffer::Dimension dimension = buffer.dimension();
+  if (thread_pool_ == nullptr || !HasDisjointRows(*output_buffer) ||
+      output_buffer->dimension() != dimension) {
+    return utils_->Convert(buffer, output_buffer);
+  }
+  // Chroma is subsampled by pairs of rows in YUV formats, so stripes must start
+  // on even rows if either side is YUV.
+  const int row_alignment = IsYuvFormat(buffer.format()) ||
+                                    IsYuvFormat(output_buffer->format())
+                                ? 2
+                                : 1;
+  return RunInStripes(
+      dimension.height, dimension.width, row_alignment,
+      [&](int row_begin, int row_end) {
+        const FrameBuffer::Dimension stripe_dimension = {dimension.width,
+                                                         row_end - row_begin};
+        ASSIGN_OR_RETURN(
+            FrameBuffer input_stripe,
+            GetSubFrameBuffer(buffer, 0, row_begin, stripe_dimension));
+        ASSIGN_OR_RETURN(FrameBuffer output_stripe,
+                         GetSubFrameBuffer(*output_buffer, 0, row_begin,
+                                           stripe_dimension));
+        return utils_->Convert(input_stripe, &output_stripe);
+      });
 }
 
 absl::Status FrameBufferUtils::Orient(const FrameBuffer& buffer,
@@ -449,169 +1343,607 @@ absl::Status FrameBufferUtils::Orient(const FrameBuffer& buffer,
   if (params.rotation_angle_deg == 0 && !params.flip.has_value()) {
     // If no rotation or flip is needed, we will copy the buffer to
     // output_buffer.
-    return utils_->Resize(buffer, output_buffer);
+    return Resize(buffer, output_buffer);
   }
 
   if (params.rotation_angle_deg == 0) {
     // Only perform flip operation.
     switch (*params.flip) {
       case OrientParams::FlipType::kHorizontal:
-        return utils_->FlipHorizontally(buffer, output_buffer);
+        return FlipHorizontally(buffer, output_buffer);
       case OrientParams::FlipType::kVertical:
-        return utils_->FlipVertically(buffer, output_buffer);
+        return FlipVertically(buffer, output_buffer);
     }
   }
 
   if (!params.flip.has_value()) {
     // Only perform rotation operation.
-    return utils_->Rotate(buffer, params.rotation_angle_deg, output_buffer);
+    return Rotate(buffer,
+                  static_cast<RotationDegree>(params.rotation_angle_deg / 90),
+                  output_buffer);
   }
 
   // Perform rotation and flip operations.
-  // Create a temporary buffer to hold the rotation result.
-  auto tmp_buffer = absl::make_unique<uint8[]>(
+  // Use a scratch buffer to hold the rotation result.
+  uint8* tmp_buffer = orient_buffer_.Get(
       GetBufferByteSize(output_buffer->dimension(), output_buffer->format()));
-  auto tmp_frame_buffer = FrameBuffer::Create(
-      GetPlanes(tmp_buffer.get(), output_buffer->dimension(),
+  FrameBuffer tmp_frame_buffer(
+      GetPlanes(tmp_buffer, output_buffer->dimension(),
                 output_buffer->format()),
-      output_buffer->dimension(), buffer.format(), buffer.orientation());
+      output_buffer->dimension(), buffer.format(), buffer.orientation(),
+      buffer.timestamp());
 
-  RETURN_IF_ERROR(utils_->Rotate(buffer, params.rotation_angle_deg,
-                                 tmp_frame_buffer.get()));
-  if (params.flip == OrientParams::FlipType::kHorizontal) {
-    return utils_->FlipHorizontally(*tmp_frame_buffer, output_buffer);
-  } else {
-    return utils_->FlipVertically(*tmp_frame_buffer, output_buffer);
+  absl::Status status = Rotate(
+      buffer, static_cast<RotationDegree>(params.rotation_angle_deg / 90),
+      &tmp_frame_buffer);
+  if (status.ok()) {
+    if (params.flip == OrientParams::FlipType::kHorizontal) {
+      status = FlipHorizontally(tmp_frame_buffer, output_buffer);
+    } else {
+      status = FlipVertically(tmp_frame_buffer, output_buffer);
+    }
+  }
+  orient_buffer_.ReleaseIfAboveCap();
+  return status;
+}
+
+absl::Status FrameBufferUtils::CropResizeAndOrient(
+    const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
+    FrameBuffer* output_buffer) {
+  RETURN_IF_ERROR(
+      ValidateCropBufferInputs(buffer, *output_buffer, x0, y0, x1, y1));
+  RETURN_IF_ERROR(ValidateBufferPlaneMetadata(buffer));
+  RETURN_IF_ERROR(ValidateBufferPlaneMetadata(*output_buffer));
+  const OrientParams params =
+      GetOrientParams(buffer.orientation(), output_buffer->orientation());
+  FrameBuffer::Dimension resize_dimension = output_buffer->dimension();
+  if (params.rotation_angle_deg == 90 || params.rotation_angle_deg == 270) {
+    resize_dimension.Swap();
+  }
+  const FrameBuffer::Dimension crop_dimension = {x1 - x0 + 1, y1 - y0 + 1};
+  ASSIGN_OR_RETURN(const FrameBuffer cropped_buffer,
+                   GetSubFrameBuffer(buffer, x0, y0, crop_dimension));
+  if (!UsesBoxPreReduction(crop_dimension, resize_dimension,
+                           InterpolationMethod::kBilinear)) {
+    return ResizeAndOrient(cropped_buffer, params, output_buffer);
   }
+  StatusOr<FrameBuffer> reduced_buffer =
+      BoxPreReduce(cropped_buffer, resize_dimension);
+  absl::Status status =
+      reduced_buffer.ok()
+          ? ResizeAndOrient(reduced_buffer.value(), params, output_buffer)
+          : reduced_buffer.status();
+  reduce_buffer_.ReleaseIfAboveCap();
+  return status;
+}
+
+absl::Status FrameBufferUtils::ResizeAndOrient(const FrameBuffer& buffer,
+                                               const OrientParams& params,
+                                               FrameBuffer* output_buffer) {
+  const PlaneOrientation orientation = GetPlaneOrientation(params);
+  const FrameBuffer::Dimension input_dimension = buffer.dimension();
+  const FrameBuffer::Dimension output_dimension = output_buffer->dimension();
+  if (IsYuvFormat(buffer.format())) {
+    ASSIGN_OR_RETURN(const FrameBuffer::YuvData input_data,
+                     FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+    ASSIGN_OR_RETURN(const FrameBuffer::YuvData output_data,
+                     FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+    const FrameBuffer::Dimension input_uv_dimension = {
+        (input_dimension.width + 1) / 2, (input_dimension.height + 1) / 2};
+    const FrameBuffer::Dimension output_uv_dimension = {
+        (output_dimension.width + 1) / 2, (output_dimension.height + 1) / 2};
+    // Interleaved chroma stored in the same order in both buffers is resampled
+    // in a single pass, as 2 channels.
+    const bool is_input_interleaved =
+        input_data.uv_pixel_stride == 2 &&
+        std::abs(input_data.u_buffer - input_data.v_buffer) == 1;
+    const bool is_output_interleaved =
+        output_data.uv_pixel_stride == 2 &&
+        std::abs(output_data.u_buffer - output_data.v_buffer) == 1;
+    const bool resample_interleaved =
+        is_input_interleaved && is_output_interleaved &&
+        (input_data.u_buffer < input_data.v_buffer) ==
+            (output_data.u_buffer < output_data.v_buffer);
+    uint8* output_u = const_cast<uint8*>(output_data.u_buffer);
+    uint8* output_v = const_cast<uint8*>(output_data.v_buffer);
+    return RunInStripes(
+        output_dimension.height, output_dimension.width,
+        /*row_alignment=*/2, [&](int row_begin, int row_end) {
+          RETURN_IF_ERROR(ResizeAndOrientPlaneBilinearRows(
+              input_data.y_buffer, input_data.y_row_stride,
+              /*src_pixel_stride=*/1, input_dimension.width,
+              input_dimension.height, /*num_channels=*/1, orientation,
+              const_cast<uint8*>(output_data.y_buffer),
+              output_data.y_row_stride, /*dst_pixel_stride=*/1,
+              output_dimension.width, output_dimension.height, row_begin,
+              row_end));
+          const int uv_row_begin = row_begin / 2;
+          const int uv_row_end = (row_end + 1) / 2;
+          if (resample_interleaved) {
+            return ResizeAndOrientPlaneBilinearRows(
+                std::min(input_data.u_buffer, input_data.v_buffer),
+                input_data.uv_row_stride, input_data.uv_pixel_stride,
+                input_uv_dimension.width, input_uv_dimension.height,
+                /*num_channels=*/2, orientation, std::min(output_u, output_v),
+                output_data.uv_row_stride, output_data.uv_pixel_stride,
+                output_uv_dimension.width, output_uv_dimension.height,
+                uv_row_begin, uv_row_end);
+          }
+          RETURN_IF_ERROR(ResizeAndOrientPlaneBilinearRows(
+              input_data.u_buffer, input_data.uv_row_stride,
+              input_data.uv_pixel_stride, input_uv_dimension.width,
+              input_uv_dimension.height, /*num_channels=*/1, orientation,
+              output_u, output_data.uv_row_stride, output_data.uv_pixel_stride,
+              output_uv_dimension.width, output_uv_dimension.height,
+              uv_row_begin, uv_row_end));
+          return ResizeAndOrientPlaneBilinearRows(
+              input_data.v_buffer, input_data.uv_row_stride,
+              input_data.uv_pixel_stride, input_uv_dimension.width,
+              input_uv_dimension.height, /*num_channels=*/1, orientation,
+              output_v, output_data.uv_row_stride, output_data.uv_pixel_stride,
+              output_uv_dimension.width, output_uv_dimension.height,
+              uv_row_begin, uv_row_end);
+        });
+  }
+  ASSIGN_OR_RETURN(const int pixel_bytes, GetPixelStrides(buffer.format()));
+  const FrameBuffer::Plane& input_plane = buffer.plane(0);
+  const FrameBuffer::Plane& output_plane = output_buffer->plane(0);
+  return RunInStripes(
+      output_dimension.height, output_dimension.width,
+      /*row_alignment=*/1, [&](int row_begin, int row_end) {
+        return ResizeAndOrientPlaneBilinearRows(
+            input_plane.buffer, input_plane.stride.row_stride_bytes,
+            input_plane.stride.pixel_stride_bytes, input_dimension.width,
+            input_dimension.height, /*num_channels=*/pixel_bytes, orientation,
+            const_cast<uint8*>(output_plane.buffer),
+            output_plane.stride.row_stride_bytes,
+            output_plane.stride.pixel_stride_bytes, output_dimension.width,
+            output_dimension.height, row_begin, row_end);
+      });
 }
 
 absl::Status FrameBufferUtils::Execute(
     const FrameBuffer& buffer,
     const std::vector<FrameBufferOperation>& operations,
     FrameBuffer* output_buffer) {
-  // Reference variables to swapping input and output buffers for each command.
-  FrameBuffer input_frame_buffer = buffer;
-  FrameBuffer temp_frame_buffer = buffer;
+  absl::Status status = ExecuteOperations(buffer, operations, output_buffer);
+  ReleaseScratchBuffersAboveCap();
+  return status;
+}
 
-  // Temporary buffers and its size to hold intermediate results.
-  int buffer1_size = 0;
-  int buffer2_size = 0;
-  std::unique_ptr<uint8[]> buffer1;
-  std::unique_ptr<uint8[]> buffer2;
+absl::Status FrameBufferUtils::ExecuteOperations(
+    const FrameBuffer& buffer,
+    const std::vector<FrameBufferOperation>& operations,
+    FrameBuffer* output_buffer) {
+  std::vector<PreprocessPlan::Step> steps;
+  RETURN_IF_ERROR(CompileSteps(buffer, operations, *output_buffer, &steps));
+  return RunSteps(buffer, operations, &steps, output_buffer);
+}
+
+absl::Status FrameBufferUtils::CompileSteps(
+    const FrameBuffer& buffer,
+    const std::vector<FrameBufferOperation>& operations,
+    const FrameBuffer& output_buffer,
+    std::vector<PreprocessPlan::Step>* steps) {
+  steps->clear();
+  // Metadata of the input of each command: the first command's input is
+  // always `buffer`, the other ones the previous command's output.
+  FrameBuffer::Dimension dimension = buffer.dimension();
+  FrameBuffer::Format format = buffer.format();
+  FrameBuffer::Orientation orientation = buffer.orientation();
+  bool has_disjoint_rows = HasDisjointRows(buffer);
+  // Index of the scratch buffer holding the next intermediate result.
+  int scratch_index = 0;
 
   for (int i = 0; i < operations.size(); i++) {
     const FrameBufferOperation& operation = operations[i];
 
-    // The first command's input is always passed in `buffer`. Before
-    // process each command, the input_frame_buffer is pointed at the previous
-    // command's output buffer.
-    if (i == 0) {
-      input_frame_buffer = buffer;
-    } else {
-      input_frame_buffer = temp_frame_buffer;
+    // A crop / resize command directly followed by an orientation command is
+    // performed in a single pass when enabled and possible, resampling the
+    // input through the orientation transform.
+    bool is_oriented_crop_resize = false;
+    if (fuse_resize_and_orient_ && i + 1 < operations.size() &&
+        absl::holds_alternative<CropResizeOperation>(operation) &&
+        absl::holds_alternative<OrientOperation>(operations[i + 1])) {
+      const auto& params = absl::get<CropResizeOperation>(operation);
+      is_oriented_crop_resize =
+          SupportsCropResizeAndOrient(format, has_disjoint_rows,
+                                      params.crop_dimension,
+                                      params.resize_dimension,
+                                      params.interpolation) &&
+          (i + 2 < operations.size() || HasDisjointRows(output_buffer));
     }
+    const FrameBufferOperation& last_operation =
+        is_oriented_crop_resize ? operations[i + 1] : operation;
 
     // Calculates the resulting metadata from the command and the input.
-    FrameBuffer::Dimension new_size = GetSize(input_frame_buffer, operation);
-    FrameBuffer::Orientation new_orientation =
-        GetOrientation(input_frame_buffer, operation);
-    FrameBuffer::Format new_format = GetFormat(input_frame_buffer, operation);
-    int byte_size = GetBufferByteSize(new_size, new_format);
+    PreprocessPlan::Step step;
+    step.operation_index = i;
+    step.is_oriented_crop_resize = is_oriented_crop_resize;
+    step.dimension = GetSize(dimension, orientation, operation);
+    step.orientation = GetOrientation(orientation, last_operation);
+    step.format = GetFormat(format, operation);
+    if (is_oriented_crop_resize &&
+        RequireDimensionSwap(orientation, step.orientation)) {
+      step.dimension.Swap();
+    }
+    step.byte_size = GetBufferByteSize(step.dimension, step.format);
 
     // The last command's output buffer is always passed in `output_buffer`.
-    // For other commands, we create temporary FrameBuffer for processing.
-    if ((i + 1) == operations.size()) {
-      temp_frame_buffer = *output_buffer;
+    // For other commands, we use scratch buffers for processing.
+    if (&last_operation == &operations.back()) {
+      step.scratch_index = -1;
       // Validate the `output_buffer` metadata mathes with command line chain
       // resulting metadata.
-      if (temp_frame_buffer.format() != new_format ||
-          temp_frame_buffer.orientation() != new_orientation ||
-          temp_frame_buffer.dimension() != new_size) {
+      if (output_buffer.format() != step.format ||
+          output_buffer.orientation() != step.orientation ||
+          output_buffer.dimension() != step.dimension) {
         return absl::InvalidArgumentError(
             "The output metadata does not match pipeline result metadata.");
       }
     } else {
-      // Create a temporary buffer to hold intermediate results. For simplicity,
-      // we only create one continuous memory with no padding for intermediate
+      // Use a scratch buffer to hold intermediate results. For simplicity, we
+      // only use one continuous memory with no padding for intermediate
       // results.
       //
-      // We hold maximum 2 temporary buffers in memory at any given time.
+      // We hold maximum 2 scratch buffers in memory at any given time.
       //
       // The pipeline is a linear chain. The output buffer from previous command
-      // becomes the input buffer for the next command. We simply use odd / even
-      // index to swap between buffers.
-      std::vector<FrameBuffer::Plane> planes;
-      if (i % 2 == 0) {
-        if (buffer1_size < byte_size) {
-          buffer1_size = byte_size;
-          buffer1 = absl::make_unique<uint8[]>(byte_size);
-        }
-        planes = GetPlanes(buffer1.get(), new_size, new_format);
-      } else {
-        if (buffer2_size < byte_size) {
-          buffer2_size = byte_size;
-          buffer2 = absl::make_unique<uint8[]>(byte_size);
-        }
-        planes = GetPlanes(buffer2.get(), new_size, new_format);
-      }
-      if (planes.empty()) {
-        return absl::InternalError("Failed to construct temporary buffer.");
-      }
-      temp_frame_buffer = FrameBuffer(planes, new_size, new_format,
-                                      new_orientation, buffer.timestamp());
+      // becomes the input buffer for the next command. We simply alternate
+      // between the two buffers.
+      step.scratch_index = scratch_index;
+      scratch_index = 1 - scratch_index;
+    }
+    dimension = step.dimension;
+    format = step.format;
+    orientation = step.orientation;
+    // Intermediate results are laid out by `GetPlanes`, with disjoint rows.
+    has_disjoint_rows = true;
+    steps->push_back(std::move(step));
+    if (is_oriented_crop_resize) {
+      // The orientation command is performed as well.
+      ++i;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FrameBufferUtils::RunSteps(
+    const FrameBuffer& buffer,
+    const std::vector<FrameBufferOperation>& operations,
+    std::vector<PreprocessPlan::Step>* steps, FrameBuffer* output_buffer) {
+  // Allocate the scratch buffers once for all the steps, and lay out the
+  // intermediate results again if they moved.
+  int scratch_byte_sizes[2] = {0, 0};
+  for (const PreprocessPlan::Step& step : *steps) {
+    if (step.scratch_index >= 0) {
+      int& byte_size = scratch_byte_sizes[step.scratch_index];
+      byte_size = std::max(byte_size, step.byte_size);
+    }
+  }
+  uint8* scratch_data[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2; ++i) {
+    if (scratch_byte_sizes[i] > 0) {
+      scratch_data[i] = execute_buffers_[i].Get(scratch_byte_sizes[i]);
     }
-    RETURN_IF_ERROR(Execute(input_frame_buffer, operation, &temp_frame_buffer));
+  }
+  for (PreprocessPlan::Step& step : *steps) {
+    if (step.scratch_index < 0 ||
+        (step.result != nullptr &&
+         step.scratch_data == scratch_data[step.scratch_index])) {
+      continue;
+    }
+    std::vector<FrameBuffer::Plane> planes = GetPlanes(
+        scratch_data[step.scratch_index], step.dimension, step.format);
+    if (planes.empty()) {
+      return absl::InternalError("Failed to construct temporary buffer.");
+    }
+    step.scratch_data = scratch_data[step.scratch_index];
+    step.result = absl::make_unique<FrameBuffer>(
+        planes, step.dimension, step.format, step.orientation,
+        buffer.timestamp());
+  }
+
+  // Reference to the input buffer of each command.
+  const FrameBuffer* input_frame_buffer = &buffer;
+  for (PreprocessPlan::Step& step : *steps) {
+    FrameBuffer* result =
+        step.scratch_index < 0 ? output_buffer : step.result.get();
+    const FrameBufferOperation& operation = operations[step.operation_index];
+    if (step.is_oriented_crop_resize) {
+      const auto& params = absl::get<CropResizeOperation>(operation);
+      RETURN_IF_ERROR(CropResizeAndOrient(
+          *input_frame_buffer, params.crop_origin_x, params.crop_origin_y,
+          params.crop_dimension.width + params.crop_origin_x - 1,
+          params.crop_dimension.height + params.crop_origin_y - 1, result));
+    } else {
+      RETURN_IF_ERROR(Execute(*input_frame_buffer, operation, result));
+    }
+    input_frame_buffer = result;
   }
   return absl::OkStatus();
 }
 
+void FrameBufferUtils::SetMaxRetainedScratchBytes(size_t max_retained_bytes) {
+  for (ScratchArena& arena : execute_buffers_) {
+    arena.set_max_retained_bytes(max_retained_bytes);
+  }
+  orient_buffer_.set_max_retained_bytes(max_retained_bytes);
+  reduce_buffer_.set_max_retained_bytes(max_retained_bytes);
+  crop_buffer_.set_max_retained_bytes(max_retained_bytes);
+  batch_buffer_.set_max_retained_bytes(max_retained_bytes);
+  ReleaseScratchBuffersAboveCap();
+  batch_buffer_.ReleaseIfAboveCap();
+}
+
+void FrameBufferUtils::TrimScratchBuffers() {
+  // The cached plan refers to the scratch buffers.
+  preprocess_plan_.reset();
+  for (ScratchArena& arena : execute_buffers_) {
+    arena.Trim();
+  }
+  orient_buffer_.Trim();
+  reduce_buffer_.Trim();
+  crop_buffer_.Trim();
+  batch_buffer_.Trim();
+}
+
+void FrameBufferUtils::SetFuseResizeAndOrient(bool fuse_resize_and_orient) {
+  // The cached plan was compiled for the previous setting.
+  preprocess_plan_.reset();
+  fuse_resize_and_orient_ = fuse_resize_and_orient;
+}
+
+void FrameBufferUtils::ReleaseScratchBuffersAboveCap() {
+  for (ScratchArena& arena : execute_buffers_) {
+    arena.ReleaseIfAboveCap();
+  }
+  orient_buffer_.ReleaseIfAboveCap();
+  reduce_buffer_.ReleaseIfAboveCap();
+  crop_buffer_.ReleaseIfAboveCap();
+}
+
 absl::Status FrameBufferUtils::Preprocess(
     const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
-    FrameBuffer* output_buffer) {
-  std::vector<FrameBufferOperation> frame_buffer_operations;
+    FrameBuffer* output_buffer, InterpolationMethod interpolation) {
+  return PreprocessImpl(buffer, bounding_box,
+                        /*letterbox_padding_value=*/absl::nullopt,
+                        output_buffer, interpolation);
+}
+
+absl::Status FrameBufferUtils::PreprocessWithLetterbox(
+    const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
+    uint8 padding_value, FrameBuffer* output_buffer,
+    InterpolationMethod interpolation) {
+  return PreprocessImpl(buffer, bounding_box, padding_value, output_buffer,
+                        interpolation);
+}
+
+absl::Status FrameBufferUtils::PreprocessImpl(
+    const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
+    absl::optional<uint8> letterbox_padding_value, FrameBuffer* output_buffer,
+    InterpolationMethod interpolation) {
+  if (preprocess_plan_ == nullptr ||
+      !preprocess_plan_->Matches(buffer, bounding_box, letterbox_padding_value,
+                                 *output_buffer, interpolation)) {
+    // Drop the previous plan first, as it may be invalid.
+    preprocess_plan_.reset();
+    ASSIGN_OR_RETURN(preprocess_plan_,
+                     CompilePreprocessPlan(buffer, bounding_box,
+                                           letterbox_padding_value,
+                                           *output_buffer, interpolation));
+  }
+  return ExecutePreprocessPlan(buffer, preprocess_plan_.get(), output_buffer);
+}
+
+StatusOr<std::unique_ptr<PreprocessPlan>>
+FrameBufferUtils::CompilePreprocessPlan(
+    const FrameBuffer& input_buffer, absl::optional<BoundingBox> bounding_box,
+    absl::optional<uint8> letterbox_padding_value,
+    const FrameBuffer& output_buffer, InterpolationMethod interpolation) {
+  std::unique_ptr<PreprocessPlan> plan = absl::WrapUnique(new PreprocessPlan);
+  plan->input_signature_ = PreprocessPlan::BufferSignature::Of(input_buffer);
+  plan->output_signature_ = PreprocessPlan::BufferSignature::Of(output_buffer);
+  plan->bounding_box_ = bounding_box;
+  plan->letterbox_padding_value_ = letterbox_padding_value;
+  plan->interpolation_ = interpolation;
+
+  // The grayscale conversion of YUV buffers copies their luma plane: only
+  // process this plane, as a grayscale buffer.
+  plan->uses_luma_plane_ =
+      UsesLumaPlane(input_buffer.format(), output_buffer.format());
+  absl::optional<FrameBuffer> luma_buffer;
+  if (plan->uses_luma_plane_) {
+    ASSIGN_OR_RETURN(luma_buffer, GetLumaFrameBuffer(input_buffer));
+  }
+  const FrameBuffer& buffer =
+      luma_buffer.has_value() ? luma_buffer.value() : input_buffer;
+
+  std::vector<FrameBufferOperation>& frame_buffer_operations =
+      plan->operations_;
   // Handle cropping and resizing.
   bool needs_dimension_swap =
-      RequireDimensionSwap(buffer.orientation(), output_buffer->orientation());
+      RequireDimensionSwap(buffer.orientation(), output_buffer.orientation());
   // For intermediate steps, we need to use dimensions based on the input
   // orientation.
-  FrameBuffer::Dimension pre_orient_dimension = output_buffer->dimension();
+  FrameBuffer::Dimension pre_orient_dimension = output_buffer.dimension();
   if (needs_dimension_swap) {
     pre_orient_dimension.Swap();
   }
 
-  if (bounding_box.has_value()) {
+  if (letterbox_padding_value.has_value()) {
+    // Letterboxing case, which also handles cropping.
+    const BoundingBox region =
+        bounding_box.has_value() ? bounding_box.value() : BoundingBox();
+    const FrameBuffer::Dimension crop_dimension =
+        bounding_box.has_value()
+            ? FrameBuffer::Dimension{region.width(), region.height()}
+            : buffer.dimension();
+    frame_buffer_operations.push_back(LetterboxOperation(
+        region.origin_x(), region.origin_y(), crop_dimension,
+        pre_orient_dimension, letterbox_padding_value.value(), interpolation));
+  } else if (bounding_box.has_value()) {
     // Cropping case.
     frame_buffer_operations.push_back(CropResizeOperation(
         bounding_box.value().origin_x(), bounding_box.value().origin_y(),
         FrameBuffer::Dimension{bounding_box.value().width(),
                                bounding_box.value().height()},
-        pre_orient_dimension));
+        pre_orient_dimension, interpolation));
   } else if (pre_orient_dimension != buffer.dimension()) {
     // Resizing case.
-    frame_buffer_operations.push_back(
-        CropResizeOperation(0, 0, buffer.dimension(), pre_orient_dimension));
+    frame_buffer_operations.push_back(CropResizeOperation(
+        0, 0, buffer.dimension(), pre_orient_dimension, interpolation));
   }
 
-  // Handle color space conversion.
-  if (output_buffer->format() != buffer.format()) {
+  // Handle orientation and color space conversions. The orientation change
+  // is folded into the crop / resize when enabled and supported, which then
+  // comes first so that `Execute` performs both in a single pass. YUV buffers
+  // with odd dimensions are converted before being oriented, as flipping them
+  // shifts the chroma samples with respect to the luma ones.
+  const bool needs_orientation =
+      output_buffer.orientation() != buffer.orientation();
+  bool orient_with_crop_resize = false;
+  if (fuse_resize_and_orient_ && needs_orientation &&
+      !frame_buffer_operations.empty() &&
+      absl::holds_alternative<CropResizeOperation>(
+          frame_buffer_operations.back())) {
+    const auto& params =
+        absl::get<CropResizeOperation>(frame_buffer_operations.back());
+    orient_with_crop_resize =
+        SupportsCropResizeAndOrient(buffer, params.crop_dimension,
+                                    params.resize_dimension,
+                                    params.interpolation) &&
+        (output_buffer.format() == buffer.format() ||
+         !IsYuvFormat(buffer.format()) ||
+         (pre_orient_dimension.width % 2 == 0 &&
+          pre_orient_dimension.height % 2 == 0));
+  }
+  if (orient_with_crop_resize) {
     frame_buffer_operations.push_back(
-        ConvertOperation(output_buffer->format()));
+        OrientOperation(output_buffer.orientation()));
   }
-
-  // Handle orientation conversion.
-  if (output_buffer->orientation() != buffer.orientation()) {
+  if (output_buffer.format() != buffer.format()) {
+    frame_buffer_operations.push_back(
+        ConvertOperation(output_buffer.format()));
+  }
+  if (needs_orientation && !orient_with_crop_resize) {
     frame_buffer_operations.push_back(
-        OrientOperation(output_buffer->orientation()));
+        OrientOperation(output_buffer.orientation()));
   }
 
+  if (!frame_buffer_operations.empty()) {
+    RETURN_IF_ERROR(CompileSteps(buffer, frame_buffer_operations, output_buffer,
+                                 &plan->steps_));
+  }
+  return plan;
+}
+
+absl::Status FrameBufferUtils::ExecutePreprocessPlan(
+    const FrameBuffer& input_buffer, PreprocessPlan* plan,
+    FrameBuffer* output_buffer) {
+  if (!plan->input_signature_.Matches(input_buffer) ||
+      !plan->output_signature_.Matches(*output_buffer)) {
+    return absl::InvalidArgumentError(
+        "The buffers don't match the signature the plan was compiled for.");
+  }
+  absl::optional<FrameBuffer> luma_buffer;
+  if (plan->uses_luma_plane_) {
+    ASSIGN_OR_RETURN(luma_buffer, GetLumaFrameBuffer(input_buffer));
+  }
+  const FrameBuffer& buffer =
+      luma_buffer.has_value() ? luma_buffer.value() : input_buffer;
+
   // Execute the processing pipeline.
-  if (frame_buffer_operations.empty()) {
+  if (plan->operations_.empty()) {
     // Using resize to perform copy.
-    RETURN_IF_ERROR(Resize(buffer, output_buffer));
-  } else {
-    RETURN_IF_ERROR(Execute(buffer, frame_buffer_operations, output_buffer));
+    return Resize(buffer, output_buffer);
   }
-  return absl::OkStatus();
+  absl::Status status =
+      RunSteps(buffer, plan->operations_, &plan->steps_, output_buffer);
+  ReleaseScratchBuffersAboveCap();
+  return status;
+}
+
+absl::Status FrameBufferUtils::PreprocessBatch(
+    const FrameBuffer& buffer, const std::vector<BoundingBox>& bounding_boxes,
+    const std::vector<FrameBuffer*>& output_buffers,
+    InterpolationMethod interpolation) {
+  if (bounding_boxes.size() != output_buffers.size()) {
+    return absl::InvalidArgumentError(
+        "The number of bounding boxes and output buffers must match.");
+  }
+  if (bounding_boxes.empty()) {
+    return absl::OkStatus();
+  }
+  RETURN_IF_ERROR(ValidateBufferFormat(buffer));
+
+  // Compute the region covering all the bounding boxes, and the number of
+  // pixels converted when converting each resized crop.
+  const FrameBuffer::Dimension dimension = buffer.dimension();
+  const FrameBuffer::Format output_format = output_buffers[0]->format();
+  bool has_same_output_format = true;
+  int x0 = dimension.width;
+  int y0 = dimension.height;
+  int x1 = 0;
+  int y1 = 0;
+  int64 num_output_pixels = 0;
+  for (int i = 0; i < bounding_boxes.size(); ++i) {
+    const BoundingBox& box = bounding_boxes[i];
+    if (box.origin_x() < 0 || box.origin_y() < 0 || box.width() <= 0 ||
+        box.height() <= 0 || box.origin_x() + box.width() > dimension.width ||
+        box.origin_y() + box.height() > dimension.height) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Bounding box %d is out of the input buffer bounds.", i));
+    }
+    x0 = std::min(x0, box.origin_x());
+    y0 = std::min(y0, box.origin_y());
+    x1 = std::max(x1, box.origin_x() + box.width());
+    y1 = std::max(y1, box.origin_y() + box.height());
+    num_output_pixels += output_buffers[i]->dimension().Size();
+    has_same_output_format &= output_buffers[i]->format() == output_format;
+  }
+  if (IsYuvFormat(buffer.format())) {
+    // Align the region with the chroma planes.
+    x0 &= ~1;
+    y0 &= ~1;
+  } else if (IsPackedYuv422Format(buffer.format())) {
+    // Align the region with the macropixels.
+    x0 &= ~1;
+  }
+  const FrameBuffer::Dimension region_dimension = {x1 - x0, y1 - y0};
+
+  if (!has_same_output_format || output_format == buffer.format() ||
+      !ValidateConvertFormats(buffer.format(), output_format).ok() ||
+      region_dimension.Size() >= num_output_pixels) {
+    // Converting each resized crop is cheaper.
+    for (int i = 0; i < bounding_boxes.size(); ++i) {
+      RETURN_IF_ERROR(Preprocess(buffer, bounding_boxes[i], output_buffers[i],
+                                 interpolation));
+    }
+    return absl::OkStatus();
+  }
+
+  // Convert the region once, then crop and resize each bounding box from it.
+  ASSIGN_OR_RETURN(const FrameBuffer region,
+                   GetSubFrameBuffer(buffer, x0, y0, region_dimension));
+  std::vector<FrameBuffer::Plane> planes = GetPlanes(
+      batch_buffer_.Get(GetBufferByteSize(region_dimension, output_format)),
+      region_dimension, output_format);
+  if (planes.empty()) {
+    return absl::InternalError("Failed to construct temporary buffer.");
+  }
+  FrameBuffer converted_region(planes, region_dimension, output_format,
+                               buffer.orientation(), buffer.timestamp());
+  absl::Status status = Convert(region, &converted_region);
+  for (int i = 0; status.ok() && i < bounding_boxes.size(); ++i) {
+    BoundingBox box = bounding_boxes[i];
+    box.set_origin_x(box.origin_x() - x0);
+    box.set_origin_y(box.origin_y() - y0);
+    status =
+        Preprocess(converted_region, box, output_buffers[i], interpolation);
+  }
+  batch_buffer_.ReleaseIfAboveCap();
+  return status;
 }
 
 }  // namespace vision
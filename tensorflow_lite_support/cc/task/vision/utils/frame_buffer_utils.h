@@ -16,16 +16,21 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_UTILS_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_UTILS_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
 #include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/thread_pool.h"
 
 namespace tflite {
 namespace task {
@@ -64,6 +69,63 @@ void OrientCoordinates(int from_x, int from_y,
 bool RequireDimensionSwap(FrameBuffer::Orientation from_orientation,
                           FrameBuffer::Orientation to_orientation);
 
+// Returns whether resizing an image of dimension `from_dimension` to
+// `to_dimension` with the given `interpolation` method first reduces it by
+// integer factors with a box filter, to about twice the target dimension. This
+// is the case for kBilinear and kArea interpolation when downscaling by a
+// factor of 4 or more along any axis.
+bool UsesBoxPreReduction(FrameBuffer::Dimension from_dimension,
+                         FrameBuffer::Dimension to_dimension,
+                         InterpolationMethod interpolation);
+
+// Placement of an image resized with its aspect ratio preserved into a larger
+// image (a.k.a. letterboxing): the image is scaled to fit, centered, and the
+// remaining pixels are padded.
+struct LetterboxParams {
+  // Dimension of the scaled image.
+  FrameBuffer::Dimension scaled_dimension;
+  // Position of the top-left corner of the scaled image.
+  int offset_x;
+  int offset_y;
+};
+
+// Returns the placement of an image of dimension `from_dimension` letterboxed
+// into an image of dimension `to_dimension` and format `format`. For YUV
+// formats, offsets are rounded down to even values so that the scaled image
+// is aligned with the chroma planes. For packed YUV 4:2:2 formats, only the
+// horizontal offset is, so that the scaled image starts on a macropixel.
+LetterboxParams GetLetterboxParams(FrameBuffer::Dimension from_dimension,
+                                   FrameBuffer::Dimension to_dimension,
+                                   FrameBuffer::Format format);
+
+// Returns the format of the buffer letterboxed by
+// `FrameBufferUtils::PreprocessWithLetterbox` when pre-processing a buffer of
+// format `input_format` into a buffer of format `output_format`, i.e. the
+// format to pass to `GetLetterboxParams` to locate the scaled region. This is
+// kGRAY for the grayscale conversion of YUV buffers, which only processes their
+// luma plane, and `input_format` otherwise.
+FrameBuffer::Format GetLetterboxFormat(FrameBuffer::Format input_format,
+                                       FrameBuffer::Format output_format);
+
+// Returns the region of the upright (i.e. rotated according to `orientation`)
+// `tensor_dimension` output of `FrameBufferUtils::PreprocessWithLetterbox`
+// covered by a `roi_dimension` region of interest of a buffer of format
+// `input_format` and orientation `orientation`, pre-processed into format
+// `output_format`. The region is in pixels, and is centered in the output.
+BoundingBox GetLetterboxedOutputRegion(FrameBuffer::Dimension roi_dimension,
+                                       FrameBuffer::Format input_format,
+                                       FrameBuffer::Orientation orientation,
+                                       FrameBuffer::Dimension tensor_dimension,
+                                       FrameBuffer::Format output_format);
+
+// Maps the normalized coordinate `value` along an output axis of size
+// `output_size` to the normalized coordinate within the [region_origin,
+// region_origin + region_size) range of this axis, clamped to [0, 1]. Used
+// with `GetLetterboxedOutputRegion` to map coordinates in a letterboxed output
+// back to the upright region of interest.
+float MapToOutputRegion(float value, int output_size, int region_origin,
+                        int region_size);
+
 // Structure to express parameters needed to achieve orientation conversion.
 struct OrientParams {
   // Counterclockwise rotation angle in degrees. This is expressed as a
@@ -91,19 +153,25 @@ OrientParams GetOrientParams(FrameBuffer::Orientation from_orientation,
 //
 // To perform just cropping, the `crop_width` and `crop_height` should be the
 // same as `resize_width` `and resize_height`.
+//
+// The resize is performed with the given `interpolation` method.
 struct CropResizeOperation {
-  CropResizeOperation(int crop_origin_x, int crop_origin_y,
-                      FrameBuffer::Dimension crop_dimension,
-                      FrameBuffer::Dimension resize_dimension)
+  CropResizeOperation(
+      int crop_origin_x, int crop_origin_y,
+      FrameBuffer::Dimension crop_dimension,
+      FrameBuffer::Dimension resize_dimension,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear)
       : crop_origin_x(crop_origin_x),
         crop_origin_y(crop_origin_y),
         crop_dimension(crop_dimension),
-        resize_dimension(resize_dimension) {}
+        resize_dimension(resize_dimension),
+        interpolation(interpolation) {}
 
   int crop_origin_x;
   int crop_origin_y;
   FrameBuffer::Dimension crop_dimension;
   FrameBuffer::Dimension resize_dimension;
+  InterpolationMethod interpolation;
 };
 
 // The parameters needed to convert to the specified format.
@@ -120,10 +188,126 @@ struct OrientOperation {
   FrameBuffer::Orientation to_orientation;
 };
 
+// The parameters needed to crop, then resize with the aspect ratio preserved.
+//
+// The crop region is defined as in `CropResizeOperation`. It is then scaled to
+// fit `letterbox_dimension`, centered, and the remaining pixels are set to the
+// gray level `padding_value`. See `FrameBufferUtils::Letterbox`.
+struct LetterboxOperation {
+  LetterboxOperation(
+      int crop_origin_x, int crop_origin_y,
+      FrameBuffer::Dimension crop_dimension,
+      FrameBuffer::Dimension letterbox_dimension, uint8 padding_value = 0,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear)
+      : crop_origin_x(crop_origin_x),
+        crop_origin_y(crop_origin_y),
+        crop_dimension(crop_dimension),
+        letterbox_dimension(letterbox_dimension),
+        padding_value(padding_value),
+        interpolation(interpolation) {}
+
+  int crop_origin_x;
+  int crop_origin_y;
+  FrameBuffer::Dimension crop_dimension;
+  FrameBuffer::Dimension letterbox_dimension;
+  uint8 padding_value;
+  InterpolationMethod interpolation;
+};
+
 // A variant of the supported operations on FrameBuffers. Alias for user
 // convenience.
 using FrameBufferOperation =
-    absl::variant<CropResizeOperation, ConvertOperation, OrientOperation>;
+    absl::variant<CropResizeOperation, ConvertOperation, OrientOperation,
+                  LetterboxOperation>;
+
+// Compiled form of a `FrameBufferUtils::Preprocess` or
+// `FrameBufferUtils::PreprocessWithLetterbox` call for a given input signature
+// (the dimension, format, orientation and plane strides of the input buffer)
+// and target (the region of interest, letterboxing, interpolation method, and
+// the metadata and plane strides of the output buffer).
+//
+// A plan holds the chain of operations to perform, along with the metadata
+// and memory layout of each intermediate result and the validation of the
+// whole chain, so that executing it on frames matching its signature only
+// performs the pixel processing. Plans are compiled by
+// `FrameBufferUtils::CompilePreprocessPlan`, and executed by
+// `FrameBufferUtils::ExecutePreprocessPlan`. `Preprocess` keeps the plan of
+// its last call, and only compiles a new one when the signature changes, e.g.
+// when the region of interest of a video stream moves.
+//
+// PreprocessPlan is not thread-safe.
+class PreprocessPlan {
+ public:
+  // PreprocessPlan is neither copyable nor movable.
+  PreprocessPlan(const PreprocessPlan&) = delete;
+  PreprocessPlan& operator=(const PreprocessPlan&) = delete;
+
+  // Returns whether the plan was compiled for `buffer`, `output_buffer` and
+  // the given settings, i.e. whether executing it is equivalent to the
+  // corresponding `Preprocess` or `PreprocessWithLetterbox` call.
+  bool Matches(const FrameBuffer& buffer,
+               const absl::optional<BoundingBox>& bounding_box,
+               absl::optional<uint8> letterbox_padding_value,
+               const FrameBuffer& output_buffer,
+               InterpolationMethod interpolation) const;
+
+  // Returns the operations performed by the plan, in this order. If empty,
+  // the input buffer is copied into the output buffer.
+  const std::vector<FrameBufferOperation>& operations() const {
+    return operations_;
+  }
+
+ private:
+  friend class FrameBufferUtils;
+
+  // Metadata and memory layout of a buffer the plan applies to.
+  struct BufferSignature {
+    FrameBuffer::Dimension dimension;
+    FrameBuffer::Format format;
+    FrameBuffer::Orientation orientation;
+    // Row and pixel strides of each plane.
+    std::vector<FrameBuffer::Stride> strides;
+
+    // Returns the signature of `buffer`.
+    static BufferSignature Of(const FrameBuffer& buffer);
+    // Returns whether `buffer` has this signature.
+    bool Matches(const FrameBuffer& buffer) const;
+  };
+
+  // Single pass over the pixels, performing one operation, or a crop / resize
+  // operation and the following orient operation.
+  struct Step {
+    // Index in `operations` of the operation performed by the step.
+    int operation_index;
+    // Whether the step also performs the next operation, an orient operation.
+    bool is_oriented_crop_resize;
+    // Metadata of the result.
+    FrameBuffer::Dimension dimension;
+    FrameBuffer::Format format;
+    FrameBuffer::Orientation orientation;
+    // Index of the `FrameBufferUtils` scratch buffer holding the result, or -1
+    // if the result is written into the output buffer.
+    int scratch_index;
+    // Minimal size in bytes of the scratch buffer.
+    int byte_size;
+    // Intermediate result, laid out in the scratch buffer at `scratch_data`.
+    // Only rebuilt when the scratch buffer is reallocated.
+    const uint8* scratch_data = nullptr;
+    std::unique_ptr<FrameBuffer> result;
+  };
+
+  PreprocessPlan() = default;
+
+  BufferSignature input_signature_;
+  BufferSignature output_signature_;
+  absl::optional<BoundingBox> bounding_box_;
+  absl::optional<uint8> letterbox_padding_value_;
+  InterpolationMethod interpolation_ = InterpolationMethod::kBilinear;
+  // Whether only the luma plane of the (YUV) input buffer is processed.
+  bool uses_luma_plane_ = false;
+  std::vector<FrameBufferOperation> operations_;
+  std::vector<Step> steps_;
+};
 
 // Image processing utility. This utility provides both basic image buffer
 // manipulations (e.g. rotation, format conversion, resizing, etc) as well as
@@ -149,23 +333,68 @@ using FrameBufferOperation =
 //                          /*resize_width=*/10, /*resize_height=*/10),
 //      OrientOperation(FrameBuffer::Orientation::kLeftTop)};
 //  utils->Execute(*input, operations, output.get());
+//
+// Intermediate results are stored in scratch buffers owned by the instance and
+// reused across calls, so that processing same-sized frames does not allocate
+// memory in steady state. As a consequence, a FrameBufferUtils instance must
+// not be used concurrently from multiple threads.
+//
+// When created with more than one thread, crop, resize, convert, rotate and
+// flip operations on large enough images split the output into horizontal
+// stripes processed in parallel. The output is identical to single-threaded
+// processing. Resizing is only parallelized for the formats for which the
+// process engine supports `ResizeRows`.
+//
+// Large downscaling ratios are handled by first reducing the image with a fast
+// integer box filter to about twice the target size, then resizing the reduced
+// image with the requested interpolation method: this avoids the aliasing
+// caused by bilinear interpolation sampling only a fraction of the input
+// pixels, for a fraction of the cost of area interpolation over the whole
+// input. See `UsesBoxPreReduction`.
+//
+// If enabled through `SetFuseResizeAndOrient`, a `CropResizeOperation` using
+// bilinear interpolation directly followed by an `OrientOperation` is
+// performed in a single pass by `Execute`: the resize kernel samples the input
+// through the orientation transform and writes the oriented output directly.
+// This is supported for kRGB, kBGR and the YUV 4:2:0 formats, for which the
+// separate orientation pass would otherwise go through an intermediate format.
 class FrameBufferUtils {
  public:
   // Counter-clockwise rotation in degree.
   enum class RotationDegree { k0 = 0, k90 = 1, k180 = 2, k270 = 3 };
 
-  // Underlying process engine used for performing operations.
+  // Underlying process engine used for performing operations. Each value
+  // corresponds to an engine of the `ProcessEngineRegistry`.
   enum class ProcessEngine {
+    // Engine backed by libyuv.
     kLibyuv,
+    // Engine specializing some of the common paths with portable SIMD code,
+    // delegating to kLibyuv otherwise. See `SimdFrameBufferUtils`.
+    kSimd,
+    // Engine selecting the fastest registered engine for each kind of
+    // operation from a calibration run on first use. See
+    // `AutoFrameBufferUtils`.
+    kAuto,
   };
 
   // Factory method FrameBufferUtils instance. The processing engine is
-  // defined by `engine`.
-  static std::unique_ptr<FrameBufferUtils> Create(ProcessEngine engine) {
-    return absl::make_unique<FrameBufferUtils>(engine);
+  // defined by `engine`. Operations are performed using up to `num_threads`
+  // threads, including the calling thread.
+  static std::unique_ptr<FrameBufferUtils> Create(ProcessEngine engine,
+                                                  int num_threads = 1) {
+    return absl::make_unique<FrameBufferUtils>(engine, num_threads);
   }
 
-  explicit FrameBufferUtils(ProcessEngine engine);
+  // Factory method creating a FrameBufferUtils instance backed by the engine
+  // registered under `engine_name` in the `ProcessEngineRegistry`.
+  static tflite::support::StatusOr<std::unique_ptr<FrameBufferUtils>>
+  CreateWithEngine(const std::string& engine_name, int num_threads = 1);
+
+  explicit FrameBufferUtils(ProcessEngine engine, int num_threads = 1);
+
+  // Creates an instance backed by the given `engine`.
+  explicit FrameBufferUtils(std::unique_ptr<FrameBufferUtilsInterface> engine,
+                            int num_threads = 1);
 
   // Performs cropping operation.
   //
@@ -177,17 +406,42 @@ class FrameBufferUtils {
   // The `output_buffer` should have metadata populated and its backing buffer
   // should be big enough to store the operation result. If the `output_buffer`
   // size dimension does not match with crop dimension, then a resize is
-  // automatically performed.
-  absl::Status Crop(const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
-                    FrameBuffer* output_buffer);
+  // automatically performed, using the given `interpolation` method.
+  absl::Status Crop(
+      const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
+      FrameBuffer* output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
 
-  // Performs resizing operation.
+  // Performs resizing operation, using the given `interpolation` method.
   //
   // The resize dimension is determined based on output_buffer's size metadata.
   //
   // The output_buffer should have metadata populated and its backing buffer
   // should be big enough to store the operation result.
-  absl::Status Resize(const FrameBuffer& buffer, FrameBuffer* output_buffer);
+  absl::Status Resize(
+      const FrameBuffer& buffer, FrameBuffer* output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
+
+  // Performs cropping, then resizing with the aspect ratio preserved (a.k.a.
+  // letterboxing).
+  //
+  // The crop region (x0, y0)-(x1, y1) is defined as in `Crop`. It is scaled
+  // with the given `interpolation` method to fit the `output_buffer`
+  // dimension, and centered as described by `GetLetterboxParams`. The
+  // remaining pixels are set to the gray level `padding_value` (with an opaque
+  // alpha channel for kRGBA and kBGRA). For YUV and packed YUV 4:2:2 formats,
+  // they are set to the corresponding BT.601 luma value and neutral chroma.
+  //
+  // Each output pixel is written exactly once: the crop region is resized
+  // directly into the output buffer, and only the borders are padded.
+  //
+  // The `output_buffer` should have the same format as `buffer`, have
+  // metadata populated and its backing buffer should be big enough to store
+  // the operation result.
+  absl::Status Letterbox(
+      const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
+      uint8 padding_value, FrameBuffer* output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
 
   // Performs rotation operation.
   //
@@ -242,7 +496,11 @@ class FrameBufferUtils {
   //
   // Internally, a chain of operations is constructed. For performance
   // optimization, operations are performed in the following order: crop,
-  // resize, convert color space format, and rotate.
+  // resize, convert color space format, and rotate. If enabled through
+  // `SetFuseResizeAndOrient(true)`, when bilinear resizing is needed and the
+  // format supports it, the rotation and flip are instead folded into the
+  // resize, followed by the color space conversion, so that orienting the
+  // image costs no extra pass nor intermediate buffer.
   //
   // The `output_buffer` should have metadata populated and its backing buffer
   // should be big enough to store the operation result. Insufficient backing
@@ -252,22 +510,103 @@ class FrameBufferUtils {
   // If the `buffer` is already in desired format, then an extra copy will be
   // performed.
   //
+  // Grayscale outputs of YUV buffers (NV12, NV21, YV12, YV21) are computed
+  // from their luma plane alone, without any color conversion. When
+  // letterboxing (see `PreprocessWithLetterbox`), the padding pixels are then
+  // set to the gray level `padding_value` itself.
+  //
   // The input param `bounding_box` is defined in the `buffer` coordinate space.
-  absl::Status Preprocess(const FrameBuffer& buffer,
-                          absl::optional<BoundingBox> bounding_box,
-                          FrameBuffer* output_buffer);
+  //
+  // Resizing uses the given `interpolation` method.
+  absl::Status Preprocess(
+      const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
+      FrameBuffer* output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
+
+  // Same as `Preprocess`, except that the aspect ratio of the cropped region
+  // is preserved by resizing it with a `LetterboxOperation` padding with the
+  // gray level `padding_value`. Letterboxing happens before the color space
+  // conversion and rotation, i.e. within the `output_buffer` dimension swapped
+  // if the orientation requires it.
+  absl::Status PreprocessWithLetterbox(
+      const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
+      uint8 padding_value, FrameBuffer* output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
+
+  // Performs the same operations as `Preprocess` for each of the
+  // `bounding_boxes` of `buffer`, writing the results to the corresponding
+  // `output_buffers`, which must be as many and are typically consecutive
+  // slices of a batched tensor, e.g. created with:
+  //
+  //   CreateFromRawBuffer(tensor_data + i * GetFrameBufferByteSize(
+  //                           dimension, format), dimension, format)
+  //
+  // Each bounding box is processed by a `Preprocess` call, which compiles its
+  // own plan unless the bounding box matches the previous one. If all the
+  // output buffers have the same format, different from the input format, and
+  // the region covering all the bounding boxes has fewer pixels than the
+  // output buffers combined (e.g. many overlapping or upscaled regions), this
+  // region is converted once and shared by all the crops, instead of
+  // converting each resized crop. Results are then those of `Preprocess` on
+  // the converted frame, and may differ from `Preprocess` on `buffer` by
+  // rounding, as the color space conversion happens before resizing.
+  absl::Status PreprocessBatch(
+      const FrameBuffer& buffer, const std::vector<BoundingBox>& bounding_boxes,
+      const std::vector<FrameBuffer*>& output_buffers,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
+
+  // Compiles the operations performed by `Preprocess` (or by
+  // `PreprocessWithLetterbox` if `letterbox_padding_value` is set) on `buffer`
+  // with the given arguments into a plan, which can then be executed on any
+  // frame with the same signature, see `PreprocessPlan`. Returns an error if
+  // the output buffer metadata doesn't match the result of the operations.
+  tflite::support::StatusOr<std::unique_ptr<PreprocessPlan>>
+  CompilePreprocessPlan(
+      const FrameBuffer& buffer, absl::optional<BoundingBox> bounding_box,
+      absl::optional<uint8> letterbox_padding_value,
+      const FrameBuffer& output_buffer,
+      InterpolationMethod interpolation = InterpolationMethod::kBilinear);
+
+  // Executes `plan` on `buffer`, writing the result into `output_buffer`.
+  // Intermediate results are held by the scratch buffers of this instance.
+  // Returns an InvalidArgument error if the buffers don't match the signature
+  // `plan` was compiled for.
+  absl::Status ExecutePreprocessPlan(const FrameBuffer& buffer,
+                                     PreprocessPlan* plan,
+                                     FrameBuffer* output_buffer);
+
+  // Sets the maximum size in bytes of each scratch buffer retained between
+  // calls. Larger intermediate results are still supported, but the
+  // corresponding memory is released as soon as the call completes. Defaults
+  // to `ScratchArena::kDefaultMaxRetainedBytes`.
+  void SetMaxRetainedScratchBytes(size_t max_retained_bytes);
+
+  // Releases all the memory retained by the scratch buffers. It is allocated
+  // again on the next call needing it.
+  void TrimScratchBuffers();
+
+  // Sets whether a `CropResizeOperation` using bilinear interpolation directly
+  // followed by an `OrientOperation` is performed in a single pass, see the
+  // class comment. Defaults to false. Results are not bit-exact with the
+  // two-pass execution, as the fused kernel doesn't round the same way as the
+  // process engine scalers: values differ by up to 4 levels, and 1.5 on
+  // average, see frame_buffer_utils_test.
+  void SetFuseResizeAndOrient(bool fuse_resize_and_orient);
 
  private:
-  // Returns the new FrameBuffer size after the operation is applied.
-  FrameBuffer::Dimension GetSize(const FrameBuffer& buffer,
+  // Returns the new FrameBuffer size after the operation is applied to a
+  // buffer of the given `dimension` and `orientation`.
+  FrameBuffer::Dimension GetSize(FrameBuffer::Dimension dimension,
+                                 FrameBuffer::Orientation orientation,
                                  const FrameBufferOperation& operation);
 
   // Returns the new FrameBuffer orientation after command is processed.
   FrameBuffer::Orientation GetOrientation(
-      const FrameBuffer& buffer, const FrameBufferOperation& operation);
+      FrameBuffer::Orientation orientation,
+      const FrameBufferOperation& operation);
 
   // Returns the new FrameBuffer format after command is processed.
-  FrameBuffer::Format GetFormat(const FrameBuffer& buffer,
+  FrameBuffer::Format GetFormat(FrameBuffer::Format format,
                                 const FrameBufferOperation& operation);
 
   // Returns Plane struct based on one dimension buffer and its metadata. If
@@ -276,13 +615,117 @@ class FrameBufferUtils {
                                             FrameBuffer::Dimension dimension,
                                             FrameBuffer::Format format);
 
+  // Runs `operation` on horizontal stripes covering the output rows
+  // [0, num_rows), in parallel if a thread pool is available and the image is
+  // large enough. Stripe boundaries are multiples of `row_alignment`. Returns
+  // the first error encountered, if any.
+  absl::Status RunInStripes(
+      int num_rows, int num_columns, int row_alignment,
+      const std::function<absl::Status(int row_begin, int row_end)>&
+          operation);
+
+  // Resizes `buffer` into `output_buffer` after reducing it with a box filter,
+  // see `UsesBoxPreReduction`.
+  absl::Status ResizeWithBoxPreReduction(const FrameBuffer& buffer,
+                                         InterpolationMethod interpolation,
+                                         FrameBuffer* output_buffer);
+
+  // Reduces `buffer` with a box filter ahead of its resizing to
+  // `output_dimension`, see `UsesBoxPreReduction`. The returned buffer is held
+  // by `reduce_buffer_`, which callers must release above its cap when done.
+  tflite::support::StatusOr<FrameBuffer> BoxPreReduce(
+      const FrameBuffer& buffer, FrameBuffer::Dimension output_dimension);
+
+  // Crops the region (x0, y0)-(x1, y1) of `buffer`, resizes it with bilinear
+  // interpolation to the `output_buffer` dimension (swapped if the orientation
+  // requires it) and orients it to the `output_buffer` orientation in a single
+  // pass, the resize kernel reading the source pixels through the orientation
+  // transform. Large downscales are box pre-reduced first, as for `Resize`.
+  // Packed YUV 4:2:2 buffers, as well as YUV buffers whose chroma rows
+  // overlap, are not supported.
+  absl::Status CropResizeAndOrient(const FrameBuffer& buffer, int x0, int y0,
+                                   int x1, int y1, FrameBuffer* output_buffer);
+
+  // Resizes `buffer` with bilinear interpolation to the `output_buffer`
+  // dimension and orients it as described by `params` in a single pass. Used
+  // by `CropResizeAndOrient`.
+  absl::Status ResizeAndOrient(const FrameBuffer& buffer,
+                               const OrientParams& params,
+                               FrameBuffer* output_buffer);
+
+  // Implementation of `Preprocess` and `PreprocessWithLetterbox`, which
+  // letterboxes if `letterbox_padding_value` is set.
+  absl::Status PreprocessImpl(const FrameBuffer& buffer,
+                              absl::optional<BoundingBox> bounding_box,
+                              absl::optional<uint8> letterbox_padding_value,
+                              FrameBuffer* output_buffer,
+                              InterpolationMethod interpolation);
+
   // Executes command with params.
   absl::Status Execute(const FrameBuffer& buffer,
                        const FrameBufferOperation& operation,
                        FrameBuffer* output_buffer);
 
+  // Implementation of the public `Execute` method, which leaves the scratch
+  // buffers untrimmed.
+  absl::Status ExecuteOperations(
+      const FrameBuffer& buffer,
+      const std::vector<FrameBufferOperation>& operations,
+      FrameBuffer* output_buffer);
+
+  // Splits `operations` applied to `buffer` into `steps`, computing the
+  // metadata of each intermediate result from the metadata of `buffer`, and
+  // checking that the last one matches `output_buffer`.
+  absl::Status CompileSteps(const FrameBuffer& buffer,
+                            const std::vector<FrameBufferOperation>& operations,
+                            const FrameBuffer& output_buffer,
+                            std::vector<PreprocessPlan::Step>* steps);
+
+  // Runs the `steps` compiled from `operations` on `buffer`, writing the last
+  // result into `output_buffer`. The intermediate results are laid out in the
+  // scratch buffers first, only if they were reallocated since the last run.
+  absl::Status RunSteps(const FrameBuffer& buffer,
+                        const std::vector<FrameBufferOperation>& operations,
+                        std::vector<PreprocessPlan::Step>* steps,
+                        FrameBuffer* output_buffer);
+
+  // Releases the scratch buffers exceeding their maximum retained size.
+  void ReleaseScratchBuffersAboveCap();
+
   // Execution engine conforms to FrameBufferUtilsInterface.
   std::unique_ptr<FrameBufferUtilsInterface> utils_;
+
+  // Thread pool used to process stripes in parallel. Only set if more than one
+  // thread is requested.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Scratch buffers holding the intermediate results of `Execute`. We hold
+  // maximum 2 intermediate results in memory at any given time.
+  ScratchArena execute_buffers_[2];
+
+  // Scratch buffer holding the rotation result when `Orient` needs both a
+  // rotation and a flip.
+  ScratchArena orient_buffer_;
+
+  // Scratch buffer holding the result of box pre-reduction.
+  ScratchArena reduce_buffer_;
+
+  // Scratch buffer holding the cropped region of packed YUV 4:2:2 buffers
+  // realigned on a macropixel before resizing, see `Crop`.
+  ScratchArena crop_buffer_;
+
+  // Scratch buffer holding the region converted once by `PreprocessBatch`.
+  // Unlike the other scratch buffers, it is only released above its cap at the
+  // end of `PreprocessBatch`, as it is in use across `Preprocess` calls.
+  ScratchArena batch_buffer_;
+
+  // Plan of the last `Preprocess` or `PreprocessWithLetterbox` call, reused by
+  // the next calls with the same signature.
+  std::unique_ptr<PreprocessPlan> preprocess_plan_;
+
+  // Whether to fold orientation into bilinear resizing. See
+  // `SetFuseResizeAndOrient`.
+  bool fuse_resize_and_orient_ = false;
 };
 
 }  // namespace vision
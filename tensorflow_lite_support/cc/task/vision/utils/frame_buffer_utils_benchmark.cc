@@ -0,0 +1,343 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the FrameBufferUtils operations (Crop, Resize, Rotate, Flip,
+// Convert and the full Preprocess pipeline) over every FrameBuffer::Format and
+// source sizes from VGA to 4K, for the kLibyuv and kSimd engines.
+//
+// Besides the time per call, each benchmark reports the throughput in source
+// megapixels per second ("MPix/s"), and the number of bytes and blocks
+// allocated on the heap per call ("alloc_bytes/call", "allocs/call"), as
+// counted by the global operator new replacement below.
+//
+// Arguments are: engine (0 for kLibyuv, 1 for kSimd), source format, source
+// size (0 for 640x480, 1 for 1280x720, 2 for 1920x1080, 3 for 3840x2160),
+// followed by the operation specific argument if any:
+// - Rotate: the rotation (1 for 90, 2 for 180, 3 for 270 degrees),
+// - Flip: the direction (0 for horizontal, 1 for vertical),
+// - Convert: the target format,
+// - Preprocess: the source orientation (1 to 8).
+// Unsupported combinations are reported as skipped with the error message.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_pool.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+namespace {
+
+std::atomic<tflite::int64> num_allocated_bytes(0);
+std::atomic<tflite::int64> num_allocations(0);
+
+}  // namespace
+
+// Counts the heap allocations of the whole binary. The array and nothrow
+// variants forward to this one.
+void* operator new(std::size_t size) {
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Engine = FrameBufferUtils::ProcessEngine;
+using Format = FrameBuffer::Format;
+using Orientation = FrameBuffer::Orientation;
+
+constexpr int kNumFormats = static_cast<int>(Format::kUYVY) + 1;
+constexpr FrameBuffer::Dimension kSourceDimensions[] = {
+    {640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+constexpr int kNumSourceDimensions =
+    sizeof(kSourceDimensions) / sizeof(kSourceDimensions[0]);
+// Model input dimension used as Preprocess target.
+constexpr FrameBuffer::Dimension kModelInputDimension = {224, 224};
+
+const char* GetFormatName(Format format) {
+  switch (format) {
+    case Format::kRGBA:
+      return "RGBA";
+    case Format::kRGB:
+      return "RGB";
+    case Format::kNV12:
+      return "NV12";
+    case Format::kNV21:
+      return "NV21";
+    case Format::kYV12:
+      return "YV12";
+    case Format::kYV21:
+      return "YV21";
+    case Format::kGRAY:
+      return "GRAY";
+    case Format::kBGRA:
+      return "BGRA";
+    case Format::kBGR:
+      return "BGR";
+    case Format::kYUYV:
+      return "YUYV";
+    case Format::kUYVY:
+      return "UYVY";
+  }
+  return "";
+}
+
+// Source frame and processing engine of a benchmark, set up from its first
+// three arguments.
+struct Fixture {
+  explicit Fixture(const benchmark::State& state)
+      : utils(FrameBufferUtils::Create(static_cast<Engine>(state.range(0)))),
+        format(static_cast<Format>(state.range(1))),
+        dimension(kSourceDimensions[state.range(2)]) {}
+
+  // Acquires the source frame from `pool` with the given `orientation`, and
+  // fills it with a deterministic pattern.
+  absl::Status CreateSource(Orientation orientation = Orientation::kTopLeft) {
+    auto source_or = pool.Acquire(dimension, format, orientation);
+    if (!source_or.ok()) {
+      return source_or.status();
+    }
+    source = std::move(source_or).value();
+    for (size_t i = 0; i < source.capacity(); ++i) {
+      source.data()[i] = static_cast<uint8>(i * 7 + (i >> 10));
+    }
+    return absl::OkStatus();
+  }
+
+  // Acquires an output frame from `pool`, in `output`.
+  absl::Status CreateOutput(FrameBuffer::Dimension output_dimension,
+                            Format output_format,
+                            Orientation orientation = Orientation::kTopLeft) {
+    auto output_or = pool.Acquire(output_dimension, output_format, orientation);
+    if (!output_or.ok()) {
+      return output_or.status();
+    }
+    output = std::move(output_or).value();
+    return absl::OkStatus();
+  }
+
+  FrameBufferPool pool;
+  std::unique_ptr<FrameBufferUtils> utils;
+  Format format;
+  FrameBuffer::Dimension dimension;
+  PooledFrameBuffer source;
+  PooledFrameBuffer output;
+};
+
+// Runs `operation` in the benchmark loop, and reports the throughput and the
+// allocations per call. The benchmark is skipped if the setup or the first
+// call fails.
+template <typename Operation>
+void RunBenchmark(benchmark::State& state, const Fixture& fixture,
+                  const absl::Status& setup_status,
+                  const Operation& operation) {
+  if (!setup_status.ok()) {
+    state.SkipWithError(setup_status.ToString().c_str());
+    return;
+  }
+  // Warm-up call, so that lazily initialized state (e.g. scratch memory) is
+  // not accounted for.
+  const absl::Status status = operation();
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+  const int64 allocated_bytes_before = num_allocated_bytes.load();
+  const int64 allocations_before = num_allocations.load();
+  for (auto s : state) {
+    operation().IgnoreError();
+    benchmark::DoNotOptimize(fixture.output.data());
+  }
+  const double num_calls = static_cast<double>(state.iterations());
+  state.counters["alloc_bytes/call"] =
+      (num_allocated_bytes.load() - allocated_bytes_before) / num_calls;
+  state.counters["allocs/call"] =
+      (num_allocations.load() - allocations_before) / num_calls;
+  state.counters["MPix/s"] = benchmark::Counter(
+      num_calls * fixture.dimension.width * fixture.dimension.height * 1e-6,
+      benchmark::Counter::kIsRate);
+  state.SetLabel(GetFormatName(fixture.format));
+}
+
+// Crops the centered half of the frame, without resizing.
+void BM_Crop(benchmark::State& state) {
+  Fixture fixture(state);
+  const int width = fixture.dimension.width / 2;
+  const int height = fixture.dimension.height / 2;
+  const int x0 = fixture.dimension.width / 4;
+  const int y0 = fixture.dimension.height / 4;
+  absl::Status status = fixture.CreateSource();
+  if (status.ok()) {
+    status = fixture.CreateOutput({width, height}, fixture.format);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return fixture.utils->Crop(*fixture.source, x0, y0, x0 + width - 1,
+                               y0 + height - 1, fixture.output.frame_buffer());
+  });
+}
+
+// Downscales the frame by a factor 2 with bilinear interpolation.
+void BM_Resize(benchmark::State& state) {
+  Fixture fixture(state);
+  absl::Status status = fixture.CreateSource();
+  if (status.ok()) {
+    status = fixture.CreateOutput(
+        {fixture.dimension.width / 2, fixture.dimension.height / 2},
+        fixture.format);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return fixture.utils->Resize(*fixture.source,
+                                 fixture.output.frame_buffer());
+  });
+}
+
+void BM_Rotate(benchmark::State& state) {
+  Fixture fixture(state);
+  const auto rotation =
+      static_cast<FrameBufferUtils::RotationDegree>(state.range(3));
+  FrameBuffer::Dimension output_dimension = fixture.dimension;
+  if (rotation != FrameBufferUtils::RotationDegree::k180) {
+    output_dimension.Swap();
+  }
+  absl::Status status = fixture.CreateSource();
+  if (status.ok()) {
+    status = fixture.CreateOutput(output_dimension, fixture.format);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return fixture.utils->Rotate(*fixture.source, rotation,
+                                 fixture.output.frame_buffer());
+  });
+}
+
+void BM_Flip(benchmark::State& state) {
+  Fixture fixture(state);
+  const bool vertical = state.range(3) != 0;
+  absl::Status status = fixture.CreateSource();
+  if (status.ok()) {
+    status = fixture.CreateOutput(fixture.dimension, fixture.format);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return vertical ? fixture.utils->FlipVertically(
+                          *fixture.source, fixture.output.frame_buffer())
+                    : fixture.utils->FlipHorizontally(
+                          *fixture.source, fixture.output.frame_buffer());
+  });
+}
+
+void BM_Convert(benchmark::State& state) {
+  Fixture fixture(state);
+  const auto output_format = static_cast<Format>(state.range(3));
+  absl::Status status = ValidateConvertFormats(fixture.format, output_format);
+  if (status.ok()) {
+    status = fixture.CreateSource();
+  }
+  if (status.ok()) {
+    status = fixture.CreateOutput(fixture.dimension, output_format);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return fixture.utils->Convert(*fixture.source,
+                                  fixture.output.frame_buffer());
+  });
+}
+
+// Converts the whole frame to a 224x224 kRGB model input in the kTopLeft
+// orientation, as the vision tasks do.
+void BM_Preprocess(benchmark::State& state) {
+  Fixture fixture(state);
+  absl::Status status =
+      fixture.CreateSource(static_cast<Orientation>(state.range(3)));
+  if (status.ok()) {
+    status = fixture.CreateOutput(kModelInputDimension, Format::kRGB);
+  }
+  RunBenchmark(state, fixture, status, [&] {
+    return fixture.utils->Preprocess(*fixture.source, absl::nullopt,
+                                     fixture.output.frame_buffer());
+  });
+}
+
+// Sweeps the engines, formats and source sizes, with each of the operation
+// specific arguments in [`min_extra`, `max_extra`] if `has_extra` is true.
+void SweepArguments(benchmark::internal::Benchmark* benchmark, bool has_extra,
+                    int min_extra = 0, int max_extra = 0) {
+  for (int engine : {static_cast<int>(Engine::kLibyuv),
+                     static_cast<int>(Engine::kSimd)}) {
+    for (int format = 0; format < kNumFormats; ++format) {
+      for (int size = 0; size < kNumSourceDimensions; ++size) {
+        if (!has_extra) {
+          benchmark->Args({engine, format, size});
+          continue;
+        }
+        for (int extra = min_extra; extra <= max_extra; ++extra) {
+          benchmark->Args({engine, format, size, extra});
+        }
+      }
+    }
+  }
+}
+
+void BasicArguments(benchmark::internal::Benchmark* benchmark) {
+  SweepArguments(benchmark, /*has_extra=*/false);
+}
+
+void RotateArguments(benchmark::internal::Benchmark* benchmark) {
+  SweepArguments(benchmark, /*has_extra=*/true, 1, 3);
+}
+
+void FlipArguments(benchmark::internal::Benchmark* benchmark) {
+  SweepArguments(benchmark, /*has_extra=*/true, 0, 1);
+}
+
+void ConvertArguments(benchmark::internal::Benchmark* benchmark) {
+  SweepArguments(benchmark, /*has_extra=*/true, 0, kNumFormats - 1);
+}
+
+void PreprocessArguments(benchmark::internal::Benchmark* benchmark) {
+  SweepArguments(benchmark, /*has_extra=*/true,
+                 static_cast<int>(Orientation::kTopLeft),
+                 static_cast<int>(Orientation::kLeftBottom));
+}
+
+BENCHMARK(BM_Crop)->Apply(BasicArguments);
+BENCHMARK(BM_Resize)->Apply(BasicArguments);
+BENCHMARK(BM_Rotate)->Apply(RotateArguments);
+BENCHMARK(BM_Flip)->Apply(FlipArguments);
+BENCHMARK(BM_Convert)->Apply(ConvertArguments);
+BENCHMARK(BM_Preprocess)->Apply(PreprocessArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -23,6 +23,17 @@ namespace tflite {
 namespace task {
 namespace vision {
 
+// Interpolation methods available for resizing operations.
+enum class InterpolationMethod {
+  // Bilinear interpolation of the 4 nearest pixels.
+  kBilinear,
+  // Averaging of the pixels covered by each output pixel (a.k.a. box
+  // filtering). Only meaningful for downscaling, where it avoids aliasing.
+  kArea,
+  // Nearest pixel, without any filtering.
+  kNearestNeighbor,
+};
+
 // Interface for the FrameBuffer image processing library.
 class FrameBufferUtilsInterface {
  public:
@@ -49,6 +60,36 @@ class FrameBufferUtilsInterface {
   virtual absl::Status Resize(const FrameBuffer& buffer,
                               FrameBuffer* output_buffer) = 0;
 
+  // Same as `Resize`, using the given `interpolation` method instead of the
+  // bilinear interpolation used by `Resize`.
+  //
+  // The default implementation only supports bilinear interpolation.
+  virtual absl::Status ResizeWithInterpolation(
+      const FrameBuffer& buffer, InterpolationMethod interpolation,
+      FrameBuffer* output_buffer) {
+    if (interpolation != InterpolationMethod::kBilinear) {
+      return absl::UnimplementedError(
+          "Only bilinear interpolation is supported.");
+    }
+    return Resize(buffer, output_buffer);
+  }
+
+  // Returns whether `ResizeRows` is supported for buffers of the given format.
+  virtual bool SupportsResizeRows(FrameBuffer::Format format) const {
+    return false;
+  }
+
+  // Computes the rows [row_begin, row_end) of the result of
+  // `Resize(buffer, output_buffer)`, leaving the other rows of `output_buffer`
+  // untouched. The computed rows must be identical to the ones computed by
+  // `Resize`, so that disjoint row ranges can be computed concurrently.
+  //
+  // Only available for the formats for which `SupportsResizeRows` returns true.
+  virtual absl::Status ResizeRows(const FrameBuffer& buffer, int row_begin,
+                                  int row_end, FrameBuffer* output_buffer) {
+    return absl::UnimplementedError("ResizeRows is not supported.");
+  }
+
   // Rotates `buffer` counter-clockwise by the given `angle_deg` (in degrees).
   //
   // When rotating by 90 degrees, the top-right corner of `buffer` becomes
@@ -0,0 +1,933 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+using Orientation = FrameBuffer::Orientation;
+using ProcessEngine = FrameBufferUtils::ProcessEngine;
+
+constexpr int kNumThreads = 4;
+
+// Frame sizes large enough to be split in stripes, with even and odd
+// dimensions.
+constexpr FrameBuffer::Dimension kFrameDimensions[] = {{640, 480},
+                                                       {301, 203}};
+
+const std::vector<Format>& GetSupportedFormats() {
+  static const std::vector<Format>* formats =
+      new std::vector<Format>{Format::kRGB,  Format::kRGBA, Format::kGRAY,
+                              Format::kNV12, Format::kNV21, Format::kYV12,
+                              Format::kYV21};
+  return *formats;
+}
+
+// Frame buffer along with its backing data.
+struct TestFrame {
+  std::vector<uint8> data;
+  std::unique_ptr<FrameBuffer> buffer;
+};
+
+TestFrame CreateTestFrame(FrameBuffer::Dimension dimension, Format format,
+                          Orientation orientation = Orientation::kTopLeft) {
+  TestFrame frame;
+  frame.data.resize(GetFrameBufferByteSize(dimension, format));
+  uint32 state = 12345;
+  for (uint8& value : frame.data) {
+    state = state * 1103515245 + 12345;
+    value = static_cast<uint8>(state >> 16);
+  }
+  frame.buffer =
+      CreateFromRawBuffer(frame.data.data(), dimension, format, orientation)
+          .value();
+  return frame;
+}
+
+// Runs `operation` into a `dimension` output buffer of the given `format` and
+// `orientation` with 1 and `kNumThreads` threads, and expects the same
+// results. Operations unsupported for the given formats must fail the same
+// way.
+void ExpectSameResultWithThreads(
+    ProcessEngine engine, FrameBuffer::Dimension dimension, Format format,
+    Orientation orientation,
+    const std::function<absl::Status(FrameBufferUtils*, FrameBuffer*)>&
+        operation) {
+  FrameBufferUtils single_threaded_utils(engine, /*num_threads=*/1);
+  FrameBufferUtils multi_threaded_utils(engine, kNumThreads);
+  TestFrame expected_output = CreateTestFrame(dimension, format, orientation);
+  TestFrame output = CreateTestFrame(dimension, format, orientation);
+  const absl::Status expected_status =
+      operation(&single_threaded_utils, expected_output.buffer.get());
+  const absl::Status status =
+      operation(&multi_threaded_utils, output.buffer.get());
+  EXPECT_EQ(status.code(), expected_status.code());
+  if (expected_status.ok()) {
+    EXPECT_EQ(output.data, expected_output.data);
+  }
+}
+
+FrameBuffer::Dimension Transpose(FrameBuffer::Dimension dimension) {
+  return {dimension.height, dimension.width};
+}
+
+class MultithreadingTest
+    : public ::testing::TestWithParam<std::tuple<ProcessEngine, Format>> {};
+
+TEST_P(MultithreadingTest, MatchesSingleThreaded) {
+  const ProcessEngine engine = std::get<0>(GetParam());
+  const Format format = std::get<1>(GetParam());
+  for (FrameBuffer::Dimension dimension : kFrameDimensions) {
+    SCOPED_TRACE(testing::Message()
+                 << dimension.width << "x" << dimension.height);
+    const TestFrame frame = CreateTestFrame(dimension, format);
+    const FrameBuffer& input = *frame.buffer;
+
+    ExpectSameResultWithThreads(
+        engine, {201, 170}, format, Orientation::kTopLeft,
+        [&](FrameBufferUtils* utils, FrameBuffer* output) {
+          return utils->Crop(input, 11, 21, 211, 190, output);
+        });
+    ExpectSameResultWithThreads(
+        engine, {224, 224}, format, Orientation::kTopLeft,
+        [&](FrameBufferUtils* utils, FrameBuffer* output) {
+          return utils->Crop(input, 10, 20, 210, 190, output);
+        });
+    for (FrameBuffer::Dimension output_dimension :
+         {FrameBuffer::Dimension{224, 300}, FrameBuffer::Dimension{700, 530},
+          dimension}) {
+      ExpectSameResultWithThreads(
+          engine, output_dimension, format, Orientation::kTopLeft,
+          [&](FrameBufferUtils* utils, FrameBuffer* output) {
+            return utils->Resize(input, output);
+          });
+    }
+    for (auto rotation : {FrameBufferUtils::RotationDegree::k90,
+                          FrameBufferUtils::RotationDegree::k180,
+                          FrameBufferUtils::RotationDegree::k270}) {
+      ExpectSameResultWithThreads(
+          engine,
+          rotation == FrameBufferUtils::RotationDegree::k180
+              ? dimension
+              : Transpose(dimension),
+          format, Orientation::kTopLeft,
+          [&](FrameBufferUtils* utils, FrameBuffer* output) {
+            return utils->Rotate(input, rotation, output);
+          });
+    }
+    ExpectSameResultWithThreads(
+        engine, dimension, format, Orientation::kTopLeft,
+        [&](FrameBufferUtils* utils, FrameBuffer* output) {
+          return utils->FlipHorizontally(input, output);
+        });
+    ExpectSameResultWithThreads(
+        engine, dimension, format, Orientation::kTopLeft,
+        [&](FrameBufferUtils* utils, FrameBuffer* output) {
+          return utils->FlipVertically(input, output);
+        });
+    for (Format output_format : GetSupportedFormats()) {
+      if (output_format == format) {
+        continue;
+      }
+      ExpectSameResultWithThreads(
+          engine, dimension, output_format, Orientation::kTopLeft,
+          [&](FrameBufferUtils* utils, FrameBuffer* output) {
+            return utils->Convert(input, output);
+          });
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllEnginesAndFormats, MultithreadingTest,
+    ::testing::Combine(::testing::Values(ProcessEngine::kLibyuv,
+                                         ProcessEngine::kSimd),
+                       ::testing::ValuesIn(GetSupportedFormats())));
+
+class MultithreadingOrientationTest
+    : public ::testing::TestWithParam<std::tuple<Format, int>> {};
+
+TEST_P(MultithreadingOrientationTest, MatchesSingleThreaded) {
+  const Format format = std::get<0>(GetParam());
+  const auto orientation = static_cast<Orientation>(std::get<1>(GetParam()));
+  const bool swap = RequireDimensionSwap(orientation, Orientation::kTopLeft);
+  for (FrameBuffer::Dimension dimension : kFrameDimensions) {
+    SCOPED_TRACE(testing::Message()
+                 << dimension.width << "x" << dimension.height);
+    const TestFrame frame = CreateTestFrame(dimension, format, orientation);
+    const FrameBuffer& input = *frame.buffer;
+
+    ExpectSameResultWithThreads(
+        ProcessEngine::kLibyuv, swap ? Transpose(dimension) : dimension,
+        format, Orientation::kTopLeft,
+        [&](FrameBufferUtils* utils, FrameBuffer* output) {
+          return utils->Orient(input, output);
+        });
+    for (Format output_format : {Format::kRGB, Format::kGRAY}) {
+      ExpectSameResultWithThreads(
+          ProcessEngine::kLibyuv, {224, 200}, output_format,
+          Orientation::kTopLeft,
+          [&](FrameBufferUtils* utils, FrameBuffer* output) {
+            BoundingBox roi;
+            roi.set_origin_x(4);
+            roi.set_origin_y(6);
+            roi.set_width(dimension.width / 2);
+            roi.set_height(dimension.height / 2);
+            return utils->Preprocess(input, roi, output);
+          });
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllFormatsAndOrientations, MultithreadingOrientationTest,
+    ::testing::Combine(::testing::ValuesIn(GetSupportedFormats()),
+                       ::testing::Range(1, 9)));
+
+class FuseResizeAndOrientTest
+    : public ::testing::TestWithParam<std::tuple<Format, int>> {};
+
+// Folding the orientation into bilinear resizing rounds differently than
+// resizing with the process engine and orienting separately. This bounds the
+// differences.
+TEST_P(FuseResizeAndOrientTest, StaysCloseToTwoPassExecution) {
+  const Format format = std::get<0>(GetParam());
+  const auto orientation = static_cast<Orientation>(std::get<1>(GetParam()));
+  for (FrameBuffer::Dimension dimension : kFrameDimensions) {
+    SCOPED_TRACE(testing::Message()
+                 << dimension.width << "x" << dimension.height);
+    const TestFrame frame = CreateTestFrame(dimension, format, orientation);
+    for (Format output_format : {format, Format::kRGB, Format::kGRAY}) {
+      for (FrameBuffer::Dimension output_dimension :
+           {FrameBuffer::Dimension{224, 200},
+            FrameBuffer::Dimension{500, 400}}) {
+        SCOPED_TRACE(testing::Message()
+                     << "to " << static_cast<int>(output_format) << " "
+                     << output_dimension.width << "x"
+                     << output_dimension.height);
+        FrameBufferUtils utils(ProcessEngine::kLibyuv);
+        FrameBufferUtils fused_utils(ProcessEngine::kLibyuv);
+        fused_utils.SetFuseResizeAndOrient(true);
+        TestFrame expected_output =
+            CreateTestFrame(output_dimension, output_format);
+        TestFrame output = CreateTestFrame(output_dimension, output_format);
+        const absl::Status expected_status = utils.Preprocess(
+            *frame.buffer, absl::nullopt, expected_output.buffer.get());
+        const absl::Status status = fused_utils.Preprocess(
+            *frame.buffer, absl::nullopt, output.buffer.get());
+        ASSERT_EQ(status.code(), expected_status.code());
+        if (!expected_status.ok()) {
+          continue;
+        }
+        int max_difference = 0;
+        double sum = 0.0;
+        for (size_t i = 0; i < output.data.size(); ++i) {
+          const int difference =
+              std::abs(output.data[i] - expected_output.data[i]);
+          max_difference = std::max(max_difference, difference);
+          sum += difference;
+        }
+        EXPECT_LE(max_difference, 4);
+        EXPECT_LE(sum / output.data.size(), 2.0);
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllFormatsAndOrientations, FuseResizeAndOrientTest,
+    ::testing::Combine(::testing::ValuesIn(GetSupportedFormats()),
+                       ::testing::Range(1, 9)));
+
+// Packed frame formats, with the number of bytes per pixel.
+const std::vector<std::tuple<Format, int>>& GetPackedFormats() {
+  static const std::vector<std::tuple<Format, int>>* formats =
+      new std::vector<std::tuple<Format, int>>{
+          {Format::kGRAY, 1}, {Format::kRGB, 3}, {Format::kRGBA, 4}};
+  return *formats;
+}
+
+class InterpolationTest
+    : public ::testing::TestWithParam<std::tuple<Format, int>> {};
+
+// Returns the index of the input pixel containing the center of the output
+// pixel at `index` with nearest neighbor interpolation, computed in 16.16 fixed
+// point as libyuv does.
+int GetNearestNeighborIndex(int index, int input_size, int output_size) {
+  const int64 step = (static_cast<int64>(input_size) << 16) / output_size;
+  return static_cast<int>(((step >> 1) + index * step) >> 16);
+}
+
+TEST_P(InterpolationTest, NearestNeighborSamplesInputPixels) {
+  const Format format = std::get<0>(GetParam());
+  const int pixel_size = std::get<1>(GetParam());
+  constexpr FrameBuffer::Dimension kInputDimension = {96, 64};
+  const TestFrame frame = CreateTestFrame(kInputDimension, format);
+  for (FrameBuffer::Dimension output_dimension :
+       {FrameBuffer::Dimension{48, 32}, FrameBuffer::Dimension{36, 40},
+        FrameBuffer::Dimension{224, 100}, FrameBuffer::Dimension{13, 7}}) {
+    SCOPED_TRACE(testing::Message() << output_dimension.width << "x"
+                                    << output_dimension.height);
+    TestFrame output = CreateTestFrame(output_dimension, format);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    ASSERT_TRUE(utils
+                    .Resize(*frame.buffer, output.buffer.get(),
+                            InterpolationMethod::kNearestNeighbor)
+                    .ok());
+    int num_mismatches = 0;
+    for (int y = 0; y < output_dimension.height; ++y) {
+      const int input_y = GetNearestNeighborIndex(
+          y, kInputDimension.height, output_dimension.height);
+      for (int x = 0; x < output_dimension.width; ++x) {
+        const int input_x = GetNearestNeighborIndex(
+            x, kInputDimension.width, output_dimension.width);
+        for (int c = 0; c < pixel_size; ++c) {
+          const uint8 expected =
+              frame.data[(input_y * kInputDimension.width + input_x) *
+                             pixel_size +
+                         c];
+          const uint8 value =
+              output.data[(y * output_dimension.width + x) * pixel_size + c];
+          num_mismatches += value != expected;
+        }
+      }
+    }
+    EXPECT_EQ(num_mismatches, 0);
+  }
+}
+
+// Each output pixel is the average of the input pixels it covers, up to
+// rounding, with (factor 4) or without (factor 2) box pre-reduction.
+TEST_P(InterpolationTest, AreaAveragesCoveredPixels) {
+  const Format format = std::get<0>(GetParam());
+  const int pixel_size = std::get<1>(GetParam());
+  constexpr FrameBuffer::Dimension kInputDimension = {96, 64};
+  const TestFrame frame = CreateTestFrame(kInputDimension, format);
+  for (int factor : {2, 4}) {
+    SCOPED_TRACE(factor);
+    const FrameBuffer::Dimension output_dimension = {
+        kInputDimension.width / factor, kInputDimension.height / factor};
+    ASSERT_EQ(UsesBoxPreReduction(kInputDimension, output_dimension,
+                                  InterpolationMethod::kArea),
+              factor == 4);
+    TestFrame output = CreateTestFrame(output_dimension, format);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    ASSERT_TRUE(utils
+                    .Resize(*frame.buffer, output.buffer.get(),
+                            InterpolationMethod::kArea)
+                    .ok());
+    int max_error = 0;
+    for (int y = 0; y < output_dimension.height; ++y) {
+      for (int x = 0; x < output_dimension.width; ++x) {
+        for (int c = 0; c < pixel_size; ++c) {
+          int sum = 0;
+          for (int dy = 0; dy < factor; ++dy) {
+            for (int dx = 0; dx < factor; ++dx) {
+              sum += frame.data[((y * factor + dy) * kInputDimension.width +
+                                 x * factor + dx) *
+                                    pixel_size +
+                                c];
+            }
+          }
+          const int expected = (2 * sum + factor * factor) /
+                               (2 * factor * factor);
+          const int value =
+              output.data[(y * output_dimension.width + x) * pixel_size + c];
+          max_error = std::max(max_error, std::abs(value - expected));
+        }
+      }
+    }
+    EXPECT_LE(max_error, 1);
+  }
+}
+
+// Large downscaling ratios are box-reduced before bilinear or area
+// interpolation, so that a one-pixel checkerboard turns into uniform gray.
+// Bilinear interpolation alone only samples a fraction of the input pixels,
+// which ranges from 70 to 184 here.
+TEST_P(InterpolationTest, BoxPreReductionAvoidsAliasing) {
+  const Format format = std::get<0>(GetParam());
+  const int pixel_size = std::get<1>(GetParam());
+  constexpr FrameBuffer::Dimension kInputDimension = {640, 480};
+  constexpr FrameBuffer::Dimension kOutputDimension = {60, 45};
+  TestFrame frame = CreateTestFrame(kInputDimension, format);
+  for (int y = 0; y < kInputDimension.height; ++y) {
+    for (int x = 0; x < kInputDimension.width; ++x) {
+      for (int c = 0; c < pixel_size; ++c) {
+        frame.data[(y * kInputDimension.width + x) * pixel_size + c] =
+            (x + y) % 2 == 0 ? 0 : 255;
+      }
+    }
+  }
+  for (InterpolationMethod interpolation :
+       {InterpolationMethod::kBilinear, InterpolationMethod::kArea}) {
+    SCOPED_TRACE(static_cast<int>(interpolation));
+    ASSERT_TRUE(
+        UsesBoxPreReduction(kInputDimension, kOutputDimension, interpolation));
+    TestFrame output = CreateTestFrame(kOutputDimension, format);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    ASSERT_TRUE(
+        utils.Resize(*frame.buffer, output.buffer.get(), interpolation).ok());
+    const auto minmax =
+        std::minmax_element(output.data.begin(), output.data.end());
+    EXPECT_GE(*minmax.first, 120);
+    EXPECT_LE(*minmax.second, 135);
+  }
+  EXPECT_FALSE(UsesBoxPreReduction(kInputDimension, kOutputDimension,
+                                   InterpolationMethod::kNearestNeighbor));
+}
+
+INSTANTIATE_TEST_SUITE_P(PackedFormats, InterpolationTest,
+                         ::testing::ValuesIn(GetPackedFormats()));
+
+// Grayscale pre-processing of YUV buffers letterboxes their luma plane, with
+// an odd vertical offset here, which `GetLetterboxFormat` must account for.
+// Only the top of the region is checked: with YUV buffers, the chroma of its
+// last row also covers the first padding row below.
+TEST(GetLetterboxFormatTest, LocatesRegionLetterboxedByPreprocess) {
+  constexpr FrameBuffer::Dimension kOutputDimension = {224, 227};
+  for (Format format : GetSupportedFormats()) {
+    for (Format output_format : {Format::kRGB, Format::kGRAY}) {
+      SCOPED_TRACE(testing::Message() << static_cast<int>(format) << " to "
+                                      << static_cast<int>(output_format));
+      const TestFrame frame = CreateTestFrame({300, 200}, format);
+      TestFrame output = CreateTestFrame(kOutputDimension, output_format);
+      FrameBufferUtils utils(ProcessEngine::kLibyuv);
+      const absl::Status status = utils.PreprocessWithLetterbox(
+          *frame.buffer, absl::nullopt, /*padding_value=*/0,
+          output.buffer.get());
+      if (!status.ok()) {
+        continue;
+      }
+      const LetterboxParams params =
+          GetLetterboxParams({300, 200}, kOutputDimension,
+                             GetLetterboxFormat(format, output_format));
+      const int row_bytes = output.data.size() / kOutputDimension.height;
+      const auto is_padding_row = [&](int row) {
+        for (int i = 0; i < row_bytes; ++i) {
+          if (output.data[row * row_bytes + i] != 0) {
+            return false;
+          }
+        }
+        return true;
+      };
+      EXPECT_TRUE(is_padding_row(params.offset_y - 1));
+      EXPECT_FALSE(is_padding_row(params.offset_y));
+    }
+  }
+}
+
+BoundingBox CreateBoundingBox(int x, int y, int width, int height) {
+  BoundingBox box;
+  box.set_origin_x(x);
+  box.set_origin_y(y);
+  box.set_width(width);
+  box.set_height(height);
+  return box;
+}
+
+// Cropping packed YUV 4:2:2 buffers from an odd column realigns the cropped
+// region in a scratch buffer before resizing it with interpolation methods
+// other than bilinear. The scratch buffer is reused, grown, and released
+// above its cap across calls.
+TEST(CropTest, ResizesRealignedPackedYuv422Region) {
+  for (Format format : {Format::kYUYV, Format::kUYVY}) {
+    SCOPED_TRACE(static_cast<int>(format));
+    const TestFrame frame = CreateTestFrame({301, 203}, format);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    for (int x0 : {11, 1, 11, 101}) {
+      SCOPED_TRACE(x0);
+      if (x0 == 101) {
+        utils.SetMaxRetainedScratchBytes(0);
+      }
+      const int x1 = x0 + 199;
+      const FrameBuffer::Dimension crop_dimension = {200, 150};
+      TestFrame cropped = CreateTestFrame(crop_dimension, format);
+      FrameBufferUtils expected_utils(ProcessEngine::kLibyuv);
+      ASSERT_TRUE(expected_utils
+                      .Crop(*frame.buffer, x0, 20, x1, 169,
+                            cropped.buffer.get())
+                      .ok());
+      TestFrame expected_output = CreateTestFrame({100, 60}, format);
+      ASSERT_TRUE(expected_utils
+                      .Resize(*cropped.buffer, expected_output.buffer.get(),
+                              InterpolationMethod::kArea)
+                      .ok());
+      TestFrame output = CreateTestFrame({100, 60}, format);
+      ASSERT_TRUE(utils
+                      .Crop(*frame.buffer, x0, 20, x1, 169,
+                            output.buffer.get(), InterpolationMethod::kArea)
+                      .ok());
+      EXPECT_EQ(output.data, expected_output.data);
+    }
+  }
+}
+
+class LetterboxTest
+    : public ::testing::TestWithParam<std::tuple<Format, int>> {};
+
+// The crop region is resized into the region located by `GetLetterboxParams`,
+// exactly as `Crop` resizes it, and the other pixels are set to the padding
+// value, with an opaque alpha channel.
+TEST_P(LetterboxTest, ResizesCropRegionAndPadsBorders) {
+  const Format format = std::get<0>(GetParam());
+  const int pixel_size = std::get<1>(GetParam());
+  constexpr uint8 kPaddingValue = 42;
+  const TestFrame frame = CreateTestFrame({300, 200}, format);
+  const BoundingBox crop = CreateBoundingBox(10, 20, 240, 160);
+  const int x1 = crop.origin_x() + crop.width() - 1;
+  const int y1 = crop.origin_y() + crop.height() - 1;
+  // Padding the top and bottom, or the left and right borders.
+  for (FrameBuffer::Dimension output_dimension :
+       {FrameBuffer::Dimension{224, 224}, FrameBuffer::Dimension{160, 241},
+        FrameBuffer::Dimension{401, 200}}) {
+    SCOPED_TRACE(testing::Message() << output_dimension.width << "x"
+                                    << output_dimension.height);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    TestFrame output = CreateTestFrame(output_dimension, format);
+    ASSERT_TRUE(utils
+                    .Letterbox(*frame.buffer, crop.origin_x(), crop.origin_y(),
+                               x1, y1, kPaddingValue, output.buffer.get())
+                    .ok());
+    const LetterboxParams params = GetLetterboxParams(
+        {crop.width(), crop.height()}, output_dimension, format);
+    TestFrame scaled = CreateTestFrame(params.scaled_dimension, format);
+    ASSERT_TRUE(utils
+                    .Crop(*frame.buffer, crop.origin_x(), crop.origin_y(), x1,
+                          y1, scaled.buffer.get())
+                    .ok());
+    int num_region_mismatches = 0;
+    int num_padding_mismatches = 0;
+    for (int y = 0; y < output_dimension.height; ++y) {
+      const int scaled_y = y - params.offset_y;
+      for (int x = 0; x < output_dimension.width; ++x) {
+        const int scaled_x = x - params.offset_x;
+        const bool in_region = scaled_x >= 0 &&
+                               scaled_x < params.scaled_dimension.width &&
+                               scaled_y >= 0 &&
+                               scaled_y < params.scaled_dimension.height;
+        for (int c = 0; c < pixel_size; ++c) {
+          const uint8 value =
+              output.data[(y * output_dimension.width + x) * pixel_size + c];
+          if (in_region) {
+            num_region_mismatches +=
+                value !=
+                scaled.data[(scaled_y * params.scaled_dimension.width +
+                             scaled_x) *
+                                pixel_size +
+                            c];
+          } else {
+            num_padding_mismatches +=
+                value != (c == 3 ? 255 : kPaddingValue);
+          }
+        }
+      }
+    }
+    EXPECT_EQ(num_region_mismatches, 0);
+    EXPECT_EQ(num_padding_mismatches, 0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(PackedFormats, LetterboxTest,
+                         ::testing::ValuesIn(GetPackedFormats()));
+
+TEST(GetLetterboxedOutputRegionTest, ScalesAndCentersRegion) {
+  // Scaled by 256 / 300 and centered vertically.
+  BoundingBox region = GetLetterboxedOutputRegion(
+      {300, 200}, Format::kRGB, Orientation::kTopLeft, {256, 192},
+      Format::kRGB);
+  EXPECT_EQ(region.origin_x(), 0);
+  EXPECT_EQ(region.origin_y(), 10);
+  EXPECT_EQ(region.width(), 256);
+  EXPECT_EQ(region.height(), 171);
+
+  // Letterboxed into 192x257 before the rotation, i.e. scaled by 192 / 300
+  // into 192x128 with 64 padding rows above and 65 below, then rotated
+  // clockwise: the larger padding ends up on the left.
+  region = GetLetterboxedOutputRegion({300, 200}, Format::kRGB,
+                                      Orientation::kRightTop, {257, 192},
+                                      Format::kRGB);
+  EXPECT_EQ(region.origin_x(), 65);
+  EXPECT_EQ(region.origin_y(), 0);
+  EXPECT_EQ(region.width(), 128);
+  EXPECT_EQ(region.height(), 192);
+
+  // Offsets are rounded down to even values for YUV buffers, unless only
+  // their luma plane is letterboxed.
+  region = GetLetterboxedOutputRegion({300, 200}, Format::kNV12,
+                                      Orientation::kTopLeft, {256, 194},
+                                      Format::kRGB);
+  EXPECT_EQ(region.origin_y(), 10);
+  region = GetLetterboxedOutputRegion({300, 200}, Format::kNV12,
+                                      Orientation::kTopLeft, {256, 194},
+                                      Format::kGRAY);
+  EXPECT_EQ(region.origin_y(), 11);
+}
+
+TEST(MapToOutputRegionTest, NormalizesToRegionAndClamps) {
+  EXPECT_FLOAT_EQ(MapToOutputRegion(10.0f / 192, 192, 10, 171), 0.0f);
+  EXPECT_FLOAT_EQ(MapToOutputRegion(95.5f / 192, 192, 10, 171), 0.5f);
+  EXPECT_FLOAT_EQ(MapToOutputRegion(181.0f / 192, 192, 10, 171), 1.0f);
+  EXPECT_FLOAT_EQ(MapToOutputRegion(0.0f, 192, 10, 171), 0.0f);
+  EXPECT_FLOAT_EQ(MapToOutputRegion(1.0f, 192, 10, 171), 1.0f);
+}
+
+class LetterboxedBoxMappingTest
+    : public ::testing::TestWithParam<Orientation> {};
+
+// Maps the bounds of an object located in the upright letterboxed output back
+// to the unrotated input, as ObjectDetector does with detected boxes, and
+// expects the object bounds up to the resizing blur. The output padding is
+// uneven, so that mapping through a wrongly oriented region is noticed.
+TEST_P(LetterboxedBoxMappingTest, MapsOutputBoxesBackToInput) {
+  const Orientation orientation = GetParam();
+  constexpr FrameBuffer::Dimension kInputDimension = {300, 200};
+  constexpr FrameBuffer::Dimension kOutputDimension = {257, 192};
+  const BoundingBox object = CreateBoundingBox(60, 40, 90, 100);
+  TestFrame frame = CreateTestFrame(kInputDimension, Format::kRGB, orientation);
+  for (int y = 0; y < kInputDimension.height; ++y) {
+    for (int x = 0; x < kInputDimension.width; ++x) {
+      const bool in_object =
+          x >= object.origin_x() && x < object.origin_x() + object.width() &&
+          y >= object.origin_y() && y < object.origin_y() + object.height();
+      for (int c = 0; c < 3; ++c) {
+        frame.data[(y * kInputDimension.width + x) * 3 + c] =
+            in_object ? 255 : 0;
+      }
+    }
+  }
+  TestFrame output = CreateTestFrame(kOutputDimension, Format::kRGB);
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  ASSERT_TRUE(utils
+                  .PreprocessWithLetterbox(*frame.buffer, absl::nullopt,
+                                           /*padding_value=*/0,
+                                           output.buffer.get())
+                  .ok());
+
+  int min_x = kOutputDimension.width;
+  int min_y = kOutputDimension.height;
+  int max_x = -1;
+  int max_y = -1;
+  for (int y = 0; y < kOutputDimension.height; ++y) {
+    for (int x = 0; x < kOutputDimension.width; ++x) {
+      if (output.data[(y * kOutputDimension.width + x) * 3] > 127) {
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+      }
+    }
+  }
+  ASSERT_GE(max_x, 0);
+
+  const BoundingBox region = GetLetterboxedOutputRegion(
+      kInputDimension, Format::kRGB, orientation, kOutputDimension,
+      Format::kRGB);
+  FrameBuffer::Dimension upright_dimension = kInputDimension;
+  if (RequireDimensionSwap(orientation, Orientation::kTopLeft)) {
+    upright_dimension.Swap();
+  }
+  // The aspect ratio of the upright input is preserved.
+  EXPECT_NEAR(region.width() * upright_dimension.height,
+              region.height() * upright_dimension.width,
+              upright_dimension.width);
+
+  const BoundingBox box = OrientAndDenormalizeBoundingBox(
+      MapToOutputRegion(static_cast<float>(min_x) / kOutputDimension.width,
+                        kOutputDimension.width, region.origin_x(),
+                        region.width()),
+      MapToOutputRegion(static_cast<float>(min_y) / kOutputDimension.height,
+                        kOutputDimension.height, region.origin_y(),
+                        region.height()),
+      MapToOutputRegion(static_cast<float>(max_x + 1) / kOutputDimension.width,
+                        kOutputDimension.width, region.origin_x(),
+                        region.width()),
+      MapToOutputRegion(
+          static_cast<float>(max_y + 1) / kOutputDimension.height,
+          kOutputDimension.height, region.origin_y(), region.height()),
+      Orientation::kTopLeft, orientation, upright_dimension);
+  // One output pixel covers up to 1.6 input pixels.
+  constexpr int kTolerance = 2;
+  EXPECT_NEAR(box.origin_x(), object.origin_x(), kTolerance);
+  EXPECT_NEAR(box.origin_y(), object.origin_y(), kTolerance);
+  EXPECT_NEAR(box.width(), object.width(), kTolerance);
+  EXPECT_NEAR(box.height(), object.height(), kTolerance);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllOrientations, LetterboxedBoxMappingTest,
+    ::testing::Values(Orientation::kTopLeft, Orientation::kTopRight,
+                      Orientation::kBottomRight, Orientation::kBottomLeft,
+                      Orientation::kLeftTop, Orientation::kRightTop,
+                      Orientation::kRightBottom, Orientation::kLeftBottom));
+
+// Runs `PreprocessBatch` on `frame` and expects the same results as calling
+// `Preprocess` on `expected_frame` with each bounding box.
+void ExpectBatchMatchesPreprocess(const TestFrame& frame,
+                                  const FrameBuffer& expected_frame,
+                                  const std::vector<BoundingBox>& boxes,
+                                  FrameBuffer::Dimension output_dimension,
+                                  Format output_format) {
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  std::vector<TestFrame> outputs;
+  std::vector<FrameBuffer*> output_buffers;
+  for (int i = 0; i < boxes.size(); ++i) {
+    outputs.push_back(CreateTestFrame(output_dimension, output_format));
+    output_buffers.push_back(outputs.back().buffer.get());
+  }
+  const absl::Status status =
+      utils.PreprocessBatch(*frame.buffer, boxes, output_buffers);
+
+  FrameBufferUtils expected_utils(ProcessEngine::kLibyuv);
+  absl::Status expected_status = absl::OkStatus();
+  std::vector<TestFrame> expected_outputs;
+  for (int i = 0; expected_status.ok() && i < boxes.size(); ++i) {
+    expected_outputs.push_back(
+        CreateTestFrame(output_dimension, output_format));
+    expected_status = expected_utils.Preprocess(
+        expected_frame, boxes[i], expected_outputs.back().buffer.get());
+  }
+  ASSERT_EQ(status.code(), expected_status.code());
+  if (!status.ok()) {
+    return;
+  }
+  for (int i = 0; i < boxes.size(); ++i) {
+    SCOPED_TRACE(testing::Message() << "box " << i);
+    EXPECT_EQ(outputs[i].data, expected_outputs[i].data);
+  }
+}
+
+class PreprocessBatchTest : public ::testing::TestWithParam<Format> {};
+
+// Downscaled regions covering most of the frame are converted crop by crop,
+// exactly as by `Preprocess`.
+TEST_P(PreprocessBatchTest, MatchesPreprocessOfEachBoundingBox) {
+  const Format format = GetParam();
+  const TestFrame frame = CreateTestFrame({301, 203}, format);
+  const std::vector<BoundingBox> boxes = {CreateBoundingBox(0, 0, 150, 100),
+                                          CreateBoundingBox(151, 3, 150, 200),
+                                          CreateBoundingBox(7, 101, 97, 61)};
+  for (Format output_format : {format, Format::kRGB, Format::kGRAY}) {
+    SCOPED_TRACE(testing::Message()
+                 << "to " << static_cast<int>(output_format));
+    ExpectBatchMatchesPreprocess(frame, *frame.buffer, boxes, {48, 32},
+                                 output_format);
+  }
+}
+
+// Upscaled overlapping regions share the conversion of the region covering
+// them: the results are those of `Preprocess` on the converted frame.
+TEST_P(PreprocessBatchTest, MatchesPreprocessOfConvertedFrame) {
+  const Format format = GetParam();
+  const TestFrame frame = CreateTestFrame({301, 203}, format);
+  const std::vector<BoundingBox> boxes = {CreateBoundingBox(41, 31, 40, 30),
+                                          CreateBoundingBox(60, 45, 33, 41),
+                                          CreateBoundingBox(51, 37, 20, 20)};
+  for (Format output_format : {Format::kRGB, Format::kGRAY}) {
+    if (output_format == format) {
+      continue;
+    }
+    SCOPED_TRACE(testing::Message()
+                 << "to " << static_cast<int>(output_format));
+    TestFrame converted_frame = CreateTestFrame({301, 203}, output_format);
+    FrameBufferUtils utils(ProcessEngine::kLibyuv);
+    if (!utils.Convert(*frame.buffer, converted_frame.buffer.get()).ok()) {
+      continue;
+    }
+    ExpectBatchMatchesPreprocess(frame, *converted_frame.buffer, boxes,
+                                 {96, 96}, output_format);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormats, PreprocessBatchTest,
+                         ::testing::ValuesIn(GetSupportedFormats()));
+
+class PreprocessPlanTest : public ::testing::TestWithParam<Format> {};
+
+// Region of interest, rotation and color conversion, so that the plan holds
+// intermediate results in scratch buffers.
+constexpr FrameBuffer::Dimension kPlanOutputDimension = {96, 64};
+const BoundingBox& GetPlanBoundingBox() {
+  static const BoundingBox* box =
+      new BoundingBox(CreateBoundingBox(13, 21, 201, 151));
+  return *box;
+}
+
+// Returns the output format of the plans of `format` frames: grayscale
+// frames don't convert to RGB.
+Format GetPlanOutputFormat(Format format) {
+  return format == Format::kGRAY ? Format::kGRAY : Format::kRGB;
+}
+
+// Returns the output of a fresh `Preprocess` call on `frame`.
+TestFrame PreprocessWithNewUtils(const TestFrame& frame) {
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  TestFrame output = CreateTestFrame(
+      kPlanOutputDimension, GetPlanOutputFormat(frame.buffer->format()),
+      Orientation::kRightTop);
+  EXPECT_TRUE(utils
+                  .Preprocess(*frame.buffer, GetPlanBoundingBox(),
+                              output.buffer.get())
+                  .ok());
+  return output;
+}
+
+// Changes the content of `frame`, keeping its signature.
+void ChangeContent(TestFrame* frame, uint8 mask) {
+  for (uint8& value : frame->data) {
+    value ^= mask;
+  }
+}
+
+TEST_P(PreprocessPlanTest, ReusedPlanMatchesPreprocess) {
+  TestFrame frame = CreateTestFrame({301, 203}, GetParam());
+  TestFrame output =
+      CreateTestFrame(kPlanOutputDimension, GetPlanOutputFormat(GetParam()),
+                      Orientation::kRightTop);
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  auto plan = utils.CompilePreprocessPlan(
+      *frame.buffer, GetPlanBoundingBox(),
+      /*letterbox_padding_value=*/absl::nullopt, *output.buffer);
+  ASSERT_TRUE(plan.ok()) << plan.status();
+  EXPECT_FALSE(plan.value()->operations().empty());
+  for (uint8 mask : {0x00, 0x5a, 0xff}) {
+    SCOPED_TRACE(static_cast<int>(mask));
+    ChangeContent(&frame, mask);
+    ASSERT_TRUE(utils
+                    .ExecutePreprocessPlan(*frame.buffer, plan.value().get(),
+                                           output.buffer.get())
+                    .ok());
+    EXPECT_EQ(output.data, PreprocessWithNewUtils(frame).data);
+  }
+}
+
+TEST_P(PreprocessPlanTest, RejectsBuffersWithOtherSignature) {
+  const TestFrame frame = CreateTestFrame({301, 203}, GetParam());
+  TestFrame output =
+      CreateTestFrame(kPlanOutputDimension, GetPlanOutputFormat(GetParam()),
+                      Orientation::kRightTop);
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  std::unique_ptr<PreprocessPlan> plan =
+      utils
+          .CompilePreprocessPlan(*frame.buffer, GetPlanBoundingBox(),
+                                 /*letterbox_padding_value=*/absl::nullopt,
+                                 *output.buffer)
+          .value();
+
+  const TestFrame larger_frame = CreateTestFrame({302, 203}, GetParam());
+  EXPECT_EQ(utils
+                .ExecutePreprocessPlan(*larger_frame.buffer, plan.get(),
+                                       output.buffer.get())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  const TestFrame rotated_frame =
+      CreateTestFrame({301, 203}, GetParam(), Orientation::kBottomRight);
+  EXPECT_EQ(utils
+                .ExecutePreprocessPlan(*rotated_frame.buffer, plan.get(),
+                                       output.buffer.get())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  TestFrame rgba_output = CreateTestFrame(kPlanOutputDimension, Format::kRGBA,
+                                          Orientation::kRightTop);
+  EXPECT_EQ(utils
+                .ExecutePreprocessPlan(*frame.buffer, plan.get(),
+                                       rgba_output.buffer.get())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  TestFrame upright_output =
+      CreateTestFrame({64, 96}, GetPlanOutputFormat(GetParam()));
+  EXPECT_EQ(utils
+                .ExecutePreprocessPlan(*frame.buffer, plan.get(),
+                                       upright_output.buffer.get())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+// The plan lays its intermediate results out again when the scratch buffers
+// are released, reallocated or grown in between executions.
+TEST_P(PreprocessPlanTest, LaysOutIntermediateResultsAgain) {
+  TestFrame frame = CreateTestFrame({301, 203}, GetParam());
+  TestFrame output =
+      CreateTestFrame(kPlanOutputDimension, GetPlanOutputFormat(GetParam()),
+                      Orientation::kRightTop);
+  FrameBufferUtils utils(ProcessEngine::kLibyuv);
+  std::unique_ptr<PreprocessPlan> plan =
+      utils
+          .CompilePreprocessPlan(*frame.buffer, GetPlanBoundingBox(),
+                                 /*letterbox_padding_value=*/absl::nullopt,
+                                 *output.buffer)
+          .value();
+  ASSERT_TRUE(utils
+                  .ExecutePreprocessPlan(*frame.buffer, plan.get(),
+                                         output.buffer.get())
+                  .ok());
+
+  const std::vector<std::function<void()>> scratch_changes = {
+      [&utils]() { utils.TrimScratchBuffers(); },
+      [&utils]() {
+        // Grows the scratch buffers beyond the size needed by the plan.
+        const TestFrame large_frame = CreateTestFrame({640, 480}, GetParam());
+        TestFrame large_output =
+            CreateTestFrame({480, 640}, GetPlanOutputFormat(GetParam()),
+                            Orientation::kRightTop);
+        EXPECT_TRUE(utils
+                        .Preprocess(*large_frame.buffer, absl::nullopt,
+                                    large_output.buffer.get())
+                        .ok());
+      },
+      [&utils]() {
+        // Releases the scratch buffers after each call.
+        utils.SetMaxRetainedScratchBytes(0);
+      },
+  };
+  for (int i = 0; i < scratch_changes.size(); ++i) {
+    SCOPED_TRACE(i);
+    scratch_changes[i]();
+    ChangeContent(&frame, 0x33);
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_TRUE(utils
+                      .ExecutePreprocessPlan(*frame.buffer, plan.get(),
+                                             output.buffer.get())
+                      .ok());
+      EXPECT_EQ(output.data, PreprocessWithNewUtils(frame).data);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormats, PreprocessPlanTest,
+                         ::testing::ValuesIn(GetSupportedFormats()));
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
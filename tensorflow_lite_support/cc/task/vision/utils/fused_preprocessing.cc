@@ -0,0 +1,671 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/fused_preprocessing.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+constexpr int kRgbChannels = 3;
+
+// Weights of the red, green and blue channels in the luma of RGB images, as
+// used by the libyuv full range (a.k.a. J400) grayscale conversions.
+constexpr float kRedLumaWeight = 0.299f;
+constexpr float kGreenLumaWeight = 0.587f;
+constexpr float kBlueLumaWeight = 0.114f;
+
+// Bilinear interpolation parameters along one axis: the interpolated value is
+// `(1 - weight) * source[index0] + weight * source[index1]`.
+struct AxisSample {
+  int index0;
+  int index1;
+  float weight;
+};
+
+// Returns the interpolation parameters needed to resize the `[origin, origin +
+// length)` range of a source axis to `output_length` samples, aligning pixel
+// centers. Sampling positions are clamped so that they never fall outside the
+// range. If `subsampled` is true, the returned indices address a plane
+// subsampled by a factor 2 along that axis (e.g. YUV420 chroma planes).
+std::vector<AxisSample> BuildAxisSamples(int origin, int length,
+                                         int output_length, int plane_length,
+                                         bool subsampled) {
+  std::vector<AxisSample> samples(output_length);
+  const float ratio = static_cast<float>(length) / output_length;
+  const float min_position = origin;
+  const float max_position = origin + length - 1;
+  for (int i = 0; i < output_length; ++i) {
+    float position = origin + (i + 0.5f) * ratio - 0.5f;
+    position = std::min(std::max(position, min_position), max_position);
+    if (subsampled) {
+      position = (position + 0.5f) * 0.5f - 0.5f;
+      position = std::min(std::max(position, 0.0f),
+                          static_cast<float>(plane_length - 1));
+    }
+    const int index0 = static_cast<int>(position);
+    samples[i] = {index0, std::min(index0 + 1, plane_length - 1),
+                  position - index0};
+  }
+  return samples;
+}
+
+// Returns the bilinear interpolation of the 8-bit plane `data` at the location
+// described by `x` and `y`.
+inline float Interpolate(const uint8* data, int row_stride, int pixel_stride,
+                         const AxisSample& x, const AxisSample& y) {
+  const uint8* row0 = data + y.index0 * row_stride;
+  const uint8* row1 = data + y.index1 * row_stride;
+  const int offset0 = x.index0 * pixel_stride;
+  const int offset1 = x.index1 * pixel_stride;
+  const float top = row0[offset0] + (row0[offset1] - row0[offset0]) * x.weight;
+  const float bottom =
+      row1[offset0] + (row1[offset1] - row1[offset0]) * x.weight;
+  return top + (bottom - top) * y.weight;
+}
+
+// Samples single plane interleaved (RGB, RGBA, BGR, BGRA) or grayscale frame
+// buffers. If `is_bgr` is true, the red and blue channels are swapped in
+// memory.
+template <bool kIsGray>
+class PackedSampler {
+ public:
+  PackedSampler(const FrameBuffer::Plane& plane,
+                const std::vector<AxisSample>& x_samples,
+                const std::vector<AxisSample>& y_samples, bool is_bgr = false)
+      : data_(plane.buffer),
+        row_stride_(plane.stride.row_stride_bytes),
+        pixel_stride_(plane.stride.pixel_stride_bytes),
+        red_offset_(is_bgr ? 2 : 0),
+        x_samples_(x_samples),
+        y_samples_(y_samples) {}
+
+  // Writes the RGB values at position (`x`, `y`) of the resized image into
+  // `rgb`.
+  void Sample(int x, int y, float* rgb) const {
+    const AxisSample& x_sample = x_samples_[x];
+    const AxisSample& y_sample = y_samples_[y];
+    if (kIsGray) {
+      rgb[0] = rgb[1] = rgb[2] =
+          Interpolate(data_, row_stride_, pixel_stride_, x_sample, y_sample);
+      return;
+    }
+    for (int c = 0; c < kRgbChannels; ++c) {
+      // Channel `c` is at offset `c` in RGB order, or `2 - c` in BGR order.
+      rgb[c] = Interpolate(data_ + std::abs(red_offset_ - c), row_stride_,
+                           pixel_stride_, x_sample, y_sample);
+    }
+  }
+
+  // Returns the gray level at position (`x`, `y`) of the resized image.
+  float SampleGray(int x, int y) const {
+    if (kIsGray) {
+      return Interpolate(data_, row_stride_, pixel_stride_, x_samples_[x],
+                         y_samples_[y]);
+    }
+    float rgb[kRgbChannels];
+    Sample(x, y, rgb);
+    return kRedLumaWeight * rgb[0] + kGreenLumaWeight * rgb[1] +
+           kBlueLumaWeight * rgb[2];
+  }
+
+ private:
+  const uint8* data_;
+  const int row_stride_;
+  const int pixel_stride_;
+  const int red_offset_;
+  const std::vector<AxisSample>& x_samples_;
+  const std::vector<AxisSample>& y_samples_;
+};
+
+// Returns whether `format` belongs to the YUV420 family.
+bool IsYuvFormat(FrameBuffer::Format format) {
+  return format == FrameBuffer::Format::kNV12 ||
+         format == FrameBuffer::Format::kNV21 ||
+         format == FrameBuffer::Format::kYV12 ||
+         format == FrameBuffer::Format::kYV21;
+}
+
+// Converts the `luma`, `u` and `v` values to RGB values in [0, 255] written
+// into `rgb`, using the BT.601 limited range coefficients, which is what
+// libyuv uses for the YUV420 family formats.
+inline void ConvertYuvToRgb(float luma, float u, float v, float* rgb) {
+  const float scaled_luma = 1.164f * (luma - 16.0f);
+  const float cb = u - 128.0f;
+  const float cr = v - 128.0f;
+  rgb[0] = std::min(std::max(scaled_luma + 1.596f * cr, 0.0f), 255.0f);
+  rgb[1] =
+      std::min(std::max(scaled_luma - 0.391f * cb - 0.813f * cr, 0.0f), 255.0f);
+  rgb[2] = std::min(std::max(scaled_luma + 2.018f * cb, 0.0f), 255.0f);
+}
+
+// Samples YUV420 family frame buffers (NV12, NV21, YV12, YV21) and packed YUV
+// 4:2:2 frame buffers (YUYV, UYVY), whose luma samples are `y_pixel_stride`
+// bytes apart. Luma and chroma values are interpolated separately, then
+// converted to RGB.
+class YuvSampler {
+ public:
+  YuvSampler(const FrameBuffer::YuvData& yuv_data,
+             const std::vector<AxisSample>& x_samples,
+             const std::vector<AxisSample>& y_samples,
+             const std::vector<AxisSample>& uv_x_samples,
+             const std::vector<AxisSample>& uv_y_samples,
+             int y_pixel_stride = 1)
+      : yuv_data_(yuv_data),
+        y_pixel_stride_(y_pixel_stride),
+        x_samples_(x_samples),
+        y_samples_(y_samples),
+        uv_x_samples_(uv_x_samples),
+        uv_y_samples_(uv_y_samples) {}
+
+  // Writes the RGB values at position (`x`, `y`) of the resized image into
+  // `rgb`.
+  void Sample(int x, int y, float* rgb) const {
+    const float luma =
+        Interpolate(yuv_data_.y_buffer, yuv_data_.y_row_stride,
+                    y_pixel_stride_, x_samples_[x], y_samples_[y]);
+    const float u = Interpolate(yuv_data_.u_buffer, yuv_data_.uv_row_stride,
+                                yuv_data_.uv_pixel_stride, uv_x_samples_[x],
+                                uv_y_samples_[y]);
+    const float v = Interpolate(yuv_data_.v_buffer, yuv_data_.uv_row_stride,
+                                yuv_data_.uv_pixel_stride, uv_x_samples_[x],
+                                uv_y_samples_[y]);
+    ConvertYuvToRgb(luma, u, v, rgb);
+  }
+
+  // Returns the gray level at position (`x`, `y`) of the resized image, i.e.
+  // the luma value as is.
+  float SampleGray(int x, int y) const {
+    return Interpolate(yuv_data_.y_buffer, yuv_data_.y_row_stride,
+                       y_pixel_stride_, x_samples_[x], y_samples_[y]);
+  }
+
+ private:
+  const FrameBuffer::YuvData yuv_data_;
+  const int y_pixel_stride_;
+  const std::vector<AxisSample>& x_samples_;
+  const std::vector<AxisSample>& y_samples_;
+  const std::vector<AxisSample>& uv_x_samples_;
+  const std::vector<AxisSample>& uv_y_samples_;
+};
+
+// Affine mapping from the upright output coordinates to the coordinates in the
+// resized (but not yet oriented) image:
+//   x = origin_x + output_x * col_step_x + output_y * row_step_x
+//   y = origin_y + output_x * col_step_y + output_y * row_step_y
+struct OrientationMapping {
+  int origin_x;
+  int origin_y;
+  int col_step_x;
+  int col_step_y;
+  int row_step_x;
+  int row_step_y;
+};
+
+// Returns the mapping from upright coordinates in an image of size
+// `output_dimension` to coordinates in the same image in `orientation`. As
+// orientation changes only consist of rotations and flips, the mapping is
+// affine and fully determined by three points.
+OrientationMapping GetOrientationMapping(
+    FrameBuffer::Orientation orientation,
+    FrameBuffer::Dimension output_dimension) {
+  int x00, y00, x10, y10, x01, y01;
+  OrientCoordinates(0, 0, FrameBuffer::Orientation::kTopLeft, orientation,
+                    output_dimension, &x00, &y00);
+  OrientCoordinates(1, 0, FrameBuffer::Orientation::kTopLeft, orientation,
+                    output_dimension, &x10, &y10);
+  OrientCoordinates(0, 1, FrameBuffer::Orientation::kTopLeft, orientation,
+                    output_dimension, &x01, &y01);
+  return {x00, y00, x10 - x00, y10 - y00, x01 - x00, y01 - y00};
+}
+
+template <typename T>
+inline T ConvertValue(float value);
+
+template <>
+inline float ConvertValue<float>(float value) {
+  return value;
+}
+
+template <>
+inline uint8 ConvertValue<uint8>(float value) {
+  return static_cast<uint8>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+}
+
+template <>
+inline int8 ConvertValue<int8>(float value) {
+  // Shift to the non-negative range so that truncation rounds to nearest.
+  return static_cast<int8>(
+      static_cast<int>(std::min(std::max(value + 128.5f, 0.0f), 255.0f)) -
+      128);
+}
+
+template <typename T, bool kIsGray, typename Sampler>
+void RunKernel(const Sampler& sampler, const OrientationMapping& mapping,
+               const TensorBufferSpec& output_spec) {
+  T* output = static_cast<T*>(output_spec.data);
+  const std::array<float, 3>& scale = output_spec.scale;
+  const std::array<float, 3>& offset = output_spec.offset;
+  float rgb[kRgbChannels];
+  for (int output_y = 0; output_y < output_spec.dimension.height; ++output_y) {
+    int x = mapping.origin_x + output_y * mapping.row_step_x;
+    int y = mapping.origin_y + output_y * mapping.row_step_y;
+    for (int output_x = 0; output_x < output_spec.dimension.width;
+         ++output_x, x += mapping.col_step_x, y += mapping.col_step_y) {
+      if (kIsGray) {
+        *output++ =
+            ConvertValue<T>(sampler.SampleGray(x, y) * scale[0] + offset[0]);
+        continue;
+      }
+      sampler.Sample(x, y, rgb);
+      *output++ = ConvertValue<T>(rgb[0] * scale[0] + offset[0]);
+      *output++ = ConvertValue<T>(rgb[1] * scale[1] + offset[1]);
+      *output++ = ConvertValue<T>(rgb[2] * scale[2] + offset[2]);
+    }
+  }
+}
+
+template <typename T, typename Sampler>
+void RunKernel(const Sampler& sampler, const OrientationMapping& mapping,
+               const TensorBufferSpec& output_spec) {
+  if (output_spec.num_channels == 1) {
+    RunKernel<T, /*kIsGray=*/true>(sampler, mapping, output_spec);
+  } else {
+    RunKernel<T, /*kIsGray=*/false>(sampler, mapping, output_spec);
+  }
+}
+
+template <typename Sampler>
+void RunKernel(const Sampler& sampler, const OrientationMapping& mapping,
+               const TensorBufferSpec& output_spec) {
+  switch (output_spec.element_type) {
+    case TensorBufferSpec::ElementType::kUInt8:
+      RunKernel<uint8>(sampler, mapping, output_spec);
+      break;
+    case TensorBufferSpec::ElementType::kInt8:
+      RunKernel<int8>(sampler, mapping, output_spec);
+      break;
+    case TensorBufferSpec::ElementType::kFloat32:
+      RunKernel<float>(sampler, mapping, output_spec);
+      break;
+  }
+}
+
+// Converts the upright YUV420 image `yuv_data`, which has the destination
+// dimensions, to RGB and writes it into the destination buffer described by
+// `output_spec`. As for libyuv conversions, each chroma sample is used as is
+// for the 2x2 luma samples it covers.
+template <typename T>
+void RunYuvConversionKernel(const FrameBuffer::YuvData& yuv_data,
+                            const TensorBufferSpec& output_spec) {
+  T* output = static_cast<T*>(output_spec.data);
+  const std::array<float, 3>& scale = output_spec.scale;
+  const std::array<float, 3>& offset = output_spec.offset;
+  float rgb[kRgbChannels];
+  for (int y = 0; y < output_spec.dimension.height; ++y) {
+    const uint8* y_row = yuv_data.y_buffer + y * yuv_data.y_row_stride;
+    const uint8* u_row = yuv_data.u_buffer + (y / 2) * yuv_data.uv_row_stride;
+    const uint8* v_row = yuv_data.v_buffer + (y / 2) * yuv_data.uv_row_stride;
+    for (int x = 0; x < output_spec.dimension.width; ++x) {
+      const int uv_offset = (x / 2) * yuv_data.uv_pixel_stride;
+      ConvertYuvToRgb(y_row[x], u_row[uv_offset], v_row[uv_offset], rgb);
+      *output++ = ConvertValue<T>(rgb[0] * scale[0] + offset[0]);
+      *output++ = ConvertValue<T>(rgb[1] * scale[1] + offset[1]);
+      *output++ = ConvertValue<T>(rgb[2] * scale[2] + offset[2]);
+    }
+  }
+}
+
+// Writes the upright grayscale image `data`, which has the destination
+// dimensions, into the destination buffer described by `output_spec`.
+template <typename T>
+void RunGrayConversionKernel(const uint8* data, int row_stride,
+                             const TensorBufferSpec& output_spec) {
+  T* output = static_cast<T*>(output_spec.data);
+  const float scale = output_spec.scale[0];
+  const float offset = output_spec.offset[0];
+  for (int y = 0; y < output_spec.dimension.height; ++y) {
+    const uint8* row = data + y * row_stride;
+    for (int x = 0; x < output_spec.dimension.width; ++x) {
+      *output++ = ConvertValue<T>(row[x] * scale + offset);
+    }
+  }
+}
+
+// Returns the size in bytes of a single element of the given type.
+size_t GetElementByteSize(TensorBufferSpec::ElementType element_type) {
+  return element_type == TensorBufferSpec::ElementType::kFloat32
+             ? sizeof(float)
+             : sizeof(uint8);
+}
+
+absl::Status ValidatePreprocessingInputs(const FrameBuffer& buffer,
+                                         const BoundingBox& roi,
+                                         const TensorBufferSpec& output_spec) {
+  RETURN_IF_ERROR(ValidateBufferPlaneMetadata(buffer));
+  RETURN_IF_ERROR(ValidateBufferFormat(buffer));
+  if (roi.width() <= 0 || roi.height() <= 0 || roi.origin_x() < 0 ||
+      roi.origin_y() < 0 ||
+      roi.origin_x() + roi.width() > buffer.dimension().width ||
+      roi.origin_y() + roi.height() > buffer.dimension().height) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid crop region (%d, %d, %d, %d) for a %dx%d "
+                        "frame buffer.",
+                        roi.origin_x(), roi.origin_y(), roi.width(),
+                        roi.height(), buffer.dimension().width,
+                        buffer.dimension().height),
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (output_spec.data == nullptr || output_spec.dimension.width <= 0 ||
+      output_spec.dimension.height <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "The output buffer must be non-null and have positive dimensions.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (output_spec.num_channels != 1 && output_spec.num_channels != 3) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected 1 or 3 output channels, got %d.",
+                        output_spec.num_channels),
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (output_spec.byte_size !=
+      output_spec.dimension.Size() * output_spec.num_channels *
+          GetElementByteSize(output_spec.element_type)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Size mismatch or unsupported padding bytes between pixel data and "
+        "output buffer.",
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+StatusOr<TensorBufferSpec> BuildTensorBufferSpec(const ImageTensorSpecs& specs,
+                                                 TfLiteTensor* tensor) {
+  TensorBufferSpec result;
+  result.data = tensor->data.raw;
+  result.byte_size = tensor->bytes;
+  result.dimension = {specs.image_width, specs.image_height};
+  result.num_channels = GetNumChannels(specs.color_space);
+
+  std::array<float, 3> mean_values = {0.0f, 0.0f, 0.0f};
+  std::array<float, 3> std_values = {1.0f, 1.0f, 1.0f};
+  if (specs.normalization_options.has_value()) {
+    const NormalizationOptions& options = specs.normalization_options.value();
+    for (int c = 0; c < kRgbChannels; ++c) {
+      const int index = options.num_values == 1 ? 0 : c;
+      mean_values[c] = options.mean_values[index];
+      std_values[c] = options.std_values[index];
+    }
+  }
+
+  switch (tensor->type) {
+    case kTfLiteUInt8:
+      // No normalization required: pixel values are copied as is.
+      result.element_type = TensorBufferSpec::ElementType::kUInt8;
+      break;
+    case kTfLiteFloat32:
+      if (!specs.normalization_options.has_value()) {
+        return CreateStatusWithPayload(
+            StatusCode::kNotFound,
+            "Input tensor has type kTfLiteFloat32: it requires specifying "
+            "NormalizationOptions metadata to preprocess input images.",
+            TfLiteSupportStatus::kMetadataMissingNormalizationOptionsError);
+      }
+      result.element_type = TensorBufferSpec::ElementType::kFloat32;
+      for (int c = 0; c < kRgbChannels; ++c) {
+        result.scale[c] = 1.0f / std_values[c];
+        result.offset[c] = -mean_values[c] / std_values[c];
+      }
+      break;
+    case kTfLiteInt8: {
+      const float quantization_scale = tensor->params.scale;
+      if (quantization_scale <= 0.0f) {
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument,
+            "Input tensor has type kTfLiteInt8: it requires a positive "
+            "quantization scale.",
+            TfLiteSupportStatus::kInvalidInputTensorTypeError);
+      }
+      result.element_type = TensorBufferSpec::ElementType::kInt8;
+      for (int c = 0; c < kRgbChannels; ++c) {
+        result.scale[c] = 1.0f / (std_values[c] * quantization_scale);
+        result.offset[c] = tensor->params.zero_point -
+                           mean_values[c] * result.scale[c];
+      }
+      break;
+    }
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          absl::StrFormat("Unsupported input tensor type: %s.",
+                          TfLiteTypeGetName(tensor->type)),
+          TfLiteSupportStatus::kInvalidInputTensorTypeError);
+  }
+  return result;
+}
+
+absl::Status PreprocessIntoTensorBuffer(const FrameBuffer& buffer,
+                                        const BoundingBox& roi,
+                                        const TensorBufferSpec& output_spec) {
+  RETURN_IF_ERROR(ValidatePreprocessingInputs(buffer, roi, output_spec));
+
+  // Dimensions of the resized image, before orientation is applied.
+  FrameBuffer::Dimension resize_dimension = output_spec.dimension;
+  if (RequireDimensionSwap(buffer.orientation(),
+                           FrameBuffer::Orientation::kTopLeft)) {
+    resize_dimension.Swap();
+  }
+  const OrientationMapping mapping =
+      GetOrientationMapping(buffer.orientation(), output_spec.dimension);
+
+  const std::vector<AxisSample> x_samples =
+      BuildAxisSamples(roi.origin_x(), roi.width(), resize_dimension.width,
+                       buffer.dimension().width, /*subsampled=*/false);
+  const std::vector<AxisSample> y_samples =
+      BuildAxisSamples(roi.origin_y(), roi.height(), resize_dimension.height,
+                       buffer.dimension().height, /*subsampled=*/false);
+
+  switch (buffer.format()) {
+    case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kRGBA:
+      RunKernel(PackedSampler</*kIsGray=*/false>(buffer.plane(0), x_samples,
+                                                 y_samples),
+                mapping, output_spec);
+      break;
+    case FrameBuffer::Format::kBGR:
+    case FrameBuffer::Format::kBGRA:
+      RunKernel(PackedSampler</*kIsGray=*/false>(buffer.plane(0), x_samples,
+                                                 y_samples, /*is_bgr=*/true),
+                mapping, output_spec);
+      break;
+    case FrameBuffer::Format::kGRAY:
+      RunKernel(
+          PackedSampler</*kIsGray=*/true>(buffer.plane(0), x_samples,
+                                          y_samples),
+          mapping, output_spec);
+      break;
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+      ASSIGN_OR_RETURN(
+          FrameBuffer::Dimension uv_dimension,
+          GetUvPlaneDimension(buffer.dimension(), buffer.format()));
+      const std::vector<AxisSample> uv_x_samples =
+          BuildAxisSamples(roi.origin_x(), roi.width(), resize_dimension.width,
+                           uv_dimension.width, /*subsampled=*/true);
+      const std::vector<AxisSample> uv_y_samples = BuildAxisSamples(
+          roi.origin_y(), roi.height(), resize_dimension.height,
+          uv_dimension.height, /*subsampled=*/true);
+      RunKernel(YuvSampler(yuv_data, x_samples, y_samples, uv_x_samples,
+                           uv_y_samples),
+                mapping, output_spec);
+      break;
+    }
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY: {
+      // Chroma is only subsampled horizontally, each chroma sample being a
+      // macropixel apart from the next one.
+      const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+      const uint8* data = buffer.plane(0).buffer;
+      const int row_stride = buffer.plane(0).stride.row_stride_bytes;
+      const int u_offset = is_yuyv ? 1 : 0;
+      const FrameBuffer::YuvData yuv_data = {
+          /*y_buffer=*/is_yuyv ? data : data + 1,
+          /*u_buffer=*/data + u_offset,
+          /*v_buffer=*/data + u_offset + 2,
+          /*y_row_stride=*/row_stride,
+          /*uv_row_stride=*/row_stride,
+          /*uv_pixel_stride=*/kPackedYuv422MacropixelBytes};
+      const std::vector<AxisSample> uv_x_samples = BuildAxisSamples(
+          roi.origin_x(), roi.width(), resize_dimension.width,
+          (buffer.dimension().width + 1) / 2, /*subsampled=*/true);
+      RunKernel(YuvSampler(yuv_data, x_samples, y_samples, uv_x_samples,
+                           y_samples, kPackedYuv422PixelBytes),
+                mapping, output_spec);
+      break;
+    }
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInternal,
+          absl::StrFormat("Format %i is not supported.", buffer.format()),
+          TfLiteSupportStatus::kImageProcessingError);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status PreprocessYuvIntoTensorBuffer(
+    const FrameBuffer& buffer, const BoundingBox& roi,
+    const TensorBufferSpec& output_spec, FrameBufferUtils* utils,
+    ScratchArena* scratch_buffer, InterpolationMethod interpolation,
+    absl::optional<uint8> letterbox_padding_value) {
+  RETURN_IF_ERROR(ValidatePreprocessingInputs(buffer, roi, output_spec));
+  const FrameBuffer::Format format = buffer.format();
+  if (!IsYuvFormat(format)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Format %i is not a YUV420 family format.", format),
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+
+  const FrameBuffer::Dimension dimension = output_spec.dimension;
+  if (output_spec.num_channels == 1) {
+    // Upright grayscale image of the destination dimensions, which
+    // `FrameBufferUtils` computes from the luma plane only.
+    uint8* data = scratch_buffer->Get(dimension.Size());
+    std::unique_ptr<FrameBuffer> gray_buffer =
+        CreateFromGrayRawBuffer(data, dimension);
+    if (letterbox_padding_value.has_value()) {
+      RETURN_IF_ERROR(utils->PreprocessWithLetterbox(
+          buffer, roi, letterbox_padding_value.value(), gray_buffer.get(),
+          interpolation));
+    } else {
+      RETURN_IF_ERROR(
+          utils->Preprocess(buffer, roi, gray_buffer.get(), interpolation));
+    }
+    switch (output_spec.element_type) {
+      case TensorBufferSpec::ElementType::kUInt8:
+        RunGrayConversionKernel<uint8>(data, dimension.width, output_spec);
+        break;
+      case TensorBufferSpec::ElementType::kInt8:
+        RunGrayConversionKernel<int8>(data, dimension.width, output_spec);
+        break;
+      case TensorBufferSpec::ElementType::kFloat32:
+        RunGrayConversionKernel<float>(data, dimension.width, output_spec);
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  // Upright YUV image of the destination dimensions. NV12 and NV21 chroma rows
+  // are padded to an even number of bytes, so that they never overlap.
+  const FrameBuffer::Dimension uv_dimension = {(dimension.width + 1) / 2,
+                                               (dimension.height + 1) / 2};
+  const int y_size = dimension.Size();
+  const int uv_size = uv_dimension.Size();
+  uint8* data = scratch_buffer->Get(y_size + 2 * uv_size);
+  std::vector<FrameBuffer::Plane> planes = {
+      {data, {/*row_stride_bytes=*/dimension.width, /*pixel_stride_bytes=*/1}}};
+  if (format == FrameBuffer::Format::kNV12 ||
+      format == FrameBuffer::Format::kNV21) {
+    planes.push_back({data + y_size,
+                      {/*row_stride_bytes=*/uv_dimension.width * 2,
+                       /*pixel_stride_bytes=*/2}});
+  } else {
+    planes.push_back({data + y_size,
+                      {/*row_stride_bytes=*/uv_dimension.width,
+                       /*pixel_stride_bytes=*/1}});
+    planes.push_back({data + y_size + uv_size,
+                      {/*row_stride_bytes=*/uv_dimension.width,
+                       /*pixel_stride_bytes=*/1}});
+  }
+  std::unique_ptr<FrameBuffer> yuv_buffer = FrameBuffer::Create(
+      planes, dimension, format, FrameBuffer::Orientation::kTopLeft);
+  if (letterbox_padding_value.has_value()) {
+    RETURN_IF_ERROR(utils->PreprocessWithLetterbox(
+        buffer, roi, letterbox_padding_value.value(), yuv_buffer.get(),
+        interpolation));
+  } else {
+    RETURN_IF_ERROR(
+        utils->Preprocess(buffer, roi, yuv_buffer.get(), interpolation));
+  }
+
+  ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(*yuv_buffer));
+  switch (output_spec.element_type) {
+    case TensorBufferSpec::ElementType::kUInt8:
+      RunYuvConversionKernel<uint8>(yuv_data, output_spec);
+      break;
+    case TensorBufferSpec::ElementType::kInt8:
+      RunYuvConversionKernel<int8>(yuv_data, output_spec);
+      break;
+    case TensorBufferSpec::ElementType::kFloat32:
+      RunYuvConversionKernel<float>(yuv_data, output_spec);
+      break;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
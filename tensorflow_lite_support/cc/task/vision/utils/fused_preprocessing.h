@@ -0,0 +1,136 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FUSED_PREPROCESSING_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FUSED_PREPROCESSING_H_
+
+#include <array>
+#include <cstddef>
+
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Description of a destination buffer holding an upright, interleaved RGB
+// image (i.e. a 1 x height x width x 3 input tensor), or an upright grayscale
+// image (i.e. a 1 x height x width x 1 input tensor).
+//
+// Each output value is computed from the corresponding 8-bit color channel
+// value `pixel` (in [0, 255]) as:
+//
+//   value = pixel * scale[channel] + offset[channel]
+//
+// For integer element types, `value` is then rounded to the nearest integer
+// and saturated to the range of the type.
+struct TensorBufferSpec {
+  // Element type of the destination buffer.
+  enum class ElementType { kUInt8, kInt8, kFloat32 };
+
+  // Pointer to the first element of the destination buffer. Not owned.
+  void* data;
+  // Size of the destination buffer in bytes. Must be exactly
+  // `dimension.Size() * num_channels * sizeof(element type)`.
+  size_t byte_size;
+  ElementType element_type;
+  // Width and height of the destination image.
+  FrameBuffer::Dimension dimension;
+  // Number of channels of the destination image: 3 for RGB, 1 for grayscale.
+  int num_channels = 3;
+  // Per-channel affine transformation parameters (see above). Grayscale
+  // images only use the first value.
+  std::array<float, 3> scale = {1.0f, 1.0f, 1.0f};
+  std::array<float, 3> offset = {0.0f, 0.0f, 0.0f};
+};
+
+// Builds the TensorBufferSpec targeting `tensor`, which must be the input
+// tensor described by `specs`:
+// - kTfLiteUInt8 tensors are filled with the raw pixel values,
+// - kTfLiteFloat32 tensors are filled with the pixel values normalized using
+//   `specs.normalization_options`,
+// - kTfLiteInt8 tensors are filled with the pixel values, normalized using
+//   `specs.normalization_options` if any, then quantized using the tensor
+//   quantization parameters.
+// The number of channels is the one of `specs.color_space`.
+tflite::support::StatusOr<TensorBufferSpec> BuildTensorBufferSpec(
+    const ImageTensorSpecs& specs, TfLiteTensor* tensor);
+
+// Performs in a single pass all the operations needed to turn `buffer` into
+// the image described by `output_spec`, and writes the results directly into
+// the destination buffer. This approximates (in this order):
+// - cropping `buffer` to the region of interest `roi`,
+// - resizing it with bilinear interpolation (aspect-ratio *not* preserved) to
+//   the destination dimensions, swapped if the orientation requires it,
+// - converting it to RGB, or to grayscale (in which case YUV buffers only
+//   have their luma plane sampled, as for `FrameBufferUtils::Convert`),
+// - rotating it according to its `Orientation` so that the result is upright,
+// - applying the per-channel affine transformation and type conversion
+//   described by `output_spec`,
+// but no intermediate image is ever written to memory: each output value is
+// computed by directly sampling the source planes.
+//
+// Results are not bit-exact with `FrameBufferUtils::Preprocess` followed by
+// the same transformation: sampling happens on a float center-aligned grid,
+// and YUV is converted with float BT.601 coefficients at full chroma
+// resolution. On natural images, values differ by up to 1.5 levels on
+// average (3 levels for YUV to RGB), see fused_preprocessing_test.
+//
+// All formats supported by FrameBuffer are accepted as input. As for
+// `FrameBufferUtils::Preprocess`, `roi` is expressed in the unrotated
+// coordinates system of `buffer` and must lie within its bounds.
+absl::Status PreprocessIntoTensorBuffer(const FrameBuffer& buffer,
+                                        const BoundingBox& roi,
+                                        const TensorBufferSpec& output_spec);
+
+// Same as `PreprocessIntoTensorBuffer` for YUV420 family frame buffers (NV12,
+// NV21, YV12, YV21), but working in two passes on data of the destination
+// dimensions instead of sampling the full resolution source for each output
+// value:
+// - the luma and chroma planes of `roi` are cropped, resized with the given
+//   `interpolation` method (or letterboxed if `letterbox_padding_value` is
+//   set, see `FrameBufferUtils::PreprocessWithLetterbox`) and rotated by
+//   `utils` into an upright YUV image held by `scratch_buffer`,
+// - this image is then converted to RGB straight into the destination buffer,
+//   applying the transformation described by `output_spec`.
+// No RGB image is ever written to memory, and the planes are resized with the
+// vectorized scalers of the process engine of `utils`. For grayscale
+// destinations, only the luma plane is resized, and its values are written
+// without any color conversion.
+//
+// Grayscale results match `FrameBufferUtils::Preprocess` followed by the same
+// transformation. RGB results don't, as `FrameBufferUtils::Preprocess`
+// converts to RGB before resizing: values differ by up to 2 levels, and 0.5
+// on average, see fused_preprocessing_test.
+absl::Status PreprocessYuvIntoTensorBuffer(
+    const FrameBuffer& buffer, const BoundingBox& roi,
+    const TensorBufferSpec& output_spec, FrameBufferUtils* utils,
+    ScratchArena* scratch_buffer,
+    InterpolationMethod interpolation = InterpolationMethod::kBilinear,
+    absl::optional<uint8> letterbox_padding_value = absl::nullopt);
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FUSED_PREPROCESSING_H_
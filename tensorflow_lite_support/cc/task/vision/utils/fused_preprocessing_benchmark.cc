@@ -0,0 +1,128 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares single-pass pre-processing into a float input tensor against the
+// two-pass path it replaces when enabled, i.e. `FrameBufferUtils::Preprocess`
+// followed by a PixelNormalizer.
+//
+// Arguments are: frame width, frame height, frame format (as an integer).
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/fused_preprocessing.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+constexpr FrameBuffer::Dimension kTensorDimension = {224, 224};
+constexpr int kNumChannels = 3;
+
+std::vector<uint8> CreateTestFrameData(FrameBuffer::Dimension dimension,
+                                       FrameBuffer::Format format) {
+  std::vector<uint8> data(GetFrameBufferByteSize(dimension, format));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8>(i * 7 + i / 3);
+  }
+  return data;
+}
+
+BoundingBox CreateFullFrameRoi(FrameBuffer::Dimension dimension) {
+  BoundingBox roi;
+  roi.set_width(dimension.width);
+  roi.set_height(dimension.height);
+  return roi;
+}
+
+void BM_PreprocessTwoPass(benchmark::State& state) {
+  const FrameBuffer::Dimension dimension = {static_cast<int>(state.range(0)),
+                                            static_cast<int>(state.range(1))};
+  const auto format = static_cast<FrameBuffer::Format>(state.range(2));
+  std::vector<uint8> frame_data = CreateTestFrameData(dimension, format);
+  std::unique_ptr<FrameBuffer> frame =
+      CreateFromRawBuffer(frame_data.data(), dimension, format).value();
+  const BoundingBox roi = CreateFullFrameRoi(dimension);
+  std::unique_ptr<FrameBufferUtils> utils =
+      FrameBufferUtils::Create(FrameBufferUtils::ProcessEngine::kLibyuv);
+  std::vector<uint8> pixels(kTensorDimension.Size() * kNumChannels);
+  std::unique_ptr<FrameBuffer> output =
+      CreateFromRawBuffer(pixels.data(), kTensorDimension,
+                          FrameBuffer::Format::kRGB)
+          .value();
+  NormalizationOptions options;
+  options.num_values = 1;
+  options.mean_values.fill(127.5f);
+  options.std_values.fill(127.5f);
+  std::unique_ptr<PixelNormalizer> normalizer =
+      PixelNormalizer::Create(options, kNumChannels).value();
+  std::vector<float> tensor(pixels.size());
+  for (auto s : state) {
+    utils->Preprocess(*frame, roi, output.get()).IgnoreError();
+    normalizer->Normalize(pixels.data(), pixels.size(), tensor.data());
+    benchmark::DoNotOptimize(tensor.data());
+  }
+}
+
+void BM_PreprocessSinglePass(benchmark::State& state) {
+  const FrameBuffer::Dimension dimension = {static_cast<int>(state.range(0)),
+                                            static_cast<int>(state.range(1))};
+  const auto format = static_cast<FrameBuffer::Format>(state.range(2));
+  std::vector<uint8> frame_data = CreateTestFrameData(dimension, format);
+  std::unique_ptr<FrameBuffer> frame =
+      CreateFromRawBuffer(frame_data.data(), dimension, format).value();
+  const BoundingBox roi = CreateFullFrameRoi(dimension);
+  std::vector<float> tensor(kTensorDimension.Size() * kNumChannels);
+  TensorBufferSpec spec;
+  spec.data = tensor.data();
+  spec.byte_size = tensor.size() * sizeof(float);
+  spec.element_type = TensorBufferSpec::ElementType::kFloat32;
+  spec.dimension = kTensorDimension;
+  spec.scale.fill(1.0f / 127.5f);
+  spec.offset.fill(-1.0f);
+  for (auto s : state) {
+    PreprocessIntoTensorBuffer(*frame, roi, spec).IgnoreError();
+    benchmark::DoNotOptimize(tensor.data());
+  }
+}
+
+void PreprocessArguments(benchmark::internal::Benchmark* benchmark) {
+  for (FrameBuffer::Format format :
+       {FrameBuffer::Format::kRGB, FrameBuffer::Format::kRGBA,
+        FrameBuffer::Format::kNV21}) {
+    for (const FrameBuffer::Dimension& dimension :
+         {FrameBuffer::Dimension{320, 240}, FrameBuffer::Dimension{640, 480},
+          FrameBuffer::Dimension{1280, 720}}) {
+      benchmark->Args(
+          {dimension.width, dimension.height, static_cast<int>(format)});
+    }
+  }
+}
+
+BENCHMARK(BM_PreprocessTwoPass)->Apply(PreprocessArguments);
+BENCHMARK(BM_PreprocessSinglePass)->Apply(PreprocessArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
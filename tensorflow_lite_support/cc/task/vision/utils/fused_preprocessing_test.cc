@@ -0,0 +1,315 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/fused_preprocessing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+using Orientation = FrameBuffer::Orientation;
+
+// Normalization parameters mapping [0, 255] to [-1, 1].
+constexpr float kMeanValue = 127.5f;
+constexpr float kStdValue = 127.5f;
+
+// Returns the value of channel `channel` of the test pattern at (x, y): smooth
+// variations with some fine texture, standing for natural images.
+uint8 GetPatternValue(int x, int y, int channel) {
+  const float value =
+      128.0f + 70.0f * std::sin(x * 0.05f + channel) *
+                   std::cos(y * 0.04f - channel) +
+      30.0f * std::sin((x + y) * 0.011f * (channel + 1)) +
+      ((x * 7 + y * 13 + channel * 5) % 11 - 5);
+  return static_cast<uint8>(std::max(0.0f, std::min(255.0f, value)));
+}
+
+// Frame buffer filled with the test pattern, along with its backing data.
+struct TestFrame {
+  std::vector<uint8> data;
+  std::unique_ptr<FrameBuffer> buffer;
+};
+
+TestFrame CreateTestFrame(FrameBuffer::Dimension dimension, Format format,
+                          Orientation orientation) {
+  TestFrame frame;
+  frame.data.resize(GetFrameBufferByteSize(dimension, format));
+  frame.buffer = CreateFromRawBuffer(frame.data.data(), dimension, format,
+                                     orientation)
+                     .value();
+  if (format == Format::kRGB || format == Format::kRGBA ||
+      format == Format::kGRAY) {
+    const int pixel_stride = GetPixelStrides(format).value();
+    for (int y = 0; y < dimension.height; ++y) {
+      for (int x = 0; x < dimension.width; ++x) {
+        uint8* pixel =
+            frame.data.data() + (y * dimension.width + x) * pixel_stride;
+        for (int c = 0; c < pixel_stride; ++c) {
+          pixel[c] = c == 3 ? 255 : GetPatternValue(x, y, c);
+        }
+      }
+    }
+    return frame;
+  }
+  // YUV formats: chroma has a lower amplitude than luma, as in real images.
+  const FrameBuffer::YuvData yuv_data =
+      FrameBuffer::GetYuvDataFromFrameBuffer(*frame.buffer).value();
+  for (int y = 0; y < dimension.height; ++y) {
+    for (int x = 0; x < dimension.width; ++x) {
+      const_cast<uint8*>(yuv_data.y_buffer)[y * yuv_data.y_row_stride + x] =
+          GetPatternValue(x, y, 0);
+    }
+  }
+  for (int y = 0; y < (dimension.height + 1) / 2; ++y) {
+    for (int x = 0; x < (dimension.width + 1) / 2; ++x) {
+      const int offset =
+          y * yuv_data.uv_row_stride + x * yuv_data.uv_pixel_stride;
+      const_cast<uint8*>(yuv_data.u_buffer)[offset] =
+          128 + (GetPatternValue(2 * x, 2 * y, 1) - 128) / 2;
+      const_cast<uint8*>(yuv_data.v_buffer)[offset] =
+          128 + (GetPatternValue(2 * x, 2 * y, 2) - 128) / 2;
+    }
+  }
+  return frame;
+}
+
+TensorBufferSpec CreateFloatSpec(FrameBuffer::Dimension dimension,
+                                 int num_channels, std::vector<float>* data) {
+  data->assign(dimension.Size() * num_channels, 0.0f);
+  TensorBufferSpec spec;
+  spec.data = data->data();
+  spec.byte_size = data->size() * sizeof(float);
+  spec.element_type = TensorBufferSpec::ElementType::kFloat32;
+  spec.dimension = dimension;
+  spec.num_channels = num_channels;
+  spec.scale.fill(1.0f / kStdValue);
+  spec.offset.fill(-kMeanValue / kStdValue);
+  return spec;
+}
+
+// Pre-processes `frame` the two-pass way, i.e. with
+// `FrameBufferUtils::Preprocess` (or `PreprocessWithLetterbox` if
+// `letterbox_padding_value` is set) followed by a PixelNormalizer.
+std::vector<float> PreprocessWithProcessEngine(
+    const FrameBuffer& frame, const BoundingBox& roi,
+    FrameBuffer::Dimension dimension, int num_channels,
+    InterpolationMethod interpolation = InterpolationMethod::kBilinear,
+    absl::optional<uint8> letterbox_padding_value = absl::nullopt) {
+  std::unique_ptr<FrameBufferUtils> utils =
+      FrameBufferUtils::Create(FrameBufferUtils::ProcessEngine::kLibyuv);
+  std::vector<uint8> pixels(dimension.Size() * num_channels);
+  std::unique_ptr<FrameBuffer> output =
+      CreateFromRawBuffer(pixels.data(), dimension,
+                          num_channels == 1 ? Format::kGRAY : Format::kRGB)
+          .value();
+  if (letterbox_padding_value.has_value()) {
+    EXPECT_TRUE(utils
+                    ->PreprocessWithLetterbox(frame, roi,
+                                              *letterbox_padding_value,
+                                              output.get(), interpolation)
+                    .ok());
+  } else {
+    EXPECT_TRUE(
+        utils->Preprocess(frame, roi, output.get(), interpolation).ok());
+  }
+  NormalizationOptions options;
+  options.num_values = 1;
+  options.mean_values.fill(kMeanValue);
+  options.std_values.fill(kStdValue);
+  std::unique_ptr<PixelNormalizer> normalizer =
+      PixelNormalizer::Create(options, num_channels).value();
+  std::vector<float> values(pixels.size());
+  normalizer->Normalize(pixels.data(), pixels.size(), values.data());
+  return values;
+}
+
+// Maximum and mean absolute differences, in 8-bit pixel levels.
+struct Difference {
+  float max = 0.0f;
+  float mean = 0.0f;
+};
+
+Difference ComputeDifference(const std::vector<float>& values,
+                             const std::vector<float>& expected_values) {
+  Difference difference;
+  double sum = 0.0;
+  for (size_t i = 0; i < values.size(); ++i) {
+    const float level_difference =
+        std::fabs(values[i] - expected_values[i]) * kStdValue;
+    difference.max = std::max(difference.max, level_difference);
+    sum += level_difference;
+  }
+  difference.mean = sum / values.size();
+  return difference;
+}
+
+struct FusedPreprocessingParams {
+  Format format;
+  Orientation orientation;
+  int num_channels;
+};
+
+std::vector<FusedPreprocessingParams> GetAllParams() {
+  std::vector<FusedPreprocessingParams> params;
+  for (Format format : {Format::kRGB, Format::kRGBA, Format::kGRAY,
+                        Format::kNV12, Format::kNV21, Format::kYV12,
+                        Format::kYV21}) {
+    for (int orientation = 1; orientation <= 8; ++orientation) {
+      for (int num_channels : {1, 3}) {
+        if (format == Format::kGRAY && num_channels == 3) {
+          continue;
+        }
+        params.push_back({format, static_cast<Orientation>(orientation),
+                          num_channels});
+      }
+    }
+  }
+  return params;
+}
+
+bool IsYuvFormat(Format format) {
+  return format == Format::kNV12 || format == Format::kNV21 ||
+         format == Format::kYV12 || format == Format::kYV21;
+}
+
+class FusedPreprocessingTest
+    : public ::testing::TestWithParam<FusedPreprocessingParams> {};
+
+// Single-pass pre-processing samples the source on a float center-aligned
+// grid and converts YUV with float BT.601 coefficients, so it is not
+// bit-exact with the ProcessEngine operations. This bounds the differences.
+TEST_P(FusedPreprocessingTest, StaysCloseToProcessEngine) {
+  const FusedPreprocessingParams& params = GetParam();
+  // Converting YUV to RGB after resizing the chroma planes, as the
+  // ProcessEngine does, shifts the chroma sampling phase.
+  const bool converts_yuv =
+      IsYuvFormat(params.format) && params.num_channels == 3;
+  const float max_difference = converts_yuv ? 20.0f : 6.0f;
+  const float max_mean_difference = converts_yuv ? 3.5f : 2.0f;
+  for (FrameBuffer::Dimension frame_dimension :
+       {FrameBuffer::Dimension{640, 480}, FrameBuffer::Dimension{301, 199}}) {
+    for (FrameBuffer::Dimension tensor_dimension :
+         {FrameBuffer::Dimension{224, 160}, FrameBuffer::Dimension{300, 300}}) {
+      TestFrame frame = CreateTestFrame(frame_dimension, params.format,
+                                        params.orientation);
+      BoundingBox roi;
+      roi.set_origin_x(6);
+      roi.set_origin_y(4);
+      roi.set_width(frame_dimension.width - 20);
+      roi.set_height(frame_dimension.height - 10);
+
+      std::vector<float> values;
+      const TensorBufferSpec spec =
+          CreateFloatSpec(tensor_dimension, params.num_channels, &values);
+      ASSERT_TRUE(PreprocessIntoTensorBuffer(*frame.buffer, roi, spec).ok());
+      const Difference difference = ComputeDifference(
+          values, PreprocessWithProcessEngine(*frame.buffer, roi,
+                                              tensor_dimension,
+                                              params.num_channels));
+      EXPECT_LE(difference.max, max_difference);
+      EXPECT_LE(difference.mean, max_mean_difference);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormatsAndOrientations, FusedPreprocessingTest,
+                         ::testing::ValuesIn(GetAllParams()));
+
+std::vector<FusedPreprocessingParams> GetYuvParams() {
+  std::vector<FusedPreprocessingParams> params;
+  for (const FusedPreprocessingParams& param : GetAllParams()) {
+    if (IsYuvFormat(param.format)) {
+      params.push_back(param);
+    }
+  }
+  return params;
+}
+
+class DirectYuvPreprocessingTest
+    : public ::testing::TestWithParam<FusedPreprocessingParams> {};
+
+// Direct YUV pre-processing converts to RGB after resizing, whereas the
+// ProcessEngine converts the cropped region to RGB before resizing it, so RGB
+// values only differ by the rounding of the intermediate images. Grayscale
+// values are the resized luma plane in both cases, up to float rounding.
+TEST_P(DirectYuvPreprocessingTest, StaysCloseToProcessEngine) {
+  const FusedPreprocessingParams& params = GetParam();
+  const bool converts_yuv = params.num_channels == 3;
+  const float max_difference = converts_yuv ? 2.0f : 0.001f;
+  const float max_mean_difference = converts_yuv ? 0.5f : 0.001f;
+  std::unique_ptr<FrameBufferUtils> utils =
+      FrameBufferUtils::Create(FrameBufferUtils::ProcessEngine::kLibyuv);
+  ScratchArena scratch_buffer;
+  for (FrameBuffer::Dimension frame_dimension :
+       {FrameBuffer::Dimension{640, 480}, FrameBuffer::Dimension{301, 199}}) {
+    TestFrame frame =
+        CreateTestFrame(frame_dimension, params.format, params.orientation);
+    BoundingBox roi;
+    roi.set_origin_x(6);
+    roi.set_origin_y(4);
+    roi.set_width(frame_dimension.width - 20);
+    roi.set_height(frame_dimension.height - 10);
+    for (FrameBuffer::Dimension tensor_dimension :
+         {FrameBuffer::Dimension{224, 160}, FrameBuffer::Dimension{300, 300}}) {
+      for (InterpolationMethod interpolation :
+           {InterpolationMethod::kBilinear, InterpolationMethod::kArea,
+            InterpolationMethod::kNearestNeighbor}) {
+        for (absl::optional<uint8> letterbox_padding_value :
+             {absl::optional<uint8>(), absl::optional<uint8>(100)}) {
+          std::vector<float> values;
+          const TensorBufferSpec spec =
+              CreateFloatSpec(tensor_dimension, params.num_channels, &values);
+          ASSERT_TRUE(PreprocessYuvIntoTensorBuffer(
+                          *frame.buffer, roi, spec, utils.get(),
+                          &scratch_buffer, interpolation,
+                          letterbox_padding_value)
+                          .ok());
+          const Difference difference = ComputeDifference(
+              values, PreprocessWithProcessEngine(
+                          *frame.buffer, roi, tensor_dimension,
+                          params.num_channels, interpolation,
+                          letterbox_padding_value));
+          EXPECT_LE(difference.max, max_difference);
+          EXPECT_LE(difference.mean, max_mean_difference);
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormatsAndOrientations, DirectYuvPreprocessingTest,
+                         ::testing::ValuesIn(GetYuvParams()));
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
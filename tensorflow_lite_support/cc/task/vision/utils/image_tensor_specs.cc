@@ -27,6 +27,8 @@ namespace vision {
 namespace {
 
 using ::absl::StatusCode;
+using ::tflite::ColorSpaceType;
+using ::tflite::ColorSpaceType_GRAYSCALE;
 using ::tflite::ColorSpaceType_RGB;
 using ::tflite::ContentProperties;
 using ::tflite::ContentProperties_ImageProperties;
@@ -134,6 +136,10 @@ StatusOr<absl::optional<NormalizationOptions>> GetNormalizationOptionsIfAny(
 
 }  // namespace
 
+int GetNumChannels(tflite::ColorSpaceType color_space) {
+  return color_space == ColorSpaceType_GRAYSCALE ? 1 : 3;
+}
+
 StatusOr<ImageTensorSpecs> BuildInputImageTensorSpecs(
     const TfLiteEngine::Interpreter& interpreter,
     const tflite::metadata::ModelMetadataExtractor& metadata_extractor) {
@@ -163,14 +169,16 @@ StatusOr<ImageTensorSpecs> BuildInputImageTensorSpecs(
         "Only 4D tensors in BHWD layout are supported.",
         TfLiteSupportStatus::kInvalidInputTensorDimensionsError);
   }
-  static constexpr TfLiteType valid_types[] = {kTfLiteUInt8, kTfLiteFloat32};
+  static constexpr TfLiteType valid_types[] = {kTfLiteUInt8, kTfLiteInt8,
+                                               kTfLiteFloat32};
   TfLiteType input_type = input_tensor->type;
   if (!absl::c_linear_search(valid_types, input_type)) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrCat(
             "Type mismatch for input tensor ", input_tensor->name,
-            ". Requested one of these types: kTfLiteUint8/kTfLiteFloat32, got ",
+            ". Requested one of these types: "
+            "kTfLiteUint8/kTfLiteInt8/kTfLiteFloat32, got ",
             TfLiteTypeGetName(input_type), "."),
         TfLiteSupportStatus::kInvalidInputTensorTypeError);
   }
@@ -182,19 +190,38 @@ StatusOr<ImageTensorSpecs> BuildInputImageTensorSpecs(
   const int width = input_tensor->dims->data[2];
   const int depth = input_tensor->dims->data[3];
 
-  if (props != nullptr && props->color_space() != ColorSpaceType_RGB) {
-    return CreateStatusWithPayload(StatusCode::kInvalidArgument,
-                                   "Only RGB color space is supported for now.",
-                                   TfLiteSupportStatus::kInvalidArgumentError);
+  // Without metadata, the color space is inferred from the number of
+  // channels.
+  ColorSpaceType color_space =
+      depth == 1 ? ColorSpaceType_GRAYSCALE : ColorSpaceType_RGB;
+  if (props != nullptr) {
+    color_space = props->color_space();
+    if (color_space != ColorSpaceType_RGB &&
+        color_space != ColorSpaceType_GRAYSCALE) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          "Only RGB and GRAYSCALE color spaces are supported for now.",
+          TfLiteSupportStatus::kInvalidArgumentError);
+    }
   }
-  if (batch != 1 || depth != 3) {
+  const int num_channels = GetNumChannels(color_space);
+  if (batch != 1 || depth != num_channels) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrCat("The input tensor should have dimensions 1 x height x "
-                     "width x 3. Got ",
-                     batch, " x ", height, " x ", width, " x ", depth, "."),
+                     "width x ",
+                     num_channels, ". Got ", batch, " x ", height, " x ",
+                     width, " x ", depth, "."),
         TfLiteSupportStatus::kInvalidInputTensorDimensionsError);
   }
+  if (normalization_options.has_value() && num_channels == 1 &&
+      normalization_options.value().num_values != 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "NormalizationOptions: grayscale input tensors expect a single mean "
+        "and std value.",
+        TfLiteSupportStatus::kMetadataInvalidProcessUnitsError);
+  }
   int bytes_size = input_tensor->bytes;
   size_t byte_depth =
       input_type == kTfLiteFloat32 ? sizeof(float) : sizeof(uint8);
@@ -236,13 +263,12 @@ StatusOr<ImageTensorSpecs> BuildInputImageTensorSpecs(
   }
 
   // Note: in the future, additional checks against `props->default_size()`
-  // might be added. Also, verify that NormalizationOptions, if any, do specify
-  // a single value when color space is grayscale.
+  // might be added.
 
   ImageTensorSpecs result;
   result.image_width = width;
   result.image_height = height;
-  result.color_space = ColorSpaceType_RGB;
+  result.color_space = color_space;
   result.tensor_type = input_type;
   result.normalization_options = normalization_options;
 
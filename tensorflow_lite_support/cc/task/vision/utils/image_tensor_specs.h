@@ -29,7 +29,8 @@ namespace task {
 namespace vision {
 
 // Parameters used for input image normalization when input tensor has
-// kTfLiteFloat32 type.
+// kTfLiteFloat32 type. They are also applied, before quantization, when input
+// tensor has kTfLiteInt8 type.
 //
 // Exactly 1 or 3 values are expected for `mean_values` and `std_values`. In
 // case 1 value only is specified, it is used for all channels. E.g. for a RGB
@@ -59,7 +60,7 @@ struct ImageTensorSpecs {
   // Expected image dimensions, e.g. image_width=224, image_height=224.
   int image_width;
   int image_height;
-  // Expected color space, e.g. color_space=RGB.
+  // Expected color space, i.e. RGB (3 channels) or GRAYSCALE (1 channel).
   tflite::ColorSpaceType color_space;
   // Expected input tensor type, e.g. if tensor_type=kTfLiteFloat32 the caller
   // should usually perform some normalization to convert the uint8 pixels into
@@ -73,11 +74,16 @@ struct ImageTensorSpecs {
   absl::optional<NormalizationOptions> normalization_options;
 };
 
+// Returns the number of channels of images in the given color space, i.e. 1
+// for GRAYSCALE and 3 for RGB.
+int GetNumChannels(tflite::ColorSpaceType color_space);
+
 // Performs sanity checks on the expected input tensor including consistency
-// checks against model metadata, if any. For now, a single RGB input with BHWD
-// layout, where B = 1 and D = 3, is expected. Returns the corresponding input
-// specifications if they pass, or an error otherwise (too many input tensors,
-// etc).
+// checks against model metadata, if any. For now, a single RGB or GRAYSCALE
+// input with BHWD layout, where B = 1 and D = 3 or 1 respectively, is
+// expected. Without metadata, the color space is GRAYSCALE if D = 1, RGB
+// otherwise. Returns the corresponding input specifications if they pass, or
+// an error otherwise (too many input tensors, etc).
 // Note: both interpreter and metadata extractor *must* be successfully
 // initialized before calling this function by means of (respectively):
 // - `tflite::InterpreterBuilder`,
@@ -0,0 +1,35 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow_lite_support/cc/task/vision/utils/interpolation_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+InterpolationMethod GetInterpolationMethod(
+    Interpolation::Method interpolation_method) {
+  switch (interpolation_method) {
+    case Interpolation::AREA:
+      return InterpolationMethod::kArea;
+    case Interpolation::NEAREST_NEIGHBOR:
+      return InterpolationMethod::kNearestNeighbor;
+    default:
+      return InterpolationMethod::kBilinear;
+  }
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -19,7 +19,9 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/port/integral_types.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/bilinear_scaler.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
 
 namespace tflite {
@@ -41,7 +44,7 @@ using ::tflite::support::TfLiteSupportStatus;
 namespace {
 
 // Converts NV12 `buffer` to the `output_buffer` of the target color space.
-// Supported output format includes RGB24 and YV21.
+// Supported output format includes RGB24, BGR24 and YV21.
 absl::Status ConvertFromNv12(const FrameBuffer& buffer,
                              FrameBuffer* output_buffer) {
   ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
@@ -78,6 +81,37 @@ absl::Status ConvertFromNv12(const FrameBuffer& buffer,
       }
       break;
     }
+    case FrameBuffer::Format::kBGR: {
+      // The RGB24 format of Libyuv represents the 8-bit interleaved RGB format
+      // with B being the first byte in memory.
+      int ret = libyuv::NV12ToRGB24(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.u_buffer,
+          yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv NV12ToRGB24 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
+    case FrameBuffer::Format::kBGRA: {
+      // The libyuv ARGB format is interleaved BGRA format in memory.
+      int ret = libyuv::NV12ToARGB(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.u_buffer,
+          yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv NV12ToARGB operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21: {
       ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
@@ -128,7 +162,7 @@ absl::Status ConvertFromNv12(const FrameBuffer& buffer,
 }
 
 // Converts NV21 `buffer` into the `output_buffer` of the target color space.
-// Supported output format includes RGB24 and YV21.
+// Supported output format includes RGB24, BGR24 and YV21.
 absl::Status ConvertFromNv21(const FrameBuffer& buffer,
                              FrameBuffer* output_buffer) {
   ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
@@ -139,7 +173,7 @@ absl::Status ConvertFromNv21(const FrameBuffer& buffer,
       // the big endian style with R being the first byte in memory.
       int ret = libyuv::NV21ToRAW(
           yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.v_buffer,
-          yuv_data.uv_pixel_stride,
+          yuv_data.uv_row_stride,
           const_cast<uint8*>(output_buffer->plane(0).buffer),
           output_buffer->plane(0).stride.row_stride_bytes,
           buffer.dimension().width, buffer.dimension().height);
@@ -154,7 +188,7 @@ absl::Status ConvertFromNv21(const FrameBuffer& buffer,
       // The libyuv ABGR format is interleaved RGBA format in memory.
       int ret = libyuv::NV21ToABGR(
           yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.v_buffer,
-          yuv_data.uv_pixel_stride,
+          yuv_data.uv_row_stride,
           const_cast<uint8*>(output_buffer->plane(0).buffer),
           output_buffer->plane(0).stride.row_stride_bytes,
           buffer.dimension().width, buffer.dimension().height);
@@ -165,6 +199,37 @@ absl::Status ConvertFromNv21(const FrameBuffer& buffer,
       }
       break;
     }
+    case FrameBuffer::Format::kBGR: {
+      // The RGB24 format of Libyuv represents the 8-bit interleaved RGB format
+      // with B being the first byte in memory.
+      int ret = libyuv::NV21ToRGB24(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.v_buffer,
+          yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv NV21ToRGB24 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
+    case FrameBuffer::Format::kBGRA: {
+      // The libyuv ARGB format is interleaved BGRA format in memory.
+      int ret = libyuv::NV21ToARGB(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.v_buffer,
+          yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv NV21ToARGB operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21: {
       ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
@@ -218,7 +283,7 @@ absl::Status ConvertFromNv21(const FrameBuffer& buffer,
 }
 
 // Converts YV12/YV21 `buffer` to the `output_buffer` of the target color space.
-// Supported output format includes RGB24, NV12, and NV21.
+// Supported output format includes RGB24, BGR24, NV12, and NV21.
 absl::Status ConvertFromYv(const FrameBuffer& buffer,
                            FrameBuffer* output_buffer) {
   ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
@@ -255,6 +320,37 @@ absl::Status ConvertFromYv(const FrameBuffer& buffer,
       }
       break;
     }
+    case FrameBuffer::Format::kBGR: {
+      // The RGB24 format of Libyuv represents the 8-bit interleaved RGB format
+      // with B being the first byte in memory.
+      int ret = libyuv::I420ToRGB24(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.u_buffer,
+          yuv_data.uv_row_stride, yuv_data.v_buffer, yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv I420ToRGB24 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
+    case FrameBuffer::Format::kBGRA: {
+      // The libyuv ARGB format is interleaved BGRA format in memory.
+      int ret = libyuv::I420ToARGB(
+          yuv_data.y_buffer, yuv_data.y_row_stride, yuv_data.u_buffer,
+          yuv_data.uv_row_stride, yuv_data.v_buffer, yuv_data.uv_row_stride,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv I420ToARGB operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
     case FrameBuffer::Format::kNV12: {
       ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
                        FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
@@ -327,13 +423,12 @@ absl::Status ConvertFromYv(const FrameBuffer& buffer,
 }
 
 // Resizes YV12/YV21 `buffer` to the target `output_buffer`.
-absl::Status ResizeYv(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+absl::Status ResizeYv(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                      libyuv::FilterMode filter_mode) {
   ASSIGN_OR_RETURN(FrameBuffer::YuvData input_data,
                    FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
   ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
                    FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
-  // TODO(b/151217096): Choose the optimal image resizing filter to optimize
-  // the model inference performance.
   int ret = libyuv::I420Scale(
       input_data.y_buffer, input_data.y_row_stride, input_data.u_buffer,
       input_data.uv_row_stride, input_data.v_buffer, input_data.uv_row_stride,
@@ -342,7 +437,7 @@ absl::Status ResizeYv(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
       const_cast<uint8_t*>(output_data.u_buffer), output_data.uv_row_stride,
       const_cast<uint8_t*>(output_data.v_buffer), output_data.uv_row_stride,
       output_buffer->dimension().width, output_buffer->dimension().height,
-      libyuv::FilterMode::kFilterBilinear);
+      filter_mode);
   if (ret != 0) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown, "Libyuv I420Scale operation failed.",
@@ -352,7 +447,8 @@ absl::Status ResizeYv(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
 }
 
 // Resizes NV12/NV21 `buffer` to the target `output_buffer`.
-absl::Status ResizeNv(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+absl::Status ResizeNv(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                      libyuv::FilterMode filter_mode) {
   const int buffer_size =
       GetFrameBufferByteSize(buffer.dimension(), FrameBuffer::Format::kYV21);
   auto yuv_raw_buffer = absl::make_unique<uint8[]>(buffer_size);
@@ -383,20 +479,24 @@ absl::Status ResizeNv(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
                                        output_buffer->dimension(),
                                        FrameBuffer::Format::kYV12,
                                        output_buffer->orientation()));
-  RETURN_IF_ERROR(ResizeYv(*yuv_buffer, resized_yuv_buffer.get()));
+  RETURN_IF_ERROR(
+      ResizeYv(*yuv_buffer, resized_yuv_buffer.get(), filter_mode));
 
   RETURN_IF_ERROR(ConvertFromYv(*resized_yuv_buffer, output_buffer));
   return absl::OkStatus();
 }
 
 // Converts `buffer` to libyuv ARGB format and stores the conversion result
-// in `dest_argb`.
+// in `dest_argb`. kBGR buffers are accepted as well, in which case the red and
+// blue channels of the result are swapped, which is suitable for geometric
+// operations round tripping through ARGB.
 absl::Status ConvertRgbToArgb(const FrameBuffer& buffer, uint8* dest_argb,
                               int dest_stride_argb) {
   RETURN_IF_ERROR(ValidateBufferPlaneMetadata(buffer));
-  if (buffer.format() != FrameBuffer::Format::kRGB) {
+  if (buffer.format() != FrameBuffer::Format::kRGB &&
+      buffer.format() != FrameBuffer::Format::kBGR) {
     return CreateStatusWithPayload(StatusCode::kInternal,
-                                   "RGB input format is expected.",
+                                   "RGB or BGR input format is expected.",
                                    TfLiteSupportStatus::kImageProcessingError);
   }
 
@@ -427,12 +527,14 @@ absl::Status ConvertRgbToArgb(const FrameBuffer& buffer, uint8* dest_argb,
 }
 
 // Converts `src_argb` in libyuv ARGB format to FrameBuffer::kRGB format and
-// stores the conversion result in `output_buffer`.
+// stores the conversion result in `output_buffer`. This is the inverse of
+// `ConvertRgbToArgb`, and likewise accepts kBGR output buffers.
 absl::Status ConvertArgbToRgb(uint8* src_argb, int src_stride_argb,
                               FrameBuffer* output_buffer) {
   RETURN_IF_ERROR(ValidateBufferPlaneMetadata(*output_buffer));
-  if (output_buffer->format() != FrameBuffer::Format::kRGB) {
-    return absl::InternalError("RGB input format is expected.");
+  if (output_buffer->format() != FrameBuffer::Format::kRGB &&
+      output_buffer->format() != FrameBuffer::Format::kBGR) {
+    return absl::InternalError("RGB or BGR input format is expected.");
   }
 
   if (src_argb == nullptr || src_stride_argb <= 0) {
@@ -503,7 +605,20 @@ absl::Status ConvertRgbaToArgb(const FrameBuffer& buffer, uint8* dest_argb,
 // Converts kRGB `buffer` to the `output_buffer` of the target color space.
 absl::Status ConvertFromRgb(const FrameBuffer& buffer,
                             FrameBuffer* output_buffer) {
-  if (output_buffer->format() == FrameBuffer::Format::kGRAY) {
+  if (output_buffer->format() == FrameBuffer::Format::kBGR) {
+    // Swapping the red and blue channels converts in both directions.
+    int ret = libyuv::RAWToRGB24(
+        buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+        const_cast<uint8*>(output_buffer->plane(0).buffer),
+        output_buffer->plane(0).stride.row_stride_bytes,
+        buffer.dimension().width, buffer.dimension().height);
+    if (ret != 0) {
+      return CreateStatusWithPayload(
+          StatusCode::kInternal, "Libyuv RAWToRGB24 operation failed.",
+          TfLiteSupportStatus::kImageProcessingBackendError);
+    }
+    return absl::OkStatus();
+  } else if (output_buffer->format() == FrameBuffer::Format::kGRAY) {
     int ret = libyuv::RAWToJ400(
         buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
         const_cast<uint8*>(output_buffer->plane(0).buffer),
@@ -658,6 +773,35 @@ absl::Status ConvertFromRgba(const FrameBuffer& buffer,
       }
       break;
     }
+    case FrameBuffer::Format::kBGRA: {
+      // Swapping the red and blue channels converts in both directions.
+      int ret = libyuv::ABGRToARGB(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv ABGRToARGB operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
+    case FrameBuffer::Format::kBGR: {
+      // Reading the kRGBA buffer as ARGB (BGRA in memory) swaps the red and
+      // blue channels, which RAW (RGB in memory) then keeps in that order.
+      int ret = libyuv::ARGBToRAW(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv ARGBToRAW operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      break;
+    }
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -668,6 +812,441 @@ absl::Status ConvertFromRgba(const FrameBuffer& buffer,
   return absl::OkStatus();
 }
 
+// Converts kBGR `buffer` to the `output_buffer` of the target color space.
+// kBGR is the libyuv RGB24 format.
+absl::Status ConvertFromBgr(const FrameBuffer& buffer,
+                            FrameBuffer* output_buffer) {
+  switch (output_buffer->format()) {
+    case FrameBuffer::Format::kRGB: {
+      // Swapping the red and blue channels converts in both directions.
+      int ret = libyuv::RAWToRGB24(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv RAWToRGB24 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      return absl::OkStatus();
+    }
+    case FrameBuffer::Format::kGRAY: {
+      int ret = libyuv::RGB24ToJ400(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv RGB24ToJ400 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      return absl::OkStatus();
+    }
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      // As for kRGB, kNV12 / kNV21 outputs are produced through I420.
+      const bool is_nv =
+          output_buffer->format() == FrameBuffer::Format::kNV12 ||
+          output_buffer->format() == FrameBuffer::Format::kNV21;
+      FrameBuffer::YuvData yuv_data;
+      std::unique_ptr<uint8[]> tmp_yuv_buffer;
+      std::unique_ptr<FrameBuffer> yuv_frame_buffer;
+      if (is_nv) {
+        tmp_yuv_buffer = absl::make_unique<uint8[]>(GetFrameBufferByteSize(
+            buffer.dimension(), FrameBuffer::Format::kYV21));
+        ASSIGN_OR_RETURN(
+            yuv_frame_buffer,
+            CreateFromRawBuffer(tmp_yuv_buffer.get(), buffer.dimension(),
+                                FrameBuffer::Format::kYV21,
+                                output_buffer->orientation()));
+        ASSIGN_OR_RETURN(yuv_data, FrameBuffer::GetYuvDataFromFrameBuffer(
+                                       *yuv_frame_buffer));
+      } else {
+        ASSIGN_OR_RETURN(yuv_data, FrameBuffer::GetYuvDataFromFrameBuffer(
+                                       *output_buffer));
+      }
+      int ret = libyuv::RGB24ToI420(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          const_cast<uint8*>(yuv_data.y_buffer), yuv_data.y_row_stride,
+          const_cast<uint8*>(yuv_data.u_buffer), yuv_data.uv_row_stride,
+          const_cast<uint8*>(yuv_data.v_buffer), yuv_data.uv_row_stride,
+          buffer.dimension().width, buffer.dimension().height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv RGB24ToI420 operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      if (is_nv) {
+        return ConvertFromYv(*yuv_frame_buffer, output_buffer);
+      }
+      return absl::OkStatus();
+    }
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInternal,
+          absl::StrFormat("Format %i is not supported.",
+                          output_buffer->format()),
+          TfLiteSupportStatus::kImageProcessingError);
+  }
+}
+
+// Converts kBGRA `buffer` to the `output_buffer` of the target color space.
+// kBGRA is the libyuv ARGB format, which is natively supported.
+absl::Status ConvertFromBgra(const FrameBuffer& buffer,
+                             FrameBuffer* output_buffer) {
+  const uint8* src = buffer.plane(0).buffer;
+  const int src_stride = buffer.plane(0).stride.row_stride_bytes;
+  const int width = buffer.dimension().width;
+  const int height = buffer.dimension().height;
+  int ret = 0;
+  const char* operation = "";
+  switch (output_buffer->format()) {
+    case FrameBuffer::Format::kRGB:
+      operation = "ARGBToRAW";
+      ret = libyuv::ARGBToRAW(
+          src, src_stride, const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes, width, height);
+      break;
+    case FrameBuffer::Format::kRGBA:
+      operation = "ARGBToABGR";
+      ret = libyuv::ARGBToABGR(
+          src, src_stride, const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes, width, height);
+      break;
+    case FrameBuffer::Format::kBGR:
+      operation = "ARGBToRGB24";
+      ret = libyuv::ARGBToRGB24(
+          src, src_stride, const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes, width, height);
+      break;
+    case FrameBuffer::Format::kGRAY:
+      operation = "ARGBToJ400";
+      ret = libyuv::ARGBToJ400(
+          src, src_stride, const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes, width, height);
+      break;
+    case FrameBuffer::Format::kNV12: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+      operation = "ARGBToNV12";
+      ret = libyuv::ARGBToNV12(
+          src, src_stride, const_cast<uint8*>(output_data.y_buffer),
+          output_data.y_row_stride, const_cast<uint8*>(output_data.u_buffer),
+          output_data.uv_row_stride, width, height);
+      break;
+    }
+    case FrameBuffer::Format::kNV21: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+      operation = "ARGBToNV21";
+      ret = libyuv::ARGBToNV21(
+          src, src_stride, const_cast<uint8*>(output_data.y_buffer),
+          output_data.y_row_stride, const_cast<uint8*>(output_data.v_buffer),
+          output_data.uv_row_stride, width, height);
+      break;
+    }
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+      operation = "ARGBToI420";
+      ret = libyuv::ARGBToI420(
+          src, src_stride, const_cast<uint8*>(output_data.y_buffer),
+          output_data.y_row_stride, const_cast<uint8*>(output_data.u_buffer),
+          output_data.uv_row_stride, const_cast<uint8*>(output_data.v_buffer),
+          output_data.uv_row_stride, width, height);
+      break;
+    }
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInternal,
+          absl::StrFormat("Format %i is not supported.",
+                          output_buffer->format()),
+          TfLiteSupportStatus::kImageProcessingError);
+  }
+  if (ret != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Libyuv %s operation failed.", operation),
+        TfLiteSupportStatus::kImageProcessingBackendError);
+  }
+  return absl::OkStatus();
+}
+
+// Planar YUV 4:2:2 image, used as intermediate representation to process
+// packed YUV 4:2:2 (kYUYV / kUYVY) buffers plane by plane.
+struct I422Image {
+  explicit I422Image(FrameBuffer::Dimension dimension)
+      : width(dimension.width),
+        height(dimension.height),
+        uv_width((dimension.width + 1) / 2),
+        data(absl::make_unique<uint8[]>((width + 2 * uv_width) * height)) {}
+
+  uint8* y() { return data.get(); }
+  uint8* u() { return data.get() + width * height; }
+  uint8* v() { return u() + uv_width * height; }
+
+  int width;
+  int height;
+  // Width of the chroma planes, which is also their row stride.
+  int uv_width;
+  std::unique_ptr<uint8[]> data;
+};
+
+// Unpacks the kYUYV / kUYVY `buffer` into `image`, which must have the same
+// dimension.
+absl::Status UnpackYuv422(const FrameBuffer& buffer, I422Image* image) {
+  const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+  int ret = (is_yuyv ? libyuv::YUY2ToI422 : libyuv::UYVYToI422)(
+      buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+      image->y(), image->width, image->u(), image->uv_width, image->v(),
+      image->uv_width, image->width, image->height);
+  if (ret != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Libyuv %s operation failed.",
+                        is_yuyv ? "YUY2ToI422" : "UYVYToI422"),
+        TfLiteSupportStatus::kImageProcessingBackendError);
+  }
+  return absl::OkStatus();
+}
+
+// Packs `image` into the kYUYV / kUYVY `output_buffer`, which must have the
+// same dimension.
+absl::Status PackYuv422(I422Image* image, FrameBuffer* output_buffer) {
+  const bool is_yuyv = output_buffer->format() == FrameBuffer::Format::kYUYV;
+  int ret = (is_yuyv ? libyuv::I422ToYUY2 : libyuv::I422ToUYVY)(
+      image->y(), image->width, image->u(), image->uv_width, image->v(),
+      image->uv_width, const_cast<uint8*>(output_buffer->plane(0).buffer),
+      output_buffer->plane(0).stride.row_stride_bytes, image->width,
+      image->height);
+  if (ret != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Libyuv %s operation failed.",
+                        is_yuyv ? "I422ToYUY2" : "I422ToUYVY"),
+        TfLiteSupportStatus::kImageProcessingBackendError);
+  }
+  return absl::OkStatus();
+}
+
+// Converts kYUYV / kUYVY `buffer` to the `output_buffer` of the target color
+// space. Conversions not natively supported by libyuv go through I422.
+absl::Status ConvertFromPackedYuv422(const FrameBuffer& buffer,
+                                     FrameBuffer* output_buffer) {
+  const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+  const uint8* src = buffer.plane(0).buffer;
+  const int src_stride = buffer.plane(0).stride.row_stride_bytes;
+  const int width = buffer.dimension().width;
+  const int height = buffer.dimension().height;
+  switch (output_buffer->format()) {
+    case FrameBuffer::Format::kBGRA: {
+      int ret = (is_yuyv ? libyuv::YUY2ToARGB : libyuv::UYVYToARGB)(
+          src, src_stride, const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes, width, height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown,
+            absl::StrFormat("Libyuv %s operation failed.",
+                            is_yuyv ? "YUY2ToARGB" : "UYVYToARGB"),
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      return absl::OkStatus();
+    }
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+      int ret = (is_yuyv ? libyuv::YUY2ToI420 : libyuv::UYVYToI420)(
+          src, src_stride, const_cast<uint8*>(output_data.y_buffer),
+          output_data.y_row_stride, const_cast<uint8*>(output_data.u_buffer),
+          output_data.uv_row_stride, const_cast<uint8*>(output_data.v_buffer),
+          output_data.uv_row_stride, width, height);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown,
+            absl::StrFormat("Libyuv %s operation failed.",
+                            is_yuyv ? "YUY2ToI420" : "UYVYToI420"),
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      return absl::OkStatus();
+    }
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21: {
+      auto yuv_raw_buffer = absl::make_unique<uint8[]>(GetFrameBufferByteSize(
+          buffer.dimension(), FrameBuffer::Format::kYV21));
+      ASSIGN_OR_RETURN(
+          std::unique_ptr<FrameBuffer> yuv_buffer,
+          CreateFromRawBuffer(yuv_raw_buffer.get(), buffer.dimension(),
+                              FrameBuffer::Format::kYV21,
+                              output_buffer->orientation()));
+      RETURN_IF_ERROR(ConvertFromPackedYuv422(buffer, yuv_buffer.get()));
+      return ConvertFromYv(*yuv_buffer, output_buffer);
+    }
+    default:
+      break;
+  }
+
+  I422Image image(buffer.dimension());
+  RETURN_IF_ERROR(UnpackYuv422(buffer, &image));
+  uint8* dst = const_cast<uint8*>(output_buffer->plane(0).buffer);
+  const int dst_stride = output_buffer->plane(0).stride.row_stride_bytes;
+  int ret = 0;
+  const char* operation = "";
+  switch (output_buffer->format()) {
+    case FrameBuffer::Format::kRGB:
+      operation = "I422ToRAW";
+      ret = libyuv::I422ToRAW(image.y(), image.width, image.u(), image.uv_width,
+                              image.v(), image.uv_width, dst, dst_stride,
+                              width, height);
+      break;
+    case FrameBuffer::Format::kRGBA:
+      operation = "I422ToABGR";
+      ret = libyuv::I422ToABGR(image.y(), image.width, image.u(),
+                               image.uv_width, image.v(), image.uv_width, dst,
+                               dst_stride, width, height);
+      break;
+    case FrameBuffer::Format::kBGR:
+      operation = "I422ToRGB24";
+      ret = libyuv::I422ToRGB24(image.y(), image.width, image.u(),
+                                image.uv_width, image.v(), image.uv_width, dst,
+                                dst_stride, width, height);
+      break;
+    case FrameBuffer::Format::kGRAY:
+      libyuv::CopyPlane(image.y(), image.width, dst, dst_stride, width, height);
+      break;
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return PackYuv422(&image, output_buffer);
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInternal,
+          absl::StrFormat("Format %i is not supported.",
+                          output_buffer->format()),
+          TfLiteSupportStatus::kImageProcessingError);
+  }
+  if (ret != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Libyuv %s operation failed.", operation),
+        TfLiteSupportStatus::kImageProcessingBackendError);
+  }
+  return absl::OkStatus();
+}
+
+// Resizes kYUYV / kUYVY `buffer` to the target `output_buffer`, by scaling
+// each plane of its I422 representation.
+absl::Status ResizePackedYuv422(const FrameBuffer& buffer,
+                                FrameBuffer* output_buffer,
+                                libyuv::FilterMode filter_mode) {
+  I422Image image(buffer.dimension());
+  RETURN_IF_ERROR(UnpackYuv422(buffer, &image));
+  I422Image resized_image(output_buffer->dimension());
+  libyuv::ScalePlane(image.y(), image.width, image.width, image.height,
+                     resized_image.y(), resized_image.width,
+                     resized_image.width, resized_image.height, filter_mode);
+  libyuv::ScalePlane(image.u(), image.uv_width, image.uv_width, image.height,
+                     resized_image.u(), resized_image.uv_width,
+                     resized_image.uv_width, resized_image.height,
+                     filter_mode);
+  libyuv::ScalePlane(image.v(), image.uv_width, image.uv_width, image.height,
+                     resized_image.v(), resized_image.uv_width,
+                     resized_image.uv_width, resized_image.height,
+                     filter_mode);
+  return PackYuv422(&resized_image, output_buffer);
+}
+
+// Crops kYUYV / kUYVY `buffer` to the subregion defined by the top left pixel
+// position (x0, y0) and the bottom right pixel position (x1, y1).
+//
+// Crops starting on an even column copy whole macropixels. Otherwise the
+// macropixels are realigned, each output pixel pair using the chroma of the
+// macropixel holding its first pixel.
+absl::Status CropPackedYuv422(const FrameBuffer& buffer, int x0, int y0,
+                              int x1, int y1, FrameBuffer* output_buffer) {
+  if (buffer.plane_count() > 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInternal,
+        absl::StrFormat("Only single plane is supported for format %i.",
+                        buffer.format()),
+        TfLiteSupportStatus::kImageProcessingError);
+  }
+  const FrameBuffer::Dimension crop_dimension =
+      GetCropDimension(x0, x1, y0, y1);
+  const int src_stride = buffer.plane(0).stride.row_stride_bytes;
+  const int dst_stride = output_buffer->plane(0).stride.row_stride_bytes;
+  const uint8* src = buffer.plane(0).buffer + src_stride * y0 +
+                     x0 / 2 * kPackedYuv422MacropixelBytes;
+  uint8* dst = const_cast<uint8*>(output_buffer->plane(0).buffer);
+  const int row_bytes = GetFrameBufferByteSize({crop_dimension.width, 1},
+                                               output_buffer->format());
+  if (x0 % 2 == 0) {
+    libyuv::CopyPlane(src, src_stride, dst, dst_stride, row_bytes,
+                      crop_dimension.height);
+    return absl::OkStatus();
+  }
+
+  // Offsets of the first luma and chroma samples in a macropixel.
+  const bool is_yuyv = buffer.format() == FrameBuffer::Format::kYUYV;
+  const int y_offset = is_yuyv ? 0 : 1;
+  const int uv_offset = is_yuyv ? 1 : 0;
+  const int num_macropixels = (crop_dimension.width + 1) / 2;
+  // The second pixel of the last output macropixel may lie past the last
+  // column of `buffer`, in which case the first one is repeated.
+  const bool has_padding_pixel =
+      x0 + 2 * num_macropixels - 1 >= buffer.dimension().width;
+  for (int row = 0; row < crop_dimension.height; ++row) {
+    const uint8* src_row = src + row * src_stride;
+    uint8* dst_row = dst + row * dst_stride;
+    for (int i = 0; i < num_macropixels; ++i) {
+      const uint8* src_macropixel = src_row + i * kPackedYuv422MacropixelBytes;
+      uint8* dst_macropixel = dst_row + i * kPackedYuv422MacropixelBytes;
+      const bool is_last = i == num_macropixels - 1;
+      dst_macropixel[y_offset] = src_macropixel[y_offset + 2];
+      dst_macropixel[y_offset + 2] =
+          is_last && has_padding_pixel
+              ? src_macropixel[y_offset + 2]
+              : src_macropixel[kPackedYuv422MacropixelBytes + y_offset];
+      dst_macropixel[uv_offset] = src_macropixel[uv_offset];
+      dst_macropixel[uv_offset + 2] = src_macropixel[uv_offset + 2];
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Flips kYUYV / kUYVY `buffer` horizontally by mirroring each plane of its
+// I422 representation.
+absl::Status FlipHorizontallyPackedYuv422(const FrameBuffer& buffer,
+                                          FrameBuffer* output_buffer) {
+  I422Image image(buffer.dimension());
+  RETURN_IF_ERROR(UnpackYuv422(buffer, &image));
+  I422Image flipped_image(output_buffer->dimension());
+  libyuv::MirrorPlane(image.y(), image.width, flipped_image.y(),
+                      flipped_image.width, image.width, image.height);
+  libyuv::MirrorPlane(image.u(), image.uv_width, flipped_image.u(),
+                      flipped_image.uv_width, image.uv_width, image.height);
+  libyuv::MirrorPlane(image.v(), image.uv_width, flipped_image.v(),
+                      flipped_image.uv_width, image.uv_width, image.height);
+  return PackYuv422(&flipped_image, output_buffer);
+}
+
+// Returns the libyuv filter mode implementing `interpolation`.
+libyuv::FilterMode GetLibyuvFilterMode(InterpolationMethod interpolation) {
+  switch (interpolation) {
+    case InterpolationMethod::kArea:
+      return libyuv::FilterMode::kFilterBox;
+    case InterpolationMethod::kNearestNeighbor:
+      return libyuv::FilterMode::kFilterNone;
+    case InterpolationMethod::kBilinear:
+      break;
+  }
+  return libyuv::FilterMode::kFilterBilinear;
+}
+
 // Returns libyuv rotation based on counter-clockwise angle_deg.
 libyuv::RotationMode GetLibyuvRotationMode(int angle_deg) {
   switch (angle_deg) {
@@ -852,7 +1431,40 @@ absl::Status RotateNv(const FrameBuffer& buffer, int angle_deg,
   return absl::OkStatus();
 }
 
-// This method only supports kGRAY, kRGB, and kRGBA format.
+// Rotates kYUYV / kUYVY `buffer`. Chroma is upsampled to 4:4:4, rotated along
+// with luma, then downsampled back to 4:2:2 by averaging horizontal pairs.
+absl::Status RotatePackedYuv422(const FrameBuffer& buffer, int angle_deg,
+                                FrameBuffer* output_buffer) {
+  I422Image image(buffer.dimension());
+  RETURN_IF_ERROR(UnpackYuv422(buffer, &image));
+  I422Image rotated_image(output_buffer->dimension());
+  const libyuv::RotationMode rotation = GetLibyuvRotationMode(angle_deg % 360);
+  libyuv::RotatePlane(image.y(), image.width, rotated_image.y(),
+                      rotated_image.width, image.width, image.height, rotation);
+  // Full resolution chroma planes, before and after rotation.
+  const int plane_size = image.width * image.height;
+  auto chroma_buffer = absl::make_unique<uint8[]>(plane_size * 2);
+  uint8* full_chroma = chroma_buffer.get();
+  uint8* rotated_full_chroma = chroma_buffer.get() + plane_size;
+  for (int plane = 0; plane < 2; ++plane) {
+    uint8* src_chroma = plane == 0 ? image.u() : image.v();
+    uint8* dst_chroma = plane == 0 ? rotated_image.u() : rotated_image.v();
+    libyuv::ScalePlane(src_chroma, image.uv_width, image.uv_width,
+                       image.height, full_chroma, image.width, image.width,
+                       image.height, libyuv::FilterMode::kFilterNone);
+    libyuv::RotatePlane(full_chroma, image.width, rotated_full_chroma,
+                        rotated_image.width, image.width, image.height,
+                        rotation);
+    libyuv::ScalePlane(rotated_full_chroma, rotated_image.width,
+                       rotated_image.width, rotated_image.height, dst_chroma,
+                       rotated_image.uv_width, rotated_image.uv_width,
+                       rotated_image.height, libyuv::FilterMode::kFilterBox);
+  }
+  return PackYuv422(&rotated_image, output_buffer);
+}
+
+// This method only supports single plane formats, i.e. kGRAY, kRGB, kRGBA,
+// kBGR, kBGRA, kYUYV and kUYVY.
 absl::Status FlipPlaneVertically(const FrameBuffer& buffer,
                                  FrameBuffer* output_buffer) {
   if (buffer.plane_count() > 1) {
@@ -863,20 +1475,21 @@ absl::Status FlipPlaneVertically(const FrameBuffer& buffer,
         TfLiteSupportStatus::kImageProcessingError);
   }
 
-  ASSIGN_OR_RETURN(int pixel_stride, GetPixelStrides(buffer.format()));
+  // Bytes per row, which for packed YUV 4:2:2 formats cover whole macropixels.
+  const int row_bytes = GetFrameBufferByteSize(
+      {output_buffer->dimension().width, 1}, buffer.format());
 
   // Flip vertically is achieved by passing in negative height.
   libyuv::CopyPlane(buffer.plane(0).buffer,
                     buffer.plane(0).stride.row_stride_bytes,
                     const_cast<uint8*>(output_buffer->plane(0).buffer),
-                    output_buffer->plane(0).stride.row_stride_bytes,
-                    output_buffer->dimension().width * pixel_stride,
+                    output_buffer->plane(0).stride.row_stride_bytes, row_bytes,
                     -output_buffer->dimension().height);
 
   return absl::OkStatus();
 }
 
-// This method only supports kGRAY, kRGBA, and kRGB formats.
+// This method only supports kGRAY, kRGBA, kRGB, kBGRA and kBGR formats.
 absl::Status CropPlane(const FrameBuffer& buffer, int x0, int y0, int x1,
                        int y1, FrameBuffer* output_buffer) {
   if (buffer.plane_count() > 1) {
@@ -973,7 +1586,8 @@ absl::Status CropYv(const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
 }
 
 absl::Status CropResizeYuv(const FrameBuffer& buffer, int x0, int y0, int x1,
-                           int y1, FrameBuffer* output_buffer) {
+                           int y1, FrameBuffer* output_buffer,
+                           libyuv::FilterMode filter_mode) {
   FrameBuffer::Dimension crop_dimension = GetCropDimension(x0, x1, y0, y1);
   if (crop_dimension == output_buffer->dimension()) {
     switch (buffer.format()) {
@@ -1013,25 +1627,25 @@ absl::Status CropResizeYuv(const FrameBuffer& buffer, int x0, int y0, int x1,
       std::unique_ptr<FrameBuffer> cropped_buffer = FrameBuffer::Create(
           {cropped_plane_y, cropped_plane_u, cropped_plane_v}, crop_dimension,
           buffer.format(), buffer.orientation());
-      return ResizeNv(*cropped_buffer, output_buffer);
+      return ResizeNv(*cropped_buffer, output_buffer, filter_mode);
     }
     case FrameBuffer::Format::kNV21: {
       std::unique_ptr<FrameBuffer> cropped_buffer = FrameBuffer::Create(
           {cropped_plane_y, cropped_plane_v, cropped_plane_u}, crop_dimension,
           buffer.format(), buffer.orientation());
-      return ResizeNv(*cropped_buffer, output_buffer);
+      return ResizeNv(*cropped_buffer, output_buffer, filter_mode);
     }
     case FrameBuffer::Format::kYV12: {
       std::unique_ptr<FrameBuffer> cropped_buffer = FrameBuffer::Create(
           {cropped_plane_y, cropped_plane_v, cropped_plane_u}, crop_dimension,
           buffer.format(), buffer.orientation());
-      return ResizeYv(*cropped_buffer, output_buffer);
+      return ResizeYv(*cropped_buffer, output_buffer, filter_mode);
     }
     case FrameBuffer::Format::kYV21: {
       std::unique_ptr<FrameBuffer> cropped_buffer = FrameBuffer::Create(
           {cropped_plane_y, cropped_plane_u, cropped_plane_v}, crop_dimension,
           buffer.format(), buffer.orientation());
-      return ResizeYv(*cropped_buffer, output_buffer);
+      return ResizeYv(*cropped_buffer, output_buffer, filter_mode);
     }
     default:
       return CreateStatusWithPayload(
@@ -1087,7 +1701,41 @@ absl::Status FlipHorizontallyPlane(const FrameBuffer& buffer,
   return absl::OkStatus();
 }
 
-absl::Status ResizeRgb(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+// Resizes the kRGB `buffer` to `output_buffer` by sampling the nearest pixel,
+// using the same sampling grid as libyuv's `kFilterNone` mode.
+void ResizeRgbNearest(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+  const int src_width = buffer.dimension().width;
+  const int src_height = buffer.dimension().height;
+  const int dst_width = output_buffer->dimension().width;
+  const int dst_height = output_buffer->dimension().height;
+  // 16.16 fixed-point source position steps.
+  const int64 dx = (static_cast<int64>(src_width) << 16) / dst_width;
+  const int64 dy = (static_cast<int64>(src_height) << 16) / dst_height;
+  std::vector<int> src_offsets(dst_width);
+  int64 x = dx >> 1;
+  for (int i = 0; i < dst_width; ++i, x += dx) {
+    src_offsets[i] = static_cast<int>(x >> 16) * kRgbPixelBytes;
+  }
+  const int src_stride = buffer.plane(0).stride.row_stride_bytes;
+  const int dst_stride = output_buffer->plane(0).stride.row_stride_bytes;
+  int64 y = dy >> 1;
+  for (int row = 0; row < dst_height; ++row, y += dy) {
+    const uint8* src_row =
+        buffer.plane(0).buffer + static_cast<int>(y >> 16) * src_stride;
+    uint8* dst_row =
+        const_cast<uint8*>(output_buffer->plane(0).buffer) + row * dst_stride;
+    for (int i = 0; i < dst_width; ++i) {
+      const uint8* src_pixel = src_row + src_offsets[i];
+      dst_row[0] = src_pixel[0];
+      dst_row[1] = src_pixel[1];
+      dst_row[2] = src_pixel[2];
+      dst_row += kRgbPixelBytes;
+    }
+  }
+}
+
+absl::Status ResizeRgb(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                       libyuv::FilterMode filter_mode) {
   if (buffer.plane_count() > 1) {
     return CreateStatusWithPayload(
         StatusCode::kInternal,
@@ -1096,38 +1744,44 @@ absl::Status ResizeRgb(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
         TfLiteSupportStatus::kImageProcessingError);
   }
 
-  // libyuv doesn't support scale kRGB (RGB24) foramat. In this method,
-  // the implementation converts kRGB format to ARGB and use ARGB buffer for
-  // scaling. The result is then convert back to RGB.
-
-  // Convert RGB to ARGB
-  int argb_buffer_size =
-      GetFrameBufferByteSize(buffer.dimension(), FrameBuffer::Format::kRGBA);
-  auto argb_buffer = absl::make_unique<uint8[]>(argb_buffer_size);
-  const int argb_row_bytes = buffer.dimension().width * kRgbaPixelBytes;
-  RETURN_IF_ERROR(ConvertRgbToArgb(buffer, argb_buffer.get(), argb_row_bytes));
+  // libyuv doesn't support scaling kRGB (RGB24) format: use a dedicated
+  // bilinear scaler or nearest neighbor sampling rather than a round trip
+  // through the ARGB format.
+  if (filter_mode == libyuv::FilterMode::kFilterBilinear) {
+    return ResizeRgb24Bilinear(
+        buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+        buffer.dimension().width, buffer.dimension().height,
+        const_cast<uint8*>(output_buffer->plane(0).buffer),
+        output_buffer->plane(0).stride.row_stride_bytes,
+        output_buffer->dimension().width, output_buffer->dimension().height);
+  }
+  if (filter_mode == libyuv::FilterMode::kFilterNone) {
+    ResizeRgbNearest(buffer, output_buffer);
+    return absl::OkStatus();
+  }
 
-  // Resize ARGB
-  int resized_argb_buffer_size = GetFrameBufferByteSize(
-      output_buffer->dimension(), FrameBuffer::Format::kRGBA);
-  auto resized_argb_buffer =
-      absl::make_unique<uint8[]>(resized_argb_buffer_size);
-  int resized_argb_row_bytes =
+  // Other filters go through the ARGB format.
+  const int argb_buffer_stride = buffer.dimension().width * kRgbaPixelBytes;
+  auto argb_buffer = absl::make_unique<uint8[]>(argb_buffer_stride *
+                                                buffer.dimension().height);
+  RETURN_IF_ERROR(
+      ConvertRgbToArgb(buffer, argb_buffer.get(), argb_buffer_stride));
+  const int resized_argb_buffer_stride =
       output_buffer->dimension().width * kRgbaPixelBytes;
+  auto resized_argb_buffer = absl::make_unique<uint8[]>(
+      resized_argb_buffer_stride * output_buffer->dimension().height);
   int ret = libyuv::ARGBScale(
-      argb_buffer.get(), argb_row_bytes, buffer.dimension().width,
+      argb_buffer.get(), argb_buffer_stride, buffer.dimension().width,
       buffer.dimension().height, resized_argb_buffer.get(),
-      resized_argb_row_bytes, output_buffer->dimension().width,
-      output_buffer->dimension().height, libyuv::FilterMode::kFilterBilinear);
+      resized_argb_buffer_stride, output_buffer->dimension().width,
+      output_buffer->dimension().height, filter_mode);
   if (ret != 0) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown, "Libyuv ARGBScale operation failed.",
         TfLiteSupportStatus::kImageProcessingBackendError);
   }
-
-  // Convert ARGB to RGB
-  return ConvertArgbToRgb(resized_argb_buffer.get(), resized_argb_row_bytes,
-                          output_buffer);
+  return ConvertArgbToRgb(resized_argb_buffer.get(),
+                          resized_argb_buffer_stride, output_buffer);
 }
 
 // Horizontally flip `buffer` and store the result in `output_buffer`.
@@ -1159,7 +1813,8 @@ absl::Status FlipHorizontallyRgb(const FrameBuffer& buffer,
 #endif  // LIBYUV_VERSION >= 1747
 }
 
-absl::Status ResizeRgba(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+absl::Status ResizeRgba(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                        libyuv::FilterMode filter_mode) {
   if (buffer.plane_count() > 1) {
     return CreateStatusWithPayload(
         StatusCode::kInternal,
@@ -1173,7 +1828,7 @@ absl::Status ResizeRgba(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
       const_cast<uint8*>(output_buffer->plane(0).buffer),
       output_buffer->plane(0).stride.row_stride_bytes,
       output_buffer->dimension().width, output_buffer->dimension().height,
-      libyuv::FilterMode::kFilterBilinear);
+      filter_mode);
   if (ret != 0) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown, "Libyuv ARGBScale operation failed.",
@@ -1282,7 +1937,8 @@ absl::Status FlipVerticallyYv(const FrameBuffer& buffer,
 
 // Resize `buffer` to metadata defined in `output_buffer`. This
 // method assumes buffer has pixel stride equals to 1 (grayscale equivalent).
-absl::Status ResizeGray(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+absl::Status ResizeGray(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                        libyuv::FilterMode filter_mode) {
   if (buffer.plane_count() > 1) {
     return CreateStatusWithPayload(
         StatusCode::kInternal,
@@ -1296,13 +1952,52 @@ absl::Status ResizeGray(const FrameBuffer& buffer, FrameBuffer* output_buffer) {
       const_cast<uint8*>(output_buffer->plane(0).buffer),
       output_buffer->plane(0).stride.row_stride_bytes,
       output_buffer->dimension().width, output_buffer->dimension().height,
-      libyuv::FilterMode::kFilterBilinear);
+      filter_mode);
   return absl::OkStatus();
 }
 
-// This method only supports kGRAY, kRGBA, and kRGB formats.
+// Crops kYUYV / kUYVY `buffer` to the subregion defined by the top left pixel
+// position (x0, y0) and the bottom right pixel position (x1, y1), and resizes
+// it to the dimension of `output_buffer`.
+absl::Status CropResizePackedYuv422(const FrameBuffer& buffer, int x0, int y0,
+                                    int x1, int y1, FrameBuffer* output_buffer,
+                                    libyuv::FilterMode filter_mode) {
+  FrameBuffer::Dimension crop_dimension = GetCropDimension(x0, x1, y0, y1);
+  if (crop_dimension == output_buffer->dimension()) {
+    return CropPackedYuv422(buffer, x0, y0, x1, y1, output_buffer);
+  }
+
+  std::unique_ptr<uint8[]> cropped_raw_buffer;
+  std::unique_ptr<FrameBuffer> cropped_buffer;
+  if (x0 % 2 == 0) {
+    // Cropping is achieved by adjusting origin to the macropixel holding
+    // (x0, y0).
+    const int row_stride = buffer.plane(0).stride.row_stride_bytes;
+    FrameBuffer::Plane plane = {
+        /*buffer=*/buffer.plane(0).buffer + row_stride * y0 +
+            x0 / 2 * kPackedYuv422MacropixelBytes,
+        /*stride=*/{row_stride, kPackedYuv422PixelBytes}};
+    cropped_buffer =
+        FrameBuffer::Create({plane}, crop_dimension, buffer.format(),
+                            buffer.orientation(), buffer.timestamp());
+  } else {
+    // Macropixels need to be realigned first.
+    cropped_raw_buffer = absl::make_unique<uint8[]>(
+        GetFrameBufferByteSize(crop_dimension, buffer.format()));
+    ASSIGN_OR_RETURN(
+        cropped_buffer,
+        CreateFromRawBuffer(cropped_raw_buffer.get(), crop_dimension,
+                            buffer.format(), buffer.orientation()));
+    RETURN_IF_ERROR(
+        CropPackedYuv422(buffer, x0, y0, x1, y1, cropped_buffer.get()));
+  }
+  return ResizePackedYuv422(*cropped_buffer, output_buffer, filter_mode);
+}
+
+// This method only supports kGRAY, kRGBA, kRGB, kBGRA and kBGR formats.
 absl::Status CropResize(const FrameBuffer& buffer, int x0, int y0, int x1,
-                        int y1, FrameBuffer* output_buffer) {
+                        int y1, FrameBuffer* output_buffer,
+                        libyuv::FilterMode filter_mode) {
   FrameBuffer::Dimension crop_dimension = GetCropDimension(x0, x1, y0, y1);
   if (crop_dimension == output_buffer->dimension()) {
     return CropPlane(buffer, x0, y0, x1, y1, output_buffer);
@@ -1321,11 +2016,13 @@ absl::Status CropResize(const FrameBuffer& buffer, int x0, int y0, int x1,
 
   switch (buffer.format()) {
     case FrameBuffer::Format::kRGB:
-      return ResizeRgb(*adjusted_buffer, output_buffer);
+    case FrameBuffer::Format::kBGR:
+      return ResizeRgb(*adjusted_buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kRGBA:
-      return ResizeRgba(*adjusted_buffer, output_buffer);
+    case FrameBuffer::Format::kBGRA:
+      return ResizeRgba(*adjusted_buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kGRAY:
-      return ResizeGray(*adjusted_buffer, output_buffer);
+      return ResizeGray(*adjusted_buffer, output_buffer, filter_mode);
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -1347,13 +2044,21 @@ absl::Status LibyuvFrameBufferUtils::Crop(const FrameBuffer& buffer, int x0,
   switch (buffer.format()) {
     case FrameBuffer::Format::kRGBA:
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGRA:
+    case FrameBuffer::Format::kBGR:
     case FrameBuffer::Format::kGRAY:
-      return CropResize(buffer, x0, y0, x1, y1, output_buffer);
+      return CropResize(buffer, x0, y0, x1, y1, output_buffer,
+                        libyuv::FilterMode::kFilterBilinear);
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21:
-      return CropResizeYuv(buffer, x0, y0, x1, y1, output_buffer);
+      return CropResizeYuv(buffer, x0, y0, x1, y1, output_buffer,
+                           libyuv::FilterMode::kFilterBilinear);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return CropResizePackedYuv422(buffer, x0, y0, x1, y1, output_buffer,
+                                    libyuv::FilterMode::kFilterBilinear);
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -1364,20 +2069,99 @@ absl::Status LibyuvFrameBufferUtils::Crop(const FrameBuffer& buffer, int x0,
 
 absl::Status LibyuvFrameBufferUtils::Resize(const FrameBuffer& buffer,
                                             FrameBuffer* output_buffer) {
+  return ResizeWithInterpolation(buffer, InterpolationMethod::kBilinear,
+                                 output_buffer);
+}
+
+absl::Status LibyuvFrameBufferUtils::ResizeWithInterpolation(
+    const FrameBuffer& buffer, InterpolationMethod interpolation,
+    FrameBuffer* output_buffer) {
   RETURN_IF_ERROR(ValidateResizeBufferInputs(buffer, *output_buffer));
+  const libyuv::FilterMode filter_mode = GetLibyuvFilterMode(interpolation);
   switch (buffer.format()) {
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21:
-      return ResizeYv(buffer, output_buffer);
+      return ResizeYv(buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
-      return ResizeNv(buffer, output_buffer);
+      return ResizeNv(buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kRGB:
-      return ResizeRgb(buffer, output_buffer);
+    case FrameBuffer::Format::kBGR:
+      return ResizeRgb(buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kRGBA:
-      return ResizeRgba(buffer, output_buffer);
+    case FrameBuffer::Format::kBGRA:
+      return ResizeRgba(buffer, output_buffer, filter_mode);
     case FrameBuffer::Format::kGRAY:
-      return ResizeGray(buffer, output_buffer);
+      return ResizeGray(buffer, output_buffer, filter_mode);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return ResizePackedYuv422(buffer, output_buffer, filter_mode);
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInternal,
+          absl::StrFormat("Format %i is not supported.", buffer.format()),
+          TfLiteSupportStatus::kImageProcessingError);
+  }
+}
+
+bool LibyuvFrameBufferUtils::SupportsResizeRows(
+    FrameBuffer::Format format) const {
+  return format == FrameBuffer::Format::kRGB ||
+         format == FrameBuffer::Format::kRGBA ||
+         format == FrameBuffer::Format::kBGR ||
+         format == FrameBuffer::Format::kBGRA;
+}
+
+absl::Status LibyuvFrameBufferUtils::ResizeRows(const FrameBuffer& buffer,
+                                                int row_begin, int row_end,
+                                                FrameBuffer* output_buffer) {
+  RETURN_IF_ERROR(ValidateResizeBufferInputs(buffer, *output_buffer));
+  if (row_begin < 0 || row_begin >= row_end ||
+      row_end > output_buffer->dimension().height) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid row range [%d, %d) for output height %d.",
+                        row_begin, row_end, output_buffer->dimension().height),
+        TfLiteSupportStatus::kImageProcessingInvalidArgumentError);
+  }
+  if (buffer.plane_count() > 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInternal,
+        absl::StrFormat("Only single plane is supported for format %i.",
+                        buffer.format()),
+        TfLiteSupportStatus::kImageProcessingError);
+  }
+  switch (buffer.format()) {
+    case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
+      return ResizeRgb24BilinearRows(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          output_buffer->dimension().width, output_buffer->dimension().height,
+          row_begin, row_end);
+    case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA: {
+      // The clipped destination rows are bit-exact with the ones computed by
+      // ARGBScale in `ResizeRgba`.
+      int ret = libyuv::ARGBScaleClip(
+          buffer.plane(0).buffer, buffer.plane(0).stride.row_stride_bytes,
+          buffer.dimension().width, buffer.dimension().height,
+          const_cast<uint8*>(output_buffer->plane(0).buffer),
+          output_buffer->plane(0).stride.row_stride_bytes,
+          output_buffer->dimension().width, output_buffer->dimension().height,
+          /*clip_x=*/0, /*clip_y=*/row_begin,
+          /*clip_width=*/output_buffer->dimension().width,
+          /*clip_height=*/row_end - row_begin,
+          libyuv::FilterMode::kFilterBilinear);
+      if (ret != 0) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Libyuv ARGBScaleClip operation failed.",
+            TfLiteSupportStatus::kImageProcessingBackendError);
+      }
+      return absl::OkStatus();
+    }
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -1399,6 +2183,7 @@ absl::Status LibyuvFrameBufferUtils::Rotate(const FrameBuffer& buffer,
     case FrameBuffer::Format::kGRAY:
       return RotateGray(buffer, angle_deg, output_buffer);
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
       return RotateRgba(buffer, angle_deg, output_buffer);
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
@@ -1407,7 +2192,11 @@ absl::Status LibyuvFrameBufferUtils::Rotate(const FrameBuffer& buffer,
     case FrameBuffer::Format::kYV21:
       return RotateYv(buffer, angle_deg, output_buffer);
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
       return RotateRgb(buffer, angle_deg, output_buffer);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return RotatePackedYuv422(buffer, angle_deg, output_buffer);
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -1425,6 +2214,7 @@ absl::Status LibyuvFrameBufferUtils::FlipHorizontally(
 
   switch (buffer.format()) {
     case FrameBuffer::Format::kRGBA:
+    case FrameBuffer::Format::kBGRA:
       return FlipHorizontallyRgba(buffer, output_buffer);
     case FrameBuffer::Format::kYV12:
     case FrameBuffer::Format::kYV21:
@@ -1433,9 +2223,13 @@ absl::Status LibyuvFrameBufferUtils::FlipHorizontally(
     case FrameBuffer::Format::kNV21:
       return FlipHorizontallyNv(buffer, output_buffer);
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGR:
       return FlipHorizontallyRgb(buffer, output_buffer);
     case FrameBuffer::Format::kGRAY:
       return FlipHorizontallyPlane(buffer, output_buffer);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return FlipHorizontallyPackedYuv422(buffer, output_buffer);
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
@@ -1454,7 +2248,11 @@ absl::Status LibyuvFrameBufferUtils::FlipVertically(
   switch (buffer.format()) {
     case FrameBuffer::Format::kRGBA:
     case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kBGRA:
+    case FrameBuffer::Format::kBGR:
     case FrameBuffer::Format::kGRAY:
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
       return FlipPlaneVertically(buffer, output_buffer);
     case FrameBuffer::Format::kNV12:
     case FrameBuffer::Format::kNV21:
@@ -1486,6 +2284,13 @@ absl::Status LibyuvFrameBufferUtils::Convert(const FrameBuffer& buffer,
       return ConvertFromRgb(buffer, output_buffer);
     case FrameBuffer::Format::kRGBA:
       return ConvertFromRgba(buffer, output_buffer);
+    case FrameBuffer::Format::kBGR:
+      return ConvertFromBgr(buffer, output_buffer);
+    case FrameBuffer::Format::kBGRA:
+      return ConvertFromBgra(buffer, output_buffer);
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY:
+      return ConvertFromPackedYuv422(buffer, output_buffer);
     default:
       return CreateStatusWithPayload(
           StatusCode::kInternal,
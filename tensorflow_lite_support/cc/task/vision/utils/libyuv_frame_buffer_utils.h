@@ -48,6 +48,22 @@ class LibyuvFrameBufferUtils : public FrameBufferUtilsInterface {
   absl::Status Resize(const FrameBuffer& buffer,
                       FrameBuffer* output_buffer) override;
 
+  // Resizes `buffer` to the size of the given `output_buffer` using the given
+  // `interpolation` method. kArea interpolation falls back to bilinear
+  // interpolation when upscaling.
+  absl::Status ResizeWithInterpolation(const FrameBuffer& buffer,
+                                       InterpolationMethod interpolation,
+                                       FrameBuffer* output_buffer) override;
+
+  // Returns true for the kRGB and kRGBA formats.
+  bool SupportsResizeRows(FrameBuffer::Format format) const override;
+
+  // Computes the rows [row_begin, row_end) of the result of `Resize`.
+  //
+  // Only supports the kRGB and kRGBA formats.
+  absl::Status ResizeRows(const FrameBuffer& buffer, int row_begin,
+                          int row_end, FrameBuffer* output_buffer) override;
+
   // Rotates `buffer` counter-clockwise by the given `angle_deg` (in degrees).
   //
   // The given angle must be a multiple of 90 degrees.
@@ -0,0 +1,183 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/motion_gate.h"
+
+#include <cstdlib>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+/* static */
+StatusOr<std::unique_ptr<MotionGate>> MotionGate::Create(
+    const MotionGateOptions& options) {
+  if (options.signature_width <= 0 || options.signature_height <= 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid signature dimension: %dx%d.",
+                        options.signature_width, options.signature_height),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.pixel_difference_threshold < 0 ||
+      options.pixel_difference_threshold > 255) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid pixel_difference_threshold: %d. It must be "
+                        "in [0, 255].",
+                        options.pixel_difference_threshold),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.changed_fraction_threshold < 0 ||
+      options.changed_fraction_threshold > 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Invalid changed_fraction_threshold: %f. It must be "
+                        "in [0, 1].",
+                        options.changed_fraction_threshold),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return absl::WrapUnique(new MotionGate(options));
+}
+
+MotionGate::MotionGate(const MotionGateOptions& options)
+    : options_(options),
+      frame_buffer_utils_(
+          FrameBufferUtils::Create(FrameBufferUtils::ProcessEngine::kLibyuv)),
+      signature_(options.signature_width * options.signature_height),
+      reference_signature_(signature_.size()) {}
+
+absl::Status MotionGate::ComputeSignature(const FrameBuffer& frame_buffer) {
+  const FrameBuffer::Dimension signature_dimension = {
+      options_.signature_width, options_.signature_height};
+  // The signature keeps the frame orientation, so that no rotation happens.
+  std::unique_ptr<FrameBuffer> signature_buffer = CreateFromGrayRawBuffer(
+      signature_.data(), signature_dimension, frame_buffer.orientation());
+  switch (frame_buffer.format()) {
+    case FrameBuffer::Format::kGRAY:
+      return frame_buffer_utils_->Resize(frame_buffer, signature_buffer.get(),
+                                         InterpolationMethod::kArea);
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      // Only the luma plane is resized.
+      ASSIGN_OR_RETURN(const FrameBuffer::YuvData yuv_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(frame_buffer));
+      std::unique_ptr<FrameBuffer> luma_buffer = FrameBuffer::Create(
+          {{yuv_data.y_buffer, {yuv_data.y_row_stride, /*pixel_stride=*/1}}},
+          frame_buffer.dimension(), FrameBuffer::Format::kGRAY,
+          frame_buffer.orientation());
+      return frame_buffer_utils_->Resize(*luma_buffer, signature_buffer.get(),
+                                         InterpolationMethod::kArea);
+    }
+    case FrameBuffer::Format::kYUYV:
+    case FrameBuffer::Format::kUYVY: {
+      // Packed YUV 4:2:2 formats don't convert to grayscale: the luma values
+      // are extracted from the resized frame instead.
+      packed_signature_.resize(
+          GetFrameBufferByteSize(signature_dimension, frame_buffer.format()));
+      ASSIGN_OR_RETURN(
+          std::unique_ptr<FrameBuffer> packed_buffer,
+          CreateFromRawBuffer(packed_signature_.data(), signature_dimension,
+                              frame_buffer.format(),
+                              frame_buffer.orientation()));
+      RETURN_IF_ERROR(frame_buffer_utils_->Resize(
+          frame_buffer, packed_buffer.get(), InterpolationMethod::kArea));
+      const FrameBuffer::Plane& plane = packed_buffer->plane(0);
+      const int luma_offset =
+          frame_buffer.format() == FrameBuffer::Format::kUYVY ? 1 : 0;
+      for (int y = 0; y < signature_dimension.height; ++y) {
+        const uint8* src = plane.buffer + y * plane.stride.row_stride_bytes +
+                           luma_offset;
+        uint8* dst = signature_.data() + y * signature_dimension.width;
+        for (int x = 0; x < signature_dimension.width; ++x) {
+          dst[x] = src[x * kPackedYuv422PixelBytes];
+        }
+      }
+      return absl::OkStatus();
+    }
+    default:
+      // Resizing happens before the conversion to grayscale.
+      return frame_buffer_utils_->Preprocess(frame_buffer, absl::nullopt,
+                                             signature_buffer.get(),
+                                             InterpolationMethod::kArea);
+  }
+}
+
+StatusOr<bool> MotionGate::ShouldRunInference(const FrameBuffer& frame_buffer) {
+  RETURN_IF_ERROR(ComputeSignature(frame_buffer));
+  ++num_frames_;
+
+  bool should_run_inference =
+      !has_reference_ || frame_buffer.dimension() != reference_dimension_ ||
+      frame_buffer.format() != reference_format_ ||
+      frame_buffer.orientation() != reference_orientation_;
+  if (!should_run_inference && options_.max_consecutive_skipped_frames > 0 &&
+      num_consecutive_skipped_frames_ >=
+          options_.max_consecutive_skipped_frames) {
+    should_run_inference = true;
+  }
+  if (!should_run_inference && options_.max_staleness > absl::ZeroDuration() &&
+      frame_buffer.timestamp() - reference_timestamp_ >
+          options_.max_staleness) {
+    should_run_inference = true;
+  }
+  if (!should_run_inference) {
+    int num_changed_pixels = 0;
+    for (int i = 0; i < signature_.size(); ++i) {
+      if (std::abs(signature_[i] - reference_signature_[i]) >
+          options_.pixel_difference_threshold) {
+        ++num_changed_pixels;
+      }
+    }
+    should_run_inference =
+        num_changed_pixels >
+        options_.changed_fraction_threshold * signature_.size();
+  }
+
+  if (!should_run_inference) {
+    ++num_skipped_frames_;
+    ++num_consecutive_skipped_frames_;
+    return false;
+  }
+  signature_.swap(reference_signature_);
+  has_reference_ = true;
+  reference_dimension_ = frame_buffer.dimension();
+  reference_format_ = frame_buffer.format();
+  reference_orientation_ = frame_buffer.orientation();
+  reference_timestamp_ = frame_buffer.timestamp();
+  num_consecutive_skipped_frames_ = 0;
+  return true;
+}
+
+void MotionGate::Reset() {
+  has_reference_ = false;
+  num_consecutive_skipped_frames_ = 0;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,196 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_MOTION_GATE_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_MOTION_GATE_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Options for `MotionGate`.
+struct MotionGateOptions {
+  // Dimensions of the luma signature each frame is downsampled to before being
+  // compared with the reference frame. Each signature pixel averages a block
+  // of the frame, which filters out the sensor noise.
+  int signature_width = 32;
+  int signature_height = 32;
+
+  // A signature pixel is considered changed if its luma differs from the
+  // reference one by more than `pixel_difference_threshold` (in [0, 255]).
+  int pixel_difference_threshold = 8;
+
+  // Inference runs if the fraction of changed signature pixels exceeds
+  // `changed_fraction_threshold` (in [0, 1]). The default value of 1% detects
+  // changes covering about 10 pixels of a 32x32 signature, e.g. a small object
+  // moving in a corner of the frame.
+  float changed_fraction_threshold = 0.01f;
+
+  // Staleness bounds: inference runs at least every
+  // `max_consecutive_skipped_frames + 1` frames, and whenever the frame
+  // timestamp is more than `max_staleness` after the one of the last frame
+  // inference ran on. Non-positive values disable the corresponding bound.
+  int max_consecutive_skipped_frames = 30;
+  absl::Duration max_staleness = absl::ZeroDuration();
+};
+
+// Decides whether inference needs to run on the frames of a video stream, by
+// comparing a cheap downsampled luma signature of each frame with the one of
+// the last frame inference ran on. For static camera feeds, most frames are
+// then skipped, the last inference results remaining valid.
+//
+// Signatures are computed with `FrameBufferUtils` area resizing: the luma
+// plane of YUV frames is resized directly, while other formats are resized
+// then converted to grayscale. Comparing with the last frame inference ran on,
+// rather than with the previous frame, ensures that slow changes are
+// eventually detected.
+//
+// MotionGate is not thread-safe.
+class MotionGate {
+ public:
+  // Creates an instance with the given options, or returns an
+  // InvalidArgument error if they are invalid.
+  static tflite::support::StatusOr<std::unique_ptr<MotionGate>> Create(
+      const MotionGateOptions& options = MotionGateOptions());
+
+  // Returns whether inference needs to run on `frame_buffer`. If so, the
+  // caller is expected to run it, and `frame_buffer` becomes the reference
+  // frame the next ones are compared with. Inference always runs on the first
+  // frame, as well as on frames whose dimension, format or orientation differ
+  // from the reference frame ones.
+  tflite::support::StatusOr<bool> ShouldRunInference(
+      const FrameBuffer& frame_buffer);
+
+  // Forgets the reference frame, so that inference runs on the next frame,
+  // e.g. after inference failed on the reference frame.
+  void Reset();
+
+  // Returns the number of frames processed by `ShouldRunInference`, and the
+  // number of those for which inference was skipped.
+  int64 num_frames() const { return num_frames_; }
+  int64 num_skipped_frames() const { return num_skipped_frames_; }
+
+  // Returns the number of frames skipped since inference last ran.
+  int num_consecutive_skipped_frames() const {
+    return num_consecutive_skipped_frames_;
+  }
+
+ private:
+  explicit MotionGate(const MotionGateOptions& options);
+
+  // Computes the luma signature of `frame_buffer` into `signature_`.
+  absl::Status ComputeSignature(const FrameBuffer& frame_buffer);
+
+  const MotionGateOptions options_;
+  std::unique_ptr<FrameBufferUtils> frame_buffer_utils_;
+
+  // Signature of the current frame, and of the reference frame.
+  std::vector<uint8> signature_;
+  std::vector<uint8> reference_signature_;
+  // Downsampled packed YUV 4:2:2 frame, the luma signature is extracted from.
+  std::vector<uint8> packed_signature_;
+
+  // Metadata of the reference frame, if any.
+  bool has_reference_ = false;
+  FrameBuffer::Dimension reference_dimension_;
+  FrameBuffer::Format reference_format_ = FrameBuffer::Format::kRGB;
+  FrameBuffer::Orientation reference_orientation_ =
+      FrameBuffer::Orientation::kTopLeft;
+  absl::Time reference_timestamp_;
+
+  int64 num_frames_ = 0;
+  int64 num_skipped_frames_ = 0;
+  int num_consecutive_skipped_frames_ = 0;
+};
+
+// Streaming wrapper around a vision task, e.g. `ObjectDetector::Detect` or
+// `ImageSegmenter::Segment`, skipping inference on the frames that are nearly
+// identical to the last frame inference ran on, as decided by a
+// `MotionGate`. The last inference results are returned for skipped frames.
+//
+// Example usage:
+//
+//   ASSIGN_OR_RETURN(std::unique_ptr<MotionGate> gate, MotionGate::Create());
+//   MotionGatedInference<DetectionResult> gated_detector(std::move(gate));
+//   while (...) {
+//     ASSIGN_OR_RETURN(
+//         DetectionResult result,
+//         gated_detector.Run(*frame, [&](const FrameBuffer& frame_buffer) {
+//           return detector->Detect(frame_buffer);
+//         }));
+//   }
+//
+// MotionGatedInference is not thread-safe.
+template <class OutputType>
+class MotionGatedInference {
+ public:
+  using InferenceFunction =
+      std::function<tflite::support::StatusOr<OutputType>(const FrameBuffer&)>;
+
+  explicit MotionGatedInference(std::unique_ptr<MotionGate> motion_gate)
+      : motion_gate_(std::move(motion_gate)) {}
+
+  // Returns the results of `inference` on `frame_buffer`, or the last ones if
+  // inference is skipped for this frame. Failed inferences are not cached, so
+  // that inference runs again on the next frame.
+  tflite::support::StatusOr<OutputType> Run(
+      const FrameBuffer& frame_buffer, const InferenceFunction& inference) {
+    ASSIGN_OR_RETURN(const bool should_run_inference,
+                     motion_gate_->ShouldRunInference(frame_buffer));
+    if (!should_run_inference && last_result_.has_value()) {
+      last_run_skipped_ = true;
+      return last_result_.value();
+    }
+    last_run_skipped_ = false;
+    tflite::support::StatusOr<OutputType> result = inference(frame_buffer);
+    if (!result.ok()) {
+      motion_gate_->Reset();
+      last_result_.reset();
+      return result.status();
+    }
+    last_result_ = result.value();
+    return result;
+  }
+
+  // Returns whether the results returned by the last call to `Run` were the
+  // cached ones.
+  bool last_run_skipped() const { return last_run_skipped_; }
+
+  const MotionGate& motion_gate() const { return *motion_gate_; }
+
+ private:
+  std::unique_ptr<MotionGate> motion_gate_;
+  absl::optional<OutputType> last_result_;
+  bool last_run_skipped_ = false;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_MOTION_GATE_H_
@@ -0,0 +1,287 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/motion_gate.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::tflite::support::StatusOr;
+
+// Frames are twice as large as the default 32x32 signature, so that each
+// signature pixel averages a 2x2 block.
+constexpr FrameBuffer::Dimension kFrameDimension = {64, 64};
+constexpr int kBaseLevel = 100;
+
+const absl::Time kStartTime = absl::FromUnixSeconds(1000);
+
+// Grayscale frame whose signature pixels can be changed independently.
+class TestFrame {
+ public:
+  explicit TestFrame(FrameBuffer::Dimension dimension = kFrameDimension)
+      : dimension_(dimension), data_(dimension.Size(), kBaseLevel) {}
+
+  // Sets the 2x2 block of the signature pixel `index` to `level`.
+  void SetSignaturePixel(int index, uint8 level) {
+    const int signature_width = dimension_.width / 2;
+    const int x = 2 * (index % signature_width);
+    const int y = 2 * (index / signature_width);
+    for (int row = y; row < y + 2; ++row) {
+      data_[row * dimension_.width + x] = level;
+      data_[row * dimension_.width + x + 1] = level;
+    }
+  }
+
+  // Sets the `count` first signature pixels to `level`.
+  void SetSignaturePixels(int count, uint8 level) {
+    for (int i = 0; i < count; ++i) {
+      SetSignaturePixel(i, level);
+    }
+  }
+
+  std::unique_ptr<FrameBuffer> Buffer(
+      absl::Time timestamp = kStartTime,
+      FrameBuffer::Orientation orientation =
+          FrameBuffer::Orientation::kTopLeft) const {
+    return CreateFromGrayRawBuffer(data_.data(), dimension_, orientation,
+                                   timestamp);
+  }
+
+ private:
+  FrameBuffer::Dimension dimension_;
+  std::vector<uint8> data_;
+};
+
+std::unique_ptr<MotionGate> CreateMotionGate(
+    const MotionGateOptions& options = MotionGateOptions()) {
+  return MotionGate::Create(options).value();
+}
+
+bool ShouldRunInference(MotionGate* gate, const FrameBuffer& frame_buffer) {
+  return gate->ShouldRunInference(frame_buffer).value();
+}
+
+TEST(MotionGateTest, RejectsInvalidOptions) {
+  MotionGateOptions options;
+  options.signature_width = 0;
+  EXPECT_EQ(MotionGate::Create(options).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  options = MotionGateOptions();
+  options.pixel_difference_threshold = 256;
+  EXPECT_EQ(MotionGate::Create(options).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  options = MotionGateOptions();
+  options.changed_fraction_threshold = 1.5f;
+  EXPECT_EQ(MotionGate::Create(options).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(MotionGateTest, RunsOnFirstFrameOnlyForStaticFrames) {
+  std::unique_ptr<MotionGate> gate = CreateMotionGate();
+  const TestFrame frame;
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  }
+  EXPECT_EQ(gate->num_frames(), 6);
+  EXPECT_EQ(gate->num_skipped_frames(), 5);
+  EXPECT_EQ(gate->num_consecutive_skipped_frames(), 5);
+}
+
+// With the default 1% threshold, more than 10.24 of the 1024 signature pixels
+// must change.
+TEST(MotionGateTest, RunsWhenChangedFractionExceedsThreshold) {
+  std::unique_ptr<MotionGate> gate = CreateMotionGate();
+  TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+
+  frame.SetSignaturePixels(10, kBaseLevel + 50);
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  frame.SetSignaturePixels(11, kBaseLevel + 50);
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  // The changed frame is now the reference.
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+}
+
+TEST(MotionGateTest, IgnoresDifferencesUpToPixelThreshold) {
+  MotionGateOptions options;
+  options.pixel_difference_threshold = 8;
+  std::unique_ptr<MotionGate> gate = CreateMotionGate(options);
+  TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+
+  frame.SetSignaturePixels(1024, kBaseLevel + 8);
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  frame.SetSignaturePixels(1024, kBaseLevel - 8);
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  frame.SetSignaturePixels(1024, kBaseLevel + 9);
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+}
+
+// Slow changes accumulate, as frames are compared with the reference frame
+// rather than with the previous one.
+TEST(MotionGateTest, DetectsSlowChanges) {
+  std::unique_ptr<MotionGate> gate = CreateMotionGate();
+  TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  for (int delta = 1; delta <= 8; ++delta) {
+    frame.SetSignaturePixels(1024, kBaseLevel + delta);
+    EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  }
+  frame.SetSignaturePixels(1024, kBaseLevel + 9);
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+}
+
+TEST(MotionGateTest, RunsAfterMaxConsecutiveSkippedFrames) {
+  MotionGateOptions options;
+  options.max_consecutive_skipped_frames = 3;
+  std::unique_ptr<MotionGate> gate = CreateMotionGate(options);
+  const TestFrame frame;
+  for (int cycle = 0; cycle < 2; ++cycle) {
+    SCOPED_TRACE(cycle);
+    EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+    EXPECT_EQ(gate->num_consecutive_skipped_frames(), 0);
+    for (int i = 1; i <= 3; ++i) {
+      EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+      EXPECT_EQ(gate->num_consecutive_skipped_frames(), i);
+    }
+  }
+}
+
+TEST(MotionGateTest, NeverForcesRunWithoutStalenessBounds) {
+  MotionGateOptions options;
+  options.max_consecutive_skipped_frames = 0;
+  std::unique_ptr<MotionGate> gate = CreateMotionGate(options);
+  const TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(ShouldRunInference(
+        gate.get(), *frame.Buffer(kStartTime + absl::Hours(i))));
+  }
+}
+
+TEST(MotionGateTest, RunsWhenReferenceFrameIsStale) {
+  MotionGateOptions options;
+  options.max_consecutive_skipped_frames = 0;
+  options.max_staleness = absl::Seconds(1);
+  std::unique_ptr<MotionGate> gate = CreateMotionGate(options);
+  const TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer(kStartTime)));
+  EXPECT_FALSE(ShouldRunInference(
+      gate.get(), *frame.Buffer(kStartTime + absl::Milliseconds(500))));
+  EXPECT_FALSE(ShouldRunInference(
+      gate.get(), *frame.Buffer(kStartTime + absl::Seconds(1))));
+  EXPECT_TRUE(ShouldRunInference(
+      gate.get(), *frame.Buffer(kStartTime + absl::Milliseconds(1500))));
+  // Staleness is measured from the new reference frame.
+  EXPECT_FALSE(ShouldRunInference(
+      gate.get(), *frame.Buffer(kStartTime + absl::Milliseconds(2500))));
+}
+
+TEST(MotionGateTest, RunsWhenFrameMetadataChanges) {
+  std::unique_ptr<MotionGate> gate = CreateMotionGate();
+  const TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  ASSERT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+
+  // Dimension change, with the same signature.
+  const TestFrame larger_frame({128, 64});
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *larger_frame.Buffer()));
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *larger_frame.Buffer()));
+  EXPECT_EQ(gate->num_consecutive_skipped_frames(), 1);
+
+  // Format change, with the same signature.
+  std::vector<uint8> rgb_data(kFrameDimension.Size() * 3, kBaseLevel);
+  std::unique_ptr<FrameBuffer> rgb_buffer =
+      CreateFromRgbRawBuffer(rgb_data.data(), kFrameDimension);
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *rgb_buffer));
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *rgb_buffer));
+
+  // Orientation change.
+  EXPECT_TRUE(ShouldRunInference(
+      gate.get(),
+      *frame.Buffer(kStartTime, FrameBuffer::Orientation::kRightTop)));
+  EXPECT_EQ(gate->num_consecutive_skipped_frames(), 0);
+}
+
+TEST(MotionGateTest, RunsAfterReset) {
+  std::unique_ptr<MotionGate> gate = CreateMotionGate();
+  const TestFrame frame;
+  ASSERT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  ASSERT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  gate->Reset();
+  EXPECT_EQ(gate->num_consecutive_skipped_frames(), 0);
+  EXPECT_TRUE(ShouldRunInference(gate.get(), *frame.Buffer()));
+  EXPECT_FALSE(ShouldRunInference(gate.get(), *frame.Buffer()));
+}
+
+TEST(MotionGatedInferenceTest, ReturnsLastResultsForSkippedFrames) {
+  MotionGatedInference<int> gated_inference(CreateMotionGate());
+  const TestFrame frame;
+  int num_runs = 0;
+  const auto inference = [&](const FrameBuffer&) -> StatusOr<int> {
+    return ++num_runs;
+  };
+  EXPECT_EQ(gated_inference.Run(*frame.Buffer(), inference).value(), 1);
+  EXPECT_FALSE(gated_inference.last_run_skipped());
+  EXPECT_EQ(gated_inference.Run(*frame.Buffer(), inference).value(), 1);
+  EXPECT_TRUE(gated_inference.last_run_skipped());
+  EXPECT_EQ(num_runs, 1);
+}
+
+TEST(MotionGatedInferenceTest, RunsAgainAfterFailedInference) {
+  MotionGatedInference<int> gated_inference(CreateMotionGate());
+  const TestFrame frame;
+  int num_runs = 0;
+  const auto failing_inference = [&](const FrameBuffer&) -> StatusOr<int> {
+    ++num_runs;
+    return absl::InternalError("Inference failed.");
+  };
+  const auto inference = [&](const FrameBuffer&) -> StatusOr<int> {
+    return ++num_runs;
+  };
+  EXPECT_EQ(gated_inference.Run(*frame.Buffer(), inference).value(), 1);
+  // The frame changes, and inference fails on it.
+  TestFrame changed_frame;
+  changed_frame.SetSignaturePixels(1024, kBaseLevel + 50);
+  EXPECT_EQ(gated_inference.Run(*changed_frame.Buffer(), failing_inference)
+                .status()
+                .code(),
+            absl::StatusCode::kInternal);
+  // Inference runs again on the same frame, instead of returning the results
+  // of the previous frame.
+  EXPECT_EQ(gated_inference.Run(*changed_frame.Buffer(), inference).value(), 3);
+  EXPECT_FALSE(gated_inference.last_run_skipped());
+  EXPECT_EQ(gated_inference.Run(*changed_frame.Buffer(), inference).value(), 3);
+  EXPECT_TRUE(gated_inference.last_run_skipped());
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,183 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow_lite_support/cc/common.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+// Number of values processed per iteration by the SIMD path: 3 x 16 bytes, so
+// that each 4-float vector always covers the same channels for both 1 and 3
+// channel images.
+constexpr size_t kSimdBlockSize = 48;
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PixelNormalizer>> PixelNormalizer::Create(
+    const NormalizationOptions& options, int num_channels) {
+  if (num_channels != 1 && num_channels != 3) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected 1 or 3 channels, got %d.", num_channels),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.num_values != 1 && options.num_values != 3) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected 1 or 3 normalization values, got %d.",
+                        options.num_values),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  std::array<float, 3> mean_values;
+  std::array<float, 3> inv_std_values;
+  for (int c = 0; c < 3; ++c) {
+    const int index = num_channels == 1 || options.num_values == 1 ? 0 : c;
+    if (options.std_values[index] == 0.0f) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          "Normalization std values must be non-zero.",
+          TfLiteSupportStatus::kInvalidArgumentError);
+    }
+    mean_values[c] = options.mean_values[index];
+    inv_std_values[c] = 1.0f / options.std_values[index];
+  }
+  return absl::WrapUnique(
+      new PixelNormalizer(num_channels, mean_values, inv_std_values));
+}
+
+PixelNormalizer::PixelNormalizer(int num_channels,
+                                 const std::array<float, 3>& mean_values,
+                                 const std::array<float, 3>& inv_std_values)
+    : num_channels_(num_channels),
+      mean_values_(mean_values),
+      inv_std_values_(inv_std_values) {
+  for (int c = 0; c < 3; ++c) {
+    for (int value = 0; value < 256; ++value) {
+      lookup_tables_[c][value] =
+          (static_cast<float>(value) - mean_values_[c]) * inv_std_values_[c];
+    }
+  }
+}
+
+void PixelNormalizer::NormalizeWithLookupTables(const uint8* src, size_t start,
+                                                size_t num_values,
+                                                float* dst) const {
+  if (num_channels_ == 1) {
+    const std::array<float, 256>& table = lookup_tables_[0];
+    for (size_t i = start; i < num_values; ++i) {
+      dst[i] = table[src[i]];
+    }
+    return;
+  }
+  const std::array<float, 256>& table0 = lookup_tables_[0];
+  const std::array<float, 256>& table1 = lookup_tables_[1];
+  const std::array<float, 256>& table2 = lookup_tables_[2];
+  for (size_t i = start; i + 2 < num_values; i += 3) {
+    dst[i] = table0[src[i]];
+    dst[i + 1] = table1[src[i + 1]];
+    dst[i + 2] = table2[src[i + 2]];
+  }
+}
+
+void PixelNormalizer::Normalize(const uint8* src, size_t num_values,
+                                float* dst) const {
+  size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+  // Per-vector parameters: vector `k` of a block covers the values at indices
+  // [4k, 4k + 4), i.e. channels (4k + j) % num_channels.
+  float means[3][4];
+  float inv_stds[3][4];
+  for (int k = 0; k < 3; ++k) {
+    for (int j = 0; j < 4; ++j) {
+      const int channel = (4 * k + j) % num_channels_;
+      means[k][j] = mean_values_[channel];
+      inv_stds[k][j] = inv_std_values_[channel];
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 mean[3] = {_mm_loadu_ps(means[0]), _mm_loadu_ps(means[1]),
+                          _mm_loadu_ps(means[2])};
+  const __m128 inv_std[3] = {_mm_loadu_ps(inv_stds[0]),
+                             _mm_loadu_ps(inv_stds[1]),
+                             _mm_loadu_ps(inv_stds[2])};
+  for (; i + kSimdBlockSize <= num_values; i += kSimdBlockSize) {
+    for (int b = 0; b < 3; ++b) {
+      const __m128i bytes =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16 * b));
+      const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+      const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+      const __m128i words[4] = {
+          _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+          _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero)};
+      for (int v = 0; v < 4; ++v) {
+        const int k = (4 * b + v) % 3;
+        const __m128 values = _mm_cvtepi32_ps(words[v]);
+        _mm_storeu_ps(dst + i + 16 * b + 4 * v,
+                      _mm_mul_ps(_mm_sub_ps(values, mean[k]), inv_std[k]));
+      }
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t mean[3] = {vld1q_f32(means[0]), vld1q_f32(means[1]),
+                               vld1q_f32(means[2])};
+  const float32x4_t inv_std[3] = {vld1q_f32(inv_stds[0]),
+                                  vld1q_f32(inv_stds[1]),
+                                  vld1q_f32(inv_stds[2])};
+  for (; i + kSimdBlockSize <= num_values; i += kSimdBlockSize) {
+    for (int b = 0; b < 3; ++b) {
+      const uint8x16_t bytes = vld1q_u8(src + i + 16 * b);
+      const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+      const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+      const uint32x4_t words[4] = {
+          vmovl_u16(vget_low_u16(low)), vmovl_u16(vget_high_u16(low)),
+          vmovl_u16(vget_low_u16(high)), vmovl_u16(vget_high_u16(high))};
+      for (int v = 0; v < 4; ++v) {
+        const int k = (4 * b + v) % 3;
+        const float32x4_t values = vcvtq_f32_u32(words[v]);
+        vst1q_f32(dst + i + 16 * b + 4 * v,
+                  vmulq_f32(vsubq_f32(values, mean[k]), inv_std[k]));
+      }
+    }
+  }
+#endif
+  NormalizeWithLookupTables(src, i, num_values, dst);
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
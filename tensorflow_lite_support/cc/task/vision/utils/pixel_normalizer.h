@@ -0,0 +1,85 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PIXEL_NORMALIZER_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PIXEL_NORMALIZER_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Converts interleaved 8-bit pixel data (e.g. RGB or grayscale) into floats
+// normalized according to NormalizationOptions, i.e. for each channel `c`:
+//
+//   (value - mean_values[c]) / std_values[c]
+//
+// The bulk of the data is converted with SIMD widening conversions (SSE2 or
+// NEON) when available. Otherwise, and for the trailing values, per-channel
+// 256-entry lookup tables built at creation time are used. Both paths produce
+// results bit-identical to computing `(value - mean) * (1 / std)` value by
+// value, see pixel_normalizer_test.
+//
+// Example:
+//
+//   ASSIGN_OR_RETURN(std::unique_ptr<PixelNormalizer> normalizer,
+//                    PixelNormalizer::Create(options, /*num_channels=*/3));
+//   normalizer->Normalize(rgb_data, width * height * 3, float_data);
+class PixelNormalizer {
+ public:
+  // Creates a PixelNormalizer for pixels made of `num_channels` interleaved
+  // channels, which must be 1 (grayscale) or 3 (RGB). If `options` provides a
+  // single value, it is used for all channels. If it provides three values for
+  // a grayscale image, only the first one is used. Returns an InvalidArgument
+  // error if one of the std values used is zero, which would otherwise turn
+  // the normalized values into infinities or NaNs.
+  static tflite::support::StatusOr<std::unique_ptr<PixelNormalizer>> Create(
+      const NormalizationOptions& options, int num_channels);
+
+  // Normalizes the `num_values` 8-bit values from `src` into `dst`.
+  // `num_values` must be a multiple of the number of channels.
+  void Normalize(const uint8* src, size_t num_values, float* dst) const;
+
+  // Returns the number of interleaved channels.
+  int num_channels() const { return num_channels_; }
+
+ private:
+  PixelNormalizer(int num_channels, const std::array<float, 3>& mean_values,
+                  const std::array<float, 3>& inv_std_values);
+
+  // Normalizes `src[start, num_values)` into `dst` using the lookup tables.
+  // `start` must be a multiple of the number of channels.
+  void NormalizeWithLookupTables(const uint8* src, size_t start,
+                                 size_t num_values, float* dst) const;
+
+  const int num_channels_;
+  const std::array<float, 3> mean_values_;
+  const std::array<float, 3> inv_std_values_;
+  // Per-channel lookup tables mapping each 8-bit value to its normalized
+  // value.
+  std::array<std::array<float, 256>, 3> lookup_tables_;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PIXEL_NORMALIZER_H_
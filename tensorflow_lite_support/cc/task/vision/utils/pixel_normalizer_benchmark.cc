@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares PixelNormalizer against the per-value loop previously used to
+// normalize float input tensors.
+//
+// Arguments are: image width, image height, number of channels.
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+NormalizationOptions CreateNormalizationOptions() {
+  NormalizationOptions options;
+  options.num_values = 3;
+  options.mean_values[0] = 123.675f;
+  options.mean_values[1] = 116.28f;
+  options.mean_values[2] = 103.53f;
+  options.std_values[0] = 58.395f;
+  options.std_values[1] = 57.12f;
+  options.std_values[2] = 57.375f;
+  return options;
+}
+
+std::vector<uint8> CreateTestImage(size_t num_values) {
+  std::vector<uint8> image(num_values);
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<uint8>(i * 7 + i / 3);
+  }
+  return image;
+}
+
+void BM_NormalizeScalar(benchmark::State& state) {
+  const int num_channels = state.range(2);
+  const size_t num_values = state.range(0) * state.range(1) * num_channels;
+  const NormalizationOptions options = CreateNormalizationOptions();
+  const std::vector<uint8> src = CreateTestImage(num_values);
+  std::vector<float> dst(num_values);
+  for (auto s : state) {
+    // Mirrors the loops previously found in BaseVisionTaskApi::Preprocess.
+    if (num_channels == 1) {
+      const float mean_value = options.mean_values[0];
+      const float inv_std_value = 1.0f / options.std_values[0];
+      for (size_t i = 0; i < num_values; ++i) {
+        dst[i] = (src[i] - mean_value) * inv_std_value;
+      }
+    } else {
+      const float inv_std_values[3] = {1.0f / options.std_values[0],
+                                       1.0f / options.std_values[1],
+                                       1.0f / options.std_values[2]};
+      for (size_t i = 0; i < num_values; ++i) {
+        dst[i] = (src[i] - options.mean_values[i % 3]) * inv_std_values[i % 3];
+      }
+    }
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * num_values);
+}
+
+void BM_NormalizePixelNormalizer(benchmark::State& state) {
+  const int num_channels = state.range(2);
+  const size_t num_values = state.range(0) * state.range(1) * num_channels;
+  std::unique_ptr<PixelNormalizer> normalizer =
+      PixelNormalizer::Create(CreateNormalizationOptions(), num_channels)
+          .value();
+  const std::vector<uint8> src = CreateTestImage(num_values);
+  std::vector<float> dst(num_values);
+  for (auto s : state) {
+    normalizer->Normalize(src.data(), num_values, dst.data());
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * num_values);
+}
+
+void NormalizeArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Args({224, 224, 3})
+      ->Args({512, 512, 3})
+      ->Args({224, 224, 1})
+      ->Args({512, 512, 1});
+}
+
+BENCHMARK(BM_NormalizeScalar)->Apply(NormalizeArguments);
+BENCHMARK(BM_NormalizePixelNormalizer)->Apply(NormalizeArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,169 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/pixel_normalizer.h"
+
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+// Numbers of pixels covering no, partial and several SIMD blocks of 48 values,
+// with and without trailing values.
+constexpr size_t kNumPixels[] = {0, 1, 15, 16, 17, 47, 48, 49, 97, 1000};
+
+NormalizationOptions CreateNormalizationOptions(int num_values) {
+  NormalizationOptions options;
+  options.num_values = num_values;
+  options.mean_values = {123.675f, 116.28f, 103.53f};
+  options.std_values = {58.395f, 57.12f, 57.375f};
+  return options;
+}
+
+std::vector<uint8> CreateTestData(size_t num_values) {
+  std::vector<uint8> data(num_values);
+  uint32 state = 12345;
+  for (uint8& value : data) {
+    state = state * 1103515245 + 12345;
+    value = static_cast<uint8>(state >> 16);
+  }
+  // Covers the extreme values.
+  if (num_values >= 2) {
+    data[0] = 0;
+    data[num_values - 1] = 255;
+  }
+  return data;
+}
+
+// Mirrors the per-value loop previously used to normalize float input
+// tensors, using the first value only for grayscale images.
+std::vector<float> NormalizeReference(const NormalizationOptions& options,
+                                      int num_channels,
+                                      const std::vector<uint8>& data) {
+  std::vector<float> normalized(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    const int c =
+        options.num_values == 1 || num_channels == 1 ? 0 : i % num_channels;
+    const float inv_std_value = 1.0f / options.std_values[c];
+    normalized[i] =
+        inv_std_value * (static_cast<float>(data[i]) - options.mean_values[c]);
+  }
+  return normalized;
+}
+
+class PixelNormalizerTest
+    : public ::testing::TestWithParam<std::tuple<int, int>> {};
+
+TEST_P(PixelNormalizerTest, MatchesPerValueReference) {
+  const int num_channels = std::get<0>(GetParam());
+  const NormalizationOptions options =
+      CreateNormalizationOptions(std::get<1>(GetParam()));
+  std::unique_ptr<PixelNormalizer> normalizer =
+      PixelNormalizer::Create(options, num_channels).value();
+  for (size_t num_pixels : kNumPixels) {
+    SCOPED_TRACE(num_pixels);
+    const std::vector<uint8> data = CreateTestData(num_pixels * num_channels);
+    const std::vector<float> expected =
+        NormalizeReference(options, num_channels, data);
+    // Guards the end of the output against overflows.
+    std::vector<float> normalized(data.size() + 1, -1.0f);
+    normalizer->Normalize(data.data(), data.size(), normalized.data());
+    EXPECT_EQ(normalized.back(), -1.0f);
+    normalized.pop_back();
+    // Bitwise comparison.
+    ASSERT_EQ(normalized.size(), expected.size());
+    EXPECT_EQ(memcmp(normalized.data(), expected.data(),
+                     expected.size() * sizeof(float)),
+              0);
+  }
+}
+
+// Starts at each offset within a SIMD block, as input tensors need not be
+// aligned.
+TEST_P(PixelNormalizerTest, MatchesPerValueReferenceWhenUnaligned) {
+  const int num_channels = std::get<0>(GetParam());
+  const NormalizationOptions options =
+      CreateNormalizationOptions(std::get<1>(GetParam()));
+  std::unique_ptr<PixelNormalizer> normalizer =
+      PixelNormalizer::Create(options, num_channels).value();
+  const std::vector<uint8> data = CreateTestData(200 * num_channels);
+  const std::vector<float> expected =
+      NormalizeReference(options, num_channels, data);
+  for (int offset = 0; offset < 16; ++offset) {
+    SCOPED_TRACE(offset);
+    const size_t start = offset * num_channels;
+    std::vector<float> normalized(data.size() + 1);
+    normalizer->Normalize(data.data() + start, data.size() - start,
+                          normalized.data() + 1);
+    EXPECT_EQ(memcmp(normalized.data() + 1, expected.data() + start,
+                     (data.size() - start) * sizeof(float)),
+              0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ChannelsAndValues, PixelNormalizerTest,
+    ::testing::Combine(::testing::Values(1, 3), ::testing::Values(1, 3)));
+
+TEST(PixelNormalizerCreateTest, RejectsInvalidNumChannels) {
+  EXPECT_EQ(PixelNormalizer::Create(CreateNormalizationOptions(3), 2)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(PixelNormalizer::Create(CreateNormalizationOptions(3), 4)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(PixelNormalizerCreateTest, RejectsInvalidNumValues) {
+  EXPECT_EQ(PixelNormalizer::Create(CreateNormalizationOptions(2), 3)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+// The per-value loop accepted zero std values, turning the normalized values
+// into infinities or NaNs: they are now rejected, unless unused.
+TEST(PixelNormalizerCreateTest, RejectsZeroStdValues) {
+  NormalizationOptions options = CreateNormalizationOptions(3);
+  options.std_values[1] = 0.0f;
+  EXPECT_EQ(PixelNormalizer::Create(options, 3).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  // Only the first value is used for grayscale images.
+  EXPECT_TRUE(PixelNormalizer::Create(options, 1).ok());
+
+  options = CreateNormalizationOptions(1);
+  options.std_values[0] = 0.0f;
+  EXPECT_EQ(PixelNormalizer::Create(options, 1).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(PixelNormalizer::Create(options, 3).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,189 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/preprocessing_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::tflite::support::StatusOr;
+
+constexpr uint64 kFingerprintMultiplier = 0x9e3779b97f4a7c15ULL;
+
+// Mixes `value` into `hash`. For a given `hash`, this is a bijection of
+// `value`, and for a given `value`, a bijection of `hash`.
+inline uint64 Mix(uint64 hash, uint64 value) {
+  hash = (hash ^ value) * kFingerprintMultiplier;
+  return hash ^ (hash >> 29);
+}
+
+// Mixes the `num_rows` rows of `row_bytes` bytes starting at `data`, and
+// `row_stride` bytes apart, into `hash`. Each row is hashed as 4 interleaved
+// lanes of 8-byte words, so that the multiplications don't wait on each other,
+// and its hash is then mixed into `hash`.
+uint64 MixRows(const uint8* data, int row_bytes, int row_stride, int num_rows,
+               uint64 hash) {
+  for (int y = 0; y < num_rows; ++y) {
+    const uint8* row = data + static_cast<int64>(y) * row_stride;
+    uint64 lanes[4] = {0, 1, 2, 3};
+    int x = 0;
+    for (; x + 32 <= row_bytes; x += 32) {
+      for (int lane = 0; lane < 4; ++lane) {
+        uint64 word;
+        memcpy(&word, row + x + 8 * lane, sizeof(word));
+        lanes[lane] = Mix(lanes[lane], word);
+      }
+    }
+    for (; x + 8 <= row_bytes; x += 8) {
+      uint64 word;
+      memcpy(&word, row + x, sizeof(word));
+      lanes[0] = Mix(lanes[0], word);
+    }
+    uint64 tail = 0;
+    memcpy(&tail, row + x, row_bytes - x);
+    lanes[1] = Mix(lanes[1], tail);
+    hash = Mix(hash, Mix(Mix(Mix(lanes[0], lanes[1]), lanes[2]), lanes[3]));
+  }
+  return hash;
+}
+
+}  // namespace
+
+StatusOr<uint64> GetFrameContentFingerprint(const FrameBuffer& frame_buffer) {
+  const FrameBuffer::Dimension dimension = frame_buffer.dimension();
+  const FrameBuffer::Format format = frame_buffer.format();
+  if (format != FrameBuffer::Format::kNV12 &&
+      format != FrameBuffer::Format::kNV21 &&
+      format != FrameBuffer::Format::kYV12 &&
+      format != FrameBuffer::Format::kYV21) {
+    uint64 hash = 0;
+    for (int i = 0; i < frame_buffer.plane_count(); ++i) {
+      const FrameBuffer::Plane& plane = frame_buffer.plane(i);
+      const int row_bytes =
+          IsPackedYuv422Format(format)
+              ? (dimension.width + 1) / 2 * kPackedYuv422MacropixelBytes
+              : dimension.width * plane.stride.pixel_stride_bytes;
+      hash = MixRows(plane.buffer, row_bytes, plane.stride.row_stride_bytes,
+                     dimension.height, hash);
+    }
+    return hash;
+  }
+  ASSIGN_OR_RETURN(const FrameBuffer::YuvData yuv_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(frame_buffer));
+  ASSIGN_OR_RETURN(const FrameBuffer::Dimension uv_dimension,
+                   GetUvPlaneDimension(dimension, format));
+  uint64 hash = MixRows(yuv_data.y_buffer, dimension.width,
+                        yuv_data.y_row_stride, dimension.height, 0);
+  if (yuv_data.uv_pixel_stride == 1) {
+    hash = MixRows(yuv_data.u_buffer, uv_dimension.width,
+                   yuv_data.uv_row_stride, uv_dimension.height, hash);
+    return MixRows(yuv_data.v_buffer, uv_dimension.width,
+                   yuv_data.uv_row_stride, uv_dimension.height, hash);
+  }
+  // Interleaved chroma planes: hash the rows covering both.
+  const uint8* uv_buffer = std::min(yuv_data.u_buffer, yuv_data.v_buffer);
+  return MixRows(uv_buffer, uv_dimension.width * yuv_data.uv_pixel_stride,
+                 yuv_data.uv_row_stride, uv_dimension.height, hash);
+}
+
+constexpr int PreprocessingCache::kDefaultMaxEntries;
+
+bool PreprocessingCacheKey::operator==(
+    const PreprocessingCacheKey& other) const {
+  return frame_data == other.frame_data && timestamp == other.timestamp &&
+         content_fingerprint == other.content_fingerprint &&
+         frame_dimension == other.frame_dimension && format == other.format &&
+         orientation == other.orientation &&
+         roi_origin_x == other.roi_origin_x &&
+         roi_origin_y == other.roi_origin_y && roi_width == other.roi_width &&
+         roi_height == other.roi_height &&
+         tensor_dimension == other.tensor_dimension &&
+         element_type == other.element_type && scale == other.scale &&
+         offset == other.offset && interpolation == other.interpolation &&
+         letterbox_padding_value == other.letterbox_padding_value &&
+         use_fused_preprocessing == other.use_fused_preprocessing &&
+         use_direct_yuv_preprocessing == other.use_direct_yuv_preprocessing &&
+         fuse_resize_and_orient == other.fuse_resize_and_orient;
+}
+
+PreprocessingCache::PreprocessingCache(int max_entries)
+    : max_entries_(std::max(max_entries, 1)) {}
+
+bool PreprocessingCache::Lookup(const PreprocessingCacheKey& key, void* data,
+                                size_t byte_size) {
+  absl::MutexLock lock(&mutex_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->key == key && it->data.size() == byte_size) {
+      memcpy(data, it->data.data(), byte_size);
+      // Mark as most recently used.
+      entries_.splice(entries_.begin(), entries_, it);
+      ++num_hits_;
+      return true;
+    }
+  }
+  ++num_misses_;
+  return false;
+}
+
+void PreprocessingCache::Insert(const PreprocessingCacheKey& key,
+                                const void* data, size_t byte_size) {
+  absl::MutexLock lock(&mutex_);
+  auto it =
+      std::find_if(entries_.begin(), entries_.end(),
+                   [&key](const Entry& entry) { return entry.key == key; });
+  if (it == entries_.end() &&
+      static_cast<int>(entries_.size()) >= max_entries_) {
+    // Recycle the least recently used entry, along with its memory.
+    it = std::prev(entries_.end());
+  }
+  if (it == entries_.end()) {
+    entries_.emplace_front();
+  } else {
+    entries_.splice(entries_.begin(), entries_, it);
+  }
+  Entry& entry = entries_.front();
+  entry.key = key;
+  const uint8* bytes = static_cast<const uint8*>(data);
+  entry.data.assign(bytes, bytes + byte_size);
+}
+
+void PreprocessingCache::Clear() {
+  absl::MutexLock lock(&mutex_);
+  entries_.clear();
+}
+
+int64 PreprocessingCache::num_hits() const {
+  absl::MutexLock lock(&mutex_);
+  return num_hits_;
+}
+
+int64 PreprocessingCache::num_misses() const {
+  absl::MutexLock lock(&mutex_);
+  return num_misses_;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PREPROCESSING_CACHE_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PREPROCESSING_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/fused_preprocessing.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Everything the pre-processed input tensor data depends on: the identity of
+// the input frame, the region of interest, the target tensor and the
+// pre-processing settings.
+struct PreprocessingCacheKey {
+  // Frame identity: the frame is identified by the address of its first plane,
+  // its timestamp and the fingerprint of its content (see
+  // `GetFrameContentFingerprint`), along with its metadata.
+  const uint8* frame_data = nullptr;
+  absl::Time timestamp;
+  uint64 content_fingerprint = 0;
+  FrameBuffer::Dimension frame_dimension;
+  FrameBuffer::Format format = FrameBuffer::Format::kRGB;
+  FrameBuffer::Orientation orientation = FrameBuffer::Orientation::kTopLeft;
+
+  // Region of interest, in the unrotated frame of reference.
+  int roi_origin_x = 0;
+  int roi_origin_y = 0;
+  int roi_width = 0;
+  int roi_height = 0;
+
+  // Target tensor: dimensions, element type, as well as normalization and
+  // quantization parameters.
+  FrameBuffer::Dimension tensor_dimension;
+  TensorBufferSpec::ElementType element_type =
+      TensorBufferSpec::ElementType::kUInt8;
+  std::array<float, 3> scale = {1.0f, 1.0f, 1.0f};
+  std::array<float, 3> offset = {0.0f, 0.0f, 0.0f};
+
+  // Pre-processing settings, which may affect the result by rounding.
+  InterpolationMethod interpolation = InterpolationMethod::kBilinear;
+  absl::optional<uint8> letterbox_padding_value;
+  bool use_fused_preprocessing = false;
+  bool use_direct_yuv_preprocessing = false;
+  bool fuse_resize_and_orient = false;
+
+  bool operator==(const PreprocessingCacheKey& other) const;
+  bool operator!=(const PreprocessingCacheKey& other) const {
+    return !(*this == other);
+  }
+};
+
+// Returns a 64-bit fingerprint of the pixel data of `frame_buffer`, ignoring
+// the row padding bytes. Changes within a single row always change the
+// fingerprint if confined to 8 bytes starting at a multiple of 8 from the
+// start of the row, and otherwise do so with overwhelming probability. This
+// takes a single pass over the frame, cheaper than its pre-processing.
+tflite::support::StatusOr<uint64> GetFrameContentFingerprint(
+    const FrameBuffer& frame_buffer);
+
+// Cache of pre-processed input tensor data, meant to be shared by the vision
+// tasks running on the same frames (e.g. an ImageClassifier and an
+// ObjectDetector with the same 224x224 float input), so that a frame
+// pre-processed by one of them is only copied by the others. See
+// `BaseVisionTaskApi::SetPreprocessingCache`.
+//
+// The `max_entries` most recently used entries are kept, a single one being
+// enough when all the tasks run on a frame before moving to the next one.
+// Entries are only looked up by key, which includes a fingerprint of the
+// frame content: a buffer reused for successive frames with the same
+// timestamp doesn't return stale data.
+//
+// PreprocessingCache is thread-safe.
+class PreprocessingCache {
+ public:
+  // Default value for `max_entries`.
+  static constexpr int kDefaultMaxEntries = 4;
+
+  explicit PreprocessingCache(int max_entries = kDefaultMaxEntries);
+
+  // PreprocessingCache is neither copyable nor movable.
+  PreprocessingCache(const PreprocessingCache&) = delete;
+  PreprocessingCache& operator=(const PreprocessingCache&) = delete;
+
+  // Copies the data cached for `key` into `data`, and returns true, if any
+  // data of `byte_size` bytes is cached for `key`. Returns false otherwise.
+  bool Lookup(const PreprocessingCacheKey& key, void* data, size_t byte_size);
+
+  // Caches the `byte_size` bytes of `data` for `key`, evicting the least
+  // recently used entry if the cache is full.
+  void Insert(const PreprocessingCacheKey& key, const void* data,
+              size_t byte_size);
+
+  // Removes all the entries.
+  void Clear();
+
+  // Returns the number of successful and failed lookups so far.
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  struct Entry {
+    PreprocessingCacheKey key;
+    std::vector<uint8> data;
+  };
+
+  const int max_entries_;
+  mutable absl::Mutex mutex_;
+  // Entries, from the most to the least recently used.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  int64 num_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64 num_misses_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PREPROCESSING_CACHE_H_
@@ -0,0 +1,284 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/preprocessing_cache.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+
+PreprocessingCacheKey CreateKey(int roi_origin_x) {
+  PreprocessingCacheKey key;
+  key.timestamp = absl::FromUnixSeconds(1000);
+  key.frame_dimension = {640, 480};
+  key.roi_width = 100;
+  key.roi_height = 100;
+  key.roi_origin_x = roi_origin_x;
+  key.tensor_dimension = {224, 224};
+  return key;
+}
+
+std::vector<uint8> CreateData(uint8 value) {
+  return std::vector<uint8>(16, value);
+}
+
+bool Lookup(PreprocessingCache* cache, const PreprocessingCacheKey& key,
+            std::vector<uint8>* data) {
+  data->assign(16, 0);
+  return cache->Lookup(key, data->data(), data->size());
+}
+
+TEST(PreprocessingCacheTest, ReturnsInsertedData) {
+  PreprocessingCache cache;
+  std::vector<uint8> data;
+  EXPECT_FALSE(Lookup(&cache, CreateKey(0), &data));
+  cache.Insert(CreateKey(0), CreateData(1).data(), 16);
+  ASSERT_TRUE(Lookup(&cache, CreateKey(0), &data));
+  EXPECT_EQ(data, CreateData(1));
+  EXPECT_FALSE(Lookup(&cache, CreateKey(1), &data));
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 2);
+}
+
+TEST(PreprocessingCacheTest, MissesOnSizeMismatch) {
+  PreprocessingCache cache;
+  cache.Insert(CreateKey(0), CreateData(1).data(), 8);
+  std::vector<uint8> data;
+  EXPECT_FALSE(Lookup(&cache, CreateKey(0), &data));
+}
+
+TEST(PreprocessingCacheTest, ReplacesDataOfExistingKey) {
+  PreprocessingCache cache;
+  cache.Insert(CreateKey(0), CreateData(1).data(), 16);
+  cache.Insert(CreateKey(0), CreateData(2).data(), 16);
+  std::vector<uint8> data;
+  ASSERT_TRUE(Lookup(&cache, CreateKey(0), &data));
+  EXPECT_EQ(data, CreateData(2));
+}
+
+TEST(PreprocessingCacheTest, EvictsLeastRecentlyUsedEntry) {
+  PreprocessingCache cache(/*max_entries=*/2);
+  std::vector<uint8> data;
+  cache.Insert(CreateKey(0), CreateData(0).data(), 16);
+  cache.Insert(CreateKey(1), CreateData(1).data(), 16);
+  // Makes the first entry the most recently used one.
+  ASSERT_TRUE(Lookup(&cache, CreateKey(0), &data));
+  cache.Insert(CreateKey(2), CreateData(2).data(), 16);
+
+  EXPECT_FALSE(Lookup(&cache, CreateKey(1), &data));
+  ASSERT_TRUE(Lookup(&cache, CreateKey(0), &data));
+  EXPECT_EQ(data, CreateData(0));
+  ASSERT_TRUE(Lookup(&cache, CreateKey(2), &data));
+  EXPECT_EQ(data, CreateData(2));
+}
+
+TEST(PreprocessingCacheTest, ClearRemovesAllEntries) {
+  PreprocessingCache cache;
+  cache.Insert(CreateKey(0), CreateData(0).data(), 16);
+  cache.Insert(CreateKey(1), CreateData(1).data(), 16);
+  cache.Clear();
+  std::vector<uint8> data;
+  EXPECT_FALSE(Lookup(&cache, CreateKey(0), &data));
+  EXPECT_FALSE(Lookup(&cache, CreateKey(1), &data));
+}
+
+TEST(PreprocessingCacheTest, KeyCoversAllFields) {
+  static const uint8 kFrameData[1] = {};
+  const std::vector<std::function<void(PreprocessingCacheKey*)>> changes = {
+      [](PreprocessingCacheKey* key) { key->frame_data = kFrameData; },
+      [](PreprocessingCacheKey* key) { key->timestamp += absl::Seconds(1); },
+      [](PreprocessingCacheKey* key) { key->content_fingerprint = 1; },
+      [](PreprocessingCacheKey* key) { key->frame_dimension = {480, 640}; },
+      [](PreprocessingCacheKey* key) { key->format = Format::kNV21; },
+      [](PreprocessingCacheKey* key) {
+        key->orientation = FrameBuffer::Orientation::kRightTop;
+      },
+      [](PreprocessingCacheKey* key) { key->roi_origin_x = 1; },
+      [](PreprocessingCacheKey* key) { key->roi_origin_y = 1; },
+      [](PreprocessingCacheKey* key) { key->roi_width = 101; },
+      [](PreprocessingCacheKey* key) { key->roi_height = 101; },
+      [](PreprocessingCacheKey* key) { key->tensor_dimension = {192, 192}; },
+      [](PreprocessingCacheKey* key) {
+        key->element_type = TensorBufferSpec::ElementType::kFloat32;
+      },
+      [](PreprocessingCacheKey* key) { key->scale[2] = 2.0f; },
+      [](PreprocessingCacheKey* key) { key->offset[1] = 1.0f; },
+      [](PreprocessingCacheKey* key) {
+        key->interpolation = InterpolationMethod::kArea;
+      },
+      [](PreprocessingCacheKey* key) { key->letterbox_padding_value = 0; },
+      [](PreprocessingCacheKey* key) { key->use_fused_preprocessing = true; },
+      [](PreprocessingCacheKey* key) {
+        key->use_direct_yuv_preprocessing = true;
+      },
+      [](PreprocessingCacheKey* key) { key->fuse_resize_and_orient = true; },
+  };
+  for (int i = 0; i < changes.size(); ++i) {
+    SCOPED_TRACE(i);
+    PreprocessingCacheKey key = CreateKey(0);
+    changes[i](&key);
+    EXPECT_NE(key, CreateKey(0));
+    EXPECT_EQ(key, key);
+  }
+}
+
+// Frame data, with rows padded by `kPadding` bytes filled differently.
+struct TestFrame {
+  std::vector<uint8> data;
+  std::unique_ptr<FrameBuffer> buffer;
+};
+
+constexpr FrameBuffer::Dimension kFrameDimension = {37, 11};
+constexpr int kPadding = 5;
+
+// Creates a `format` frame whose rows, or luma and chroma rows, are padded
+// with `padding_value`.
+TestFrame CreateTestFrame(Format format, uint8 padding_value) {
+  TestFrame frame;
+  const int width = kFrameDimension.width;
+  const int height = kFrameDimension.height;
+  const int uv_width = (width + 1) / 2;
+  const int uv_height = (height + 1) / 2;
+  int row_bytes = 0;
+  switch (format) {
+    case Format::kRGB:
+      row_bytes = width * 3;
+      break;
+    case Format::kRGBA:
+      row_bytes = width * 4;
+      break;
+    case Format::kGRAY:
+      row_bytes = width;
+      break;
+    case Format::kYUYV:
+    case Format::kUYVY:
+      row_bytes = uv_width * 4;
+      break;
+    default:
+      break;
+  }
+  uint32 state = 12345;
+  const auto next_value = [&state]() {
+    state = state * 1103515245 + 12345;
+    return static_cast<uint8>(state >> 16);
+  };
+  if (row_bytes > 0) {
+    const int row_stride = row_bytes + kPadding;
+    frame.data.assign(row_stride * height, padding_value);
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < row_bytes; ++x) {
+        frame.data[y * row_stride + x] = next_value();
+      }
+    }
+    const int pixel_stride = row_bytes / width;
+    frame.buffer = FrameBuffer::Create(
+        {{frame.data.data(), {row_stride, pixel_stride}}}, kFrameDimension,
+        format, FrameBuffer::Orientation::kTopLeft);
+    return frame;
+  }
+  // YUV 4:2:0 formats, with padded rows.
+  const bool is_semi_planar =
+      format == Format::kNV12 || format == Format::kNV21;
+  const int y_stride = width + kPadding;
+  const int uv_row_bytes = is_semi_planar ? uv_width * 2 : uv_width;
+  const int uv_stride = uv_row_bytes + kPadding;
+  const int num_uv_planes = is_semi_planar ? 1 : 2;
+  frame.data.assign(y_stride * height + num_uv_planes * uv_stride * uv_height,
+                    padding_value);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      frame.data[y * y_stride + x] = next_value();
+    }
+  }
+  uint8* uv_data = frame.data.data() + y_stride * height;
+  for (int plane = 0; plane < num_uv_planes; ++plane) {
+    for (int y = 0; y < uv_height; ++y) {
+      for (int x = 0; x < uv_row_bytes; ++x) {
+        uv_data[(plane * uv_height + y) * uv_stride + x] = next_value();
+      }
+    }
+  }
+  const FrameBuffer::Plane y_plane = {frame.data.data(), {y_stride, 1}};
+  if (is_semi_planar) {
+    frame.buffer = FrameBuffer::Create({y_plane, {uv_data, {uv_stride, 2}}},
+                                       kFrameDimension, format,
+                                       FrameBuffer::Orientation::kTopLeft);
+  } else {
+    frame.buffer = FrameBuffer::Create(
+        {y_plane,
+         {uv_data, {uv_stride, 1}},
+         {uv_data + uv_stride * uv_height, {uv_stride, 1}}},
+        kFrameDimension, format, FrameBuffer::Orientation::kTopLeft);
+  }
+  return frame;
+}
+
+class FrameContentFingerprintTest : public ::testing::TestWithParam<Format> {};
+
+TEST_P(FrameContentFingerprintTest, IgnoresRowPadding) {
+  const TestFrame frame = CreateTestFrame(GetParam(), /*padding_value=*/0);
+  const TestFrame other_frame =
+      CreateTestFrame(GetParam(), /*padding_value=*/255);
+  EXPECT_EQ(GetFrameContentFingerprint(*frame.buffer).value(),
+            GetFrameContentFingerprint(*other_frame.buffer).value());
+}
+
+// A camera buffer reused with the same timestamp must not return stale data:
+// every pixel byte, including the chroma ones, affects the fingerprint.
+TEST_P(FrameContentFingerprintTest, ChangesWithEveryPixelByte) {
+  TestFrame frame = CreateTestFrame(GetParam(), /*padding_value=*/0);
+  const uint64 fingerprint = GetFrameContentFingerprint(*frame.buffer).value();
+  const TestFrame padding_frame =
+      CreateTestFrame(GetParam(), /*padding_value=*/255);
+  int num_pixel_bytes = 0;
+  for (int i = 0; i < frame.data.size(); ++i) {
+    if (frame.data[i] != padding_frame.data[i]) {
+      continue;
+    }
+    // Only pixel bytes are equal in both frames, unless they happen to hold
+    // the padding value.
+    ++num_pixel_bytes;
+    frame.data[i] ^= 0x40;
+    EXPECT_NE(GetFrameContentFingerprint(*frame.buffer).value(), fingerprint)
+        << "byte " << i;
+    frame.data[i] ^= 0x40;
+  }
+  EXPECT_GE(num_pixel_bytes, kFrameDimension.Size());
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormats, FrameContentFingerprintTest,
+                         ::testing::Values(Format::kRGB, Format::kRGBA,
+                                           Format::kGRAY, Format::kYUYV,
+                                           Format::kUYVY, Format::kNV12,
+                                           Format::kNV21, Format::kYV12,
+                                           Format::kYV21));
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,123 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/process_engine_registry.h"
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/auto_frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/libyuv_frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/simd_frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+ProcessEngineRegistry& ProcessEngineRegistry::Global() {
+  static ProcessEngineRegistry* const registry = new ProcessEngineRegistry();
+  return *registry;
+}
+
+ProcessEngineRegistry::ProcessEngineRegistry() {
+  factories_.emplace_back(kLibyuvProcessEngineName, [] {
+    return absl::make_unique<LibyuvFrameBufferUtils>();
+  });
+  factories_.emplace_back(kSimdProcessEngineName, [] {
+    return absl::make_unique<SimdFrameBufferUtils>();
+  });
+  factories_.emplace_back(kAutoProcessEngineName,
+                          [this] { return CreateAutoEngine(); });
+}
+
+absl::Status ProcessEngineRegistry::Register(const std::string& name,
+                                             Factory factory) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& entry : factories_) {
+    if (entry.first == name) {
+      return CreateStatusWithPayload(
+          StatusCode::kAlreadyExists,
+          absl::StrFormat("A process engine is already registered as '%s'.",
+                          name),
+          TfLiteSupportStatus::kInvalidArgumentError);
+    }
+  }
+  factories_.emplace_back(name, std::move(factory));
+  return absl::OkStatus();
+}
+
+StatusOr<std::unique_ptr<FrameBufferUtilsInterface>>
+ProcessEngineRegistry::Create(const std::string& name) const {
+  Factory factory;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& entry : factories_) {
+      if (entry.first == name) {
+        factory = entry.second;
+        break;
+      }
+    }
+  }
+  if (!factory) {
+    return CreateStatusWithPayload(
+        StatusCode::kNotFound,
+        absl::StrFormat("No process engine is registered as '%s'.", name),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  // Factories are run without holding the lock, as the "auto" one looks up
+  // the other engines.
+  std::unique_ptr<FrameBufferUtilsInterface> engine = factory();
+  if (engine == nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kInternal,
+        absl::StrFormat("Process engine '%s' could not be created.", name),
+        TfLiteSupportStatus::kImageProcessingError);
+  }
+  return engine;
+}
+
+std::vector<std::string> ProcessEngineRegistry::GetRegisteredNames() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::string> names;
+  names.reserve(factories_.size());
+  for (const auto& entry : factories_) {
+    names.push_back(entry.first);
+  }
+  return names;
+}
+
+std::unique_ptr<FrameBufferUtilsInterface>
+ProcessEngineRegistry::CreateAutoEngine() const {
+  std::vector<AutoFrameBufferUtils::NamedEngine> engines;
+  for (const std::string& name : GetRegisteredNames()) {
+    if (name == kAutoProcessEngineName) {
+      continue;
+    }
+    StatusOr<std::unique_ptr<FrameBufferUtilsInterface>> engine = Create(name);
+    if (engine.ok()) {
+      engines.emplace_back(name, std::move(engine.value()));
+    }
+  }
+  return absl::make_unique<AutoFrameBufferUtils>(std::move(engines));
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
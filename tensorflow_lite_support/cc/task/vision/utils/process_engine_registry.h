@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PROCESS_ENGINE_REGISTRY_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PROCESS_ENGINE_REGISTRY_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Names of the in-tree process engines.
+constexpr char kLibyuvProcessEngineName[] = "libyuv";
+constexpr char kSimdProcessEngineName[] = "simd";
+// Name of the engine dispatching each operation to the fastest of all the
+// other registered engines, see `AutoFrameBufferUtils`.
+constexpr char kAutoProcessEngineName[] = "auto";
+
+// Registry of the FrameBufferUtilsInterface implementations (a.k.a. process
+// engines) available to FrameBufferUtils, identified by name.
+//
+// The in-tree engines are always registered. Additional engines, e.g. backed
+// by a platform specific image processing library, can be registered at
+// initialization time and then selected by name through
+// `FrameBufferUtils::CreateWithEngine`:
+//
+//   RETURN_IF_ERROR(ProcessEngineRegistry::Global().Register(
+//       "my_engine", [] { return absl::make_unique<MyFrameBufferUtils>(); }));
+//
+// Registered engines are also candidates of the "auto" engine, and are thus
+// expected to produce the same results as the in-tree engines.
+//
+// This class is thread-safe.
+class ProcessEngineRegistry {
+ public:
+  using Factory = std::function<std::unique_ptr<FrameBufferUtilsInterface>()>;
+
+  // Returns the process-wide registry.
+  static ProcessEngineRegistry& Global();
+
+  ProcessEngineRegistry();
+
+  // ProcessEngineRegistry is neither copyable nor movable.
+  ProcessEngineRegistry(const ProcessEngineRegistry&) = delete;
+  ProcessEngineRegistry& operator=(const ProcessEngineRegistry&) = delete;
+
+  // Registers the engine created by `factory` under the given `name`. Returns
+  // an error if an engine is already registered under this name.
+  absl::Status Register(const std::string& name, Factory factory);
+
+  // Creates an instance of the engine registered under the given `name`.
+  tflite::support::StatusOr<std::unique_ptr<FrameBufferUtilsInterface>> Create(
+      const std::string& name) const;
+
+  // Returns the names of the registered engines, in registration order.
+  std::vector<std::string> GetRegisteredNames() const;
+
+ private:
+  // Creates an engine dispatching to all the other registered engines.
+  std::unique_ptr<FrameBufferUtilsInterface> CreateAutoEngine() const;
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::pair<std::string, Factory>> factories_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_PROCESS_ENGINE_REGISTRY_H_
@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+constexpr size_t ScratchArena::kAlignment;
+constexpr size_t ScratchArena::kDefaultMaxRetainedBytes;
+
+uint8* AllocateAlignedBlock(size_t byte_size, size_t alignment,
+                            std::unique_ptr<uint8[]>* storage,
+                            size_t* capacity) {
+  *capacity = (byte_size + alignment - 1) / alignment * alignment;
+  storage->reset(new uint8[*capacity + alignment - 1]);
+  const uintptr_t address = reinterpret_cast<uintptr_t>(storage->get());
+  return storage->get() + (alignment - address % alignment) % alignment;
+}
+
+ScratchArena::ScratchArena(ScratchArena&& other)
+    : max_retained_bytes_(other.max_retained_bytes_) {
+  *this = std::move(other);
+}
+
+ScratchArena& ScratchArena::operator=(ScratchArena&& other) {
+  if (this != &other) {
+    storage_ = std::move(other.storage_);
+    data_ = other.data_;
+    capacity_ = other.capacity_;
+    max_retained_bytes_ = other.max_retained_bytes_;
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+  }
+  return *this;
+}
+
+uint8* ScratchArena::Get(size_t byte_size) {
+  if (byte_size <= capacity_ && data_ != nullptr) {
+    return data_;
+  }
+  // Release the previous block first to lower the peak memory usage.
+  Trim();
+  data_ = AllocateAlignedBlock(byte_size, kAlignment, &storage_, &capacity_);
+  return data_;
+}
+
+void ScratchArena::ReleaseIfAboveCap() {
+  if (capacity_ > max_retained_bytes_) {
+    Trim();
+  }
+}
+
+void ScratchArena::Trim() {
+  storage_.reset();
+  data_ = nullptr;
+  capacity_ = 0;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,97 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SCRATCH_ARENA_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SCRATCH_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Reusable block of scratch memory used to hold intermediate image processing
+// results, so that processing a stream of same-sized frames does not perform
+// any heap allocation once the first frame has been processed.
+//
+// The block is 64-byte aligned, allocated on first use and only reallocated
+// when a larger block is requested. In order to bound the memory kept alive
+// between calls, blocks larger than `max_retained_bytes` are released by
+// `ReleaseIfAboveCap`, which is meant to be called once the intermediate
+// results are no longer needed.
+//
+// ScratchArena is not thread-safe.
+class ScratchArena {
+ public:
+  // Alignment in bytes of the memory returned by `Get`, which matches the
+  // cache line size of most targeted CPUs and the widest SIMD registers.
+  static constexpr size_t kAlignment = 64;
+
+  // Default value for `max_retained_bytes`, large enough to hold a 4K RGBA
+  // frame.
+  static constexpr size_t kDefaultMaxRetainedBytes = 32 * 1024 * 1024;
+
+  explicit ScratchArena(size_t max_retained_bytes = kDefaultMaxRetainedBytes)
+      : max_retained_bytes_(max_retained_bytes) {}
+
+  // ScratchArena is movable but not copyable. Moved-from instances hold no
+  // block.
+  ScratchArena(ScratchArena&& other);
+  ScratchArena& operator=(ScratchArena&& other);
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  // Returns a 64-byte aligned block of at least `byte_size` bytes with
+  // unspecified content. The block remains valid until the next call to `Get`,
+  // `ReleaseIfAboveCap` or `Trim`.
+  uint8* Get(size_t byte_size);
+
+  // Releases the block if its size exceeds `max_retained_bytes`.
+  void ReleaseIfAboveCap();
+
+  // Releases the block, if any.
+  void Trim();
+
+  // Returns the size in bytes of the currently allocated block.
+  size_t capacity() const { return capacity_; }
+
+  size_t max_retained_bytes() const { return max_retained_bytes_; }
+  void set_max_retained_bytes(size_t max_retained_bytes) {
+    max_retained_bytes_ = max_retained_bytes;
+  }
+
+ private:
+  std::unique_ptr<uint8[]> storage_;
+  // Start of the aligned block within `storage_`.
+  uint8* data_ = nullptr;
+  size_t capacity_ = 0;
+  size_t max_retained_bytes_;
+};
+
+// Allocates into `storage` a block of at least `byte_size` bytes, rounded up to
+// a multiple of `alignment` so that SIMD code may safely process whole
+// registers up to its end, and returns the start of the block aligned on
+// `alignment` bytes. The rounded up size is stored in `capacity`.
+uint8* AllocateAlignedBlock(size_t byte_size, size_t alignment,
+                            std::unique_ptr<uint8[]>* storage,
+                            size_t* capacity);
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SCRATCH_ARENA_H_
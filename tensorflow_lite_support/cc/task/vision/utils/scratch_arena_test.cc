@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+bool IsAligned(const uint8* data) {
+  return reinterpret_cast<uintptr_t>(data) % ScratchArena::kAlignment == 0;
+}
+
+TEST(ScratchArenaTest, AllocatesOnFirstUse) {
+  ScratchArena arena;
+  EXPECT_EQ(arena.capacity(), 0);
+  uint8* data = arena.Get(100);
+  ASSERT_NE(data, nullptr);
+  EXPECT_TRUE(IsAligned(data));
+  // The capacity is rounded up to a multiple of the alignment.
+  EXPECT_EQ(arena.capacity(), 128);
+  // The whole block is writable.
+  memset(data, 0xff, arena.capacity());
+}
+
+TEST(ScratchArenaTest, ReusesBlockForSmallerOrEqualSizes) {
+  ScratchArena arena;
+  uint8* data = arena.Get(1000);
+  EXPECT_EQ(arena.Get(1000), data);
+  EXPECT_EQ(arena.Get(1), data);
+  EXPECT_EQ(arena.Get(arena.capacity()), data);
+  EXPECT_EQ(arena.capacity(), 1024);
+}
+
+TEST(ScratchArenaTest, GrowsForLargerSizes) {
+  ScratchArena arena;
+  arena.Get(1000);
+  for (size_t byte_size : {1025, 4097, 1 << 20, (1 << 20) + 1}) {
+    SCOPED_TRACE(byte_size);
+    uint8* data = arena.Get(byte_size);
+    ASSERT_NE(data, nullptr);
+    EXPECT_TRUE(IsAligned(data));
+    EXPECT_GE(arena.capacity(), byte_size);
+    EXPECT_LT(arena.capacity(), byte_size + ScratchArena::kAlignment);
+    memset(data, 0xff, byte_size);
+  }
+}
+
+TEST(ScratchArenaTest, AlignsEveryBlock) {
+  ScratchArena arena;
+  for (size_t byte_size = 1; byte_size < 20000; byte_size = byte_size * 3 + 1) {
+    SCOPED_TRACE(byte_size);
+    arena.Trim();
+    EXPECT_TRUE(IsAligned(arena.Get(byte_size)));
+  }
+}
+
+TEST(ScratchArenaTest, TrimReleasesBlock) {
+  ScratchArena arena;
+  arena.Get(1000);
+  arena.Trim();
+  EXPECT_EQ(arena.capacity(), 0);
+  // Trimming an empty arena is a no-op.
+  arena.Trim();
+  EXPECT_EQ(arena.capacity(), 0);
+  EXPECT_NE(arena.Get(10), nullptr);
+  EXPECT_EQ(arena.capacity(), 64);
+}
+
+TEST(ScratchArenaTest, ReleaseIfAboveCapOnlyReleasesLargeBlocks) {
+  ScratchArena arena(/*max_retained_bytes=*/1024);
+  arena.Get(1024);
+  arena.ReleaseIfAboveCap();
+  EXPECT_EQ(arena.capacity(), 1024);
+  arena.Get(1025);
+  arena.ReleaseIfAboveCap();
+  EXPECT_EQ(arena.capacity(), 0);
+
+  arena.Get(1024);
+  arena.set_max_retained_bytes(0);
+  arena.ReleaseIfAboveCap();
+  EXPECT_EQ(arena.capacity(), 0);
+}
+
+TEST(ScratchArenaTest, MoveTransfersBlock) {
+  ScratchArena arena(/*max_retained_bytes=*/4096);
+  uint8* data = arena.Get(1000);
+  ScratchArena moved(std::move(arena));
+  EXPECT_EQ(moved.capacity(), 1024);
+  EXPECT_EQ(moved.max_retained_bytes(), 4096);
+  EXPECT_EQ(moved.Get(1000), data);
+  EXPECT_EQ(arena.capacity(), 0);
+
+  ScratchArena assigned;
+  assigned.Get(10);
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.Get(1000), data);
+  EXPECT_EQ(moved.capacity(), 0);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,379 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/segmentation_mask_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+namespace {
+
+// Minimum number of mask rows per stripe, and minimum number of mask pixels for
+// post-processing to be split into stripes: below these, the synchronization
+// overhead outweighs the benefits of parallel processing.
+constexpr int kMinStripeRows = 16;
+constexpr int kMinParallelPixels = 128 * 128;
+
+// Largest quantization scale for which the dequantized values of distinct
+// uint8 values remain distinct finite numbers.
+constexpr float kMaxOrderPreservingScale =
+    std::numeric_limits<float>::max() / 256;
+
+// Returns the index of the highest of the `depth` confidences in `values`, or 0
+// if none of them is positive. NaNs are ignored.
+int GetCategory(const float* values, int depth) {
+  int d = 0;
+  float max_value = 0.0f;
+#if defined(__SSE2__)
+  // `_mm_max_ps` returns its second operand if either is NaN, which thus only
+  // holds numbers.
+  __m128 max4 = _mm_setzero_ps();
+  for (; d + 4 <= depth; d += 4) {
+    max4 = _mm_max_ps(_mm_loadu_ps(values + d), max4);
+  }
+  max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(1, 0, 3, 2)));
+  max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(2, 3, 0, 1)));
+  max_value = _mm_cvtss_f32(max4);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  // `vmaxq_f32` propagates NaNs, hence the explicit comparison.
+  float32x4_t max4 = vdupq_n_f32(0.0f);
+  for (; d + 4 <= depth; d += 4) {
+    const float32x4_t v = vld1q_f32(values + d);
+    max4 = vbslq_f32(vcgtq_f32(v, max4), v, max4);
+  }
+  float lanes[4];
+  vst1q_f32(lanes, max4);
+  for (const float lane : lanes) {
+    if (lane > max_value) max_value = lane;
+  }
+#endif
+  for (; d < depth; ++d) {
+    if (values[d] > max_value) max_value = values[d];
+  }
+  if (max_value == 0.0f) {
+    return 0;
+  }
+
+  // Find the first occurrence of the highest confidence.
+  d = 0;
+#if defined(__SSE2__)
+  const __m128 target = _mm_set1_ps(max_value);
+  for (; d + 4 <= depth; d += 4) {
+    if (_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + d), target)) != 0) {
+      break;
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t target = vdupq_n_f32(max_value);
+  for (; d + 4 <= depth; d += 4) {
+    const uint64x2_t equal =
+        vreinterpretq_u64_u32(vceqq_f32(vld1q_f32(values + d), target));
+    if ((vgetq_lane_u64(equal, 0) | vgetq_lane_u64(equal, 1)) != 0) {
+      break;
+    }
+  }
+#endif
+  while (values[d] != max_value) {
+    ++d;
+  }
+  return d;
+}
+
+// Returns the index of the highest of the `depth` quantized confidences in
+// `values`, or 0 if none of them is above `zero_point`.
+int GetQuantizedCategory(const uint8* values, int depth, int zero_point) {
+  int d = 0;
+  uint8 max_value = 0;
+#if defined(__SSE2__)
+  __m128i max16 = _mm_setzero_si128();
+  for (; d + 16 <= depth; d += 16) {
+    max16 = _mm_max_epu8(
+        max16, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + d)));
+  }
+  max16 = _mm_max_epu8(max16, _mm_srli_si128(max16, 8));
+  max16 = _mm_max_epu8(max16, _mm_srli_si128(max16, 4));
+  max16 = _mm_max_epu8(max16, _mm_srli_si128(max16, 2));
+  max16 = _mm_max_epu8(max16, _mm_srli_si128(max16, 1));
+  max_value = static_cast<uint8>(_mm_cvtsi128_si32(max16));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  uint8x16_t max16 = vdupq_n_u8(0);
+  for (; d + 16 <= depth; d += 16) {
+    max16 = vmaxq_u8(max16, vld1q_u8(values + d));
+  }
+  uint8x8_t max8 = vpmax_u8(vget_low_u8(max16), vget_high_u8(max16));
+  max8 = vpmax_u8(max8, max8);
+  max8 = vpmax_u8(max8, max8);
+  max8 = vpmax_u8(max8, max8);
+  max_value = vget_lane_u8(max8, 0);
+#endif
+  for (; d < depth; ++d) {
+    if (values[d] > max_value) max_value = values[d];
+  }
+  if (max_value <= zero_point) {
+    return 0;
+  }
+
+  // Find the first occurrence of the highest confidence.
+  d = 0;
+#if defined(__SSE2__)
+  const __m128i target = _mm_set1_epi8(static_cast<char>(max_value));
+  for (; d + 16 <= depth; d += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + d));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, target)) != 0) {
+      break;
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint8x16_t target = vdupq_n_u8(max_value);
+  for (; d + 16 <= depth; d += 16) {
+    const uint64x2_t equal =
+        vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(values + d), target));
+    if ((vgetq_lane_u64(equal, 0) | vgetq_lane_u64(equal, 1)) != 0) {
+      break;
+    }
+  }
+#endif
+  while (values[d] != max_value) {
+    ++d;
+  }
+  return d;
+}
+
+// Returns the index of the highest of the `depth` dequantized confidences in
+// `values`, or 0 if none of them is positive. Used when dequantization may not
+// preserve the order of the values.
+int GetDequantizedCategory(const uint8* values, int depth, float scale,
+                           int zero_point) {
+  int class_index = 0;
+  float max_confidence = 0.0f;
+  for (int d = 0; d < depth; ++d) {
+    const float confidence =
+        scale * (static_cast<int>(values[d]) - zero_point);
+    if (confidence > max_confidence) {
+      class_index = d;
+      max_confidence = confidence;
+    }
+  }
+  return class_index;
+}
+
+// Fills the rows [row_begin, row_end) of `category_mask` with the results of
+// `get_category` on the depth vectors of `data`.
+template <typename T, typename GetCategoryFunction>
+void FillCategoryMaskRows(const T* data, const MaskTensorLayout& layout,
+                          int row_begin, int row_end,
+                          const GetCategoryFunction& get_category,
+                          uint8* category_mask) {
+  const int width = layout.mask_dimension.width;
+  for (int y = row_begin; y < row_end; ++y) {
+    uint8* row = category_mask + y * width;
+    int offset = layout.origin_offset + y * layout.y_stride;
+    for (int x = 0; x < width; ++x) {
+      row[x] = static_cast<uint8>(get_category(data + offset));
+      offset += layout.x_stride;
+    }
+  }
+}
+
+// Fills the rows [row_begin, row_end) of the `layout.depth` confidence masks
+// with the results of `get_confidence` on the values of `data`.
+template <typename T, typename GetConfidenceFunction>
+void FillConfidenceMaskRows(const T* data, const MaskTensorLayout& layout,
+                            int row_begin, int row_end,
+                            const GetConfidenceFunction& get_confidence,
+                            float* const* confidence_masks) {
+  const int width = layout.mask_dimension.width;
+  for (int y = row_begin; y < row_end; ++y) {
+    int offset = layout.origin_offset + y * layout.y_stride;
+    for (int x = 0; x < width; ++x) {
+      const T* values = data + offset;
+      const int pixel_index = y * width + x;
+      for (int d = 0; d < layout.depth; ++d) {
+        confidence_masks[d][pixel_index] = get_confidence(values[d]);
+      }
+      offset += layout.x_stride;
+    }
+  }
+}
+
+// Calls `compute_rows` on row ranges covering the rows of masks of the given
+// `dimension`, spread across `thread_pool` (if not null) for large masks.
+void RunInStripes(
+    FrameBuffer::Dimension dimension, ThreadPool* thread_pool,
+    const std::function<void(int row_begin, int row_end)>& compute_rows) {
+  const int num_rows = dimension.height;
+  int num_stripes = 1;
+  if (thread_pool != nullptr && dimension.Size() >= kMinParallelPixels) {
+    num_stripes =
+        std::min(thread_pool->num_threads(), num_rows / kMinStripeRows);
+  }
+  if (num_stripes <= 1) {
+    compute_rows(0, num_rows);
+    return;
+  }
+  // Split the rows as evenly as possible.
+  thread_pool->ParallelFor(num_stripes, [&](int stripe) {
+    compute_rows(num_rows * stripe / num_stripes,
+                 num_rows * (stripe + 1) / num_stripes);
+  });
+}
+
+}  // namespace
+
+MaskTensorLayout GetMaskTensorLayout(
+    FrameBuffer::Dimension tensor_dimension, int depth,
+    FrameBuffer::Orientation tensor_orientation) {
+  const FrameBuffer::Orientation mask_orientation =
+      FrameBuffer::Orientation::kTopLeft;
+  MaskTensorLayout layout;
+  layout.mask_dimension = tensor_dimension;
+  if (RequireDimensionSwap(tensor_orientation, mask_orientation)) {
+    layout.mask_dimension.Swap();
+  }
+  layout.depth = depth;
+
+  // Orienting coordinates is an affine transform: derive its offsets from the
+  // tensor coordinates of mask pixels (0, 0), (1, 0) and (0, 1).
+  int origin_x, origin_y, right_x, right_y, below_x, below_y;
+  OrientCoordinates(0, 0, mask_orientation, tensor_orientation,
+                    layout.mask_dimension, &origin_x, &origin_y);
+  OrientCoordinates(1, 0, mask_orientation, tensor_orientation,
+                    layout.mask_dimension, &right_x, &right_y);
+  OrientCoordinates(0, 1, mask_orientation, tensor_orientation,
+                    layout.mask_dimension, &below_x, &below_y);
+  const int tensor_row_stride = tensor_dimension.width * depth;
+  layout.origin_offset = origin_y * tensor_row_stride + origin_x * depth;
+  layout.x_stride =
+      (right_y - origin_y) * tensor_row_stride + (right_x - origin_x) * depth;
+  layout.y_stride =
+      (below_y - origin_y) * tensor_row_stride + (below_x - origin_x) * depth;
+  return layout;
+}
+
+void ComputeCategoryMaskRows(const float* data, const MaskTensorLayout& layout,
+                             int row_begin, int row_end,
+                             uint8* category_mask) {
+  const int depth = layout.depth;
+  FillCategoryMaskRows(
+      data, layout, row_begin, row_end,
+      [depth](const float* values) { return GetCategory(values, depth); },
+      category_mask);
+}
+
+void ComputeCategoryMaskRows(const uint8* data, float scale, int zero_point,
+                             const MaskTensorLayout& layout, int row_begin,
+                             int row_end, uint8* category_mask) {
+  const int depth = layout.depth;
+  // Dequantization is then strictly increasing: products of `scale` with
+  // distinct integers in [-255, 255] are distinct, and exact up to a relative
+  // error of 2^-24.
+  const bool preserves_order = std::isnormal(scale) && scale > 0.0f &&
+                               scale <= kMaxOrderPreservingScale &&
+                               zero_point >= 0 && zero_point <= 255;
+  if (preserves_order) {
+    FillCategoryMaskRows(
+        data, layout, row_begin, row_end,
+        [depth, zero_point](const uint8* values) {
+          return GetQuantizedCategory(values, depth, zero_point);
+        },
+        category_mask);
+  } else {
+    FillCategoryMaskRows(
+        data, layout, row_begin, row_end,
+        [depth, scale, zero_point](const uint8* values) {
+          return GetDequantizedCategory(values, depth, scale, zero_point);
+        },
+        category_mask);
+  }
+}
+
+void ComputeConfidenceMaskRows(const float* data,
+                               const MaskTensorLayout& layout, int row_begin,
+                               int row_end, float* const* confidence_masks) {
+  FillConfidenceMaskRows(
+      data, layout, row_begin, row_end, [](float value) { return value; },
+      confidence_masks);
+}
+
+void ComputeConfidenceMaskRows(const uint8* data, float scale, int zero_point,
+                               const MaskTensorLayout& layout, int row_begin,
+                               int row_end, float* const* confidence_masks) {
+  FillConfidenceMaskRows(
+      data, layout, row_begin, row_end,
+      [scale, zero_point](uint8 value) {
+        return scale * (static_cast<int>(value) - zero_point);
+      },
+      confidence_masks);
+}
+
+void ComputeCategoryMask(const float* data, const MaskTensorLayout& layout,
+                         ThreadPool* thread_pool, uint8* category_mask) {
+  RunInStripes(layout.mask_dimension, thread_pool,
+               [&](int row_begin, int row_end) {
+                 ComputeCategoryMaskRows(data, layout, row_begin, row_end,
+                                         category_mask);
+               });
+}
+
+void ComputeCategoryMask(const uint8* data, float scale, int zero_point,
+                         const MaskTensorLayout& layout,
+                         ThreadPool* thread_pool, uint8* category_mask) {
+  RunInStripes(layout.mask_dimension, thread_pool,
+               [&](int row_begin, int row_end) {
+                 ComputeCategoryMaskRows(data, scale, zero_point, layout,
+                                         row_begin, row_end, category_mask);
+               });
+}
+
+void ComputeConfidenceMasks(const float* data, const MaskTensorLayout& layout,
+                            ThreadPool* thread_pool,
+                            float* const* confidence_masks) {
+  RunInStripes(layout.mask_dimension, thread_pool,
+               [&](int row_begin, int row_end) {
+                 ComputeConfidenceMaskRows(data, layout, row_begin, row_end,
+                                           confidence_masks);
+               });
+}
+
+void ComputeConfidenceMasks(const uint8* data, float scale, int zero_point,
+                            const MaskTensorLayout& layout,
+                            ThreadPool* thread_pool,
+                            float* const* confidence_masks) {
+  RunInStripes(layout.mask_dimension, thread_pool,
+               [&](int row_begin, int row_end) {
+                 ComputeConfidenceMaskRows(data, scale, zero_point, layout,
+                                           row_begin, row_end,
+                                           confidence_masks);
+               });
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SEGMENTATION_MASK_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SEGMENTATION_MASK_UTILS_H_
+
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/thread_pool.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Layout of a `[height x width x depth]` segmentation output tensor, as seen
+// from the masks computed from it, which are in the unrotated frame of
+// reference (i.e. with orientation kTopLeft) while the tensor has the
+// orientation of the input frame. Masks pixels map to tensor depth vectors
+// through an affine transform, described by the offsets below, in elements.
+struct MaskTensorLayout {
+  // Dimension of the masks, i.e. of the tensor with its width and height
+  // swapped for 90° and 270° rotations.
+  FrameBuffer::Dimension mask_dimension;
+  // Number of classes, i.e. length of the contiguous depth vectors.
+  int depth;
+  // Offset of the depth vector of mask pixel (0, 0).
+  int origin_offset;
+  // Offset increments from a mask pixel to its right neighbor, and to the
+  // neighbor below it.
+  int x_stride;
+  int y_stride;
+};
+
+// Returns the layout of a tensor of the given `tensor_dimension` and `depth`,
+// whose pixels have orientation `tensor_orientation`.
+MaskTensorLayout GetMaskTensorLayout(
+    FrameBuffer::Dimension tensor_dimension, int depth,
+    FrameBuffer::Orientation tensor_orientation);
+
+// Computes the rows [row_begin, row_end) of the category mask from the float
+// tensor `data`, i.e. the index of the highest confidence of the depth vector
+// of each mask pixel, or 0 if no confidence is positive. Ties are resolved in
+// favor of the lowest index. `category_mask` points to the first row of the
+// whole mask, whose rows are `layout.mask_dimension.width` bytes long.
+//
+// Depth vectors are scanned with SSE2 or NEON instructions where available.
+void ComputeCategoryMaskRows(const float* data, const MaskTensorLayout& layout,
+                             int row_begin, int row_end, uint8* category_mask);
+
+// Same as above, for a uint8 tensor with the given quantization parameters.
+// The category mask is then that of the dequantized confidences. It is
+// computed in the integer domain whenever dequantization preserves the order
+// of the values, i.e. for any positive normal `scale` (up to FLT_MAX / 256)
+// and `zero_point` in [0, 255].
+void ComputeCategoryMaskRows(const uint8* data, float scale, int zero_point,
+                             const MaskTensorLayout& layout, int row_begin,
+                             int row_end, uint8* category_mask);
+
+// Computes the rows [row_begin, row_end) of the confidence masks from the
+// float tensor `data`, i.e. the confidence of each class for each mask pixel.
+// `confidence_masks[d]` points to the first row of the whole mask of class
+// `d`, whose rows are `layout.mask_dimension.width` values long.
+void ComputeConfidenceMaskRows(const float* data,
+                               const MaskTensorLayout& layout, int row_begin,
+                               int row_end, float* const* confidence_masks);
+
+// Same as above, for a uint8 tensor whose values are dequantized as
+// `scale * (value - zero_point)`.
+void ComputeConfidenceMaskRows(const uint8* data, float scale, int zero_point,
+                               const MaskTensorLayout& layout, int row_begin,
+                               int row_end, float* const* confidence_masks);
+
+// Computes the whole category mask as `ComputeCategoryMaskRows`, in row
+// stripes spread across `thread_pool` for large masks. `thread_pool` may be
+// null, in which case all rows are computed on the calling thread. Mask pixels
+// are computed independently, so that the result doesn't depend on the
+// stripes.
+void ComputeCategoryMask(const float* data, const MaskTensorLayout& layout,
+                         ThreadPool* thread_pool, uint8* category_mask);
+void ComputeCategoryMask(const uint8* data, float scale, int zero_point,
+                         const MaskTensorLayout& layout,
+                         ThreadPool* thread_pool, uint8* category_mask);
+
+// Same as above for the confidence masks, computed as
+// `ComputeConfidenceMaskRows`.
+void ComputeConfidenceMasks(const float* data, const MaskTensorLayout& layout,
+                            ThreadPool* thread_pool,
+                            float* const* confidence_masks);
+void ComputeConfidenceMasks(const uint8* data, float scale, int zero_point,
+                            const MaskTensorLayout& layout,
+                            ThreadPool* thread_pool,
+                            float* const* confidence_masks);
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SEGMENTATION_MASK_UTILS_H_
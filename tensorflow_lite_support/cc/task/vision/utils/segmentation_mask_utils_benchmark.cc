@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares ComputeCategoryMaskRows against the per-pixel loop previously used
+// by ImageSegmenter to compute category masks.
+//
+// Arguments are: tensor width, tensor height, tensor depth, whether the tensor
+// is quantized, orientation of the tensor.
+
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/segmentation_mask_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+constexpr float kScale = 0.1f;
+constexpr int kZeroPoint = 128;
+
+// Test tensor, whose confidences peak at a different class for each pixel.
+struct TestTensor {
+  std::vector<float> float_data;
+  std::vector<uint8> uint8_data;
+};
+
+TestTensor CreateTestTensor(int width, int height, int depth) {
+  TestTensor tensor;
+  tensor.uint8_data.resize(width * height * depth);
+  tensor.float_data.resize(tensor.uint8_data.size());
+  for (int i = 0; i < tensor.uint8_data.size(); ++i) {
+    const int pixel = i / depth;
+    const int d = i % depth;
+    tensor.uint8_data[i] =
+        static_cast<uint8>(d == pixel % depth ? 200 : (i * 37) % 160);
+    tensor.float_data[i] = kScale * (tensor.uint8_data[i] - kZeroPoint);
+  }
+  return tensor;
+}
+
+void BM_CategoryMaskScalar(benchmark::State& state) {
+  const FrameBuffer::Dimension tensor_dimension = {
+      static_cast<int>(state.range(0)), static_cast<int>(state.range(1))};
+  const int depth = state.range(2);
+  const bool is_quantized = state.range(3) != 0;
+  const auto orientation =
+      static_cast<FrameBuffer::Orientation>(state.range(4));
+  const TestTensor tensor =
+      CreateTestTensor(tensor_dimension.width, tensor_dimension.height, depth);
+  FrameBuffer::Dimension mask_dimension = tensor_dimension;
+  if (RequireDimensionSwap(orientation, FrameBuffer::Orientation::kTopLeft)) {
+    mask_dimension.Swap();
+  }
+  std::vector<uint8> mask(mask_dimension.Size());
+  for (auto s : state) {
+    // Mirrors the loop previously found in ImageSegmenter::Postprocess.
+    int pixel_offset = 0;
+    for (int mask_y = 0; mask_y < mask_dimension.height; ++mask_y) {
+      for (int mask_x = 0; mask_x < mask_dimension.width; ++mask_x) {
+        int tensor_x;
+        int tensor_y;
+        OrientCoordinates(mask_x, mask_y, FrameBuffer::Orientation::kTopLeft,
+                          orientation, mask_dimension, &tensor_x, &tensor_y);
+        int class_index = 0;
+        float max_confidence = 0.0f;
+        for (int d = 0; d < depth; ++d) {
+          const int index = tensor_dimension.width * depth * tensor_y +
+                            depth * tensor_x + d;
+          const float confidence =
+              is_quantized ? kScale * (static_cast<int>(
+                                           tensor.uint8_data[index]) -
+                                       kZeroPoint)
+                           : tensor.float_data[index];
+          if (confidence > max_confidence) {
+            class_index = d;
+            max_confidence = confidence;
+          }
+        }
+        mask[pixel_offset++] = static_cast<uint8>(class_index);
+      }
+    }
+    benchmark::DoNotOptimize(mask.data());
+  }
+  state.SetItemsProcessed(state.iterations() * mask_dimension.Size());
+}
+
+void BM_CategoryMask(benchmark::State& state) {
+  const FrameBuffer::Dimension tensor_dimension = {
+      static_cast<int>(state.range(0)), static_cast<int>(state.range(1))};
+  const int depth = state.range(2);
+  const bool is_quantized = state.range(3) != 0;
+  const auto orientation =
+      static_cast<FrameBuffer::Orientation>(state.range(4));
+  const TestTensor tensor =
+      CreateTestTensor(tensor_dimension.width, tensor_dimension.height, depth);
+  const MaskTensorLayout layout =
+      GetMaskTensorLayout(tensor_dimension, depth, orientation);
+  const int height = layout.mask_dimension.height;
+  std::vector<uint8> mask(layout.mask_dimension.Size());
+  for (auto s : state) {
+    if (is_quantized) {
+      ComputeCategoryMaskRows(tensor.uint8_data.data(), kScale, kZeroPoint,
+                              layout, 0, height, mask.data());
+    } else {
+      ComputeCategoryMaskRows(tensor.float_data.data(), layout, 0, height,
+                              mask.data());
+    }
+    benchmark::DoNotOptimize(mask.data());
+  }
+  state.SetItemsProcessed(state.iterations() * layout.mask_dimension.Size());
+}
+
+void CategoryMaskArguments(benchmark::internal::Benchmark* benchmark) {
+  for (int is_quantized = 0; is_quantized <= 1; ++is_quantized) {
+    for (const int orientation :
+         {static_cast<int>(FrameBuffer::Orientation::kTopLeft),
+          static_cast<int>(FrameBuffer::Orientation::kRightTop)}) {
+      benchmark->Args({257, 257, 21, is_quantized, orientation})
+          ->Args({513, 513, 21, is_quantized, orientation});
+    }
+  }
+}
+
+BENCHMARK(BM_CategoryMaskScalar)->Apply(CategoryMaskArguments);
+BENCHMARK(BM_CategoryMask)->Apply(CategoryMaskArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,355 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/segmentation_mask_utils.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/thread_pool.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Orientation = FrameBuffer::Orientation;
+
+constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// Depths below, equal to and above multiples of the SIMD width.
+constexpr int kDepths[] = {1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 21, 33};
+
+constexpr FrameBuffer::Dimension kTensorDimensions[] = {
+    {7, 5}, {1, 9}, {16, 16}};
+
+// Computes the category mask with the per-pixel loop previously found in
+// ImageSegmenter::Postprocess, `get_confidence` returning the confidence of
+// the tensor element at the given index.
+std::vector<uint8> ComputeCategoryMaskPerPixel(
+    FrameBuffer::Dimension tensor_dimension, int depth,
+    Orientation tensor_orientation,
+    const std::function<float(int)>& get_confidence) {
+  FrameBuffer::Dimension mask_dimension = tensor_dimension;
+  if (RequireDimensionSwap(tensor_orientation, Orientation::kTopLeft)) {
+    mask_dimension.Swap();
+  }
+  std::vector<uint8> category_mask;
+  for (int mask_y = 0; mask_y < mask_dimension.height; ++mask_y) {
+    for (int mask_x = 0; mask_x < mask_dimension.width; ++mask_x) {
+      int tensor_x;
+      int tensor_y;
+      OrientCoordinates(mask_x, mask_y, Orientation::kTopLeft,
+                        tensor_orientation, mask_dimension, &tensor_x,
+                        &tensor_y);
+      int class_index = 0;
+      float max_confidence = 0.0f;
+      for (int d = 0; d < depth; ++d) {
+        const float confidence = get_confidence(
+            tensor_dimension.width * depth * tensor_y + depth * tensor_x + d);
+        if (confidence > max_confidence) {
+          class_index = d;
+          max_confidence = confidence;
+        }
+      }
+      category_mask.push_back(static_cast<uint8>(class_index));
+    }
+  }
+  return category_mask;
+}
+
+// Same as above for the confidence masks, concatenated.
+std::vector<float> ComputeConfidenceMasksPerPixel(
+    FrameBuffer::Dimension tensor_dimension, int depth,
+    Orientation tensor_orientation,
+    const std::function<float(int)>& get_confidence) {
+  FrameBuffer::Dimension mask_dimension = tensor_dimension;
+  if (RequireDimensionSwap(tensor_orientation, Orientation::kTopLeft)) {
+    mask_dimension.Swap();
+  }
+  std::vector<float> confidence_masks(mask_dimension.Size() * depth);
+  int pixel_index = 0;
+  for (int mask_y = 0; mask_y < mask_dimension.height; ++mask_y) {
+    for (int mask_x = 0; mask_x < mask_dimension.width; ++mask_x) {
+      int tensor_x;
+      int tensor_y;
+      OrientCoordinates(mask_x, mask_y, Orientation::kTopLeft,
+                        tensor_orientation, mask_dimension, &tensor_x,
+                        &tensor_y);
+      for (int d = 0; d < depth; ++d) {
+        confidence_masks[d * mask_dimension.Size() + pixel_index] =
+            get_confidence(tensor_dimension.width * depth * tensor_y +
+                           depth * tensor_x + d);
+      }
+      ++pixel_index;
+    }
+  }
+  return confidence_masks;
+}
+
+// Distributions of the float test confidences.
+enum class Distribution {
+  // Positive and negative values.
+  kMixed,
+  // Non-positive values only, for which class 0 is expected.
+  kNonPositive,
+  // A few small integers, making ties frequent.
+  kFewValues,
+};
+
+std::vector<float> CreateFloatTensor(int size, Distribution distribution,
+                                     std::mt19937* rng) {
+  std::vector<float> data(size);
+  for (float& value : data) {
+    switch (distribution) {
+      case Distribution::kMixed:
+        value = ((*rng)() % 2000) / 100.0f - 10.0f;
+        break;
+      case Distribution::kNonPositive:
+        value = -static_cast<float>((*rng)() % 100);
+        break;
+      case Distribution::kFewValues:
+        value = static_cast<float>((*rng)() % 4);
+        break;
+    }
+    // Sprinkle special values.
+    const int special = (*rng)() % 100;
+    if (special < 2) {
+      value = kNaN;
+    } else if (special < 4) {
+      value = -0.0f;
+    } else if (special < 5) {
+      value = kInfinity;
+    }
+  }
+  return data;
+}
+
+std::vector<uint8> ComputeCategoryMask(const std::vector<float>& data,
+                                       const MaskTensorLayout& layout) {
+  std::vector<uint8> category_mask(layout.mask_dimension.Size());
+  // Computes the mask in two row ranges, as done in parallel.
+  const int middle_row = layout.mask_dimension.height / 2;
+  ComputeCategoryMaskRows(data.data(), layout, middle_row,
+                          layout.mask_dimension.height, category_mask.data());
+  ComputeCategoryMaskRows(data.data(), layout, 0, middle_row,
+                          category_mask.data());
+  return category_mask;
+}
+
+TEST(ComputeCategoryMaskRowsTest, ResolvesTiesAndIgnoresNaNs) {
+  const MaskTensorLayout layout =
+      GetMaskTensorLayout({1, 1}, 9, Orientation::kTopLeft);
+  // Ties go to the lowest index.
+  EXPECT_EQ(ComputeCategoryMask({1, 3, 2, 3, 3, 0, 1, 2, 3}, layout)[0], 1);
+  EXPECT_EQ(ComputeCategoryMask({1, 0, 2, 0, 0, 0, 1, 2, 2}, layout)[0], 2);
+  EXPECT_EQ(ComputeCategoryMask({1, 0, 2, 0, 0, 0, 1, 2, 5}, layout)[0], 8);
+  // NaNs are ignored, wherever they are.
+  EXPECT_EQ(ComputeCategoryMask({kNaN, 1, 2, 0, 0, 0, 0, 0, 0}, layout)[0],
+            2);
+  EXPECT_EQ(ComputeCategoryMask({1, kNaN, kNaN, kNaN, 0, 2, 0, 0, kNaN},
+                                layout)[0],
+            5);
+  EXPECT_EQ(ComputeCategoryMask({0, 0, 0, 0, 0, 0, 0, 1, kNaN}, layout)[0],
+            7);
+  // Class 0 when no confidence is positive.
+  EXPECT_EQ(ComputeCategoryMask({kNaN, kNaN, kNaN, kNaN, kNaN, kNaN, kNaN,
+                                 kNaN, kNaN},
+                                layout)[0],
+            0);
+  EXPECT_EQ(ComputeCategoryMask({-1, -0.0f, -kInfinity, 0, -2, -3, kNaN, -4,
+                                 -5},
+                                layout)[0],
+            0);
+  // Infinities are regular values.
+  EXPECT_EQ(ComputeCategoryMask({1, 2, kInfinity, 3, kInfinity, 0, 0, 0, 0},
+                                layout)[0],
+            2);
+}
+
+class ComputeCategoryMaskRowsOrientationTest
+    : public ::testing::TestWithParam<int> {};
+
+TEST_P(ComputeCategoryMaskRowsOrientationTest, FloatMatchesPerPixelLoop) {
+  const auto orientation = static_cast<Orientation>(GetParam());
+  std::mt19937 rng(GetParam());
+  for (int depth : kDepths) {
+    for (FrameBuffer::Dimension tensor_dimension : kTensorDimensions) {
+      for (Distribution distribution :
+           {Distribution::kMixed, Distribution::kNonPositive,
+            Distribution::kFewValues}) {
+        const std::vector<float> data = CreateFloatTensor(
+            tensor_dimension.Size() * depth, distribution, &rng);
+        const MaskTensorLayout layout =
+            GetMaskTensorLayout(tensor_dimension, depth, orientation);
+        EXPECT_EQ(ComputeCategoryMask(data, layout),
+                  ComputeCategoryMaskPerPixel(
+                      tensor_dimension, depth, orientation,
+                      [&](int index) { return data[index]; }))
+            << "depth: " << depth << ", distribution: "
+            << static_cast<int>(distribution);
+      }
+    }
+  }
+}
+
+TEST_P(ComputeCategoryMaskRowsOrientationTest, Uint8MatchesPerPixelLoop) {
+  const auto orientation = static_cast<Orientation>(GetParam());
+  std::mt19937 rng(GetParam());
+  for (int depth : kDepths) {
+    for (FrameBuffer::Dimension tensor_dimension : kTensorDimensions) {
+      for (bool few_values : {false, true}) {
+        std::vector<uint8> data(tensor_dimension.Size() * depth);
+        for (uint8& value : data) {
+          value = few_values ? 126 + rng() % 4 : rng() % 256;
+        }
+        const MaskTensorLayout layout =
+            GetMaskTensorLayout(tensor_dimension, depth, orientation);
+        // Order-preserving quantization parameters, and others falling back to
+        // dequantization.
+        for (float scale : {0.1f, 0.0039f, 0.0f, -0.1f, 1e-40f, 1e38f, 3e38f}) {
+          for (int zero_point : {0, 128, 255, -5, 300}) {
+            std::vector<uint8> category_mask(layout.mask_dimension.Size());
+            ComputeCategoryMaskRows(data.data(), scale, zero_point, layout, 0,
+                                    layout.mask_dimension.height,
+                                    category_mask.data());
+            EXPECT_EQ(category_mask,
+                      ComputeCategoryMaskPerPixel(
+                          tensor_dimension, depth, orientation,
+                          [&](int index) {
+                            return scale * (static_cast<int>(data[index]) -
+                                            zero_point);
+                          }))
+                << "depth: " << depth << ", scale: " << scale
+                << ", zero point: " << zero_point;
+          }
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllOrientations,
+                         ComputeCategoryMaskRowsOrientationTest,
+                         ::testing::Range(1, 9));
+
+// Tensor large enough for the masks to be split in stripes, whose row count
+// isn't a multiple of the number of stripes.
+constexpr FrameBuffer::Dimension kLargeTensorDimension = {257, 131};
+constexpr int kLargeTensorDepth = 5;
+constexpr int kNumThreads = 4;
+
+// Returns the pointers to the `depth` masks concatenated in `masks`.
+std::vector<float*> GetMaskPointers(int depth, std::vector<float>* masks) {
+  std::vector<float*> pointers(depth);
+  for (int d = 0; d < depth; ++d) {
+    pointers[d] = masks->data() + d * masks->size() / depth;
+  }
+  return pointers;
+}
+
+class StripedMasksTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(StripedMasksTest, CategoryMaskMatchesPerPixelLoop) {
+  const auto orientation = static_cast<Orientation>(GetParam());
+  std::mt19937 rng(GetParam());
+  const int size = kLargeTensorDimension.Size() * kLargeTensorDepth;
+  const std::vector<float> float_data =
+      CreateFloatTensor(size, Distribution::kFewValues, &rng);
+  std::vector<uint8> uint8_data(size);
+  for (uint8& value : uint8_data) {
+    value = 126 + rng() % 4;
+  }
+  const float scale = 0.1f;
+  const int zero_point = 127;
+  const MaskTensorLayout layout = GetMaskTensorLayout(
+      kLargeTensorDimension, kLargeTensorDepth, orientation);
+  const std::vector<uint8> expected_float_mask = ComputeCategoryMaskPerPixel(
+      kLargeTensorDimension, kLargeTensorDepth, orientation,
+      [&](int index) { return float_data[index]; });
+  const std::vector<uint8> expected_uint8_mask = ComputeCategoryMaskPerPixel(
+      kLargeTensorDimension, kLargeTensorDepth, orientation, [&](int index) {
+        return scale * (static_cast<int>(uint8_data[index]) - zero_point);
+      });
+
+  ThreadPool thread_pool(kNumThreads);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool}) {
+    std::vector<uint8> category_mask(layout.mask_dimension.Size());
+    ComputeCategoryMask(float_data.data(), layout, pool,
+                        category_mask.data());
+    EXPECT_EQ(category_mask, expected_float_mask);
+    ComputeCategoryMask(uint8_data.data(), scale, zero_point, layout, pool,
+                        category_mask.data());
+    EXPECT_EQ(category_mask, expected_uint8_mask);
+  }
+}
+
+TEST_P(StripedMasksTest, ConfidenceMasksMatchPerPixelLoop) {
+  const auto orientation = static_cast<Orientation>(GetParam());
+  std::mt19937 rng(GetParam());
+  const int size = kLargeTensorDimension.Size() * kLargeTensorDepth;
+  const std::vector<float> float_data =
+      CreateFloatTensor(size, Distribution::kMixed, &rng);
+  std::vector<uint8> uint8_data(size);
+  for (uint8& value : uint8_data) {
+    value = rng() % 256;
+  }
+  const float scale = 0.0039f;
+  const int zero_point = 3;
+  const MaskTensorLayout layout = GetMaskTensorLayout(
+      kLargeTensorDimension, kLargeTensorDepth, orientation);
+  const std::vector<float> expected_float_masks =
+      ComputeConfidenceMasksPerPixel(
+          kLargeTensorDimension, kLargeTensorDepth, orientation,
+          [&](int index) { return float_data[index]; });
+  const std::vector<float> expected_uint8_masks =
+      ComputeConfidenceMasksPerPixel(
+          kLargeTensorDimension, kLargeTensorDepth, orientation,
+          [&](int index) {
+            return scale * (static_cast<int>(uint8_data[index]) - zero_point);
+          });
+
+  ThreadPool thread_pool(kNumThreads);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool}) {
+    std::vector<float> masks(size);
+    const std::vector<float*> mask_pointers =
+        GetMaskPointers(kLargeTensorDepth, &masks);
+    ComputeConfidenceMasks(float_data.data(), layout, pool,
+                           mask_pointers.data());
+    // Compare the bits, as the masks hold NaNs.
+    EXPECT_EQ(0, memcmp(masks.data(), expected_float_masks.data(),
+                        size * sizeof(float)));
+    ComputeConfidenceMasks(uint8_data.data(), scale, zero_point, layout, pool,
+                           mask_pointers.data());
+    EXPECT_EQ(masks, expected_uint8_masks);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllOrientations, StripedMasksTest,
+                         ::testing::Range(1, 9));
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,470 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/simd_frame_buffer_utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "include/libyuv.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+constexpr int kRgbPixelBytes = 3;
+constexpr int kUvPixelBytes = 2;
+
+// Side of the square tiles used to transpose images with 3 bytes per pixel,
+// chosen so that the source and destination rows of a tile stay in L1 cache.
+constexpr int kTransposeTileSize = 16;
+
+// Transposes the `width` x `height` image of `kPixelBytes` bytes per pixel
+// `src` into the `height` x `width` image `dst`, i.e. dst(x, y) = src(y, x).
+// Strides are in bytes and may be negative.
+template <int kPixelBytes>
+void TransposeScalar(const uint8* src, int src_stride, uint8* dst,
+                     int dst_stride, int width, int height) {
+  for (int x = 0; x < width; ++x) {
+    uint8* dst_row = dst + x * dst_stride;
+    const uint8* src_column = src + x * kPixelBytes;
+    for (int y = 0; y < height; ++y) {
+      std::memcpy(dst_row + y * kPixelBytes, src_column + y * src_stride,
+                  kPixelBytes);
+    }
+  }
+}
+
+// Same as `TransposeScalar<3>`, processing the image by square tiles.
+void TransposeRgb(const uint8* src, int src_stride, uint8* dst, int dst_stride,
+                  int width, int height) {
+  for (int y = 0; y < height; y += kTransposeTileSize) {
+    const int tile_height = std::min(kTransposeTileSize, height - y);
+    for (int x = 0; x < width; x += kTransposeTileSize) {
+      TransposeScalar<kRgbPixelBytes>(
+          src + y * src_stride + x * kRgbPixelBytes, src_stride,
+          dst + x * dst_stride + y * kRgbPixelBytes, dst_stride,
+          std::min(kTransposeTileSize, width - x), tile_height);
+    }
+  }
+}
+
+// Transposes a block of 8 x 8 pixels of 2 bytes per pixel.
+void Transpose8x8Uv(const uint8* src, int src_stride, uint8* dst,
+                    int dst_stride) {
+#if defined(__SSE2__)
+  __m128i r[8];
+  for (int i = 0; i < 8; ++i) {
+    r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    src += src_stride;
+  }
+  // Interleave pixels, then pairs of pixels, then quadruples of pixels.
+  __m128i a[8];
+  for (int i = 0; i < 4; ++i) {
+    a[2 * i] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+    a[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+  }
+  __m128i b[8];
+  for (int i = 0; i < 2; ++i) {
+    b[4 * i] = _mm_unpacklo_epi32(a[4 * i], a[4 * i + 2]);
+    b[4 * i + 1] = _mm_unpackhi_epi32(a[4 * i], a[4 * i + 2]);
+    b[4 * i + 2] = _mm_unpacklo_epi32(a[4 * i + 1], a[4 * i + 3]);
+    b[4 * i + 3] = _mm_unpackhi_epi32(a[4 * i + 1], a[4 * i + 3]);
+  }
+  for (int i = 0; i < 4; ++i) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_unpacklo_epi64(b[i], b[i + 4]));
+    dst += dst_stride;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_unpackhi_epi64(b[i], b[i + 4]));
+    dst += dst_stride;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  uint16x8_t r[8];
+  for (int i = 0; i < 8; ++i) {
+    r[i] = vreinterpretq_u16_u8(vld1q_u8(src));
+    src += src_stride;
+  }
+  // Transpose 2x2 blocks of pixels, then 2x2 blocks of pairs of pixels, then
+  // swap the 4x4 blocks of pixels.
+  uint16x8x2_t a[4];
+  for (int i = 0; i < 4; ++i) {
+    a[i] = vtrnq_u16(r[2 * i], r[2 * i + 1]);
+  }
+  uint32x4x2_t b[4];
+  for (int i = 0; i < 2; ++i) {
+    b[2 * i] = vtrnq_u32(vreinterpretq_u32_u16(a[2 * i].val[0]),
+                         vreinterpretq_u32_u16(a[2 * i + 1].val[0]));
+    b[2 * i + 1] = vtrnq_u32(vreinterpretq_u32_u16(a[2 * i].val[1]),
+                             vreinterpretq_u32_u16(a[2 * i + 1].val[1]));
+  }
+  // b[0] holds columns (0, 4) and (2, 6) of rows 0-3, b[1] columns (1, 5) and
+  // (3, 7) of rows 0-3, and b[2], b[3] the same for rows 4-7.
+  uint32x4_t columns[8];
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      const uint32x4_t top = b[i].val[j];
+      const uint32x4_t bottom = b[i + 2].val[j];
+      columns[2 * j + i] =
+          vcombine_u32(vget_low_u32(top), vget_low_u32(bottom));
+      columns[2 * j + i + 4] =
+          vcombine_u32(vget_high_u32(top), vget_high_u32(bottom));
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    vst1q_u8(dst, vreinterpretq_u8_u32(columns[i]));
+    dst += dst_stride;
+  }
+#else
+  TransposeScalar<kUvPixelBytes>(src, src_stride, dst, dst_stride, 8, 8);
+#endif
+}
+
+// Same as `TransposeScalar<2>`, processing the image by blocks of 8 x 8 pixels.
+void TransposeUv(const uint8* src, int src_stride, uint8* dst, int dst_stride,
+                 int width, int height) {
+  int y = 0;
+  for (; y + 8 <= height; y += 8) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+      Transpose8x8Uv(src + y * src_stride + x * kUvPixelBytes, src_stride,
+                     dst + x * dst_stride + y * kUvPixelBytes, dst_stride);
+    }
+    TransposeScalar<kUvPixelBytes>(
+        src + y * src_stride + x * kUvPixelBytes, src_stride,
+        dst + x * dst_stride + y * kUvPixelBytes, dst_stride, width - x, 8);
+  }
+  TransposeScalar<kUvPixelBytes>(src + y * src_stride, src_stride,
+                                 dst + y * kUvPixelBytes, dst_stride, width,
+                                 height - y);
+}
+
+// Writes the `width` pixels of 2 bytes per pixel of `src` to `dst` in reverse
+// order.
+void MirrorUvRow(const uint8* src, uint8* dst, int width) {
+  int x = 0;
+#if defined(__SSE2__)
+  for (; x + 8 <= width; x += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        src + (width - x - 8) * kUvPixelBytes));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * kUvPixelBytes), v);
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; x + 8 <= width; x += 8) {
+    uint16x8_t v = vreinterpretq_u16_u8(
+        vld1q_u8(src + (width - x - 8) * kUvPixelBytes));
+    v = vrev64q_u16(v);
+    v = vcombine_u16(vget_high_u16(v), vget_low_u16(v));
+    vst1q_u8(dst + x * kUvPixelBytes, vreinterpretq_u8_u16(v));
+  }
+#endif
+  for (; x < width; ++x) {
+    std::memcpy(dst + x * kUvPixelBytes,
+                src + (width - x - 1) * kUvPixelBytes, kUvPixelBytes);
+  }
+}
+
+// Rotates the `width` x `height` image `src` with the given pixel `transpose`
+// function counter-clockwise by `angle_deg` (90 or 270) degrees.
+template <typename TransposeFunction>
+void RotateByTransposition(const TransposeFunction& transpose, const uint8* src,
+                           int src_stride, uint8* dst, int dst_stride,
+                           int width, int height, int angle_deg) {
+  if (angle_deg == 90) {
+    // Transposing into the rows of `dst` in bottom-up order.
+    transpose(src, src_stride, dst + (width - 1) * dst_stride, -dst_stride,
+              width, height);
+  } else {
+    // Transposing the rows of `src` in bottom-up order.
+    transpose(src + (height - 1) * src_stride, -src_stride, dst, dst_stride,
+              width, height);
+  }
+}
+
+// Returns the libyuv filter mode implementing `interpolation`, which is the
+// one used by `LibyuvFrameBufferUtils`.
+libyuv::FilterMode GetLibyuvFilterMode(InterpolationMethod interpolation) {
+  switch (interpolation) {
+    case InterpolationMethod::kArea:
+      return libyuv::FilterMode::kFilterBox;
+    case InterpolationMethod::kNearestNeighbor:
+      return libyuv::FilterMode::kFilterNone;
+    case InterpolationMethod::kBilinear:
+      break;
+  }
+  return libyuv::FilterMode::kFilterBilinear;
+}
+
+// Returns libyuv rotation based on counter-clockwise angle_deg.
+libyuv::RotationMode GetLibyuvRotationMode(int angle_deg) {
+  switch (angle_deg) {
+    case 90:
+      return libyuv::kRotate270;
+    case 270:
+      return libyuv::kRotate90;
+    case 180:
+      return libyuv::kRotate180;
+    default:
+      return libyuv::kRotate0;
+  }
+}
+
+// Returns the interleaved chroma data of the kNV12 / kNV21 `yuv_data` in
+// memory order, i.e. UV for kNV12 and VU for kNV21.
+const uint8* GetInterleavedChroma(const FrameBuffer::YuvData& yuv_data) {
+  return std::min(yuv_data.u_buffer, yuv_data.v_buffer);
+}
+
+// Returns whether `buffer` is a kNV12 / kNV21 buffer with interleaved chroma,
+// which is the case for all buffers created from raw NV12 / NV21 data, and
+// whose chroma rows don't overlap in memory. Such an overlap happens for kNV12
+// buffers with an odd width created from raw data, the result of operations
+// on which depends on the order in which pixels are written: these are left
+// to libyuv.
+bool HasInterleavedChroma(const FrameBuffer& buffer) {
+  if (buffer.format() != FrameBuffer::Format::kNV12 &&
+      buffer.format() != FrameBuffer::Format::kNV21) {
+    return false;
+  }
+  auto yuv_data = FrameBuffer::GetYuvDataFromFrameBuffer(buffer);
+  if (!yuv_data.ok()) {
+    return false;
+  }
+  const int uv_width = (buffer.dimension().width + 1) / 2;
+  return yuv_data.value().uv_pixel_stride == kUvPixelBytes &&
+         std::abs(yuv_data.value().u_buffer - yuv_data.value().v_buffer) == 1 &&
+         yuv_data.value().uv_row_stride >= uv_width * kUvPixelBytes;
+}
+
+// Rotates the kRGB or kBGR `buffer` without any intermediate conversion.
+absl::Status RotateRgb(const FrameBuffer& buffer, int angle_deg,
+                       FrameBuffer* output_buffer) {
+  const uint8* src = buffer.plane(0).buffer;
+  const int src_stride = buffer.plane(0).stride.row_stride_bytes;
+  uint8* dst = const_cast<uint8*>(output_buffer->plane(0).buffer);
+  const int dst_stride = output_buffer->plane(0).stride.row_stride_bytes;
+  const int width = buffer.dimension().width;
+  const int height = buffer.dimension().height;
+  if (angle_deg == 180) {
+    // Mirroring the rows of `src` in bottom-up order, libyuv flips the source
+    // vertically when given a negative height.
+    int ret = libyuv::RGB24Mirror(src, src_stride, dst, dst_stride, width,
+                                  -height);
+    if (ret != 0) {
+      return CreateStatusWithPayload(
+          StatusCode::kUnknown, "Libyuv RGB24Mirror operation failed.",
+          TfLiteSupportStatus::kImageProcessingBackendError);
+    }
+    return absl::OkStatus();
+  }
+  RotateByTransposition(TransposeRgb, src, src_stride, dst, dst_stride, width,
+                        height, angle_deg);
+  return absl::OkStatus();
+}
+
+// Rotates the kNV12 / kNV21 `buffer` with interleaved chroma without any
+// intermediate conversion to I420.
+absl::Status RotateNv(const FrameBuffer& buffer, int angle_deg,
+                      FrameBuffer* output_buffer) {
+  ASSIGN_OR_RETURN(FrameBuffer::YuvData input_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+  ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+  const int width = buffer.dimension().width;
+  const int height = buffer.dimension().height;
+  int ret = libyuv::RotatePlane(
+      input_data.y_buffer, input_data.y_row_stride,
+      const_cast<uint8*>(output_data.y_buffer), output_data.y_row_stride, width,
+      height, GetLibyuvRotationMode(angle_deg));
+  if (ret != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown, "Libyuv RotatePlane operation failed.",
+        TfLiteSupportStatus::kImageProcessingBackendError);
+  }
+
+  const uint8* src_uv = GetInterleavedChroma(input_data);
+  uint8* dst_uv = const_cast<uint8*>(GetInterleavedChroma(output_data));
+  const int uv_width = (width + 1) / 2;
+  const int uv_height = (height + 1) / 2;
+  if (angle_deg == 180) {
+    for (int y = 0; y < uv_height; ++y) {
+      MirrorUvRow(src_uv + (uv_height - 1 - y) * input_data.uv_row_stride,
+                  dst_uv + y * output_data.uv_row_stride, uv_width);
+    }
+  } else {
+    RotateByTransposition(TransposeUv, src_uv, input_data.uv_row_stride,
+                          dst_uv, output_data.uv_row_stride, uv_width,
+                          uv_height, angle_deg);
+  }
+  return absl::OkStatus();
+}
+
+// Resizes the kNV12 / kNV21 `buffer` with interleaved chroma, scaling the Y
+// plane in place and only going through separate U and V planes for chroma.
+//
+// The scaling is identical to the one of libyuv::I420Scale, which is what
+// `LibyuvFrameBufferUtils` uses after converting the whole frame to I420.
+//
+// The separate chroma planes are stored in `chroma_buffer`.
+absl::Status ResizeNv(const FrameBuffer& buffer, FrameBuffer* output_buffer,
+                      libyuv::FilterMode filter_mode,
+                      ScratchArena* chroma_buffer) {
+  ASSIGN_OR_RETURN(FrameBuffer::YuvData input_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+  ASSIGN_OR_RETURN(FrameBuffer::YuvData output_data,
+                   FrameBuffer::GetYuvDataFromFrameBuffer(*output_buffer));
+  const FrameBuffer::Dimension input_dimension = buffer.dimension();
+  const FrameBuffer::Dimension output_dimension = output_buffer->dimension();
+  libyuv::ScalePlane(input_data.y_buffer, input_data.y_row_stride,
+                     input_dimension.width, input_dimension.height,
+                     const_cast<uint8*>(output_data.y_buffer),
+                     output_data.y_row_stride, output_dimension.width,
+                     output_dimension.height, filter_mode);
+
+  const int input_uv_width = (input_dimension.width + 1) / 2;
+  const int input_uv_height = (input_dimension.height + 1) / 2;
+  const int output_uv_width = (output_dimension.width + 1) / 2;
+  const int output_uv_height = (output_dimension.height + 1) / 2;
+  const int input_plane_size = input_uv_width * input_uv_height;
+  const int output_plane_size = output_uv_width * output_uv_height;
+  // The first and second chroma planes, in memory order.
+  uint8* input_first =
+      chroma_buffer->Get(2 * (input_plane_size + output_plane_size));
+  uint8* input_second = input_first + input_plane_size;
+  uint8* output_first = input_second + input_plane_size;
+  uint8* output_second = output_first + output_plane_size;
+  libyuv::SplitUVPlane(GetInterleavedChroma(input_data),
+                       input_data.uv_row_stride, input_first, input_uv_width,
+                       input_second, input_uv_width, input_uv_width,
+                       input_uv_height);
+  libyuv::ScalePlane(input_first, input_uv_width, input_uv_width,
+                     input_uv_height, output_first, output_uv_width,
+                     output_uv_width, output_uv_height, filter_mode);
+  libyuv::ScalePlane(input_second, input_uv_width, input_uv_width,
+                     input_uv_height, output_second, output_uv_width,
+                     output_uv_width, output_uv_height, filter_mode);
+  libyuv::MergeUVPlane(output_first, output_uv_width, output_second,
+                       output_uv_width,
+                       const_cast<uint8*>(GetInterleavedChroma(output_data)),
+                       output_data.uv_row_stride, output_uv_width,
+                       output_uv_height);
+  chroma_buffer->ReleaseIfAboveCap();
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status SimdFrameBufferUtils::Crop(const FrameBuffer& buffer, int x0,
+                                        int y0, int x1, int y1,
+                                        FrameBuffer* output_buffer) {
+  return libyuv_utils_.Crop(buffer, x0, y0, x1, y1, output_buffer);
+}
+
+absl::Status SimdFrameBufferUtils::Resize(const FrameBuffer& buffer,
+                                          FrameBuffer* output_buffer) {
+  if (!HasInterleavedChroma(buffer) || !HasInterleavedChroma(*output_buffer)) {
+    return libyuv_utils_.Resize(buffer, output_buffer);
+  }
+  RETURN_IF_ERROR(ValidateResizeBufferInputs(buffer, *output_buffer));
+  return ResizeNv(buffer, output_buffer, libyuv::FilterMode::kFilterBilinear,
+                  &chroma_buffer_);
+}
+
+absl::Status SimdFrameBufferUtils::ResizeWithInterpolation(
+    const FrameBuffer& buffer, InterpolationMethod interpolation,
+    FrameBuffer* output_buffer) {
+  if (!HasInterleavedChroma(buffer) || !HasInterleavedChroma(*output_buffer)) {
+    return libyuv_utils_.ResizeWithInterpolation(buffer, interpolation,
+                                                 output_buffer);
+  }
+  RETURN_IF_ERROR(ValidateResizeBufferInputs(buffer, *output_buffer));
+  return ResizeNv(buffer, output_buffer, GetLibyuvFilterMode(interpolation),
+                  &chroma_buffer_);
+}
+
+bool SimdFrameBufferUtils::SupportsResizeRows(
+    FrameBuffer::Format format) const {
+  return libyuv_utils_.SupportsResizeRows(format);
+}
+
+absl::Status SimdFrameBufferUtils::ResizeRows(const FrameBuffer& buffer,
+                                              int row_begin, int row_end,
+                                              FrameBuffer* output_buffer) {
+  return libyuv_utils_.ResizeRows(buffer, row_begin, row_end, output_buffer);
+}
+
+absl::Status SimdFrameBufferUtils::Rotate(const FrameBuffer& buffer,
+                                          int angle_deg,
+                                          FrameBuffer* output_buffer) {
+  // kBGR buffers only differ from kRGB ones by their channel order.
+  const bool is_rgb = (buffer.format() == FrameBuffer::Format::kRGB ||
+                       buffer.format() == FrameBuffer::Format::kBGR) &&
+                      buffer.plane_count() == 1;
+  const bool is_nv =
+      HasInterleavedChroma(buffer) && HasInterleavedChroma(*output_buffer);
+  if (!is_rgb && !is_nv) {
+    return libyuv_utils_.Rotate(buffer, angle_deg, output_buffer);
+  }
+  RETURN_IF_ERROR(
+      ValidateRotateBufferInputs(buffer, *output_buffer, angle_deg));
+  RETURN_IF_ERROR(ValidateBufferFormats(buffer, *output_buffer));
+  RETURN_IF_ERROR(ValidateBufferPlaneMetadata(buffer));
+  RETURN_IF_ERROR(ValidateBufferPlaneMetadata(*output_buffer));
+  return is_rgb ? RotateRgb(buffer, angle_deg, output_buffer)
+                : RotateNv(buffer, angle_deg, output_buffer);
+}
+
+absl::Status SimdFrameBufferUtils::FlipHorizontally(
+    const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+  return libyuv_utils_.FlipHorizontally(buffer, output_buffer);
+}
+
+absl::Status SimdFrameBufferUtils::FlipVertically(const FrameBuffer& buffer,
+                                                  FrameBuffer* output_buffer) {
+  return libyuv_utils_.FlipVertically(buffer, output_buffer);
+}
+
+absl::Status SimdFrameBufferUtils::Convert(const FrameBuffer& buffer,
+                                           FrameBuffer* output_buffer) {
+  return libyuv_utils_.Convert(buffer, output_buffer);
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,104 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SIMD_FRAME_BUFFER_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SIMD_FRAME_BUFFER_UTILS_H_
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/libyuv_frame_buffer_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/scratch_arena.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Image processing engine conforming to FrameBufferUtilsInterface that
+// specializes the common pre-processing paths for which libyuv has no direct
+// support, using portable SIMD intrinsics (SSE2 or NEON, with a scalar
+// fallback):
+//
+// - rotation of kRGB and kBGR buffers, which libyuv only supports through an
+//   intermediate ARGB conversion,
+// - rotation and resizing of kNV12 / kNV21 buffers, which libyuv only supports
+//   through an intermediate I420 (i.e. kYV21) conversion of the whole frame.
+//
+// All the other operations are delegated to `LibyuvFrameBufferUtils`. The
+// results are bit-exact with the ones of `LibyuvFrameBufferUtils`, so that
+// both engines can be used interchangeably.
+//
+// The separate chroma planes used to resize kNV12 / kNV21 buffers are kept in a
+// scratch buffer reused across calls, so SimdFrameBufferUtils is not
+// thread-safe.
+class SimdFrameBufferUtils : public FrameBufferUtilsInterface {
+ public:
+  SimdFrameBufferUtils() = default;
+  ~SimdFrameBufferUtils() override = default;
+
+  // Crops input `buffer` to the specified subregions and resizes the cropped
+  // region to the target image resolution defined by the `output_buffer`.
+  absl::Status Crop(const FrameBuffer& buffer, int x0, int y0, int x1, int y1,
+                    FrameBuffer* output_buffer) override;
+
+  // Resizes `buffer` to the size of the given `output_buffer`.
+  absl::Status Resize(const FrameBuffer& buffer,
+                      FrameBuffer* output_buffer) override;
+
+  // Resizes `buffer` to the size of the given `output_buffer` using the given
+  // `interpolation` method.
+  absl::Status ResizeWithInterpolation(const FrameBuffer& buffer,
+                                       InterpolationMethod interpolation,
+                                       FrameBuffer* output_buffer) override;
+
+  // Returns true for the formats supported by
+  // `LibyuvFrameBufferUtils::ResizeRows`.
+  bool SupportsResizeRows(FrameBuffer::Format format) const override;
+
+  // Computes the rows [row_begin, row_end) of the result of `Resize`.
+  absl::Status ResizeRows(const FrameBuffer& buffer, int row_begin,
+                          int row_end, FrameBuffer* output_buffer) override;
+
+  // Rotates `buffer` counter-clockwise by the given `angle_deg` (in degrees).
+  //
+  // The given angle must be a multiple of 90 degrees.
+  absl::Status Rotate(const FrameBuffer& buffer, int angle_deg,
+                      FrameBuffer* output_buffer) override;
+
+  // Flips `buffer` horizontally.
+  absl::Status FlipHorizontally(const FrameBuffer& buffer,
+                                FrameBuffer* output_buffer) override;
+
+  // Flips `buffer` vertically.
+  absl::Status FlipVertically(const FrameBuffer& buffer,
+                              FrameBuffer* output_buffer) override;
+
+  // Converts `buffer`'s format to the format of the given `output_buffer`.
+  absl::Status Convert(const FrameBuffer& buffer,
+                       FrameBuffer* output_buffer) override;
+
+ private:
+  // Engine used for the operations that are not specialized.
+  LibyuvFrameBufferUtils libyuv_utils_;
+
+  // Holds the separate chroma planes used to resize kNV12 / kNV21 buffers.
+  ScratchArena chroma_buffer_;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_SIMD_FRAME_BUFFER_UTILS_H_
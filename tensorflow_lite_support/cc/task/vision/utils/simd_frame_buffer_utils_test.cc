@@ -0,0 +1,210 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/simd_frame_buffer_utils.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils_interface.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/libyuv_frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+
+// Frame sizes with even and odd dimensions.
+constexpr FrameBuffer::Dimension kFrameDimensions[] = {
+    {640, 480}, {301, 203}, {2, 2}};
+
+const std::vector<Format>& GetAllFormats() {
+  static const std::vector<Format>* formats = new std::vector<Format>{
+      Format::kRGBA, Format::kRGB,  Format::kNV12, Format::kNV21,
+      Format::kYV12, Format::kYV21, Format::kGRAY, Format::kBGRA,
+      Format::kBGR,  Format::kYUYV, Format::kUYVY};
+  return *formats;
+}
+
+// Frame buffer along with its backing data.
+struct TestFrame {
+  std::vector<uint8> data;
+  std::unique_ptr<FrameBuffer> buffer;
+};
+
+TestFrame CreateTestFrame(FrameBuffer::Dimension dimension, Format format) {
+  TestFrame frame;
+  frame.data.resize(GetFrameBufferByteSize(dimension, format));
+  uint32 state = 12345;
+  for (uint8& value : frame.data) {
+    state = state * 1103515245 + 12345;
+    value = static_cast<uint8>(state >> 16);
+  }
+  frame.buffer =
+      CreateFromRawBuffer(frame.data.data(), dimension, format).value();
+  return frame;
+}
+
+// Runs `operation` into a `dimension` output buffer of the given `format`
+// with both engines, and expects bit-exact results. Operations unsupported by
+// LibyuvFrameBufferUtils must fail the same way with SimdFrameBufferUtils.
+void ExpectSameResultAsLibyuv(
+    FrameBuffer::Dimension dimension, Format format,
+    const std::function<absl::Status(FrameBufferUtilsInterface*,
+                                     FrameBuffer*)>& operation) {
+  LibyuvFrameBufferUtils libyuv_utils;
+  SimdFrameBufferUtils simd_utils;
+  TestFrame expected_output = CreateTestFrame(dimension, format);
+  TestFrame output = CreateTestFrame(dimension, format);
+  const absl::Status expected_status =
+      operation(&libyuv_utils, expected_output.buffer.get());
+  const absl::Status status = operation(&simd_utils, output.buffer.get());
+  EXPECT_EQ(status.code(), expected_status.code());
+  if (expected_status.ok()) {
+    EXPECT_EQ(output.data, expected_output.data);
+  }
+}
+
+FrameBuffer::Dimension Transpose(FrameBuffer::Dimension dimension) {
+  return {dimension.height, dimension.width};
+}
+
+class SimdFrameBufferUtilsTest : public ::testing::TestWithParam<Format> {};
+
+TEST_P(SimdFrameBufferUtilsTest, MatchesLibyuv) {
+  const Format format = GetParam();
+  for (FrameBuffer::Dimension dimension : kFrameDimensions) {
+    SCOPED_TRACE(testing::Message()
+                 << dimension.width << "x" << dimension.height);
+    const TestFrame frame = CreateTestFrame(dimension, format);
+    const FrameBuffer& input = *frame.buffer;
+    const int x1 = dimension.width - 1;
+    const int y1 = dimension.height - 1;
+
+    ExpectSameResultAsLibyuv(
+        {x1 / 2 + 1, y1 / 2 + 1}, format,
+        [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+          return utils->Crop(input, x1 / 2, y1 / 2, x1, y1, output);
+        });
+    ExpectSameResultAsLibyuv(
+        {224, 224}, format,
+        [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+          return utils->Crop(input, 0, y1 / 3, x1 / 2, y1, output);
+        });
+    for (FrameBuffer::Dimension output_dimension :
+         {FrameBuffer::Dimension{224, 224}, FrameBuffer::Dimension{97, 301},
+          FrameBuffer::Dimension{700, 530}, dimension}) {
+      SCOPED_TRACE(testing::Message() << "resized to " << output_dimension.width
+                                      << "x" << output_dimension.height);
+      ExpectSameResultAsLibyuv(
+          output_dimension, format,
+          [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+            return utils->Resize(input, output);
+          });
+      for (InterpolationMethod interpolation :
+           {InterpolationMethod::kBilinear, InterpolationMethod::kArea,
+            InterpolationMethod::kNearestNeighbor}) {
+        ExpectSameResultAsLibyuv(
+            output_dimension, format,
+            [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+              return utils->ResizeWithInterpolation(input, interpolation,
+                                                    output);
+            });
+      }
+      LibyuvFrameBufferUtils libyuv_utils;
+      SimdFrameBufferUtils simd_utils;
+      ASSERT_EQ(simd_utils.SupportsResizeRows(format),
+                libyuv_utils.SupportsResizeRows(format));
+      if (simd_utils.SupportsResizeRows(format)) {
+        ExpectSameResultAsLibyuv(
+            output_dimension, format,
+            [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+              const int middle_row = output_dimension.height / 3;
+              RETURN_IF_ERROR(utils->ResizeRows(
+                  input, middle_row, output_dimension.height, output));
+              return utils->ResizeRows(input, 0, middle_row, output);
+            });
+      }
+    }
+    for (int angle_deg : {90, 180, 270}) {
+      SCOPED_TRACE(testing::Message() << "rotated by " << angle_deg);
+      ExpectSameResultAsLibyuv(
+          angle_deg == 180 ? dimension : Transpose(dimension), format,
+          [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+            return utils->Rotate(input, angle_deg, output);
+          });
+    }
+    ExpectSameResultAsLibyuv(
+        dimension, format,
+        [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+          return utils->FlipHorizontally(input, output);
+        });
+    ExpectSameResultAsLibyuv(
+        dimension, format,
+        [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+          return utils->FlipVertically(input, output);
+        });
+    for (Format output_format : GetAllFormats()) {
+      SCOPED_TRACE(testing::Message()
+                   << "converted to " << static_cast<int>(output_format));
+      ExpectSameResultAsLibyuv(
+          dimension, output_format,
+          [&](FrameBufferUtilsInterface* utils, FrameBuffer* output) {
+            return utils->Convert(input, output);
+          });
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllFormats, SimdFrameBufferUtilsTest,
+                         ::testing::ValuesIn(GetAllFormats()));
+
+// The chroma planes of successive kNV12 / kNV21 resizes share a scratch
+// buffer, which must be grown and reused without affecting the results.
+TEST(SimdFrameBufferUtilsNvResizeTest, MatchesLibyuvWithSameInstance) {
+  LibyuvFrameBufferUtils libyuv_utils;
+  SimdFrameBufferUtils simd_utils;
+  for (Format format : {Format::kNV12, Format::kNV21}) {
+    for (FrameBuffer::Dimension dimension :
+         {FrameBuffer::Dimension{2, 2}, FrameBuffer::Dimension{640, 480},
+          FrameBuffer::Dimension{301, 203}, FrameBuffer::Dimension{640, 480}}) {
+      SCOPED_TRACE(testing::Message()
+                   << static_cast<int>(format) << " " << dimension.width
+                   << "x" << dimension.height);
+      const TestFrame frame = CreateTestFrame(dimension, format);
+      TestFrame expected_output = CreateTestFrame({224, 224}, format);
+      TestFrame output = CreateTestFrame({224, 224}, format);
+      ASSERT_TRUE(
+          libyuv_utils.Resize(*frame.buffer, expected_output.buffer.get())
+              .ok());
+      ASSERT_TRUE(simd_utils.Resize(*frame.buffer, output.buffer.get()).ok());
+      EXPECT_EQ(output.data, expected_output.data);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
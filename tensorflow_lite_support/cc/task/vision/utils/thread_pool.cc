@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/thread_pool.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+ThreadPool::ThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+    work_available_.SignalAll();
+  }
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int num_tasks,
+                             const std::function<void(int)>& task) {
+  if (num_tasks <= 0) {
+    return;
+  }
+  if (workers_.empty() || num_tasks == 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    pending_tasks_ = num_tasks;
+    ++generation_;
+    work_available_.SignalAll();
+  }
+  RunTasks();
+  absl::MutexLock lock(&mutex_);
+  while (pending_tasks_ > 0) {
+    work_done_.Wait(&mutex_);
+  }
+  task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  int seen_generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      while (!stopping_ && generation_ == seen_generation) {
+        work_available_.Wait(&mutex_);
+      }
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+    RunTasks();
+  }
+}
+
+void ThreadPool::RunTasks() {
+  while (true) {
+    const std::function<void(int)>* task;
+    int index;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (task_ == nullptr || next_task_ >= num_tasks_) {
+        return;
+      }
+      task = task_;
+      index = next_task_++;
+    }
+    (*task)(index);
+    absl::MutexLock lock(&mutex_);
+    if (--pending_tasks_ == 0) {
+      work_done_.Signal();
+    }
+  }
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
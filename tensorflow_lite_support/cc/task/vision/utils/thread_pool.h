@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_THREAD_POOL_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_THREAD_POOL_H_
+
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Minimal fixed-size thread pool used to split image processing operations
+// into independent tasks (e.g. horizontal stripes of the output image).
+//
+// The calling thread takes part in the processing, so that a pool created with
+// `num_threads` threads only spawns `num_threads - 1` worker threads.
+//
+// `ParallelFor` must not be called concurrently from multiple threads.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  // ThreadPool is neither copyable nor movable.
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Calls `task(i)` for each `i` in [0, num_tasks), spread across the calling
+  // thread and the worker threads, and returns once all calls have completed.
+  void ParallelFor(int num_tasks, const std::function<void(int)>& task);
+
+  // Returns the number of threads used by `ParallelFor`, including the calling
+  // thread.
+  int num_threads() const { return workers_.size() + 1; }
+
+ private:
+  // Main loop of the worker threads.
+  void WorkerLoop();
+
+  // Runs tasks from the current `ParallelFor` call until none is left.
+  void RunTasks() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  std::vector<std::thread> workers_;
+
+  absl::Mutex mutex_;
+  // Signaled when a new `ParallelFor` call starts or the pool is destroyed.
+  absl::CondVar work_available_;
+  // Signaled when the last task of the current `ParallelFor` call completes.
+  absl::CondVar work_done_;
+  // Task of the current `ParallelFor` call, if any.
+  const std::function<void(int)>* task_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  int num_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Index of the next task to run.
+  int next_task_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of tasks not completed yet.
+  int pending_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Incremented on each `ParallelFor` call, so that workers can tell new work
+  // from spurious wake-ups.
+  int generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_THREAD_POOL_H_
@@ -14,8 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
 
+#include <csetjmp>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <utility>
 #include <vector>
 
 // These need to be defined for stb_image.h and stb_image_write.h to include
@@ -26,6 +29,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "jpeglib.h"  // from @libjpeg_turbo
 #include "stb_image.h"
 #include "stb_image_write.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
@@ -37,6 +41,124 @@ namespace vision {
 
 using ::tflite::support::StatusOr;
 
+namespace {
+
+// libjpeg error manager reporting errors to the caller through `jump_buffer`,
+// instead of exiting the process.
+struct JpegErrorManager {
+  jpeg_error_mgr manager;
+  jmp_buf jump_buffer;
+  char message[JMSG_LENGTH_MAX];
+};
+
+void JpegErrorExit(j_common_ptr info) {
+  JpegErrorManager* error = reinterpret_cast<JpegErrorManager*>(info->err);
+  (*info->err->format_message)(info, error->message);
+  longjmp(error->jump_buffer, 1);
+}
+
+// Returns whether the file starts with the JPEG start of image marker. Leaves
+// the file position at its start.
+bool IsJpegFile(FILE* file) {
+  unsigned char marker[3];
+  const bool is_jpeg = fread(marker, 1, sizeof(marker), file) ==
+                           sizeof(marker) &&
+                       marker[0] == 0xFF && marker[1] == 0xD8 &&
+                       marker[2] == 0xFF;
+  rewind(file);
+  return is_jpeg;
+}
+
+// The two functions below run the libjpeg calls that may fail. They only
+// handle trivially destructible objects, as errors unwind them with longjmp.
+
+// Reads the JPEG header from `file`, and sets up `info` to decode the image at
+// the lowest scale whose dimension is at least `target_dimension`, into
+// `color_space`. Returns false on error.
+bool ReadJpegHeader(FILE* file, FrameBuffer::Dimension target_dimension,
+                    J_COLOR_SPACE color_space, jpeg_decompress_struct* info,
+                    JpegErrorManager* error) {
+  if (setjmp(error->jump_buffer)) {
+    return false;
+  }
+  jpeg_stdio_src(info, file);
+  jpeg_read_header(info, /*require_image=*/TRUE);
+  info->out_color_space = color_space;
+  // Scales supported by all libjpeg versions, from the lowest.
+  for (const int scale_denom : {8, 4, 2, 1}) {
+    info->scale_num = 1;
+    info->scale_denom = scale_denom;
+    jpeg_calc_output_dimensions(info);
+    if (static_cast<int>(info->output_width) >= target_dimension.width &&
+        static_cast<int>(info->output_height) >= target_dimension.height) {
+      break;
+    }
+  }
+  return true;
+}
+
+// Decodes the image set up by `ReadJpegHeader` into the rows of `data`, which
+// are `row_stride` bytes apart. Returns false on error.
+bool ReadJpegScanlines(uint8* data, int row_stride,
+                       jpeg_decompress_struct* info, JpegErrorManager* error) {
+  if (setjmp(error->jump_buffer)) {
+    return false;
+  }
+  jpeg_start_decompress(info);
+  while (info->output_scanline < info->output_height) {
+    JSAMPROW row = data + info->output_scanline * row_stride;
+    jpeg_read_scanlines(info, &row, /*max_lines=*/1);
+  }
+  jpeg_finish_decompress(info);
+  return true;
+}
+
+// Returns the error reported by libjpeg.
+absl::Status GetJpegError(const JpegErrorManager& error) {
+  return absl::InternalError(absl::StrFormat(
+      "An error occurred while decoding JPEG image: %s", error.message));
+}
+
+StatusOr<PooledFrameBuffer> DecodeJpegToFrameBuffer(
+    FILE* file, FrameBuffer::Dimension target_dimension,
+    FrameBuffer::Format format, FrameBufferPool* pool) {
+  jpeg_decompress_struct info;
+  JpegErrorManager error;
+  info.err = jpeg_std_error(&error.manager);
+  error.manager.error_exit = JpegErrorExit;
+  jpeg_create_decompress(&info);
+
+  const J_COLOR_SPACE color_space =
+      format == FrameBuffer::Format::kGRAY ? JCS_GRAYSCALE : JCS_RGB;
+  absl::Status status;
+  PooledFrameBuffer frame;
+  if (!ReadJpegHeader(file, target_dimension, color_space, &info, &error)) {
+    status = GetJpegError(error);
+  } else {
+    StatusOr<PooledFrameBuffer> acquired_frame =
+        pool->Acquire({static_cast<int>(info.output_width),
+                       static_cast<int>(info.output_height)},
+                      format);
+    if (!acquired_frame.ok()) {
+      status = acquired_frame.status();
+    } else {
+      frame = std::move(acquired_frame).value();
+      if (!ReadJpegScanlines(frame.data(),
+                             frame->plane(0).stride.row_stride_bytes, &info,
+                             &error)) {
+        status = GetJpegError(error);
+      }
+    }
+  }
+  jpeg_destroy_decompress(&info);
+  if (!status.ok()) {
+    return status;
+  }
+  return std::move(frame);
+}
+
+}  // namespace
+
 StatusOr<ImageData> DecodeImageFromFile(const std::string& file_name) {
   ImageData image_data;
   image_data.pixel_data = stbi_load(file_name.c_str(), &image_data.width,
@@ -57,6 +179,48 @@ StatusOr<ImageData> DecodeImageFromFile(const std::string& file_name) {
   return image_data;
 }
 
+StatusOr<PooledFrameBuffer> DecodeImageFromFileToFrameBuffer(
+    const std::string& file_name, FrameBuffer::Dimension target_dimension,
+    FrameBuffer::Format format, FrameBufferPool* pool) {
+  if (format != FrameBuffer::Format::kRGB &&
+      format != FrameBuffer::Format::kGRAY) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected kRGB or kGRAY format, found %i.", format));
+  }
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == nullptr) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open file: %s", file_name));
+  }
+  if (IsJpegFile(file)) {
+    StatusOr<PooledFrameBuffer> frame =
+        DecodeJpegToFrameBuffer(file, target_dimension, format, pool);
+    fclose(file);
+    return frame;
+  }
+
+  // Other formats are decoded at full resolution, then copied.
+  const int channels = format == FrameBuffer::Format::kGRAY ? 1 : 3;
+  ImageData image_data;
+  image_data.pixel_data = stbi_load_from_file(
+      file, &image_data.width, &image_data.height, &image_data.channels,
+      /*desired_channels=*/channels);
+  fclose(file);
+  if (image_data.pixel_data == nullptr) {
+    return absl::InternalError(absl::StrFormat(
+        "An error occurred while decoding image: %s", stbi_failure_reason()));
+  }
+  StatusOr<PooledFrameBuffer> frame =
+      pool->Acquire({image_data.width, image_data.height}, format);
+  if (frame.ok()) {
+    // Rows of pooled buffers are not padded.
+    memcpy(frame.value().data(), image_data.pixel_data,
+           image_data.width * image_data.height * channels);
+  }
+  ImageDataFree(&image_data);
+  return frame;
+}
+
 absl::Status EncodeImageToPngFile(const ImageData& image_data,
                                   const std::string& image_path) {
   // Sanity check inputs.
@@ -15,10 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_EXAMPLES_TASK_VISION_DESKTOP_UTILS_IMAGE_UTILS_H_
 #define TENSORFLOW_LITE_SUPPORT_EXAMPLES_TASK_VISION_DESKTOP_UTILS_IMAGE_UTILS_H_
 
+#include <string>
+
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow_lite_support/cc/port/integral_types.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_pool.h"
 
 namespace tflite {
 namespace task {
@@ -43,6 +47,20 @@ struct ImageData {
 tflite::support::StatusOr<ImageData> DecodeImageFromFile(
     const std::string& file_name);
 
+// Decodes image file into a `format` frame buffer acquired from `pool`, at the
+// lowest resolution that is at least `target_dimension` along both axes (or
+// at full resolution if the image is smaller), and returns it if no error
+// occurred. `format` must be kRGB or kGRAY.
+//
+// This is meant for images that are to be downscaled anyway, e.g. to the input
+// size of a model: JPEG files are decoded with libjpeg DCT-domain scaling,
+// i.e. at 1/2, 1/4 or 1/8 of their resolution when possible, which skips most
+// of the decoding work. Other image formats are decoded at full resolution,
+// like `DecodeImageFromFile` does.
+tflite::support::StatusOr<PooledFrameBuffer> DecodeImageFromFileToFrameBuffer(
+    const std::string& file_name, FrameBuffer::Dimension target_dimension,
+    FrameBuffer::Format format, FrameBufferPool* pool);
+
 // Encodes the image provided as an ImageData as lossless PNG to the provided
 // path.
 absl::Status EncodeImageToPngFile(const ImageData& image_data,
@@ -0,0 +1,323 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "jpeglib.h"  // from @libjpeg_turbo
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_pool.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using Format = FrameBuffer::Format;
+
+// Odd dimensions, so that the scaled dimensions are rounded up.
+constexpr int kWidth = 100;
+constexpr int kHeight = 75;
+
+// Color of the test images, and its luma as computed by libjpeg.
+constexpr uint8 kRgb[] = {200, 100, 50};
+constexpr int kGray = 124;
+// Tolerance on the decoded values, as JPEG is lossy.
+constexpr int kTolerance = 3;
+
+std::string GetTestPath(const std::string& file_name) {
+  return absl::StrCat(::testing::TempDir(), "/", file_name);
+}
+
+// Encodes a `kWidth` x `kHeight` image filled with `kRgb` (or its luma, if
+// `channels` is 1) as a JPEG file at `path`.
+void WriteJpegFile(const std::string& path, int channels) {
+  std::vector<uint8> row(kWidth * channels);
+  for (int x = 0; x < kWidth; ++x) {
+    for (int c = 0; c < channels; ++c) {
+      row[x * channels + c] = channels == 1 ? kGray : kRgb[c];
+    }
+  }
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  jpeg_compress_struct info;
+  jpeg_error_mgr error;
+  info.err = jpeg_std_error(&error);
+  jpeg_create_compress(&info);
+  jpeg_stdio_dest(&info, file);
+  info.image_width = kWidth;
+  info.image_height = kHeight;
+  info.input_components = channels;
+  info.in_color_space = channels == 1 ? JCS_GRAYSCALE : JCS_RGB;
+  jpeg_set_defaults(&info);
+  jpeg_set_quality(&info, /*quality=*/95, /*force_baseline=*/TRUE);
+  jpeg_start_compress(&info, /*write_all_tables=*/TRUE);
+  while (info.next_scanline < info.image_height) {
+    JSAMPROW row_pointer = row.data();
+    jpeg_write_scanlines(&info, &row_pointer, /*num_lines=*/1);
+  }
+  jpeg_finish_compress(&info);
+  jpeg_destroy_compress(&info);
+  fclose(file);
+}
+
+std::vector<uint8> ReadFile(const std::string& path) {
+  std::vector<uint8> data;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return data;
+  }
+  int c;
+  while ((c = fgetc(file)) != EOF) {
+    data.push_back(static_cast<uint8>(c));
+  }
+  fclose(file);
+  return data;
+}
+
+void WriteFile(const std::string& path, const std::vector<uint8>& data) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+}
+
+// Expects all the pixels of `frame` to be within `kTolerance` of `expected`,
+// which holds one value per channel.
+void ExpectUniformColor(const PooledFrameBuffer& frame,
+                        const std::vector<int>& expected) {
+  const FrameBuffer::Plane& plane = frame->plane(0);
+  const int channels = expected.size();
+  ASSERT_EQ(plane.stride.pixel_stride_bytes, channels);
+  for (int y = 0; y < frame->dimension().height; ++y) {
+    for (int x = 0; x < frame->dimension().width; ++x) {
+      for (int c = 0; c < channels; ++c) {
+        const int value = plane.buffer[y * plane.stride.row_stride_bytes +
+                                       x * channels + c];
+        ASSERT_LE(std::abs(value - expected[c]), kTolerance)
+            << "at (" << x << ", " << y << "), channel " << c;
+      }
+    }
+  }
+}
+
+struct ScaleTestCase {
+  FrameBuffer::Dimension target_dimension;
+  FrameBuffer::Dimension expected_dimension;
+};
+
+class DecodeJpegScaleTest : public ::testing::TestWithParam<ScaleTestCase> {};
+
+TEST_P(DecodeJpegScaleTest, DecodesAtLowestScaleCoveringTarget) {
+  const std::string path = GetTestPath("scale.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  FrameBufferPool pool;
+  PooledFrameBuffer frame =
+      DecodeImageFromFileToFrameBuffer(path, GetParam().target_dimension,
+                                       Format::kRGB, &pool)
+          .value();
+  EXPECT_EQ(frame->format(), Format::kRGB);
+  EXPECT_EQ(frame->dimension(), GetParam().expected_dimension);
+  ExpectUniformColor(frame, {kRgb[0], kRgb[1], kRgb[2]});
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TargetDimensions, DecodeJpegScaleTest,
+    ::testing::Values(
+        // 1/8 scale, rounded up from 12.5 x 9.375.
+        ScaleTestCase{{1, 1}, {13, 10}},
+        ScaleTestCase{{13, 10}, {13, 10}},
+        // Both axes must be covered.
+        ScaleTestCase{{14, 10}, {25, 19}},
+        ScaleTestCase{{13, 11}, {25, 19}},
+        ScaleTestCase{{26, 1}, {50, 38}},
+        ScaleTestCase{{50, 38}, {50, 38}},
+        ScaleTestCase{{51, 38}, {kWidth, kHeight}},
+        // Images smaller than the target are decoded at full resolution.
+        ScaleTestCase{{224, 224}, {kWidth, kHeight}}));
+
+TEST(DecodeImageFromFileToFrameBufferTest, DecodesRgbJpegToGray) {
+  const std::string path = GetTestPath("rgb.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  FrameBufferPool pool;
+  PooledFrameBuffer frame =
+      DecodeImageFromFileToFrameBuffer(path, {26, 19}, Format::kGRAY, &pool)
+          .value();
+  EXPECT_EQ(frame->format(), Format::kGRAY);
+  EXPECT_EQ(frame->dimension(), (FrameBuffer::Dimension{50, 38}));
+  ExpectUniformColor(frame, {kGray});
+}
+
+TEST(DecodeImageFromFileToFrameBufferTest, DecodesGrayJpeg) {
+  const std::string path = GetTestPath("gray.jpg");
+  WriteJpegFile(path, /*channels=*/1);
+  FrameBufferPool pool;
+  PooledFrameBuffer gray_frame =
+      DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kGRAY, &pool)
+          .value();
+  EXPECT_EQ(gray_frame->dimension(), (FrameBuffer::Dimension{13, 10}));
+  ExpectUniformColor(gray_frame, {kGray});
+
+  PooledFrameBuffer rgb_frame =
+      DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGB, &pool)
+          .value();
+  EXPECT_EQ(rgb_frame->format(), Format::kRGB);
+  ExpectUniformColor(rgb_frame, {kGray, kGray, kGray});
+}
+
+// Non-JPEG files are decoded by stb_image at full resolution, whatever the
+// target dimension.
+TEST(DecodeImageFromFileToFrameBufferTest, DecodesPngAtFullResolution) {
+  constexpr int kPngWidth = 5;
+  constexpr int kPngHeight = 3;
+  std::vector<uint8> pixels(kPngWidth * kPngHeight * 3);
+  for (int i = 0; i < pixels.size(); ++i) {
+    pixels[i] = i * 5;
+  }
+  const ImageData image_data = {pixels.data(), kPngWidth, kPngHeight,
+                                /*channels=*/3};
+  const std::string path = GetTestPath("image.png");
+  ASSERT_TRUE(EncodeImageToPngFile(image_data, path).ok());
+
+  FrameBufferPool pool;
+  PooledFrameBuffer frame =
+      DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGB, &pool)
+          .value();
+  EXPECT_EQ(frame->format(), Format::kRGB);
+  EXPECT_EQ(frame->dimension(),
+            (FrameBuffer::Dimension{kPngWidth, kPngHeight}));
+  // PNG is lossless.
+  EXPECT_EQ(std::vector<uint8>(frame->plane(0).buffer,
+                               frame->plane(0).buffer + pixels.size()),
+            pixels);
+
+  PooledFrameBuffer gray_frame =
+      DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kGRAY, &pool)
+          .value();
+  EXPECT_EQ(gray_frame->format(), Format::kGRAY);
+  EXPECT_EQ(gray_frame->dimension(),
+            (FrameBuffer::Dimension{kPngWidth, kPngHeight}));
+}
+
+TEST(DecodeImageFromFileToFrameBufferTest, FailsOnTruncatedJpegHeader) {
+  const std::string path = GetTestPath("truncated.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  std::vector<uint8> data = ReadFile(path);
+  ASSERT_GT(data.size(), 20);
+  data.resize(20);
+  WriteFile(path, data);
+
+  FrameBufferPool pool;
+  EXPECT_EQ(DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGB, &pool)
+                .status()
+                .code(),
+            absl::StatusCode::kInternal);
+}
+
+TEST(DecodeImageFromFileToFrameBufferTest, FailsOnCorruptJpegHeader) {
+  const std::string path = GetTestPath("corrupt.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  std::vector<uint8> data = ReadFile(path);
+  // Zeroes the image height in the start of frame segment, which follows the
+  // 0xFFC0 marker, the segment length and the sample precision.
+  bool found_start_of_frame = false;
+  for (int i = 0; i + 5 < data.size(); ++i) {
+    if (data[i] == 0xFF && data[i + 1] == 0xC0) {
+      data[i + 5] = 0;
+      data[i + 6] = 0;
+      found_start_of_frame = true;
+      break;
+    }
+  }
+  ASSERT_TRUE(found_start_of_frame);
+  WriteFile(path, data);
+
+  FrameBufferPool pool;
+  EXPECT_EQ(DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGB, &pool)
+                .status()
+                .code(),
+            absl::StatusCode::kInternal);
+}
+
+// Only the start of image marker is present, so the file is detected as JPEG
+// but has no header.
+TEST(DecodeImageFromFileToFrameBufferTest, FailsOnJpegWithoutHeader) {
+  const std::string path = GetTestPath("marker.jpg");
+  WriteFile(path, {0xFF, 0xD8, 0xFF});
+
+  FrameBufferPool pool;
+  EXPECT_EQ(DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kGRAY, &pool)
+                .status()
+                .code(),
+            absl::StatusCode::kInternal);
+}
+
+// libjpeg only warns about missing compressed data, and fills the missing rows
+// in, as stb_image does: the image is still decoded at the expected dimension.
+TEST(DecodeImageFromFileToFrameBufferTest, DecodesJpegWithTruncatedScan) {
+  const std::string path = GetTestPath("truncated_scan.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  std::vector<uint8> data = ReadFile(path);
+  // Cuts the compressed data, which follows the 0xFFDA start of scan marker,
+  // in half.
+  int start_of_scan = 0;
+  for (int i = 0; i + 1 < data.size(); ++i) {
+    if (data[i] == 0xFF && data[i + 1] == 0xDA) {
+      start_of_scan = i;
+      break;
+    }
+  }
+  ASSERT_GT(start_of_scan, 0);
+  data.resize((start_of_scan + data.size()) / 2);
+  WriteFile(path, data);
+
+  FrameBufferPool pool;
+  PooledFrameBuffer frame =
+      DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGB, &pool)
+          .value();
+  EXPECT_EQ(frame->dimension(), (FrameBuffer::Dimension{13, 10}));
+}
+
+TEST(DecodeImageFromFileToFrameBufferTest, FailsOnMissingFile) {
+  FrameBufferPool pool;
+  EXPECT_EQ(DecodeImageFromFileToFrameBuffer(GetTestPath("missing.jpg"),
+                                             {1, 1}, Format::kRGB, &pool)
+                .status()
+                .code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(DecodeImageFromFileToFrameBufferTest, FailsOnUnsupportedFormat) {
+  const std::string path = GetTestPath("format.jpg");
+  WriteJpegFile(path, /*channels=*/3);
+  FrameBufferPool pool;
+  EXPECT_EQ(DecodeImageFromFileToFrameBuffer(path, {1, 1}, Format::kRGBA, &pool)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
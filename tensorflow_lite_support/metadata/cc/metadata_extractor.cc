@@ -75,17 +75,45 @@ const T* GetItemFromVector(
   }
   return src_vector->Get(index);
 }
+
+// Util to populate `indices` with the index of each named TensorMetadata in
+// src_vector. The first occurrence wins in case of duplicate names.
+void BuildNameToIndexMap(
+    const flatbuffers::Vector<flatbuffers::Offset<TensorMetadata>>* src_vector,
+    absl::flat_hash_map<std::string, int>* indices) {
+  indices->clear();
+  if (src_vector == nullptr) {
+    return;
+  }
+  indices->reserve(src_vector->size());
+  for (int i = 0; i < src_vector->size(); ++i) {
+    const TensorMetadata* tensor_metadata = src_vector->Get(i);
+    if (tensor_metadata == nullptr || tensor_metadata->name() == nullptr) {
+      continue;
+    }
+    indices->emplace(tensor_metadata->name()->str(), i);
+  }
+}
+
+// Util to look up `name` in a map built by BuildNameToIndexMap.
+int FindIndexByName(const absl::flat_hash_map<std::string, int>& indices,
+                    absl::string_view name) {
+  auto it = indices.find(name);
+  return it == indices.end() ? -1 : it->second;
+}
 }  // namespace
 
 /* static */
 tflite::support::StatusOr<std::unique_ptr<ModelMetadataExtractor>>
 ModelMetadataExtractor::CreateFromModelBuffer(const char* buffer_data,
-                                              size_t buffer_size) {
+                                              size_t buffer_size,
+                                              bool verify_buffer) {
   // Use absl::WrapUnique() to call private constructor:
   // https://abseil.io/tips/126.
   std::unique_ptr<ModelMetadataExtractor> extractor =
       absl::WrapUnique(new ModelMetadataExtractor());
-  RETURN_IF_ERROR(extractor->InitFromModelBuffer(buffer_data, buffer_size));
+  RETURN_IF_ERROR(
+      extractor->InitFromModelBuffer(buffer_data, buffer_size, verify_buffer));
   return extractor;
 }
 
@@ -134,13 +162,13 @@ std::string ModelMetadataExtractor::FindFirstAssociatedFileName(
 }
 
 absl::Status ModelMetadataExtractor::InitFromModelBuffer(
-    const char* buffer_data, size_t buffer_size) {
+    const char* buffer_data, size_t buffer_size, bool verify_buffer) {
   // Rely on the simplest, base flatbuffers verifier. Here is not the place to
   // e.g. use an OpResolver: we just want to make sure the buffer is valid to
   // access the metadata.
   flatbuffers::Verifier verifier = flatbuffers::Verifier(
       reinterpret_cast<const uint8_t*>(buffer_data), buffer_size);
-  if (!tflite::VerifyModelBuffer(verifier)) {
+  if (verify_buffer && !tflite::VerifyModelBuffer(verifier)) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         "The model is not a valid FlatBuffer buffer.",
@@ -183,6 +211,7 @@ absl::Status ModelMetadataExtractor::InitFromModelBuffer(
       return CreateStatusWithPayload(StatusCode::kInternal,
                                      "Expected Model Metadata not to be null.");
     }
+    BuildTensorIndices();
     return ExtractAssociatedFiles(buffer_data, buffer_size);
     break;
   }
@@ -260,6 +289,11 @@ absl::Status ModelMetadataExtractor::ExtractAssociatedFiles(
   return absl::OkStatus();
 }
 
+void ModelMetadataExtractor::BuildTensorIndices() {
+  BuildNameToIndexMap(GetInputTensorMetadata(), &input_tensor_indices_);
+  BuildNameToIndexMap(GetOutputTensorMetadata(), &output_tensor_indices_);
+}
+
 tflite::support::StatusOr<absl::string_view>
 ModelMetadataExtractor::GetAssociatedFile(const std::string& filename) const {
   auto it = associated_files_.find(filename);
@@ -295,6 +329,10 @@ int ModelMetadataExtractor::GetInputTensorCount() const {
   return input_tensor_metadata == nullptr ? 0 : input_tensor_metadata->size();
 }
 
+int ModelMetadataExtractor::FindInputTensorIndex(absl::string_view name) const {
+  return FindIndexByName(input_tensor_indices_, name);
+}
+
 const Vector<Offset<TensorMetadata>>*
 ModelMetadataExtractor::GetOutputTensorMetadata() const {
   if (model_metadata_ == nullptr ||
@@ -318,6 +356,11 @@ int ModelMetadataExtractor::GetOutputTensorCount() const {
   return output_tensor_metadata == nullptr ? 0 : output_tensor_metadata->size();
 }
 
+int ModelMetadataExtractor::FindOutputTensorIndex(
+    absl::string_view name) const {
+  return FindIndexByName(output_tensor_indices_, name);
+}
+
 const Vector<flatbuffers::Offset<tflite::ProcessUnit>>*
 ModelMetadataExtractor::GetInputProcessUnits() const {
   if (model_metadata_ == nullptr ||
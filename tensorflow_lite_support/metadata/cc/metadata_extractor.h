@@ -46,8 +46,13 @@ class ModelMetadataExtractor {
   //
   // [1]:
   // tensorflow_lite_support/c/task/core/external_file_handler.h
+  //
+  // The buffer is checked with the base FlatBuffer verifier, unless
+  // `verify_buffer` is false: this is only meant for buffers that are known to
+  // have already passed verification.
   static tflite::support::StatusOr<std::unique_ptr<ModelMetadataExtractor>>
-  CreateFromModelBuffer(const char* buffer_data, size_t buffer_size);
+  CreateFromModelBuffer(const char* buffer_data, size_t buffer_size,
+                        bool verify_buffer = true);
 
   // Returns the pointer to the *first* ProcessUnit with the provided type, or
   // nullptr if none can be found. An error is returned if multiple
@@ -93,6 +98,11 @@ class ModelMetadataExtractor {
   // In particular, 0 is returned when there is no metadata.
   int GetInputTensorCount() const;
 
+  // Gets the index of the *first* input tensor whose metadata has the provided
+  // name, or -1 if there is no such tensor. The lookup is performed in constant
+  // time using an index built at creation time.
+  int FindInputTensorIndex(absl::string_view name) const;
+
   // Gets the metadata for output tensors.
   const flatbuffers::Vector<flatbuffers::Offset<tflite::TensorMetadata>>*
   GetOutputTensorMetadata() const;
@@ -105,6 +115,11 @@ class ModelMetadataExtractor {
   // In particular, 0 is returned when there is no metadata.
   int GetOutputTensorCount() const;
 
+  // Gets the index of the *first* output tensor whose metadata has the provided
+  // name, or -1 if there is no such tensor. The lookup is performed in constant
+  // time using an index built at creation time.
+  int FindOutputTensorIndex(absl::string_view name) const;
+
   // Gets the input process units from SubgraphMetadata.input_process_units,
   // could be nullptr.
   const flatbuffers::Vector<flatbuffers::Offset<tflite::ProcessUnit>>*
@@ -136,11 +151,15 @@ class ModelMetadataExtractor {
   // Private default constructor, called from CreateFromModel().
   ModelMetadataExtractor() = default;
   // Initializes the ModelMetadataExtractor from the provided Model FlatBuffer.
-  absl::Status InitFromModelBuffer(const char* buffer_data, size_t buffer_size);
+  absl::Status InitFromModelBuffer(const char* buffer_data, size_t buffer_size,
+                                   bool verify_buffer);
   // Extracts and stores in associated_files_ the associated files (if present)
   // packed into the model FlatBuffer data.
   absl::Status ExtractAssociatedFiles(const char* buffer_data,
                                       size_t buffer_size);
+  // Populates input_tensor_indices_ and output_tensor_indices_ from the
+  // input and output TensorMetadata names, if any.
+  void BuildTensorIndices();
   // Pointer to the TFLite Model object from which to read the ModelMetadata.
   const tflite::Model* model_{nullptr};
   // Pointer to the extracted ModelMetadata, if any.
@@ -149,6 +168,10 @@ class ModelMetadataExtractor {
   // (corresponding to a basename, e.g. "labels.txt") as key and the file
   // contents as value.
   absl::flat_hash_map<std::string, std::string> associated_files_;
+  // The indices of the input and output tensors, keyed by the name found in
+  // their respective TensorMetadata. Tensors without name are omitted.
+  absl::flat_hash_map<std::string, int> input_tensor_indices_;
+  absl::flat_hash_map<std::string, int> output_tensor_indices_;
 };
 
 }  // namespace metadata